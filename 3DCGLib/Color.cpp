@@ -2,16 +2,16 @@
 
 namespace Lib
 {
-    // RXgN^
+    // コンストラクタ
     Color::Color(const float _r, const float _g, const float _b, const float _a)
         : r(_r), g(_g), b(_b), a(_a)
     {
     }
-    // Rs[RXgN^
+    // コピーコンストラクタ
     Color::Color(const Color &other) : r(other.r), g(other.g), b(other.b), a(other.a)
     {
     }
-    // fXgN^
+    // デストラクタ
     Color::~Color()
     {
     }
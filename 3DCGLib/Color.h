@@ -21,16 +21,16 @@ namespace Lib
         };
 #pragma warning(default:4201)
 
-        // RXgN^
+        // コンストラクタ
         Color(const float _r = 1.0f, const float _g = 1.0f, const float _b = 1.0f, const float _a = 1.0f);
 
-        // Rs[RXgN^
+        // コピーコンストラクタ
         Color(const Color &other);
 
-        // fXgN^
+        // デストラクタ
         ~Color();
 
-        // ZqI[o[[h
+        // 演算子オーバーロード
         Color operator+(const Color& other) const
         {
             return Color(r + other.r, g + other.g, b + other.b, a + other.a);
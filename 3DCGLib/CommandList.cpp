@@ -0,0 +1,264 @@
+#include <cstring>
+#include "CommandList.h"
+
+namespace Lib
+{
+    // コンストラクタ
+    StateTracker::StateTracker()
+    {
+        reset();
+    }
+
+    // 状態を不明に戻す
+    void StateTracker::reset()
+    {
+        auto unknown = reinterpret_cast<NativeResource>(UNKNOWN_RESOURCE);
+        inputLayout  = unknown;
+        vertexBuffers.fill(unknown);
+        vertexStrides.fill(UNKNOWN);
+        vertexOffsets.fill(UNKNOWN);
+        indexBuffer  = unknown;
+        indexFormat  = UNKNOWN;
+        topology     = UNKNOWN;
+        vertexShader = unknown;
+        pixelShader  = unknown;
+        vsConstantBuffers.fill(ConstantBinding{ unknown, UNKNOWN, UNKNOWN });
+        psConstantBuffers.fill(ConstantBinding{ unknown, UNKNOWN, UNKNOWN });
+    }
+
+    // 入力レイアウト
+    bool StateTracker::setInputLayout(const NativeResource layout)
+    {
+        if (inputLayout == layout) {
+            return false;
+        }
+        inputLayout = layout;
+        return true;
+    }
+
+    // 頂点バッファ
+    bool StateTracker::setVertexBuffer(const uint32_t slot, const NativeResource buffer, const uint32_t stride, const uint32_t offset)
+    {
+        if (slot >= MAX_VERTEX_BUFFERS) {
+            return true;
+        }
+        if (vertexBuffers[slot] == buffer && vertexStrides[slot] == stride && vertexOffsets[slot] == offset) {
+            return false;
+        }
+        vertexBuffers[slot] = buffer;
+        vertexStrides[slot] = stride;
+        vertexOffsets[slot] = offset;
+        return true;
+    }
+
+    // インデックスバッファ
+    bool StateTracker::setIndexBuffer(const NativeResource buffer, const IndexFormat format)
+    {
+        if (indexBuffer == buffer && indexFormat == static_cast<uint32_t>(format)) {
+            return false;
+        }
+        indexBuffer = buffer;
+        indexFormat = static_cast<uint32_t>(format);
+        return true;
+    }
+
+    // プリミティブの種類
+    bool StateTracker::setPrimitiveTopology(const PrimitiveTopology _topology)
+    {
+        if (topology == static_cast<uint32_t>(_topology)) {
+            return false;
+        }
+        topology = static_cast<uint32_t>(_topology);
+        return true;
+    }
+
+    // 頂点シェーダー
+    bool StateTracker::setVertexShader(const NativeResource shader)
+    {
+        if (vertexShader == shader) {
+            return false;
+        }
+        vertexShader = shader;
+        return true;
+    }
+
+    // ピクセルシェーダー
+    bool StateTracker::setPixelShader(const NativeResource shader)
+    {
+        if (pixelShader == shader) {
+            return false;
+        }
+        pixelShader = shader;
+        return true;
+    }
+
+    // 頂点シェーダーのコンスタントバッファ
+    bool StateTracker::setVSConstantBuffer(const uint32_t slot, const NativeResource buffer, const uint32_t offset, const uint32_t size)
+    {
+        if (slot >= MAX_CONSTANT_BUFFERS) {
+            return true;
+        }
+        return setConstantBuffer(vsConstantBuffers[slot], buffer, offset, size);
+    }
+
+    // ピクセルシェーダーのコンスタントバッファ
+    bool StateTracker::setPSConstantBuffer(const uint32_t slot, const NativeResource buffer, const uint32_t offset, const uint32_t size)
+    {
+        if (slot >= MAX_CONSTANT_BUFFERS) {
+            return true;
+        }
+        return setConstantBuffer(psConstantBuffers[slot], buffer, offset, size);
+    }
+
+    // 定数バッファ(範囲も比較する)
+    bool StateTracker::setConstantBuffer(ConstantBinding &binding, const NativeResource buffer, const uint32_t offset, const uint32_t size)
+    {
+        if (binding.buffer == buffer && binding.offset == offset && binding.size == size) {
+            return false;
+        }
+        binding = ConstantBinding{ buffer, offset, size };
+        return true;
+    }
+
+    // コンストラクタ
+    CommandList::CommandList(const bool _eliminateRedundant)
+        : eliminateRedundant(_eliminateRedundant)
+    {
+        reset();
+    }
+
+    // 記録内容と状態を破棄する(確保済みのメモリは再利用する)
+    void CommandList::reset()
+    {
+        commands.clear();
+        payload.clear();
+        tracker.reset();
+        stats = Stats{ 0, 0, 0, 0 };
+    }
+
+    void CommandList::setInputLayout(const NativeResource layout)
+    {
+        if (tracker.setInputLayout(layout) || !eliminateRedundant) {
+            push(CommandType::SetInputLayout, 0, layout);
+        }
+        else {
+            eliminate();
+        }
+    }
+
+    void CommandList::setVertexBuffer(const NativeResource buffer, const uint32_t stride, const uint32_t offset, const uint32_t slot)
+    {
+        if (tracker.setVertexBuffer(slot, buffer, stride, offset) || !eliminateRedundant) {
+            push(CommandType::SetVertexBuffer, slot, buffer, stride, offset);
+        }
+        else {
+            eliminate();
+        }
+    }
+
+    void CommandList::setIndexBuffer(const NativeResource buffer, const IndexFormat format)
+    {
+        if (tracker.setIndexBuffer(buffer, format) || !eliminateRedundant) {
+            push(CommandType::SetIndexBuffer, 0, buffer, static_cast<uint32_t>(format));
+        }
+        else {
+            eliminate();
+        }
+    }
+
+    void CommandList::setPrimitiveTopology(const PrimitiveTopology topology)
+    {
+        if (tracker.setPrimitiveTopology(topology) || !eliminateRedundant) {
+            push(CommandType::SetPrimitiveTopology, 0, nullptr, static_cast<uint32_t>(topology));
+        }
+        else {
+            eliminate();
+        }
+    }
+
+    void CommandList::setVertexShader(const NativeResource shader)
+    {
+        if (tracker.setVertexShader(shader) || !eliminateRedundant) {
+            push(CommandType::SetVertexShader, 0, shader);
+        }
+        else {
+            eliminate();
+        }
+    }
+
+    void CommandList::setPixelShader(const NativeResource shader)
+    {
+        if (tracker.setPixelShader(shader) || !eliminateRedundant) {
+            push(CommandType::SetPixelShader, 0, shader);
+        }
+        else {
+            eliminate();
+        }
+    }
+
+    void CommandList::setVSConstantBuffer(const uint32_t slot, const NativeResource buffer, const uint32_t offset, const uint32_t size)
+    {
+        if (tracker.setVSConstantBuffer(slot, buffer, offset, size) || !eliminateRedundant) {
+            push(CommandType::SetVSConstantBuffer, slot, buffer, offset, size);
+        }
+        else {
+            eliminate();
+        }
+    }
+
+    void CommandList::setPSConstantBuffer(const uint32_t slot, const NativeResource buffer, const uint32_t offset, const uint32_t size)
+    {
+        if (tracker.setPSConstantBuffer(slot, buffer, offset, size) || !eliminateRedundant) {
+            push(CommandType::SetPSConstantBuffer, slot, buffer, offset, size);
+        }
+        else {
+            eliminate();
+        }
+    }
+
+    // バッファの更新
+    void CommandList::updateBuffer(const NativeResource buffer, const void *data, const uint32_t size)
+    {
+        auto position = appendPayload(size);
+        std::memcpy(payload.data() + position, data, size);
+        push(CommandType::UpdateBuffer, 0, buffer, position, size);
+    }
+
+    // バッファの部分更新(呼び出し側が返した領域へ直接書き込む)
+    uint8_t * CommandList::updateBufferRange(const NativeResource buffer, const uint32_t offset, const uint32_t size)
+    {
+        auto position = appendPayload(size);
+        push(CommandType::UpdateBuffer, 0, buffer, position, size, static_cast<int32_t>(offset), 1);
+        return payload.data() + position;
+    }
+
+    // 描画
+    void CommandList::drawIndexed(const uint32_t indexCount, const uint32_t startIndex, const int32_t baseVertex)
+    {
+        ++stats.draws;
+        push(CommandType::DrawIndexed, 0, nullptr, indexCount, startIndex, baseVertex);
+    }
+
+    // インスタンス描画
+    void CommandList::drawIndexedInstanced(const uint32_t indexCount, const uint32_t instanceCount, const uint32_t startIndex, const int32_t baseVertex, const uint32_t startInstance)
+    {
+        ++stats.draws;
+        push(CommandType::DrawIndexedInstanced, startInstance, nullptr, indexCount, startIndex, baseVertex, instanceCount);
+    }
+
+    // コマンドの追加
+    void CommandList::push(const CommandType type, const uint32_t slot, const NativeResource resource, const uint32_t arg0, const uint32_t arg1, const int32_t arg2, const uint32_t arg3)
+    {
+        commands.push_back(Command{ type, slot, resource, arg0, arg1, arg2, arg3 });
+        ++stats.recorded;
+    }
+
+    // 転送データの領域を末尾に確保して位置を返す
+    uint32_t CommandList::appendPayload(const uint32_t size)
+    {
+        auto position = static_cast<uint32_t>(payload.size());
+        payload.resize(payload.size() + size);
+        stats.updateBytes += size;
+        return position;
+    }
+}
@@ -0,0 +1,170 @@
+#pragma once
+#ifndef COMMANDLIST_H
+#define COMMANDLIST_H
+#include <array>
+#include <cstdint>
+#include <vector>
+#include "RenderDevice.h"
+#include "MeshData.h"
+
+namespace Lib
+{
+    // コマンドの種類(それぞれがAPI呼び出し1回に対応する)
+    enum class CommandType : uint8_t
+    {
+        SetInputLayout,
+        SetVertexBuffer,
+        SetIndexBuffer,
+        SetPrimitiveTopology,
+        SetVertexShader,
+        SetPixelShader,
+        SetVSConstantBuffer,
+        SetPSConstantBuffer,
+        UpdateBuffer,
+        DrawIndexed,
+        DrawIndexedInstanced,
+        Count,
+    };
+
+    // プリミティブの種類
+    enum class PrimitiveTopology : uint32_t
+    {
+        TriangleList,
+    };
+
+    // 記録されたコマンド
+    struct Command
+    {
+        CommandType    type;
+        uint32_t       slot; //                                                                                Instanced:開始インスタンス
+        NativeResource resource;
+        uint32_t       arg0; // VB:stride  IB:IndexFormat  Topology:種類  CB:範囲の開始  Update:データ位置  Draw:インデックス数
+        uint32_t       arg1; // VB:offset                                 CB:範囲の大きさ  Update:サイズ      Draw:開始インデックス
+        int32_t        arg2; //                                                          Update:転送先の位置  Draw:ベース頂点
+        uint32_t       arg3; //                                                          Update:範囲指定なら1 Instanced:インスタンス数
+    };
+
+    // パイプラインに設定済みの状態を保持し、同じ値の再設定を検出する
+    class StateTracker
+    {
+    public:
+        static const uint32_t MAX_CONSTANT_BUFFERS = 8;
+        static const uint32_t MAX_VERTEX_BUFFERS   = 2; // 頂点とインスタンス
+
+        StateTracker();
+
+        // 状態を不明に戻す(コンテキストの状態が変わった時に呼ぶ)
+        void reset();
+
+        // 変化があればtrueを返して記録する
+        bool setInputLayout(const NativeResource layout);
+        bool setVertexBuffer(const uint32_t slot, const NativeResource buffer, const uint32_t stride, const uint32_t offset);
+        bool setIndexBuffer(const NativeResource buffer, const IndexFormat format);
+        bool setPrimitiveTopology(const PrimitiveTopology topology);
+        bool setVertexShader(const NativeResource shader);
+        bool setPixelShader(const NativeResource shader);
+        bool setVSConstantBuffer(const uint32_t slot, const NativeResource buffer, const uint32_t offset, const uint32_t size);
+        bool setPSConstantBuffer(const uint32_t slot, const NativeResource buffer, const uint32_t offset, const uint32_t size);
+
+    private:
+        // 定数バッファのスロットの状態
+        struct ConstantBinding
+        {
+            NativeResource buffer;
+            uint32_t       offset;
+            uint32_t       size;
+        };
+
+        static bool setConstantBuffer(ConstantBinding &binding, const NativeResource buffer, const uint32_t offset, const uint32_t size);
+
+        // 未設定を表す値(nullptrの設定も冗長判定の対象にするため)
+        static const uint32_t  UNKNOWN          = 0xFFFFFFFF;
+        static const uintptr_t UNKNOWN_RESOURCE = ~static_cast<uintptr_t>(0);
+
+        NativeResource inputLayout;
+        std::array<NativeResource, MAX_VERTEX_BUFFERS> vertexBuffers;
+        std::array<uint32_t,       MAX_VERTEX_BUFFERS> vertexStrides;
+        std::array<uint32_t,       MAX_VERTEX_BUFFERS> vertexOffsets;
+        NativeResource indexBuffer;
+        uint32_t       indexFormat;
+        uint32_t       topology;
+        NativeResource vertexShader;
+        NativeResource pixelShader;
+        std::array<ConstantBinding, MAX_CONSTANT_BUFFERS> vsConstantBuffers;
+        std::array<ConstantBinding, MAX_CONSTANT_BUFFERS> psConstantBuffers;
+    };
+
+    // バックエンドに依存しないコマンドの記録
+    // 冗長な設定は記録時に取り除かれる
+    class CommandList
+    {
+    public:
+        // 統計情報
+        struct Stats
+        {
+            uint32_t recorded;    // 記録したコマンド数
+            uint32_t eliminated;  // 冗長として取り除いた設定の数
+            uint32_t draws;
+            uint32_t updateBytes; // UpdateBufferで転送するバイト数
+        };
+
+        explicit CommandList(const bool _eliminateRedundant = true);
+
+        // 記録内容と状態を破棄する
+        void reset();
+
+        void setInputLayout(const NativeResource layout);
+        // slot 1はインスタンスごとのデータ
+        void setVertexBuffer(const NativeResource buffer, const uint32_t stride, const uint32_t offset = 0, const uint32_t slot = 0);
+        void setIndexBuffer(const NativeResource buffer, const IndexFormat format);
+        void setPrimitiveTopology(const PrimitiveTopology topology);
+        void setVertexShader(const NativeResource shader);
+        void setPixelShader(const NativeResource shader);
+        // sizeが0ならバッファ全体、それ以外はoffsetバイト目からの範囲を設定する(offsetは256の倍数)
+        void setVSConstantBuffer(const uint32_t slot, const NativeResource buffer, const uint32_t offset = 0, const uint32_t size = 0);
+        void setPSConstantBuffer(const uint32_t slot, const NativeResource buffer, const uint32_t offset = 0, const uint32_t size = 0);
+        // dataは記録時にコピーされる
+        void updateBuffer(const NativeResource buffer, const void *data, const uint32_t size);
+        // bufferのoffsetバイト目からsizeバイトの更新を記録し、書き込み先を返す(定数バッファには使えない)
+        // ※返したポインタは次の記録まで有効で、16バイトに整列されているとは限らない
+        uint8_t *updateBufferRange(const NativeResource buffer, const uint32_t offset, const uint32_t size);
+        void drawIndexed(const uint32_t indexCount, const uint32_t startIndex = 0, const int32_t baseVertex = 0);
+        void drawIndexedInstanced(const uint32_t indexCount, const uint32_t instanceCount, const uint32_t startIndex = 0, const int32_t baseVertex = 0, const uint32_t startInstance = 0);
+
+        const std::vector<Command> &getCommands() const { return commands; }
+        const uint8_t *getPayload(const Command &command) const { return payload.data() + command.arg0; }
+        const Stats   &getStats() const { return stats; }
+        bool empty() const { return commands.empty(); }
+
+    private:
+        void push(const CommandType type, const uint32_t slot, const NativeResource resource, const uint32_t arg0 = 0, const uint32_t arg1 = 0, const int32_t arg2 = 0, const uint32_t arg3 = 0);
+        uint32_t appendPayload(const uint32_t size);
+        void eliminate() { ++stats.eliminated; }
+
+        std::vector<Command> commands;
+        std::vector<uint8_t> payload;
+        StateTracker         tracker;
+        Stats                stats;
+        bool                 eliminateRedundant;
+    };
+
+    // 記録されたコマンドを実行するバックエンドのインターフェース
+    class RenderContext
+    {
+    public:
+        virtual ~RenderContext() {}
+
+        virtual void execute(const CommandList &list) = 0;
+
+        // 複数のコマンドリストを並び順どおりに実行する
+        // (既定では順に実行する。並列に変換できるバックエンドはオーバーライドする)
+        virtual void executeParallel(const std::vector<const CommandList*> &lists)
+        {
+            for (auto list : lists) {
+                execute(*list);
+            }
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,333 @@
+#include <thread>
+#include "D3D11RenderDevice.h"
+
+namespace Lib
+{
+    namespace
+    {
+        // 定数バッファの範囲はバイト数ではなく16バイトの定数単位で、開始と数は16定数の倍数
+        const uint32_t CONSTANT_RANGE_ALIGNMENT = 256;
+
+        UINT toConstants(const uint32_t bytes)
+        {
+            return static_cast<UINT>(bytes / 16);
+        }
+    }
+
+    // コンストラクタ
+    D3D11RenderDevice::D3D11RenderDevice(ID3D11Device *_device)
+        : device(_device)
+    {
+    }
+
+    // デストラクタ
+    D3D11RenderDevice::~D3D11RenderDevice()
+    {
+    }
+
+    // シェーダーの作成
+    NativeResource D3D11RenderDevice::createShader(const ResourceType type, const void *bytecode, const size_t size)
+    {
+        HRESULT hr = E_INVALIDARG;
+        if (type == ResourceType::VertexShader) {
+            ID3D11VertexShader *shader = nullptr;
+            hr = device->CreateVertexShader(bytecode, size, nullptr, &shader);
+            if (SUCCEEDED(hr)) {
+                return shader;
+            }
+        }
+        else if (type == ResourceType::PixelShader) {
+            ID3D11PixelShader *shader = nullptr;
+            hr = device->CreatePixelShader(bytecode, size, nullptr, &shader);
+            if (SUCCEEDED(hr)) {
+                return shader;
+            }
+        }
+        return nullptr;
+    }
+
+    // 入力レイアウトの作成
+    NativeResource D3D11RenderDevice::createInputLayout(const VertexLayout layout, const void *bytecode, const size_t size)
+    {
+        // スロット0は頂点ごと、スロット1はインスタンスごと(InstanceData)
+        D3D11_INPUT_ELEMENT_DESC elements[] = {
+            { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT,    0,  0, D3D11_INPUT_PER_VERTEX_DATA,   0 },
+            {   "NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT,    0, 12, D3D11_INPUT_PER_VERTEX_DATA,   0 },
+            {    "WORLD", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1,  0, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+            {    "WORLD", 1, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 16, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+            {    "WORLD", 2, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 32, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+            { "MATERIAL", 0, DXGI_FORMAT_R32_UINT,           1, 48, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+        };
+        UINT elementCount = layout == VertexLayout::PositionNormalInstanced ? ARRAYSIZE(elements) : 2;
+
+        ID3D11InputLayout *inputLayout = nullptr;
+        auto hr = device->CreateInputLayout(elements, elementCount, bytecode, size, &inputLayout);
+        if (FAILED(hr)) {
+            return nullptr;
+        }
+        return inputLayout;
+    }
+
+    // バッファの作成
+    NativeResource D3D11RenderDevice::createBuffer(const ResourceType type, const uint32_t byteWidth, const void *initData)
+    {
+        D3D11_BUFFER_DESC bd;
+        ZeroMemory(&bd, sizeof(bd));
+        bd.Usage          = D3D11_USAGE_DEFAULT;
+        bd.ByteWidth      = byteWidth;
+        bd.CPUAccessFlags = 0;
+        switch (type) {
+        case ResourceType::VertexBuffer:   bd.BindFlags = D3D11_BIND_VERTEX_BUFFER;   break;
+        case ResourceType::IndexBuffer:    bd.BindFlags = D3D11_BIND_INDEX_BUFFER;    break;
+        case ResourceType::ConstantBuffer: bd.BindFlags = D3D11_BIND_CONSTANT_BUFFER; break;
+        case ResourceType::UploadBuffer:
+            // マップして書き込む(4096定数を超える大きさはD3D11.1の範囲指定で使う)
+            bd.Usage          = D3D11_USAGE_DYNAMIC;
+            bd.BindFlags      = D3D11_BIND_CONSTANT_BUFFER;
+            bd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+            break;
+        default: return nullptr;
+        }
+
+        D3D11_SUBRESOURCE_DATA data;
+        ZeroMemory(&data, sizeof(data));
+        data.pSysMem = initData;
+
+        ID3D11Buffer *buffer = nullptr;
+        auto hr = device->CreateBuffer(&bd, initData != nullptr ? &data : nullptr, &buffer);
+        if (FAILED(hr)) {
+            return nullptr;
+        }
+        return buffer;
+    }
+
+    // 解放
+    void D3D11RenderDevice::release(const ResourceType type, NativeResource resource)
+    {
+        (void)type;
+        if (resource != nullptr) {
+            static_cast<IUnknown*>(resource)->Release();
+        }
+    }
+
+    // コンストラクタ
+    D3D11RenderContext::D3D11RenderContext(ID3D11Device *_device, ID3D11DeviceContext *_context, JobSystem *_jobs)
+        : device(_device), context(_context), jobs(_jobs)
+    {
+        // 定数バッファの範囲指定にはD3D11.1のインターフェースを使う(無ければバッファ全体を設定する)
+        context->QueryInterface(__uuidof(ID3D11DeviceContext1), reinterpret_cast<void**>(context1.GetAddressOf()));
+    }
+
+    // デストラクタ
+    D3D11RenderContext::~D3D11RenderContext()
+    {
+    }
+
+    // コマンドの実行
+    void D3D11RenderContext::execute(const CommandList &list)
+    {
+        play(context, context1.Get(), list);
+    }
+
+    // 複数のコマンドリストの実行
+    void D3D11RenderContext::executeParallel(const std::vector<const CommandList*> &lists)
+    {
+        if (lists.size() <= 1 || jobs == nullptr) {
+            RenderContext::executeParallel(lists);
+            return;
+        }
+
+        // 遅延コンテキストの用意
+        while (deferredContexts.size() < lists.size()) {
+            Microsoft::WRL::ComPtr<ID3D11DeviceContext> deferred;
+            if (FAILED(device->CreateDeferredContext(0, deferred.GetAddressOf()))) {
+                RenderContext::executeParallel(lists);
+                return;
+            }
+            Microsoft::WRL::ComPtr<ID3D11DeviceContext1> deferred1;
+            deferred->QueryInterface(__uuidof(ID3D11DeviceContext1), reinterpret_cast<void**>(deferred1.GetAddressOf()));
+            deferredContexts.push_back(deferred);
+            deferredContexts1.push_back(deferred1);
+        }
+
+        // 遅延コンテキストは既定の状態から始まるので、現在の出力先を引き継ぐ
+        Microsoft::WRL::ComPtr<ID3D11RenderTargetView> renderTarget;
+        Microsoft::WRL::ComPtr<ID3D11DepthStencilView> depthStencil;
+        context->OMGetRenderTargets(1, renderTarget.GetAddressOf(), depthStencil.GetAddressOf());
+        D3D11_VIEWPORT viewports[D3D11_VIEWPORT_AND_SCISSORRECT_OBJECT_COUNT_PER_PIPELINE];
+        UINT viewportCount = ARRAYSIZE(viewports);
+        context->RSGetViewports(&viewportCount, viewports);
+
+        // ワーカーで変換(遅延コンテキストはリストごとに別なので同時に使える)
+        if (results.size() < lists.size()) {
+            results.resize(lists.size());
+        }
+        jobs->parallelFor(lists.size(), [&](const size_t begin, const size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                auto deferred = deferredContexts[i].Get();
+                deferred->OMSetRenderTargets(1, renderTarget.GetAddressOf(), depthStencil.Get());
+                deferred->RSSetViewports(viewportCount, viewports);
+                play(deferred, deferredContexts1[i].Get(), *lists[i]);
+                deferred->FinishCommandList(FALSE, results[i].ReleaseAndGetAddressOf());
+            }
+        });
+
+        // 並び順どおりに実行(即時コンテキストの状態は保持する)
+        for (size_t i = 0; i < lists.size(); ++i) {
+            if (results[i] != nullptr) {
+                context->ExecuteCommandList(results[i].Get(), TRUE);
+                results[i].Reset();
+            }
+        }
+    }
+
+    // コマンドを指定のコンテキストで実行
+    void D3D11RenderContext::play(ID3D11DeviceContext *target, ID3D11DeviceContext1 *target1, const CommandList &list)
+    {
+        for (auto &command : list.getCommands()) {
+            switch (command.type) {
+            case CommandType::SetInputLayout:
+                target->IASetInputLayout(static_cast<ID3D11InputLayout*>(command.resource));
+                break;
+            case CommandType::SetVertexBuffer: {
+                auto buffer = static_cast<ID3D11Buffer*>(command.resource);
+                UINT stride = command.arg0;
+                UINT offset = command.arg1;
+                target->IASetVertexBuffers(command.slot, 1, &buffer, &stride, &offset);
+                break;
+            }
+            case CommandType::SetIndexBuffer: {
+                auto format = static_cast<IndexFormat>(command.arg0) == IndexFormat::UInt16 ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+                target->IASetIndexBuffer(static_cast<ID3D11Buffer*>(command.resource), format, 0);
+                break;
+            }
+            case CommandType::SetPrimitiveTopology:
+                target->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+                break;
+            case CommandType::SetVertexShader:
+                target->VSSetShader(static_cast<ID3D11VertexShader*>(command.resource), nullptr, 0);
+                break;
+            case CommandType::SetPixelShader:
+                target->PSSetShader(static_cast<ID3D11PixelShader*>(command.resource), nullptr, 0);
+                break;
+            case CommandType::SetVSConstantBuffer: {
+                auto buffer = static_cast<ID3D11Buffer*>(command.resource);
+                if (command.arg1 != 0 && target1 != nullptr) {
+                    UINT first = toConstants(command.arg0);
+                    UINT count = toConstants(command.arg1 + CONSTANT_RANGE_ALIGNMENT - 1) & ~15u;
+                    target1->VSSetConstantBuffers1(command.slot, 1, &buffer, &first, &count);
+                }
+                else {
+                    target->VSSetConstantBuffers(command.slot, 1, &buffer);
+                }
+                break;
+            }
+            case CommandType::SetPSConstantBuffer: {
+                auto buffer = static_cast<ID3D11Buffer*>(command.resource);
+                if (command.arg1 != 0 && target1 != nullptr) {
+                    UINT first = toConstants(command.arg0);
+                    UINT count = toConstants(command.arg1 + CONSTANT_RANGE_ALIGNMENT - 1) & ~15u;
+                    target1->PSSetConstantBuffers1(command.slot, 1, &buffer, &first, &count);
+                }
+                else {
+                    target->PSSetConstantBuffers(command.slot, 1, &buffer);
+                }
+                break;
+            }
+            case CommandType::UpdateBuffer:
+                if (command.arg3 != 0) {
+                    // 部分更新
+                    auto offset = static_cast<UINT>(command.arg2);
+                    D3D11_BOX box = { offset, 0, 0, offset + command.arg1, 1, 1 };
+                    target->UpdateSubresource(static_cast<ID3D11Buffer*>(command.resource), 0, &box, list.getPayload(command), 0, 0);
+                }
+                else {
+                    target->UpdateSubresource(static_cast<ID3D11Buffer*>(command.resource), 0, nullptr, list.getPayload(command), 0, 0);
+                }
+                break;
+            case CommandType::DrawIndexed:
+                target->DrawIndexed(command.arg0, command.arg1, command.arg2);
+                break;
+            case CommandType::DrawIndexedInstanced:
+                target->DrawIndexedInstanced(command.arg0, command.arg3, command.arg1, command.arg2, command.slot);
+                break;
+            default:
+                break;
+            }
+        }
+    }
+
+    // コンストラクタ
+    D3D11Fence::D3D11Fence(ID3D11Device *_device, ID3D11DeviceContext *_context)
+        : device(_device), context(_context), issued(0), completed(0)
+    {
+    }
+
+    // デストラクタ
+    D3D11Fence::~D3D11Fence()
+    {
+    }
+
+    // フェンスの発行(それまでに発行した描画の後にイベントクエリを置く)
+    uint64_t D3D11Fence::signal()
+    {
+        ++issued;
+
+        Microsoft::WRL::ComPtr<ID3D11Query> query;
+        if (!freeQueries.empty()) {
+            query = freeQueries.back();
+            freeQueries.pop_back();
+        }
+        else {
+            D3D11_QUERY_DESC desc;
+            ZeroMemory(&desc, sizeof(desc));
+            desc.Query = D3D11_QUERY_EVENT;
+            if (FAILED(device->CreateQuery(&desc, query.GetAddressOf()))) {
+                // クエリを作れない時はGPUに追いつくまで待ったことにする
+                context->Flush();
+                completed = issued;
+                return issued;
+            }
+        }
+
+        context->End(query.Get());
+        pending.push_back(Pending{ issued, query });
+        return issued;
+    }
+
+    // 完了した値(待たない)
+    uint64_t D3D11Fence::getCompletedValue()
+    {
+        while (!pending.empty()) {
+            auto hr = context->GetData(pending.front().query.Get(), nullptr, 0, D3D11_ASYNC_GETDATA_DONOTFLUSH);
+            if (hr == S_FALSE) {
+                break;
+            }
+            retire();
+        }
+        return completed;
+    }
+
+    // 完了待ち
+    void D3D11Fence::wait(const uint64_t value)
+    {
+        while (completed < value && !pending.empty()) {
+            // 0を渡すとコマンドがGPUへ送られる
+            auto hr = context->GetData(pending.front().query.Get(), nullptr, 0, 0);
+            if (hr == S_FALSE) {
+                std::this_thread::yield();
+                continue;
+            }
+            // デバイスの消失などで失敗した時も完了扱いにして先へ進む
+            retire();
+        }
+    }
+
+    // 先頭のクエリを完了として回収
+    void D3D11Fence::retire()
+    {
+        completed = pending.front().value;
+        freeQueries.push_back(pending.front().query);
+        pending.erase(pending.begin());
+    }
+}
@@ -0,0 +1,89 @@
+#pragma once
+#ifndef D3D11RENDERDEVICE_H
+#define D3D11RENDERDEVICE_H
+#include <d3d11_2.h>
+#include <wrl\client.h>
+#include <vector>
+#include "RenderDevice.h"
+#include "CommandList.h"
+#include "JobSystem.h"
+#include "UploadRing.h"
+
+namespace Lib
+{
+    // Direct3D11によるバックエンド
+    class D3D11RenderDevice : public RenderDevice
+    {
+    public:
+        // deviceの寿命はこのオブジェクトより長いこと
+        explicit D3D11RenderDevice(ID3D11Device *_device);
+        ~D3D11RenderDevice();
+
+        NativeResource createShader(const ResourceType type, const void *bytecode, const size_t size) override;
+        NativeResource createInputLayout(const VertexLayout layout, const void *bytecode, const size_t size) override;
+        NativeResource createBuffer(const ResourceType type, const uint32_t byteWidth, const void *initData) override;
+        void release(const ResourceType type, NativeResource resource) override;
+
+    private:
+        ID3D11Device *device;
+    };
+
+    // Direct3D11のデバイスコンテキストでコマンドを実行する
+    class D3D11RenderContext : public RenderContext
+    {
+    public:
+        // device, context, jobsの寿命はこのオブジェクトより長いこと
+        // jobsがnullptrの場合、executeParallel()は即時コンテキストで順に実行する
+        D3D11RenderContext(ID3D11Device *_device, ID3D11DeviceContext *_context, JobSystem *_jobs = nullptr);
+        ~D3D11RenderContext();
+
+        void execute(const CommandList &list) override;
+        // 各リストをjobsのワーカーで遅延コンテキストへ並列に変換し、並び順どおりに実行する
+        void executeParallel(const std::vector<const CommandList*> &lists) override;
+
+    private:
+        // target1はD3D11.1に対応していなければnullptr
+        static void play(ID3D11DeviceContext *target, ID3D11DeviceContext1 *target1, const CommandList &list);
+
+        ID3D11Device        *device;
+        ID3D11DeviceContext *context;
+        JobSystem           *jobs;
+        Microsoft::WRL::ComPtr<ID3D11DeviceContext1> context1;
+        std::vector<Microsoft::WRL::ComPtr<ID3D11DeviceContext>>  deferredContexts;
+        std::vector<Microsoft::WRL::ComPtr<ID3D11DeviceContext1>> deferredContexts1;
+        std::vector<Microsoft::WRL::ComPtr<ID3D11CommandList>>    results; // 変換結果(実行後に解放し、配列は使い回す)
+    };
+
+    // イベントクエリによるフェンス
+    // ※即時コンテキストを使うので、他のスレッドが即時コンテキストを使っていない時に呼ぶこと
+    class D3D11Fence : public Fence
+    {
+    public:
+        // device, contextの寿命はこのオブジェクトより長いこと
+        D3D11Fence(ID3D11Device *_device, ID3D11DeviceContext *_context);
+        ~D3D11Fence();
+
+        uint64_t signal() override;
+        uint64_t getCompletedValue() override;
+        void wait(const uint64_t value) override;
+
+    private:
+        // 完了を待っているクエリ
+        struct Pending
+        {
+            uint64_t value;
+            Microsoft::WRL::ComPtr<ID3D11Query> query;
+        };
+
+        void retire();
+
+        ID3D11Device        *device;
+        ID3D11DeviceContext *context;
+        std::vector<Pending> pending; // 古い順(dequeは追加のたびにヒープを使うことがあるため)
+        std::vector<Microsoft::WRL::ComPtr<ID3D11Query>> freeQueries;
+        uint64_t issued;
+        uint64_t completed;
+    };
+}
+
+#endif
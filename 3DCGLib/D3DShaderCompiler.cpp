@@ -0,0 +1,114 @@
+#include <Windows.h>
+#include <d3dcompiler.h>
+#include <wrl\client.h>
+#include <list>
+#include <unordered_map>
+#include "D3DShaderCompiler.h"
+
+#pragma comment(lib, "d3dcompiler.lib")
+
+namespace Lib
+{
+    namespace
+    {
+        // パスのディレクトリ部分(区切りを含む。なければ空)
+        std::string directoryOf(const std::string &path)
+        {
+            auto slash = path.find_last_of("/\\");
+            return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+        }
+
+        // #includeしたファイルを読み込みつつ記録する
+        // ※相対パスは#includeしたファイルのディレクトリから探す(D3D_COMPILE_STANDARD_FILE_INCLUDEと同じ)
+        class RecordingInclude : public ID3DInclude
+        {
+        public:
+            RecordingInclude(const std::string &sourceName, std::vector<ShaderInclude> &_includes)
+                : rootDirectory(directoryOf(sourceName)), includes(_includes)
+            {
+            }
+
+            HRESULT STDMETHODCALLTYPE Open(D3D_INCLUDE_TYPE type, LPCSTR fileName, LPCVOID parentData, LPCVOID *data, UINT *bytes) override
+            {
+                UNREFERENCED_PARAMETER(type);
+                auto parent    = directories.find(parentData);
+                auto directory = parent != directories.end() ? parent->second : rootDirectory;
+                auto path      = directory + fileName;
+
+                contents.emplace_back();
+                if (!ShaderCache::readInclude(path, contents.back(), includes)) {
+                    contents.pop_back();
+                    return E_FAIL;
+                }
+                *data  = contents.back().data();
+                *bytes = static_cast<UINT>(contents.back().size());
+                directories[*data] = directoryOf(path);
+                return S_OK;
+            }
+
+            HRESULT STDMETHODCALLTYPE Close(LPCVOID data) override
+            {
+                // 内容はコンパイルが終わるまで保持する(入れ子の#includeの親として参照されるため)
+                UNREFERENCED_PARAMETER(data);
+                return S_OK;
+            }
+
+        private:
+            std::string                              rootDirectory;
+            std::vector<ShaderInclude>              &includes;
+            std::list<std::string>                   contents;
+            std::unordered_map<LPCVOID, std::string> directories; // 読み込んだ内容 -> そのファイルのディレクトリ
+        };
+    }
+
+    // コンパイル
+    bool D3DShaderCompiler::compile(const ShaderSource &source, std::vector<uint8_t> &bytecode, std::vector<ShaderInclude> &includes, std::string &error)
+    {
+        // マクロ定義(終端はnullptr)
+        std::vector<D3D_SHADER_MACRO> macros;
+        macros.reserve(source.defines.size() + 1);
+        for (auto &define : source.defines) {
+            macros.push_back({ define.name.c_str(), define.value.c_str() });
+        }
+        macros.push_back({ nullptr, nullptr });
+
+        Microsoft::WRL::ComPtr<ID3DBlob> blobOut   = nullptr;
+        Microsoft::WRL::ComPtr<ID3DBlob> errorBlob = nullptr;
+
+        // ファイルと同じディレクトリからの#includeを許可する
+        RecordingInclude includeHandler(source.name, includes);
+        auto hr = D3DCompile(
+            source.code.data(),
+            source.code.size(),
+            source.name.c_str(),
+            macros.data(),
+            &includeHandler,
+            source.entryPoint.c_str(),
+            source.profile.c_str(),
+            source.flags,
+            0,
+            blobOut.GetAddressOf(),
+            errorBlob.GetAddressOf()
+        );
+
+        if (FAILED(hr)) {
+            if (errorBlob != nullptr) {
+                error.assign(static_cast<const char*>(errorBlob->GetBufferPointer()), errorBlob->GetBufferSize());
+            }
+            else {
+                error = "D3DCompile() failed";
+            }
+            return false;
+        }
+
+        auto data = static_cast<const uint8_t*>(blobOut->GetBufferPointer());
+        bytecode.assign(data, data + blobOut->GetBufferSize());
+        return true;
+    }
+
+    // コンパイラの版
+    uint64_t D3DShaderCompiler::getVersion() const
+    {
+        return D3D_COMPILER_VERSION;
+    }
+}
@@ -0,0 +1,18 @@
+#pragma once
+#ifndef D3DSHADERCOMPILER_H
+#define D3DSHADERCOMPILER_H
+#include "ShaderCache.h"
+
+namespace Lib
+{
+    // D3DCompile()によるシェーダーコンパイラ
+    // ※#includeはファイルと同じディレクトリから読み込み、読み込んだファイルをキャッシュの無効化のために記録する
+    class D3DShaderCompiler : public IShaderCompiler
+    {
+    public:
+        bool compile(const ShaderSource &source, std::vector<uint8_t> &bytecode, std::vector<ShaderInclude> &includes, std::string &error) override;
+        uint64_t getVersion() const override;
+    };
+}
+
+#endif
@@ -1,11 +1,33 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <cwchar>
 #include <d3dcompiler.h>
 #include "DirectX11.h"
+#include "D3DShaderCompiler.h"
+#include "D3D11RenderDevice.h"
+#include "Hash.h"
+#include "Profiler.h"
 
 #pragma comment(lib, "d3dcompiler.lib")
 
 namespace Lib
 {
-    // RXgN^
+    namespace
+    {
+        // 転送用リングの大きさ(256バイト単位で4096回分。3フレーム分の描画ごとの定数が収まること)
+        const uint32_t UPLOAD_RING_SIZE = 1024 * 1024;
+
+        // HRESULTを付けた失敗の表示(例: "GetBuffer()の失敗 : 0x887A0005")
+        void showFailure(const wchar_t *function, const HRESULT hr, const wchar_t *caption)
+        {
+            wchar_t message[128];
+            swprintf(message, sizeof(message) / sizeof(message[0]), L"%lsの失敗 : 0x%08X", function, static_cast<unsigned>(hr));
+            MessageBox(nullptr, message, caption, MB_OK);
+        }
+    }
+
+    // コンストラクタ
     DirectX11::DirectX11()
     {
         device           = nullptr;
@@ -15,65 +37,481 @@ namespace Lib
         depthStencil     = nullptr;
         depthStencilView = nullptr;
 
+        lightPosition = Vector3(-2.0f, 2.0f, -1.0f);
+
+        viewVersion                     = 1;
+        projectionVersion               = 1;
+        lightVersion                    = 1;
+        frameViewVersion                = 0;
+        frameProjectionVersion          = 0;
+        frameLightVersion               = 0;
+        viewProjectionViewVersion       = 0;
+        viewProjectionProjectionVersion = 0;
+        sceneVersion                    = 1;
+        frameSceneVersion               = 0;
+        presentedSceneVersion           = 0;
+        presentedFrames                 = 0;
+        skippedFrames                   = 0;
+        presentTime                     = 0.0f;
+
+        uploadBytes      = 0;
+        frameUploadBytes = 0;
+        uploadMapped     = false;
+        uploadDiscarded  = false;
+
+        renderTargetBytes = 0;
+        backBufferWidth   = 0;
+        backBufferHeight  = 0;
+
+        frameCapture   = nullptr;
+        captureRead    = 0;
+        capturePending = 0;
+
+        // コンパイル済みシェーダーは実行ディレクトリのShaderCacheに保存する
+        shaderCache = std::make_unique<ShaderCache>(std::make_shared<D3DShaderCompiler>(), "ShaderCache");
     }
 
-    // fXgN^
+    // デストラクタ
     DirectX11::~DirectX11()
     {
+        unmapUploadRing();
     }
 
-    // t[̊Jn
-    void DirectX11::begineFrame() const
+    // フレームの開始
+    void DirectX11::begineFrame()
     {
+        PROFILE_SCOPE("DirectX11::begineFrame");
+        frameArena.beginFrame();
+        renderStats.beginFrame();
+        frameSceneVersion = sceneVersion;
         float ClearColor[4]{ 0.0f, 0.125f, 0.3f, 1.0f };
         deviceContext->ClearRenderTargetView(renderTargetView.Get(), ClearColor);
-        // Zobt@[̃NA
+        // Zバッファーのクリア
         deviceContext->ClearDepthStencilView(depthStencilView.Get(), D3D11_CLEAR_DEPTH, 1.0f, 0);
+        // 描画コマンドの記録を開始
+        commandList.reset();
+        if (uploadRing != nullptr && !uploadMapped) {
+            uploadRing->beginFrame();
+            mapUploadRing();
+        }
     }
 
-    // t[̏I
-    void DirectX11::endFrame() const
+    // フレームの終了
+    void DirectX11::endFrame()
     {
-        swapChain->Present(0, 0);
+        PROFILE_SCOPE("DirectX11::endFrame");
+        // 記録したコマンドの実行
+        unmapUploadRing();
+        if (renderStats.isEnabled()) {
+            renderStats.count(commandList);
+        }
+        renderContext->execute(commandList);
+        frameUploadBytes += commandList.getStats().updateBytes;
+        commandList.reset();
+
+        // GPUがこのフレームの定数を使い終えたらリングの領域を再利用する
+        if (uploadRing != nullptr) {
+            uploadRing->endFrame();
+            frameUploadBytes += uploadRing->getStats().bytes;
+            renderStats.addConstantBytes(uploadRing->getStats().bytes);
+        }
+        renderStats.endFrame();
+
+        uploadBytes      = frameUploadBytes;
+        frameUploadBytes = 0;
+        captureFrame();
+        {
+            PROFILE_SCOPE("Present");
+            auto presentBegin = std::chrono::steady_clock::now();
+            swapChain->Present(0, 0);
+            presentTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - presentBegin).count();
+        }
+        // 描画中に変更があった場合は次のフレームも描画する
+        presentedSceneVersion = frameSceneVersion;
+        ++presentedFrames;
     }
 
-    // foCX̎擾
-    ComPtr<ID3D11Device> DirectX11::getDevice()
+    // デバイスの取得
+    const ComPtr<ID3D11Device> & DirectX11::getDevice() const
     {
         return device;
     }
 
-    // foCXReLXg̎擾
-    ComPtr<ID3D11DeviceContext> DirectX11::getDeviceContext()
+    // デバイスコンテキストの取得
+    const ComPtr<ID3D11DeviceContext> & DirectX11::getDeviceContext() const
     {
         return deviceContext;
     }
 
-    // r[sݒ
+    // 描画コマンドの取得
+    CommandList & DirectX11::getCommandList()
+    {
+        return commandList;
+    }
+
+    // フレーム内の一時メモリの取得
+    FrameArena & DirectX11::getFrameArena()
+    {
+        return frameArena;
+    }
+
+    // 描画の負荷の集計の取得
+    RenderStats & DirectX11::getRenderStats()
+    {
+        return renderStats;
+    }
+
+    // GPUメモリの見積もり
+    RenderStats::Memory DirectX11::getMemoryStats() const
+    {
+        return RenderStats::measureMemory(*resourceRegistry, renderTargetBytes);
+    }
+
+    // コマンド実行先の取得
+    RenderContext & DirectX11::getRenderContext()
+    {
+        return *renderContext;
+    }
+
+    // シェーダーキャッシュの取得
+    ShaderCache & DirectX11::getShaderCache()
+    {
+        return *shaderCache;
+    }
+
+    // リソースレジストリの取得
+    ResourceRegistry & DirectX11::getResourceRegistry()
+    {
+        return *resourceRegistry;
+    }
+
+    // リソース生成を行うバックエンドの取得
+    RenderDevice & DirectX11::getRenderDevice()
+    {
+        return *renderDevice;
+    }
+
+    // 常駐ワーカーの取得
+    JobSystem & DirectX11::getJobSystem()
+    {
+        return *jobSystem;
+    }
+
+    // 並列に記録したコマンドの実行
+    void DirectX11::submit(const ParallelRecorder &recorder)
+    {
+        unmapUploadRing();
+        if (renderStats.isEnabled()) {
+            renderStats.count(commandList);
+            for (size_t i = 0; i < recorder.getSliceCount(); ++i) {
+                renderStats.count(recorder.getList(i));
+            }
+        }
+        renderContext->execute(commandList);
+        frameUploadBytes += commandList.getStats().updateBytes;
+        commandList.reset();
+        recorder.submit(*renderContext);
+        frameUploadBytes += recorder.getStats().updateBytes;
+        // 以降の記録のためにマップし直す(書き込み済みの範囲はリングが避ける)
+        mapUploadRing();
+    }
+
+    // ビュー行列を設定
     void DirectX11::setViewMatrix(const Matrix & _view)
     {
         view = _view;
+        ++viewVersion;
+        markSceneChanged();
     }
 
-    // r[s擾
-    Matrix & DirectX11::getViewMatrix()
+    // ビュー行列を取得
+    const Matrix & DirectX11::getViewMatrix() const
     {
         return view;
     }
 
-    // ˉesݒ
+    // 射影行列を設定
     void DirectX11::setProjectionMatrix(const Matrix & _projection)
     {
         projection = _projection;
+        ++projectionVersion;
+        markSceneChanged();
     }
 
-    // ˉes擾
-    Matrix & DirectX11::getProjectionMatrix()
+    // 射影行列を取得
+    const Matrix & DirectX11::getProjectionMatrix() const
     {
         return projection;
     }
 
-    // 
+    // 点光源の位置を設定
+    void DirectX11::setLightPosition(const Vector3 & _lightPosition)
+    {
+        if (lightPosition != _lightPosition) {
+            lightPosition = _lightPosition;
+            ++lightVersion;
+            markSceneChanged();
+        }
+    }
+
+    // 点光源の位置を取得
+    const Vector3 & DirectX11::getLightPosition() const
+    {
+        return lightPosition;
+    }
+
+    // 画面の内容の変更を知らせる
+    void DirectX11::markSceneChanged()
+    {
+        ++sceneVersion;
+    }
+
+    // 最後に表示したフレーム以降に変更があったか
+    bool DirectX11::isSceneChanged() const
+    {
+        return sceneVersion != presentedSceneVersion;
+    }
+
+    // 描画を省略したフレームを数える
+    void DirectX11::skipFrame()
+    {
+        ++skippedFrames;
+    }
+
+    // 表示したフレーム数
+    uint64_t DirectX11::getPresentedFrames() const
+    {
+        return presentedFrames;
+    }
+
+    // 描画を省略したフレーム数
+    uint64_t DirectX11::getSkippedFrames() const
+    {
+        return skippedFrames;
+    }
+
+    // Presentにかかった時間
+    float DirectX11::getPresentTime() const
+    {
+        return presentTime;
+    }
+
+    // フレーム定数の更新
+    void DirectX11::updateFrameConstants()
+    {
+        if (frameViewVersion == viewVersion && frameProjectionVersion == projectionVersion && frameLightVersion == lightVersion) {
+            return;
+        }
+
+        // ビュー射影行列はビューか射影が変わった時だけ計算する
+        if (viewProjectionViewVersion != viewVersion || viewProjectionProjectionVersion != projectionVersion) {
+            viewProjection                  = view * projection;
+            viewProjectionViewVersion       = viewVersion;
+            viewProjectionProjectionVersion = projectionVersion;
+        }
+
+        FrameConstants constants;
+        constants.view           = Matrix::transpose(view);
+        constants.projection     = Matrix::transpose(projection);
+        constants.viewProjection = Matrix::transpose(viewProjection);
+
+        // 視点はビュー行列の平行移動成分を回転の逆で戻して求める
+        constants.eyePos[0] = -(view.m41 * view.m11 + view.m42 * view.m12 + view.m43 * view.m13);
+        constants.eyePos[1] = -(view.m41 * view.m21 + view.m42 * view.m22 + view.m43 * view.m23);
+        constants.eyePos[2] = -(view.m41 * view.m31 + view.m42 * view.m32 + view.m43 * view.m33);
+        constants.eyePos[3] = 1.0f;
+
+        const float ambient[4]   = { 0.2f, 0.2f, 0.2f, 0.0f };
+        const float diffuse[4]   = { 1.0f, 1.0f, 1.0f, 0.0f };
+        const float attenuate[4] = { 1.0f, 0.1f, 0.1f, 0.0f };
+        const float pos[4]       = { lightPosition.x, lightPosition.y, lightPosition.z, 0.0f };
+        memcpy(constants.ambient,              ambient,   sizeof(ambient));
+        memcpy(constants.pointLight.pos,       pos,       sizeof(pos));
+        memcpy(constants.pointLight.diffuse,   diffuse,   sizeof(diffuse));
+        memcpy(constants.pointLight.attenuate, attenuate, sizeof(attenuate));
+
+        commandList.updateBuffer(frameConstantBuffer.get(), &constants, sizeof(constants));
+
+        frameViewVersion       = viewVersion;
+        frameProjectionVersion = projectionVersion;
+        frameLightVersion      = lightVersion;
+    }
+
+    // フレーム定数のバッファ
+    NativeResource DirectX11::getFrameConstantBuffer() const
+    {
+        return frameConstantBuffer.get();
+    }
+
+    // 直前のフレームで転送した定数のバイト数
+    uint32_t DirectX11::getUploadBytes() const
+    {
+        return uploadBytes;
+    }
+
+    // 転送用リングからの割り当て
+    UploadRing::Allocation DirectX11::allocateUpload(const uint32_t size)
+    {
+        if (uploadRing == nullptr) {
+            return UploadRing::Allocation{ nullptr, 0, 0 };
+        }
+        return uploadRing->allocate(size);
+    }
+
+    // 転送用リングのバッファ
+    NativeResource DirectX11::getUploadBuffer() const
+    {
+        return uploadBuffer.get();
+    }
+
+    // 転送用リングの取得
+    const UploadRing * DirectX11::getUploadRing() const
+    {
+        return uploadRing.get();
+    }
+
+    // 転送用リングの初期化
+    // ※定数バッファの範囲指定とNO_OVERWRITEでのマップ(D3D11.1)に対応していなければ作らない
+    HRESULT DirectX11::initUploadRing()
+    {
+        D3D11_FEATURE_DATA_D3D11_OPTIONS options;
+        ZeroMemory(&options, sizeof(options));
+        auto hr = device->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options));
+        if (FAILED(hr) || !options.ConstantBufferOffsetting || !options.MapNoOverwriteOnDynamicConstantBuffer) {
+            return S_FALSE;
+        }
+
+        uploadBuffer = resourceRegistry->getBuffer(ResourceType::UploadBuffer, Hash::fnv1a("UploadRing", 10), UPLOAD_RING_SIZE, 0, nullptr);
+        if (!uploadBuffer) {
+            return S_FALSE;
+        }
+        uploadFence = std::make_unique<D3D11Fence>(device.Get(), deviceContext.Get());
+        uploadRing  = std::make_unique<UploadRing>(UPLOAD_RING_SIZE, *uploadFence);
+        return S_OK;
+    }
+
+    // 転送用リングのマップ
+    void DirectX11::mapUploadRing()
+    {
+        if (uploadRing == nullptr || uploadMapped) {
+            return;
+        }
+
+        // 最初の1回だけ破棄、以降はGPUが使用中の範囲に書き込まないことをリングが保証する
+        D3D11_MAPPED_SUBRESOURCE mapped;
+        auto mapType = uploadDiscarded ? D3D11_MAP_WRITE_NO_OVERWRITE : D3D11_MAP_WRITE_DISCARD;
+        auto hr = deviceContext->Map(static_cast<ID3D11Buffer*>(uploadBuffer.get()), 0, mapType, 0, &mapped);
+        if (FAILED(hr)) {
+            uploadRing->setMemory(nullptr);
+            return;
+        }
+        uploadRing->setMemory(static_cast<uint8_t*>(mapped.pData));
+        uploadMapped    = true;
+        uploadDiscarded = true;
+    }
+
+    // 転送用リングのマップ解除
+    void DirectX11::unmapUploadRing()
+    {
+        if (!uploadMapped) {
+            return;
+        }
+        uploadRing->setMemory(nullptr);
+        deviceContext->Unmap(static_cast<ID3D11Buffer*>(uploadBuffer.get()), 0);
+        uploadMapped = false;
+    }
+
+    // 画像の書き出し先の設定
+    void DirectX11::setFrameCapture(FrameCapture *_frameCapture)
+    {
+        // 読み戻し待ちのフレームを前の書き出し先へ全て渡す
+        while (capturePending > 0) {
+            readbackCapture(true);
+        }
+        frameCapture = _frameCapture;
+        captureRead  = 0;
+        if (frameCapture == nullptr || captureStaging[0] != nullptr) {
+            return;
+        }
+
+        // コピー先(バックバッファと同じ形式でCPUから読めるもの)
+        D3D11_TEXTURE2D_DESC desc;
+        backBuffer->GetDesc(&desc);
+        desc.Usage          = D3D11_USAGE_STAGING;
+        desc.BindFlags      = 0;
+        desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+        desc.MiscFlags      = 0;
+        for (auto &staging : captureStaging) {
+            HRESULT hr = device->CreateTexture2D(&desc, nullptr, staging.GetAddressOf());
+            if (FAILED(hr)) {
+                showFailure(L"CreateTexture2D()", hr, L"Error");
+                for (auto &created : captureStaging) {
+                    created.Reset();
+                }
+                frameCapture = nullptr;
+                return;
+            }
+        }
+    }
+
+    // バックバッファの幅
+    UINT DirectX11::getBackBufferWidth() const
+    {
+        return backBufferWidth;
+    }
+
+    // バックバッファの高さ
+    UINT DirectX11::getBackBufferHeight() const
+    {
+        return backBufferHeight;
+    }
+
+    // フレームの画像のコピーと読み戻し
+    void DirectX11::captureFrame()
+    {
+        if (frameCapture == nullptr || !frameCapture->isRunning()) {
+            return;
+        }
+        PROFILE_SCOPE("DirectX11::captureFrame");
+        // GPUが終えたコピーを古い順に読み戻す(リングが一杯なら最も古いものだけは待つ)
+        while (capturePending > 0) {
+            if (!readbackCapture(capturePending == CAPTURE_STAGING_COUNT)) {
+                break;
+            }
+        }
+        auto index = (captureRead + capturePending) % CAPTURE_STAGING_COUNT;
+        deviceContext->CopyResource(captureStaging[index].Get(), backBuffer.Get());
+        ++capturePending;
+    }
+
+    // 最も古いコピーの読み戻し
+    bool DirectX11::readbackCapture(const bool wait)
+    {
+        auto &staging = captureStaging[captureRead];
+        D3D11_MAPPED_SUBRESOURCE mapped;
+        HRESULT hr = deviceContext->Map(staging.Get(), 0, D3D11_MAP_READ, wait ? 0 : D3D11_MAP_FLAG_DO_NOT_WAIT, &mapped);
+        if (hr == DXGI_ERROR_WAS_STILL_DRAWING) {
+            return false;
+        }
+        if (SUCCEEDED(hr)) {
+            // 行の間の詰め物を除いてプールのバッファへ写す(Dropで空きがなければこのフレームは捨てる)
+            if (auto buffer = frameCapture != nullptr ? frameCapture->acquire() : nullptr) {
+                auto width  = std::min(buffer->width, backBufferWidth);
+                auto height = std::min(buffer->height, backBufferHeight);
+                auto src    = static_cast<const uint8_t*>(mapped.pData);
+                for (UINT y = 0; y < height; ++y) {
+                    std::memcpy(buffer->data + static_cast<size_t>(y) * buffer->width * 4, src + static_cast<size_t>(y) * mapped.RowPitch, width * 4);
+                }
+                frameCapture->submit(buffer);
+            }
+            deviceContext->Unmap(staging.Get(), 0);
+        }
+        captureRead = (captureRead + 1) % CAPTURE_STAGING_COUNT;
+        --capturePending;
+        return true;
+    }
+
+    // 初期化
     HRESULT DirectX11::initDevice(std::shared_ptr<Window> _window)
     {
         window = _window;
@@ -82,7 +520,7 @@ namespace Lib
         createDeviceFlags |= D3D11_CREATE_DEVICE_DEBUG;
 #endif
 
-        // hCo[̎ނ̃IvV
+        // ドライバーの種類のオプション
         D3D_DRIVER_TYPE driverTypes[] =
         {
             D3D_DRIVER_TYPE_HARDWARE,
@@ -91,7 +529,7 @@ namespace Lib
         };
         UINT numDriverTypes = ARRAYSIZE(driverTypes);
 
-        // Direct3DfoCX̃^[QbgƂȂ@\Zbg
+        // Direct3Dデバイスのターゲットとなる機能セット
         D3D_FEATURE_LEVEL featureLevels[] =
         {
             D3D_FEATURE_LEVEL_11_0,
@@ -108,35 +546,35 @@ namespace Lib
 
         DXGI_SWAP_CHAIN_DESC sd;
         ZeroMemory(&sd, sizeof(sd));
-        sd.BufferCount = 1;                                // Xbv`F[̃obt@[
-        sd.BufferDesc.Width = windowWidth;                 // 𑜓x̕
-        sd.BufferDesc.Height = windowHeight;               // 𑜓x̍
-        sd.BufferDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM; // \tH[}bg
-        sd.BufferDesc.RefreshRate.Numerator = 60;          // L̍ől
-        sd.BufferDesc.RefreshRate.Denominator = 1;         // L̍ŏl
-        sd.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;  // obNobt@[̃T[tFXgp@CPUANZXIvV
-        sd.OutputWindow = window->getHWND();               // o̓EBhEւHWNDnh
-        sd.SampleDesc.Count = 1;                           // sNZPʂ̃}`TvO̐
-        sd.SampleDesc.Quality = 0;                         // C[W̕ix
-        sd.Windowed = TRUE;                                // o͂EBhE[h̏ꍇTRUEȊOFALSE
+        sd.BufferCount = 1;                                // スワップチェーンのバッファー数
+        sd.BufferDesc.Width = windowWidth;                 // 解像度の幅
+        sd.BufferDesc.Height = windowHeight;               // 解像度の高さ
+        sd.BufferDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM; // 表示フォーマット
+        sd.BufferDesc.RefreshRate.Numerator = 60;          // 有理数の最大値
+        sd.BufferDesc.RefreshRate.Denominator = 1;         // 有理数の最小値
+        sd.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;  // バックバッファーのサーフェス使用法およびCPUアクセスオプション
+        sd.OutputWindow = window->getHWND();               // 出力ウィンドウへのHWNDハンドル
+        sd.SampleDesc.Count = 1;                           // ピクセル単位のマルチサンプリングの数
+        sd.SampleDesc.Quality = 0;                         // イメージの品質レベル
+        sd.Windowed = TRUE;                                // 出力がウィンドウモードの場合はTRUEそれ以外はFALSE
 
         HRESULT hr = S_OK;
         for (UINT driverTypeIndex = 0; driverTypeIndex < numDriverTypes; driverTypeIndex++)
         {
             driverType = driverTypes[driverTypeIndex];
             hr = D3D11CreateDeviceAndSwapChain(
-                nullptr,                               // gprfIA_v^[ւ̃|C^[î̂gꍇNULLj
-                driverType,                            // gpfoCX̎
-                nullptr,                               // \tgEFAX^CU[DLL̃nh
-                createDeviceFlags,                     // Lɂ郉^CC[
-                featureLevels,                         // D3D_FEATURE_LEVEL̔zւ̃|C^[
-                numFeatureLevels,                      // Lz̗vf
-                D3D11_SDK_VERSION,                     // SDK̃o[W
-                &sd,                                   // DXGI_SWAP_CHAINւ̃|C^[
-                swapChain.GetAddressOf(),              // IDXGISwapChainIuWFNgւ̃|C^[̃AhXԂ
-                device.GetAddressOf(),                 // ID3D11DeviceIuWFNgւ̃|C^[̃AhXԂ
-                &featureLevel,	                       // D3D_FEATURE_LEVELւ̃|C^[Ԃ
-                deviceContext.GetAddressOf()           // ID3D11DeviceContextIuWFNgւ̃|C^[̃AhXԂ
+                nullptr,                               // 使用するビデオアダプターへのポインター（既定のものを使う場合NULL）
+                driverType,                            // 使用するデバイスの種類
+                nullptr,                               // ソフトウェアラスタライザーを実装するDLLのハンドル
+                createDeviceFlags,                     // 有効にするランタイムレイヤー
+                featureLevels,                         // D3D_FEATURE_LEVELの配列へのポインター
+                numFeatureLevels,                      // 上記配列の要素数
+                D3D11_SDK_VERSION,                     // SDKのバージョン
+                &sd,                                   // DXGI_SWAP_CHAINへのポインター
+                swapChain.GetAddressOf(),              // IDXGISwapChainオブジェクトへのポインターのアドレスを返す
+                device.GetAddressOf(),                 // ID3D11Deviceオブジェクトへのポインターのアドレスを返す
+                &featureLevel,	                       // D3D_FEATURE_LEVELへのポインターを返す
+                deviceContext.GetAddressOf()           // ID3D11DeviceContextオブジェクトへのポインターのアドレスを返す
             );
 
             if (SUCCEEDED(hr)) {
@@ -144,68 +582,87 @@ namespace Lib
             }
         }
         if (FAILED(hr)) {
-            MessageBox(nullptr, L"D3DCreateDeviceAndSwapChain()̎s : " + hr, L"Error", MB_OK);
+            showFailure(L"D3DCreateDeviceAndSwapChain()", hr, L"Error");
             return hr;
         }
 
-        Microsoft::WRL::ComPtr<ID3D11Texture2D> backBuffer;
-        // obNobt@̎擾
+        // 共有リソースの管理
+        renderDevice     = std::make_unique<D3D11RenderDevice>(device.Get());
+        resourceRegistry = std::make_unique<ResourceRegistry>(*renderDevice);
+        jobSystem        = std::make_unique<JobSystem>();
+        renderContext    = std::make_unique<D3D11RenderContext>(device.Get(), deviceContext.Get(), jobSystem.get());
+
+        // フレーム定数(b0)
+        frameConstantBuffer = resourceRegistry->getBuffer(ResourceType::ConstantBuffer, Hash::fnv1a("FrameConstants", 14), sizeof(FrameConstants), 0, nullptr);
+        if (!frameConstantBuffer) {
+            MessageBox(nullptr, L"createBuffer()の失敗", L"Error", MB_OK);
+            return E_FAIL;
+        }
+
+        // 描画ごとの定数の転送用リング(作れなければUpdateSubresourceで転送する)
+        initUploadRing();
+
+        // バックバッファの取得(画像の書き出しでコピー元にするので保持する)
         hr = swapChain->GetBuffer(0, __uuidof(ID3D11Texture2D), reinterpret_cast<LPVOID*>(backBuffer.GetAddressOf()));
         if (FAILED(hr)) {
-            MessageBox(nullptr, L"GetBuffer()̎s : " + hr, nullptr, MB_OK);
+            showFailure(L"GetBuffer()", hr, nullptr);
             return hr;
         }
-        // _[^[Qbgr[̍쐬
+        // レンダーターゲットビューの作成
         hr = device->CreateRenderTargetView(backBuffer.Get(), nullptr, renderTargetView.GetAddressOf());
         if (FAILED(hr)) {
-            MessageBox(nullptr, L"CreateRenderTargetView()̎s : " + hr, nullptr, MB_OK);
+            showFailure(L"CreateRenderTargetView()", hr, nullptr);
             return hr;
         }
 
-        // [xXeVZobt@[ƂĂ΂
-        // [xXeVpeNX`\[X쐬
+        // ※深度ステンシルはZバッファーとも呼ばれる
+        // 深度ステンシル用テクスチャリソースを作成
         D3D11_TEXTURE2D_DESC descDepth;
         ZeroMemory(&descDepth, sizeof(descDepth));
-        descDepth.Width = windowWidth;                    // eNX`[̕(obNobt@ƓTCYw)
-        descDepth.Height = windowHeight;                  // eNX`[̍(obNobt@ƓTCYw)
-        descDepth.MipLevels = 1;                          // ~bv}bvx̍ő吔
-        descDepth.ArraySize = 1;                          // eNX`[z̃eNX`[̐
-        descDepth.Format = DXGI_FORMAT_D24_UNORM_S8_UINT; // eNX`[̃tH[}bg
-        descDepth.SampleDesc.Count = 1;                   // sNZPʂ̃}`TvO
-        descDepth.SampleDesc.Quality = 0;                 // C[W̕ix
-        descDepth.Usage = D3D11_USAGE_DEFAULT;            // eNX`[̓ǂݍ݂яݕ@ʂl
-        descDepth.BindFlags = D3D11_BIND_DEPTH_STENCIL;   // pCvCXe[Wւ̃oChɊւtO
-        descDepth.CPUAccessFlags = 0;                     // CPUANZX̎ނw蔄tO
-        descDepth.MiscFlags = 0;                          // ̈ʐ̒Ⴂ\[XIvVʂtO
+        descDepth.Width = windowWidth;                    // テクスチャーの幅(バックバッファと同じサイズを指定)
+        descDepth.Height = windowHeight;                  // テクスチャーの高さ(バックバッファと同じサイズを指定)
+        descDepth.MipLevels = 1;                          // ミップマップレベルの最大数
+        descDepth.ArraySize = 1;                          // テクスチャー配列内のテクスチャーの数
+        descDepth.Format = DXGI_FORMAT_D24_UNORM_S8_UINT; // テクスチャーのフォーマット
+        descDepth.SampleDesc.Count = 1;                   // ピクセル単位のマルチサンプリング数
+        descDepth.SampleDesc.Quality = 0;                 // イメージの品質レベル
+        descDepth.Usage = D3D11_USAGE_DEFAULT;            // テクスチャーの読み込みおよび書き込み方法を識別する値
+        descDepth.BindFlags = D3D11_BIND_DEPTH_STENCIL;   // パイプラインステージへのバインドに関するフラグ
+        descDepth.CPUAccessFlags = 0;                     // 許可するCPUアクセスの種類を指定売るフラグ
+        descDepth.MiscFlags = 0;                          // 他の一般性の低いリソースオプションを識別するフラグ
         hr = device->CreateTexture2D(&descDepth, nullptr, depthStencil.GetAddressOf());
         if (FAILED(hr)) {
-            MessageBox(nullptr, L"CreateTexture2D()̎s : " + hr, L"Error", MB_OK);
+            showFailure(L"CreateTexture2D()", hr, L"Error");
             return hr;
         }
 
-        // [xXeVr[ANZX\ȃeNX`[̃Tu\[Xw
+        // 深度ステンシルビューからアクセス可能なテクスチャーのサブリソースを指定
         D3D11_DEPTH_STENCIL_VIEW_DESC descDSV;
         ZeroMemory(&descDSV, sizeof(descDSV));
-        descDSV.Format = descDepth.Format;                     // \[Xf[^̃tH[}bg
-        descDSV.ViewDimension = D3D11_DSV_DIMENSION_TEXTURE2D; // \[X̃^Cv
-        descDSV.Texture2D.MipSlice = 0;                        // ŏɎgp~bv}bvx̃CfbNX
-        // \[Xf[^ւ̃ANZXpɐ[xXeVr[̍쐬
+        descDSV.Format = descDepth.Format;                     // リソースデータのフォーマット
+        descDSV.ViewDimension = D3D11_DSV_DIMENSION_TEXTURE2D; // リソースのタイプ
+        descDSV.Texture2D.MipSlice = 0;                        // 最初に使用するミップマップレベルのインデックス
+        // リソースデータへのアクセス用に深度ステンシルビューの作成
         hr = device->CreateDepthStencilView(depthStencil.Get(), &descDSV, depthStencilView.GetAddressOf());
         if (FAILED(hr)) {
-            MessageBox(nullptr, L"CreateDepthStencilView()̎s : " + hr, L"Error", MB_OK);
+            showFailure(L"CreateDepthStencilView()", hr, L"Error");
             return hr;
         }
-        // [xXeVr[^[QbgɃZbg
+        // レンダーターゲットのメモリの見積もり(R8G8B8A8とD24S8はどちらも1ピクセル4バイト)
+        renderTargetBytes = static_cast<uint64_t>(windowWidth) * windowHeight * 4 * (sd.BufferCount + 1);
+        backBufferWidth   = windowWidth;
+        backBufferHeight  = windowHeight;
+        // 深度ステンシルビューをターゲットにセット
         deviceContext->OMSetRenderTargets(1, renderTargetView.GetAddressOf(), depthStencilView.Get());
 
-        // Viewport̏
+        // Viewportの初期化
         D3D11_VIEWPORT vp;
-        vp.Width    = static_cast<FLOAT>(windowWidth);  // r[|[gxʒu
-        vp.Height   = static_cast<FLOAT>(windowHeight); // r[|[g㑤yʒu
-        vp.MinDepth = 0.0f;                             // r[|[g
-        vp.MaxDepth = 1.0f;                             // r[|[g̍
-        vp.TopLeftX = 0;                                // r[|[g̍ŏ[x(0`1)
-        vp.TopLeftY = 0;                                // r[|[g̍ő[x(0`1)
+        vp.Width    = static_cast<FLOAT>(windowWidth);  // ビューポート左側のx位置
+        vp.Height   = static_cast<FLOAT>(windowHeight); // ビューポート上側のy位置
+        vp.MinDepth = 0.0f;                             // ビューポート幅
+        vp.MaxDepth = 1.0f;                             // ビューポートの高さ
+        vp.TopLeftX = 0;                                // ビューポートの最小深度(0～1)
+        vp.TopLeftY = 0;                                // ビューポートの最大深度(0～1)
         deviceContext->RSSetViewports(1, &vp);
 
         return S_OK;
@@ -9,6 +9,16 @@
 #include "Window.h"
 #include "Matrix.h"
 #include "Color.h"
+#include "ShaderCache.h"
+#include "RenderDevice.h"
+#include "ResourceRegistry.h"
+#include "CommandList.h"
+#include "FrameArena.h"
+#include "FrameCapture.h"
+#include "JobSystem.h"
+#include "ParallelRecorder.h"
+#include "RenderStats.h"
+#include "UploadRing.h"
 
 #pragma comment(lib, "d3d11.lib")
 
@@ -22,24 +32,109 @@ namespace Lib
         ~DirectX11();
 
         HRESULT initDevice(std::shared_ptr<Window> _window);
-        void begineFrame() const;
-        void endFrame() const;
+        void begineFrame();
+        void endFrame();
 
-        ComPtr<ID3D11Device> getDevice();
-        ComPtr<ID3D11DeviceContext> getDeviceContext();
+        // ※参照を返すのでAddRef/Releaseは発生しない
+        const ComPtr<ID3D11Device>        &getDevice() const;
+        const ComPtr<ID3D11DeviceContext> &getDeviceContext() const;
+        // フレームの描画コマンド(endFrame()でまとめて実行される)
+        CommandList   &getCommandList();
+        RenderContext &getRenderContext();
+        // 並列に記録したコマンドの実行(それまでにgetCommandList()へ記録した分を先に実行する)
+        void submit(const ParallelRecorder &recorder);
+        ShaderCache &getShaderCache();
+        ResourceRegistry &getResourceRegistry();
+        RenderDevice &getRenderDevice();
+        // 並列の記録と遅延コンテキストへの変換に使う常駐ワーカー(initDevice()を呼んだスレッドが0番目)
+        JobSystem &getJobSystem();
 
-        void    setViewMatrix(const Matrix &_view);
-        Matrix &getViewMatrix();
-        void    setProjectionMatrix(const Matrix &_projection);
-        Matrix &getProjectionMatrix();
+        // ※設定のたびに版数が進み、フレーム定数は変化があった時だけ作り直される
+        void          setViewMatrix(const Matrix &_view);
+        const Matrix &getViewMatrix() const;
+        void          setProjectionMatrix(const Matrix &_projection);
+        const Matrix &getProjectionMatrix() const;
+        void          setLightPosition(const Vector3 &_lightPosition);
+        const Vector3 &getLightPosition() const;
+
+        // 画面の内容に関わる変更を知らせる
+        // ※カメラとライトは設定時に自動で知らせる。ワールド行列やマテリアル、表示の切り替えなどは呼び出し側で知らせる
+        void markSceneChanged();
+        // 最後に表示したフレーム以降に変更があったか(なければ描画もPresentも省略してよい)
+        bool isSceneChanged() const;
+        // 変更がなく描画を省略したフレームを数える
+        void     skipFrame();
+        uint64_t getPresentedFrames() const;
+        uint64_t getSkippedFrames() const;
+        // 直前のフレームのPresentにかかった時間(ミリ秒)
+        float    getPresentTime() const;
+
+        // フレーム定数(b0)が古ければ計算し直してgetCommandList()へ転送を記録する
+        // ※メインスレッドで描画の記録前に呼ぶこと
+        void updateFrameConstants();
+        NativeResource getFrameConstantBuffer() const;
+
+        // 直前のフレームで転送した定数のバイト数
+        uint32_t getUploadBytes() const;
+
+        // 描画ごとの定数を転送用リングから割り当てる(スレッドセーフ)
+        // 書き込んだ内容はgetUploadBuffer()の範囲として設定する。失敗時(D3D11.1非対応など)はUpdateBufferで転送すること
+        UploadRing::Allocation allocateUpload(const uint32_t size);
+        NativeResource getUploadBuffer() const;
+        // 転送用リング(D3D11.1非対応ならnullptr)
+        const UploadRing *getUploadRing() const;
+
+        // フレーム内の一時メモリ(begineFrame()で切り替わり、次のフレームの終わりまで有効)
+        FrameArena &getFrameArena();
+
+        // 描画の負荷の集計(既定では無効。有効にするとbegineFrame()からendFrame()の間に実行したコマンドを数える)
+        RenderStats       &getRenderStats();
+        // GPUメモリの見積もり(レジストリのリソースとレンダーターゲット)
+        RenderStats::Memory getMemoryStats() const;
+
+        // フレームの画像の書き出し先(nullptrで解除。解除時は読み戻し待ちのフレームを全て渡してから外す)
+        // endFrame()でバックバッファをステージングテクスチャへコピーし、GPUが終えたものから数フレーム遅れで読み戻す
+        void setFrameCapture(FrameCapture *_frameCapture);
+        UINT getBackBufferWidth() const;
+        UINT getBackBufferHeight() const;
 
     private:
         friend class Singleton<DirectX11>;
         DirectX11();
 
+        HRESULT initUploadRing();
+        // 転送用リングのマップ(フレーム中にコマンドを実行する前に解除する)
+        void mapUploadRing();
+        void unmapUploadRing();
+
+        // バックバッファをステージングテクスチャへコピーし、終わったコピーを読み戻す
+        void captureFrame();
+        // 最も古いコピーを読み戻して書き出しに渡す(waitがfalseでGPUが終えていなければfalse)
+        bool readbackCapture(const bool wait);
+
+        // 点光源
+        struct Light
+        {
+            float pos[4];
+            float diffuse[4];
+            float attenuate[4];
+        };
+
+        // フレームごとの定数(b0)
+        struct FrameConstants
+        {
+            Matrix view;
+            Matrix projection;
+            Matrix viewProjection;
+            float  eyePos[4];
+            float  ambient[4];
+            Light  pointLight;
+        };
+
         ComPtr<ID3D11Device>           device;
         ComPtr<ID3D11DeviceContext>    deviceContext;
         ComPtr<IDXGISwapChain>         swapChain;
+        ComPtr<ID3D11Texture2D>        backBuffer;
         ComPtr<ID3D11RenderTargetView> renderTargetView;
         ComPtr<ID3D11Texture2D>        depthStencil;
         ComPtr<ID3D11DepthStencilView> depthStencilView;
@@ -47,10 +142,67 @@ namespace Lib
         D3D_FEATURE_LEVEL featureLevel;
         D3D_DRIVER_TYPE   driverType;
 
-        Matrix view;
-        Matrix projection;
+        Matrix  view;
+        Matrix  projection;
+        Matrix  viewProjection;
+        Vector3 lightPosition;
+
+        // 版数(設定で進む)と、フレーム定数・ビュー射影行列の作成に使った版数
+        uint32_t viewVersion;
+        uint32_t projectionVersion;
+        uint32_t lightVersion;
+        uint32_t frameViewVersion;
+        uint32_t frameProjectionVersion;
+        uint32_t frameLightVersion;
+        uint32_t viewProjectionViewVersion;
+        uint32_t viewProjectionProjectionVersion;
+
+        // 画面の内容の版数と、描画中・最後に表示したフレームの版数
+        uint32_t sceneVersion;
+        uint32_t frameSceneVersion;
+        uint32_t presentedSceneVersion;
+        uint64_t presentedFrames;
+        uint64_t skippedFrames;
+        float    presentTime;
+
+        uint32_t uploadBytes;
+        uint32_t frameUploadBytes;
+
+        FrameArena frameArena;
+
+        RenderStats renderStats;
+        uint64_t    renderTargetBytes; // バックバッファと深度バッファの大きさ
+
+        UINT backBufferWidth;
+        UINT backBufferHeight;
+
+        // 画像の書き出し(読み戻しでGPUを待たないよう、コピー先をリングで回す)
+        static const UINT CAPTURE_STAGING_COUNT = 3;
+        FrameCapture           *frameCapture;
+        ComPtr<ID3D11Texture2D> captureStaging[CAPTURE_STAGING_COUNT];
+        UINT                    captureRead;    // 最も古い読み戻し待ちのコピー
+        UINT                    capturePending; // 読み戻し待ちのコピーの数
 
         std::shared_ptr<Window> window;
+
+        std::unique_ptr<ShaderCache> shaderCache;
+
+        // ※renderContextが使うので先に宣言する
+        std::unique_ptr<JobSystem> jobSystem;
+
+        // ※deviceより先に破棄されるよう後ろで宣言する
+        std::unique_ptr<RenderDevice>     renderDevice;
+        std::unique_ptr<ResourceRegistry> resourceRegistry;
+        std::unique_ptr<RenderContext>    renderContext;
+        CommandList                       commandList;
+        ResourceRef                       frameConstantBuffer;
+
+        // 描画ごとの定数の転送先(fenceより先に破棄する)
+        std::unique_ptr<Fence>            uploadFence;
+        std::unique_ptr<UploadRing>       uploadRing;
+        ResourceRef                       uploadBuffer;
+        bool                              uploadMapped;
+        bool                              uploadDiscarded;
     };
 }
 #endif
@@ -0,0 +1,151 @@
+#include <algorithm>
+#include <mutex>
+#include <vector>
+#include "FrameArena.h"
+
+namespace Lib
+{
+    namespace
+    {
+        // MAX_THREADS - 1番目以降のスレッドは最後の領域をロックして共有する
+        const unsigned SHARED_SLOT = FrameArena::MAX_THREADS - 1;
+        std::mutex sharedMutex;
+
+        // スレッドの番号の管理(終了したスレッドの番号は次に確保を始めたスレッドが使い回す)
+        std::mutex            slotMutex;
+        std::vector<unsigned> freeSlots;
+        unsigned              nextSlot = 0;
+
+        // スレッドが終了した時に番号を返す
+        struct ThreadSlot
+        {
+            unsigned index;
+
+            ThreadSlot()
+            {
+                std::lock_guard<std::mutex> lock(slotMutex);
+                if (!freeSlots.empty()) {
+                    index = freeSlots.back();
+                    freeSlots.pop_back();
+                }
+                else {
+                    index = nextSlot;
+                    nextSlot = std::min(nextSlot + 1, SHARED_SLOT);
+                }
+            }
+            ~ThreadSlot()
+            {
+                if (index != SHARED_SLOT) {
+                    std::lock_guard<std::mutex> lock(slotMutex);
+                    freeSlots.push_back(index);
+                }
+            }
+        };
+
+        // ポインタをalignの倍数に切り上げる
+        uint8_t *alignPointer(uint8_t *p, const size_t align)
+        {
+            auto address = reinterpret_cast<uintptr_t>(p);
+            return p + ((align - address % align) % align);
+        }
+    }
+
+    // コンストラクタ
+    LinearArena::LinearArena(const size_t _capacity)
+        : memory(_capacity != 0 ? std::make_unique<uint8_t[]>(_capacity) : nullptr),
+          capacity(_capacity), used(0), highWater(0)
+    {
+    }
+
+    // 確保
+    void * LinearArena::allocate(const size_t size, const size_t align)
+    {
+        if (memory != nullptr) {
+            auto begin   = memory.get() + used;
+            auto aligned = alignPointer(begin, align);
+            auto end     = used + static_cast<size_t>(aligned - begin) + size;
+            if (end <= capacity) {
+                used      = end;
+                highWater = std::max(highWater, used);
+                return aligned;
+            }
+        }
+
+        // 容量を超えた分は個別に確保する(次のreset()で容量を広げる)
+        overflow.push_back(std::make_unique<uint8_t[]>(size + align));
+        used     += size + align;
+        highWater = std::max(highWater, used);
+        return alignPointer(overflow.back().get(), align);
+    }
+
+    // まとめて解放
+    void LinearArena::reset()
+    {
+        if (!overflow.empty()) {
+            overflow.clear();
+            // 最高水位まで広げ、以降のフレームではヒープを使わない
+            capacity = highWater + highWater / 4;
+            memory   = std::make_unique<uint8_t[]>(capacity);
+        }
+        used = 0;
+    }
+
+    // コンストラクタ
+    FrameArena::FrameArena(const size_t _capacity, const unsigned _frameCount)
+        : capacity(_capacity), frameCount(std::min(std::max(_frameCount, 1u), MAX_FRAMES)), frame(0)
+    {
+    }
+
+    // 次のフレームへ進む
+    void FrameArena::beginFrame()
+    {
+        ++frame;
+        for (auto &arena : arenas[frame % frameCount]) {
+            if (arena != nullptr) {
+                arena->reset();
+            }
+        }
+    }
+
+    // 呼び出したスレッドの領域から確保
+    void * FrameArena::allocate(const size_t size, const size_t align)
+    {
+        auto  slot  = getThreadSlot();
+        auto &arena = arenas[frame % frameCount][slot];
+        if (slot == SHARED_SLOT) {
+            std::lock_guard<std::mutex> lock(sharedMutex);
+            if (arena == nullptr) {
+                arena = std::make_unique<LinearArena>(capacity);
+            }
+            return arena->allocate(size, align);
+        }
+        if (arena == nullptr) {
+            arena = std::make_unique<LinearArena>(capacity);
+        }
+        return arena->allocate(size, align);
+    }
+
+    // 統計情報
+    FrameArena::Stats FrameArena::getStats() const
+    {
+        Stats stats = { 0, 0, 0, 0, 0 };
+        for (auto &arena : arenas[frame % frameCount]) {
+            if (arena != nullptr) {
+                stats.used      += arena->getUsed();
+                stats.capacity  += arena->getCapacity();
+                stats.highWater += arena->getHighWater();
+                stats.overflows += static_cast<uint32_t>(arena->getOverflows());
+                ++stats.threads;
+            }
+        }
+        return stats;
+    }
+
+    // スレッドの番号
+    // 番号の領域は前の持ち主が確保したまま残るが、前の持ち主はもう確保しないので、そのまま続けて使える
+    unsigned FrameArena::getThreadSlot()
+    {
+        thread_local ThreadSlot slot;
+        return slot.index;
+    }
+}
@@ -0,0 +1,131 @@
+#pragma once
+#ifndef FRAMEARENA_H
+#define FRAMEARENA_H
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace Lib
+{
+    // 線形アロケータ
+    // 1つのメモリブロックの先頭から詰めて確保し、reset()でまとめて解放する(個別の解放はできない)
+    class LinearArena
+    {
+    public:
+        explicit LinearArena(const size_t _capacity = 0);
+
+        // 容量を超えた分はヒープから確保し、次のreset()で容量を最高水位まで広げる
+        void *allocate(const size_t size, const size_t align = alignof(std::max_align_t));
+        void  reset();
+
+        size_t getUsed()      const { return used; }
+        size_t getCapacity()  const { return capacity; }
+        size_t getHighWater() const { return highWater; }
+        // 直前のreset()以降にヒープへはみ出した回数
+        size_t getOverflows() const { return overflow.size(); }
+
+    private:
+        // コピーの禁止
+        LinearArena(const LinearArena &) = delete;
+        LinearArena& operator=(const LinearArena &) = delete;
+
+        std::unique_ptr<uint8_t[]> memory;
+        size_t capacity;
+        size_t used;
+        size_t highWater; // 1回のreset()の間に確保した最大のバイト数
+        std::vector<std::unique_ptr<uint8_t[]>> overflow;
+    };
+
+    // フレーム単位の一時メモリ
+    //
+    // frameCount個のフレーム分の領域を順に使い回す。beginFrame()で次のフレームの領域を空にするので、
+    // 確保したメモリはframeCount - 1回後のbeginFrame()まで有効(GPUや他のスレッドが前のフレームを読んでいても壊さない)
+    // スレッドごとに別の領域から確保するので、確保にロックは要らない
+    class FrameArena
+    {
+    public:
+        static const unsigned MAX_FRAMES  = 3;
+        static const unsigned MAX_THREADS = 64;
+
+        // 統計情報(現在のフレーム)
+        struct Stats
+        {
+            size_t   used;      // 全スレッドの使用量
+            size_t   capacity;  // 全スレッドの容量
+            size_t   highWater; // スレッドごとの最高水位の合計
+            uint32_t threads;   // このフレームの領域を持つスレッド数
+            uint32_t overflows; // ヒープへはみ出した回数
+        };
+
+        // capacityは1スレッド・1フレームあたりの初期容量
+        explicit FrameArena(const size_t _capacity = 256 * 1024, const unsigned _frameCount = 2);
+
+        // 次のフレームへ進む(どのスレッドも確保していない時に呼ぶ)
+        void beginFrame();
+
+        void *allocate(const size_t size, const size_t align = alignof(std::max_align_t));
+        template <class T>
+        T *allocateArray(const size_t count)
+        {
+            return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+        }
+
+        unsigned getFrameCount() const { return frameCount; }
+        uint64_t getFrame()      const { return frame; }
+        Stats    getStats() const;
+
+    private:
+        // コピーの禁止
+        FrameArena(const FrameArena &) = delete;
+        FrameArena& operator=(const FrameArena &) = delete;
+
+        // 呼び出したスレッドの番号(終了したスレッドの番号は使い回す)
+        static unsigned getThreadSlot();
+
+        using ThreadArenas = std::array<std::unique_ptr<LinearArena>, MAX_THREADS>;
+
+        size_t   capacity;
+        unsigned frameCount;
+        uint64_t frame;
+        std::array<ThreadArenas, MAX_FRAMES> arenas; // [フレーム][スレッド]。スレッドが初めて確保した時に作る
+    };
+
+    // FrameArenaから確保するSTLのアロケータ(解放はフレームの切り替えでまとめて行う)
+    template <class T>
+    class FrameAllocator
+    {
+    public:
+        using value_type = T;
+
+        FrameAllocator(FrameArena &_arena) : arena(&_arena) {}
+        template <class U>
+        FrameAllocator(const FrameAllocator<U> &other) : arena(other.getArena()) {}
+
+        T *allocate(const size_t count)
+        {
+            return arena->allocateArray<T>(count);
+        }
+        void deallocate(T *, const size_t)
+        {
+        }
+
+        FrameArena *getArena() const { return arena; }
+
+        template <class U>
+        bool operator==(const FrameAllocator<U> &other) const { return arena == other.getArena(); }
+        template <class U>
+        bool operator!=(const FrameAllocator<U> &other) const { return arena != other.getArena(); }
+
+    private:
+        FrameArena *arena;
+    };
+
+    // フレーム内だけで使う配列
+    template <class T>
+    using FrameVector = std::vector<T, FrameAllocator<T>>;
+}
+
+#endif
@@ -0,0 +1,273 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include "FrameCapture.h"
+#include "Profiler.h"
+
+namespace Lib
+{
+    // コンストラクタ
+    FrameCapture::FrameCapture()
+        : settings{ Format::Raw, 0, 0, 60.0f, 0, Policy::Drop }, queueHead(0), queueCount(0),
+          running(false), stopping(false), frameCounter(0), stats{}
+    {
+    }
+
+    // デストラクタ
+    FrameCapture::~FrameCapture()
+    {
+        stop();
+    }
+
+    // 書き出しの開始
+    bool FrameCapture::start(const std::string &_path, const Settings &_settings)
+    {
+        stop();
+        if (_settings.width == 0 || _settings.height == 0 || _settings.bufferCount == 0) {
+            return false;
+        }
+        path     = _path;
+        settings = _settings;
+
+        if (settings.format != Format::PPM) {
+            ofs.open(path, std::ios::binary | std::ios::trunc);
+            if (!ofs) {
+                return false;
+            }
+        }
+        if (settings.format == Format::Y4M) {
+            // フレームレートは1/1000の精度の有理数で書く
+            char header[128];
+            auto rate = static_cast<unsigned>(std::lround(std::max(settings.frameRate, 1.0f) * 1000.0f));
+            snprintf(header, sizeof(header), "YUV4MPEG2 W%u H%u F%u:1000 Ip A1:1 C444\n", settings.width, settings.height, rate);
+            ofs << header;
+        }
+
+        // 画像のバッファはまとめて確保し、記録中は確保しない
+        size_t frameBytes = static_cast<size_t>(settings.width) * settings.height * 4;
+        memory.assign(frameBytes * settings.bufferCount, 0);
+        buffers.resize(settings.bufferCount);
+        freeList.clear();
+        freeList.reserve(settings.bufferCount);
+        for (uint32_t i = 0; i < settings.bufferCount; ++i) {
+            buffers[i] = Buffer{ memory.data() + frameBytes * i, settings.width, settings.height, 0 };
+            freeList.push_back(&buffers[i]);
+        }
+        queue.assign(settings.bufferCount, nullptr);
+        queueHead    = 0;
+        queueCount   = 0;
+        frameCounter = 0;
+        stats        = Stats{};
+        stopping     = false;
+        running      = true;
+        thread = std::thread(&FrameCapture::run, this);
+        return true;
+    }
+
+    // 停止(書き出し待ちを全て書いてから)
+    void FrameCapture::stop()
+    {
+        if (!running) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        writerCondition.notify_one();
+        freeCondition.notify_all();
+        if (thread.joinable()) {
+            thread.join();
+        }
+        if (ofs.is_open()) {
+            ofs.close();
+        }
+        running = false;
+    }
+
+    // 空きバッファを借りる
+    FrameCapture::Buffer * FrameCapture::acquire()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (!running || stopping || stats.failed) {
+            return nullptr;
+        }
+        if (freeList.empty()) {
+            if (settings.policy == Policy::Drop) {
+                ++stats.dropped;
+                return nullptr;
+            }
+            auto begin = std::chrono::steady_clock::now();
+            freeCondition.wait(lock, [this] { return !freeList.empty() || stopping || stats.failed; });
+            stats.blockTime += std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - begin).count();
+            if (freeList.empty()) {
+                return nullptr;
+            }
+        }
+        auto buffer = freeList.back();
+        freeList.pop_back();
+        return buffer;
+    }
+
+    // 書き出しに渡す
+    void FrameCapture::submit(Buffer *buffer)
+    {
+        if (buffer == nullptr) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            buffer->frame = frameCounter++;
+            queue[(queueHead + queueCount) % queue.size()] = buffer;
+            ++queueCount;
+            ++stats.submitted;
+            stats.maxQueued = std::max(stats.maxQueued, static_cast<uint32_t>(queueCount));
+        }
+        writerCondition.notify_one();
+    }
+
+    // 書き出さずに返す
+    void FrameCapture::release(Buffer *buffer)
+    {
+        if (buffer == nullptr) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            freeList.push_back(buffer);
+        }
+        freeCondition.notify_one();
+    }
+
+    // 統計情報
+    FrameCapture::Stats FrameCapture::getStats() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return stats;
+    }
+
+    // 拡張子から形式を決める
+    FrameCapture::Format FrameCapture::formatFromPath(const std::string &path)
+    {
+        auto dot = path.find_last_of('.');
+        if (dot == std::string::npos) {
+            return Format::Raw;
+        }
+        auto extension = path.substr(dot + 1);
+        std::transform(extension.begin(), extension.end(), extension.begin(), [](const char c) {
+            return static_cast<char>(c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c);
+        });
+        if (extension == "y4m") {
+            return Format::Y4M;
+        }
+        if (extension == "ppm") {
+            return Format::PPM;
+        }
+        return Format::Raw;
+    }
+
+    // 書き出しスレッドの処理
+    void FrameCapture::run()
+    {
+        Profiler::getInstance().setThreadName("capture");
+        while (true) {
+            Buffer *buffer = nullptr;
+            bool    failed = false;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                writerCondition.wait(lock, [this] { return queueCount > 0 || stopping; });
+                if (queueCount == 0) {
+                    return;
+                }
+                buffer    = queue[queueHead];
+                queueHead = (queueHead + 1) % queue.size();
+                --queueCount;
+                failed = stats.failed;
+            }
+
+            // 書き込みはロックの外で行う(描画スレッドは待たない)
+            auto     begin = std::chrono::steady_clock::now();
+            uint64_t bytes = 0;
+            bool     ok    = !failed && writeFrame(*buffer, bytes);
+            auto time  = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - begin).count();
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (ok) {
+                    ++stats.written;
+                    stats.bytesWritten += bytes;
+                }
+                else {
+                    stats.failed = true;
+                }
+                stats.writeTime += time;
+                freeList.push_back(buffer);
+            }
+            freeCondition.notify_one();
+        }
+    }
+
+    // 1フレームの変換と書き込み
+    bool FrameCapture::writeFrame(const Buffer &buffer, uint64_t &bytes)
+    {
+        PROFILE_SCOPE("FrameCapture::writeFrame");
+        const size_t PIXELS = static_cast<size_t>(buffer.width) * buffer.height;
+        const uint8_t *src  = buffer.data;
+
+        switch (settings.format) {
+        case Format::Raw:
+            bytes = PIXELS * 4;
+            ofs.write(reinterpret_cast<const char*>(src), static_cast<std::streamsize>(PIXELS * 4));
+            return static_cast<bool>(ofs);
+
+        case Format::Y4M: {
+            // BT.601(リミテッドレンジ)の4:4:4。Y・U・Vの面を順に並べる
+            static const char FRAME_HEADER[] = "FRAME\n";
+            scratch.resize(PIXELS * 3);
+            auto y = scratch.data();
+            auto u = y + PIXELS;
+            auto v = u + PIXELS;
+            for (size_t i = 0; i < PIXELS; ++i) {
+                int r = src[i * 4], g = src[i * 4 + 1], b = src[i * 4 + 2];
+                y[i] = static_cast<uint8_t>((( 66 * r + 129 * g +  25 * b + 128) >> 8) +  16);
+                u[i] = static_cast<uint8_t>(((-38 * r -  74 * g + 112 * b + 128) >> 8) + 128);
+                v[i] = static_cast<uint8_t>(((112 * r -  94 * g -  18 * b + 128) >> 8) + 128);
+            }
+            bytes = sizeof(FRAME_HEADER) - 1 + scratch.size();
+            ofs.write(FRAME_HEADER, sizeof(FRAME_HEADER) - 1);
+            ofs.write(reinterpret_cast<const char*>(scratch.data()), static_cast<std::streamsize>(scratch.size()));
+            return static_cast<bool>(ofs);
+        }
+
+        case Format::PPM: {
+            char header[64];
+            int headerLength = snprintf(header, sizeof(header), "P6\n%u %u\n255\n", buffer.width, buffer.height);
+            scratch.resize(PIXELS * 3);
+            for (size_t i = 0; i < PIXELS; ++i) {
+                scratch[i * 3]     = src[i * 4];
+                scratch[i * 3 + 1] = src[i * 4 + 1];
+                scratch[i * 3 + 2] = src[i * 4 + 2];
+            }
+            bytes = headerLength + scratch.size();
+            std::ofstream file(sequencePath(buffer.frame), std::ios::binary | std::ios::trunc);
+            file.write(header, headerLength);
+            file.write(reinterpret_cast<const char*>(scratch.data()), static_cast<std::streamsize>(scratch.size()));
+            return static_cast<bool>(file);
+        }
+        }
+        return false;
+    }
+
+    // PPMの連番のファイル名(拡張子の前に6桁の番号を付ける)
+    std::string FrameCapture::sequencePath(const uint64_t frame) const
+    {
+        char number[32];
+        snprintf(number, sizeof(number), "_%06llu", static_cast<unsigned long long>(frame));
+        auto dot   = path.find_last_of('.');
+        auto slash = path.find_last_of("/\\");
+        if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+            return path + number + ".ppm";
+        }
+        return path.substr(0, dot) + number + path.substr(dot);
+    }
+}
@@ -0,0 +1,128 @@
+#pragma once
+#ifndef FRAMECAPTURE_H
+#define FRAMECAPTURE_H
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Lib
+{
+    // フレームの画像の書き出し
+    //
+    // 描画スレッドはプールからバッファを借りてフレームの画像(RGBA8)を書き込み、submit()で渡すだけ
+    // ファイルへの変換と書き込みは別スレッドで行い、書き終えたバッファはプールへ戻る(画像はコピーしない)
+    // プールが空の時は、設定に応じてそのフレームを捨てるか、空くまで待つ
+    // 画像はステージングテクスチャの読み戻し(DirectX11::setFrameCapture())か、画面なしで描いたものを渡す
+    class FrameCapture
+    {
+    public:
+        // 書き出す形式
+        enum class Format
+        {
+            Raw, // RGBA8をそのまま1つのファイルへ続けて書く
+            Y4M, // YUV4MPEG2(4:4:4)の1つのファイル
+            PPM, // 1フレーム1ファイルのP6(ファイル名に連番を付ける)
+        };
+
+        // プールが空の時の動作
+        enum class Policy
+        {
+            Drop,  // そのフレームを捨てる(描画スレッドは待たない)
+            Block, // 書き出しが終わってバッファが空くまで待つ(フレームを捨てない)
+        };
+
+        // 設定
+        struct Settings
+        {
+            Format   format;
+            uint32_t width;
+            uint32_t height;
+            float    frameRate;   // Y4Mのヘッダーに書くフレームレート
+            uint32_t bufferCount; // プールのバッファ数(描画と書き出しの間に置けるフレーム数)
+            Policy   policy;
+        };
+
+        // プールのバッファ(RGBA8、行の間に隙間なし、上の行から)
+        struct Buffer
+        {
+            uint8_t *data;
+            uint32_t width;
+            uint32_t height;
+            uint64_t frame; // submit()した順の番号
+        };
+
+        // 統計情報(start()からの累計)
+        struct Stats
+        {
+            uint64_t submitted;    // 書き出しに渡したフレーム数
+            uint64_t dropped;      // プールが空で捨てたフレーム数
+            uint64_t written;      // 書き出したフレーム数
+            uint64_t bytesWritten;
+            uint32_t maxQueued;    // 書き出し待ちの最大数
+            float    blockTime;    // Blockで描画スレッドが待った時間の合計(ミリ秒)
+            float    writeTime;    // 書き出しスレッドの変換と書き込みの時間の合計(ミリ秒)
+            bool     failed;       // 書き込みに失敗した(以降のフレームは捨てる)
+        };
+
+        FrameCapture();
+        ~FrameCapture();
+
+        // 書き出しを開始する(バッファはここでまとめて確保する)
+        bool start(const std::string &_path, const Settings &_settings);
+        // 書き出し待ちのフレームを全て書いてから止める
+        void stop();
+        bool isRunning() const { return running; }
+        const Settings &getSettings() const { return settings; }
+
+        // 描画スレッドから呼ぶ
+        // 空きバッファを借りる(Dropで空きがなければnullptr)
+        Buffer *acquire();
+        // 書き込んだバッファを書き出しに渡す
+        void    submit(Buffer *buffer);
+        // 書き出さずにプールへ返す
+        void    release(Buffer *buffer);
+
+        Stats getStats() const;
+
+        // 拡張子から形式を決める(.y4m, .ppm, それ以外はRaw)
+        static Format formatFromPath(const std::string &path);
+
+    private:
+        // コピーの禁止
+        FrameCapture(const FrameCapture &) = delete;
+        FrameCapture& operator=(const FrameCapture &) = delete;
+
+        void run();
+        // 1フレームを変換して書き込む(bytesに書き込んだバイト数)
+        bool writeFrame(const Buffer &buffer, uint64_t &bytes);
+        // PPMの連番のファイル名
+        std::string sequencePath(const uint64_t frame) const;
+
+        std::string   path;
+        Settings      settings;
+        std::ofstream ofs;     // RawとY4M
+        std::vector<uint8_t> scratch; // 形式の変換先(書き出しスレッドだけが使う)
+
+        std::vector<uint8_t> memory;   // 全バッファの画像
+        std::vector<Buffer>  buffers;
+        std::vector<Buffer*> freeList; // bufferCount分を確保済み
+        std::vector<Buffer*> queue;    // 書き出し待ちのリング(bufferCount分を確保済み)
+        size_t               queueHead;
+        size_t               queueCount;
+
+        mutable std::mutex      mutex;
+        std::condition_variable writerCondition; // 書き出し待ちが増えた・停止
+        std::condition_variable freeCondition;   // バッファが空いた
+        std::thread             thread;
+        bool                    running;
+        bool                    stopping;
+        uint64_t                frameCounter;
+        Stats                   stats;
+    };
+}
+
+#endif
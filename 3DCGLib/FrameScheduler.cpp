@@ -0,0 +1,170 @@
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include "FrameScheduler.h"
+#include "Profiler.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#include <mmsystem.h>
+#pragma comment(lib, "winmm.lib")
+#endif
+
+namespace Lib
+{
+    namespace
+    {
+        // タイマーの精度を計る時のスリープの回数
+        const int CALIBRATION_SLEEPS = 5;
+        // 広げたスリープの精度の見積もりを戻す速さ(1回の待ちで差の1/N)
+        const int GRANULARITY_DECAY = 32;
+
+        float toMilliseconds(const FrameScheduler::Clock::duration duration)
+        {
+            return std::chrono::duration<float, std::milli>(duration).count();
+        }
+    }
+
+    // コンストラクタ
+    FrameScheduler::FrameScheduler(const float _targetRate)
+        : targetRate(0.0f), period(Clock::duration::zero()), baseGranularity(Clock::duration::zero()), granularity(Clock::duration::zero()), resumed(false)
+    {
+#ifdef _WIN32
+        // 既定の約15.6msのタイマー分解能を1msにする
+        timeBeginPeriod(1);
+#endif
+        calibrate();
+        setTargetRate(_targetRate);
+        deadline = last = Clock::now();
+        resetStats();
+    }
+
+    // デストラクタ
+    FrameScheduler::~FrameScheduler()
+    {
+#ifdef _WIN32
+        timeEndPeriod(1);
+#endif
+    }
+
+    // 目標のフレームレートを設定する
+    void FrameScheduler::setTargetRate(const float _targetRate)
+    {
+        targetRate = _targetRate > 0.0f ? _targetRate : 0.0f;
+        if (targetRate > 0.0f) {
+            period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / targetRate));
+        }
+        else {
+            period = Clock::duration::zero();
+        }
+        deadline = Clock::now();
+    }
+
+    // 次のフレームの開始時刻まで待つ
+    float FrameScheduler::waitForNextFrame()
+    {
+        auto now = Clock::now();
+        if (period > Clock::duration::zero()) {
+            if (now < deadline) {
+                waitUntil(deadline);
+                now = Clock::now();
+            }
+            else if (frames > 0 && !resumed) {
+                ++lateFrames;
+            }
+            if (!resumed) {
+                maxLateness = std::max(maxLateness, static_cast<double>(toMilliseconds(now - deadline)));
+            }
+
+            // 1フレーム以上遅れた場合は取り戻そうとせず、今を基準にやり直す(連続で詰めて描画しない)
+            deadline += period;
+            if (deadline < now) {
+                deadline = now + period;
+            }
+        }
+
+        double interval = toMilliseconds(now - last);
+        last = now;
+        if (resumed) {
+            resumed = false;
+            return static_cast<float>(interval);
+        }
+        ++frames;
+        intervalSum   += interval;
+        intervalSumSq += interval * interval;
+        return static_cast<float>(interval);
+    }
+
+    // 止まっていた後の再開
+    void FrameScheduler::resume()
+    {
+        deadline = last = Clock::now();
+        resumed  = true;
+    }
+
+    // 統計情報
+    FrameScheduler::Stats FrameScheduler::getStats() const
+    {
+        Stats stats = { frames, lateFrames, 0.0f, 0.0f, static_cast<float>(maxLateness),
+                        static_cast<float>(sleepTime), static_cast<float>(spinTime), toMilliseconds(granularity) };
+        if (frames > 0) {
+            double average  = intervalSum / frames;
+            double variance = std::max(intervalSumSq / frames - average * average, 0.0);
+            stats.averageTime = static_cast<float>(average);
+            stats.jitter      = static_cast<float>(std::sqrt(variance));
+        }
+        return stats;
+    }
+
+    // 統計情報のリセット
+    void FrameScheduler::resetStats()
+    {
+        frames        = 0;
+        lateFrames    = 0;
+        intervalSum   = 0.0;
+        intervalSumSq = 0.0;
+        maxLateness   = 0.0;
+        sleepTime     = 0.0;
+        spinTime      = 0.0;
+    }
+
+    // 1msのスリープが寝過ごす時間の最大をタイマーの精度とする
+    void FrameScheduler::calibrate()
+    {
+        baseGranularity = Clock::duration::zero();
+        for (int i = 0; i < CALIBRATION_SLEEPS; ++i) {
+            auto start = Clock::now();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            baseGranularity = std::max(baseGranularity, Clock::now() - start - std::chrono::milliseconds(1));
+        }
+        granularity = baseGranularity;
+    }
+
+    // deadlineまで待つ
+    void FrameScheduler::waitUntil(const Clock::time_point _deadline)
+    {
+        PROFILE_SCOPE("FrameScheduler::wait");
+        // スリープが精度の分だけ延びても間に合う間はスリープする
+        auto now = Clock::now();
+        while (_deadline - now > granularity) {
+            auto request = _deadline - now - granularity;
+            std::this_thread::sleep_for(request);
+            auto woke = Clock::now();
+            sleepTime += toMilliseconds(woke - now);
+            // 見積もりより寝過ごした場合は精度を見直す(負荷の高い時にはOSの起床が遅れる)
+            granularity = std::min(std::max(granularity, woke - now - request), period);
+            now = woke;
+        }
+        // 一時的な遅れで広げた分は少しずつ計測値へ戻す
+        granularity -= (granularity - baseGranularity) / GRANULARITY_DECAY;
+
+        // 残りはスピンする
+        auto spinStart = now;
+        while (now < _deadline) {
+            std::this_thread::yield();
+            now = Clock::now();
+        }
+        spinTime += toMilliseconds(now - spinStart);
+    }
+}
@@ -0,0 +1,76 @@
+#pragma once
+#ifndef FRAMESCHEDULER_H
+#define FRAMESCHEDULER_H
+#include <chrono>
+#include <cstdint>
+
+namespace Lib
+{
+    // フレームの開始時刻を一定の間隔に揃える
+    //
+    // 次の開始時刻までの大半をスリープし、OSのタイマーの精度より短い残りだけをスピンして待つ
+    // (スピンだけだとコアを1つ使い切り、スリープだけだとタイマーの精度の分だけ遅れる)
+    // 開始時刻は前の予定時刻に間隔を足して決めるので、誤差が積み重ならない
+    // 時計は単調増加のsteady_clockを使う
+    class FrameScheduler
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        // 統計情報(resetStats()まで累積)
+        struct Stats
+        {
+            uint32_t frames;      // フレーム数
+            uint32_t lateFrames;  // 予定時刻を過ぎてから呼ばれたフレーム数(処理が間に合わなかった)
+            float    averageTime; // フレーム間隔の平均(ミリ秒)
+            float    jitter;      // フレーム間隔の標準偏差(ミリ秒)
+            float    maxLateness; // 予定時刻からの遅れの最大(ミリ秒)
+            float    sleepTime;   // 待ち時間のうちスリープしていた時間の合計(ミリ秒)
+            float    spinTime;    // 待ち時間のうちスピンしていた時間の合計(ミリ秒)
+            float    granularity; // スリープの精度の見積もり(ミリ秒)
+        };
+
+        // targetRateが0以下なら待たない(上限なし)
+        explicit FrameScheduler(const float _targetRate = 60.0f);
+        ~FrameScheduler();
+
+        void  setTargetRate(const float _targetRate);
+        float getTargetRate() const { return targetRate; }
+
+        // 次のフレームの開始時刻まで待ち、前のフレームの開始からの経過時間(ミリ秒)を返す
+        float waitForNextFrame();
+        // 入力待ちなどで止まっていた後に呼ぶ(次のフレームの開始予定を今にし、止まっていた間を統計に含めない)
+        void  resume();
+
+        Stats getStats() const;
+        void  resetStats();
+
+    private:
+        // コピーの禁止
+        FrameScheduler(const FrameScheduler &) = delete;
+        FrameScheduler& operator=(const FrameScheduler &) = delete;
+
+        // OSのタイマーの精度を計る
+        void calibrate();
+        // deadlineまで待つ
+        void waitUntil(const Clock::time_point _deadline);
+
+        float             targetRate;
+        Clock::duration   period;          // 0なら上限なし
+        Clock::duration   baseGranularity; // calibrate()で計ったタイマーの精度
+        Clock::duration   granularity;     // これより短い待ち時間はスピンする
+        Clock::time_point deadline;        // 次のフレームの開始予定時刻
+        Clock::time_point last;            // 前のフレームの開始時刻
+        bool              resumed;         // resume()の直後のフレーム(統計に含めない)
+
+        uint32_t frames;
+        uint32_t lateFrames;
+        double   intervalSum;   // ミリ秒
+        double   intervalSumSq;
+        double   maxLateness;
+        double   sleepTime;
+        double   spinTime;
+    };
+}
+
+#endif
@@ -0,0 +1,287 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include "FrameStats.h"
+#include "MyMath.h"
+
+namespace Lib
+{
+    namespace
+    {
+        // ミリ秒をマイクロ秒の整数にする(範囲外は切り詰める)
+        uint32_t toMicroseconds(const float milliseconds)
+        {
+            double us = static_cast<double>(milliseconds) * 1000.0;
+            if (us <= 0.0) {
+                return 0;
+            }
+            return us >= UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(us + 0.5);
+        }
+
+        // 2を底とする対数の整数部分
+        uint32_t floorLog2(uint32_t value)
+        {
+            uint32_t result = 0;
+            while (value >>= 1) {
+                ++result;
+            }
+            return result;
+        }
+    }
+
+    // コンストラクタ
+    LatencyHistogram::LatencyHistogram()
+    {
+        clear();
+    }
+
+    // 記録
+    void LatencyHistogram::record(const uint32_t microseconds)
+    {
+        ++buckets[bucketIndex(microseconds)];
+        ++count;
+        sum    += microseconds;
+        maximum = std::max(maximum, microseconds);
+    }
+
+    // 記録を加える
+    void LatencyHistogram::merge(const LatencyHistogram &other)
+    {
+        for (uint32_t i = 0; i < BUCKET_COUNT; ++i) {
+            buckets[i] += other.buckets[i];
+        }
+        count  += other.count;
+        sum    += other.sum;
+        maximum = std::max(maximum, other.maximum);
+    }
+
+    // 記録を消す
+    void LatencyHistogram::clear()
+    {
+        buckets.fill(0);
+        count   = 0;
+        sum     = 0;
+        maximum = 0;
+    }
+
+    // パーセンタイル
+    uint32_t LatencyHistogram::getPercentile(const double percentile) const
+    {
+        if (count == 0) {
+            return 0;
+        }
+        auto target = static_cast<uint64_t>(std::ceil(MyMath::clamp(percentile, 100.0, 0.0) / 100.0 * count));
+        target = std::max<uint64_t>(target, 1);
+        uint64_t seen = 0;
+        for (uint32_t i = 0; i < BUCKET_COUNT; ++i) {
+            seen += buckets[i];
+            if (seen >= target) {
+                // 区間の中央(最大値を超えないようにする)
+                auto lower = bucketLower(i);
+                auto upper = i + 1 < BUCKET_COUNT ? bucketLower(i + 1) : UINT32_MAX;
+                return std::min(lower + (upper - lower) / 2, maximum);
+            }
+        }
+        return maximum;
+    }
+
+    // 値の入る区間の番号
+    uint32_t LatencyHistogram::bucketIndex(const uint32_t value)
+    {
+        if (value < SUB_BUCKETS) {
+            return value;
+        }
+        // 2のshift乗ずつの幅でSUB_BUCKETS個に分ける
+        auto shift = floorLog2(value) - SUB_BUCKET_BITS;
+        return SUB_BUCKETS + shift * SUB_BUCKETS + ((value >> shift) - SUB_BUCKETS);
+    }
+
+    // 区間の下限
+    uint32_t LatencyHistogram::bucketLower(const uint32_t index)
+    {
+        if (index < SUB_BUCKETS) {
+            return index;
+        }
+        auto shift = (index - SUB_BUCKETS) / SUB_BUCKETS;
+        auto sub   = (index - SUB_BUCKETS) % SUB_BUCKETS;
+        return (SUB_BUCKETS + sub) << shift;
+    }
+
+    // コンストラクタ
+    FrameStats::FrameStats(const float _budget, const uint32_t _windowSlices, const float _sliceLength)
+        : budget(_budget), windowSlices(std::max<uint32_t>(_windowSlices, 1)), sliceLength(std::max(_sliceLength, 1.0f)),
+          currentSlice(0), sliceElapsed(0.0f), totalHitches(0), elapsed(0.0)
+    {
+        slices.resize(CHANNEL_COUNT * windowSlices);
+        sliceHitches.resize(windowSlices, 0);
+    }
+
+    // チャンネルの時間を記録
+    void FrameStats::record(const Channel channel, const float milliseconds)
+    {
+        auto us = toMicroseconds(milliseconds);
+        slices[channel * windowSlices + currentSlice].record(us);
+        totals[channel].record(us);
+    }
+
+    // フレームの間隔を記録
+    void FrameStats::recordFrame(const float frameTime)
+    {
+        record(FRAME, frameTime);
+        elapsed += frameTime;
+
+        // 予算を超えたフレームはヒッチ
+        if (frameTime > budget) {
+            hitches[totalHitches % MAX_HITCHES] = Hitch{ elapsed, frameTime };
+            ++totalHitches;
+            ++sliceHitches[currentSlice];
+        }
+
+        // 区間の長さだけ記録したら、最も古い区間を空にして次の記録先にする
+        sliceElapsed += frameTime;
+        for (uint32_t i = 0; i < windowSlices && sliceElapsed >= sliceLength; ++i) {
+            sliceElapsed -= sliceLength;
+            currentSlice  = (currentSlice + 1) % windowSlices;
+            for (uint32_t channel = 0; channel < CHANNEL_COUNT; ++channel) {
+                slices[channel * windowSlices + currentSlice].clear();
+            }
+            sliceHitches[currentSlice] = 0;
+        }
+        sliceElapsed = std::min(sliceElapsed, sliceLength);
+    }
+
+    // 直近の区間のまとめ
+    FrameStats::Summary FrameStats::getSummary(const Channel channel) const
+    {
+        LatencyHistogram window;
+        mergeWindow(channel, window);
+        return summarize(window);
+    }
+
+    // 記録開始からのまとめ
+    FrameStats::Summary FrameStats::getTotalSummary(const Channel channel) const
+    {
+        return summarize(totals[channel]);
+    }
+
+    // 直近の区間のヒッチの数
+    uint32_t FrameStats::getWindowHitches() const
+    {
+        uint32_t count = 0;
+        for (auto hitch : sliceHitches) {
+            count += hitch;
+        }
+        return count;
+    }
+
+    // 直近のヒッチ
+    uint32_t FrameStats::getRecentHitches(Hitch *out, const uint32_t count) const
+    {
+        auto available = static_cast<uint32_t>(std::min<uint64_t>(totalHitches, MAX_HITCHES));
+        auto n = std::min(count, available);
+        for (uint32_t i = 0; i < n; ++i) {
+            out[i] = hitches[(totalHitches - n + i) % MAX_HITCHES];
+        }
+        return n;
+    }
+
+    // CSVへ追記
+    bool FrameStats::appendCsv(const std::string &path) const
+    {
+        bool empty = true;
+        {
+            std::ifstream ifs(path, std::ios::binary | std::ios::ate);
+            empty = !ifs || ifs.tellg() <= 0;
+        }
+        std::ofstream ofs(path, std::ios::app);
+        if (!ofs) {
+            return false;
+        }
+        if (empty) {
+            ofs << "time_ms,channel,count,mean_ms,p50_ms,p95_ms,p99_ms,max_ms,hitches,budget_ms\n";
+        }
+        char line[256];
+        for (uint32_t channel = 0; channel < CHANNEL_COUNT; ++channel) {
+            auto summary = getSummary(static_cast<Channel>(channel));
+            snprintf(line, sizeof(line), "%.1f,%s,%llu,%.3f,%.3f,%.3f,%.3f,%.3f,%u,%.3f\n",
+                elapsed, channelName(static_cast<Channel>(channel)), static_cast<unsigned long long>(summary.count),
+                summary.mean, summary.p50, summary.p95, summary.p99, summary.max,
+                channel == FRAME ? getWindowHitches() : 0, budget);
+            ofs << line;
+        }
+        return static_cast<bool>(ofs);
+    }
+
+    // JSONで書き出す
+    bool FrameStats::writeJson(const std::string &path) const
+    {
+        std::ofstream ofs(path, std::ios::trunc);
+        if (!ofs) {
+            return false;
+        }
+        char line[256];
+        auto writeSummaries = [&](const char *label, const bool total, const uint64_t hitchCount) {
+            snprintf(line, sizeof(line), "  \"%s\": {\n", label);
+            ofs << line;
+            for (uint32_t channel = 0; channel < CHANNEL_COUNT; ++channel) {
+                auto summary = total ? getTotalSummary(static_cast<Channel>(channel)) : getSummary(static_cast<Channel>(channel));
+                snprintf(line, sizeof(line), "    \"%s\": {\"count\": %llu, \"mean\": %.3f, \"p50\": %.3f, \"p95\": %.3f, \"p99\": %.3f, \"max\": %.3f},\n",
+                    channelName(static_cast<Channel>(channel)), static_cast<unsigned long long>(summary.count),
+                    summary.mean, summary.p50, summary.p95, summary.p99, summary.max);
+                ofs << line;
+            }
+            snprintf(line, sizeof(line), "    \"hitches\": %llu\n  },\n", static_cast<unsigned long long>(hitchCount));
+            ofs << line;
+        };
+
+        snprintf(line, sizeof(line), "{\n  \"time_ms\": %.1f,\n  \"budget_ms\": %.3f,\n  \"window_ms\": %.1f,\n", elapsed, budget, windowSlices * sliceLength);
+        ofs << line;
+        writeSummaries("window", false, getWindowHitches());
+        writeSummaries("total", true, totalHitches);
+
+        Hitch recent[MAX_HITCHES];
+        auto count = getRecentHitches(recent, MAX_HITCHES);
+        ofs << "  \"recent_hitches\": [";
+        for (uint32_t i = 0; i < count; ++i) {
+            snprintf(line, sizeof(line), "%s\n    {\"time_ms\": %.1f, \"duration_ms\": %.3f}", i == 0 ? "" : ",", recent[i].time, recent[i].duration);
+            ofs << line;
+        }
+        ofs << (count > 0 ? "\n  ]\n}\n" : "]\n}\n");
+        return static_cast<bool>(ofs);
+    }
+
+    // チャンネルの名前
+    const char * FrameStats::channelName(const Channel channel)
+    {
+        switch (channel) {
+        case FRAME:   return "frame";
+        case UPDATE:  return "update";
+        case RENDER:  return "render";
+        case PRESENT: return "present";
+        default:      return "unknown";
+        }
+    }
+
+    // ヒストグラムのまとめ(ミリ秒)
+    FrameStats::Summary FrameStats::summarize(const LatencyHistogram &histogram) const
+    {
+        return Summary{
+            histogram.getCount(),
+            static_cast<float>(histogram.getMean() / 1000.0),
+            histogram.getPercentile(50.0) / 1000.0f,
+            histogram.getPercentile(95.0) / 1000.0f,
+            histogram.getPercentile(99.0) / 1000.0f,
+            histogram.getMax() / 1000.0f
+        };
+    }
+
+    // 直近の区間をまとめる
+    void FrameStats::mergeWindow(const Channel channel, LatencyHistogram &out) const
+    {
+        out.clear();
+        for (uint32_t i = 0; i < windowSlices; ++i) {
+            out.merge(slices[channel * windowSlices + i]);
+        }
+    }
+}
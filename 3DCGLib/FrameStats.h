@@ -0,0 +1,129 @@
+#pragma once
+#ifndef FRAMESTATS_H
+#define FRAMESTATS_H
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Lib
+{
+    // 時間の分布を数えるヒストグラム(マイクロ秒単位)
+    //
+    // 2の累乗ごとの区間をSUB_BUCKETS個に等分した対数線形の区間で数える(HDRヒストグラムと同じ考え方)
+    // 値の大きさによらず相対誤差は1/SUB_BUCKETS以下で、記録は配列の加算だけ
+    class LatencyHistogram
+    {
+    public:
+        static const uint32_t SUB_BUCKET_BITS = 5;
+        static const uint32_t SUB_BUCKETS     = 1u << SUB_BUCKET_BITS;
+        static const uint32_t BUCKET_COUNT    = SUB_BUCKETS + (32 - SUB_BUCKET_BITS) * SUB_BUCKETS;
+
+        LatencyHistogram();
+
+        void record(const uint32_t microseconds);
+        // otherの記録を加える
+        void merge(const LatencyHistogram &other);
+        void clear();
+
+        uint64_t getCount() const { return count; }
+        uint32_t getMax()   const { return maximum; }
+        double   getMean()  const { return count > 0 ? static_cast<double>(sum) / count : 0.0; }
+        // 下からpercentile%の位置の値(その値が入る区間の中央)
+        uint32_t getPercentile(const double percentile) const;
+
+        // 値の入る区間の番号と、区間の下限
+        static uint32_t bucketIndex(const uint32_t value);
+        static uint32_t bucketLower(const uint32_t index);
+
+    private:
+        std::array<uint32_t, BUCKET_COUNT> buckets;
+        uint64_t count;
+        uint64_t sum;
+        uint32_t maximum;
+    };
+
+    // フレーム時間の統計
+    //
+    // フレームの間隔と、更新・描画・Presentに使ったCPU時間をそれぞれヒストグラムで数え、
+    // 直近windowSlices区間(1区間はsliceLengthミリ秒)のパーセンタイルを求める
+    // 予算(budget)を超えたフレームをヒッチとして数え、直近のものを記録する
+    // 記録はメモリを確保しない(ヒストグラムはコンストラクタでまとめて確保する)
+    class FrameStats
+    {
+    public:
+        enum Channel
+        {
+            FRAME,   // フレームの開始の間隔
+            UPDATE,  // 入力とシミュレーション結果の反映
+            RENDER,  // 描画コマンドの記録と実行
+            PRESENT, // Present
+            CHANNEL_COUNT
+        };
+
+        static const uint32_t MAX_HITCHES = 64; // 記録しておく直近のヒッチの数
+
+        // 1つのヒッチ
+        struct Hitch
+        {
+            double time;     // 記録開始からの時間(ミリ秒)
+            float  duration; // フレームの間隔(ミリ秒)
+        };
+
+        // 直近の区間のまとめ(時間はミリ秒)
+        struct Summary
+        {
+            uint64_t count;
+            float    mean;
+            float    p50;
+            float    p95;
+            float    p99;
+            float    max;
+        };
+
+        explicit FrameStats(const float _budget = 1000.0f / 60.0f, const uint32_t _windowSlices = 10, const float _sliceLength = 1000.0f);
+
+        // チャンネルの時間を記録する(ミリ秒)
+        void record(const Channel channel, const float milliseconds);
+        // フレームの間隔を記録し、ヒッチの判定と区間の切り替えを行う(1フレームに1回)
+        void recordFrame(const float frameTime);
+
+        // 直近の区間(window)のまとめ
+        Summary  getSummary(const Channel channel) const;
+        // 記録開始からのまとめ
+        Summary  getTotalSummary(const Channel channel) const;
+        uint32_t getWindowHitches() const;
+        uint64_t getTotalHitches() const { return totalHitches; }
+        // 直近のヒッチ(古い順)。countは最大MAX_HITCHES
+        uint32_t getRecentHitches(Hitch *out, const uint32_t count) const;
+        float    getBudget() const { return budget; }
+
+        // 直近の区間のまとめをCSVの1行ずつ追記する(ファイルが空ならヘッダーも書く)
+        bool appendCsv(const std::string &path) const;
+        // 直近の区間・記録開始からのまとめと、直近のヒッチをJSONで書き出す
+        bool writeJson(const std::string &path) const;
+
+    private:
+        static const char *channelName(const Channel channel);
+        Summary summarize(const LatencyHistogram &histogram) const;
+        // 直近の区間をまとめたヒストグラム
+        void mergeWindow(const Channel channel, LatencyHistogram &out) const;
+
+        float    budget;
+        uint32_t windowSlices;
+        float    sliceLength;
+
+        // [チャンネル][区間]のリング。currentSliceが記録中
+        std::vector<LatencyHistogram> slices;
+        std::vector<uint32_t>         sliceHitches;
+        uint32_t                      currentSlice;
+        float                         sliceElapsed;
+
+        std::array<LatencyHistogram, CHANNEL_COUNT> totals;
+        uint64_t                                    totalHitches;
+        std::array<Hitch, MAX_HITCHES>              hitches; // n番目のヒッチをn % MAX_HITCHESへ書くリング
+        double                                      elapsed; // 記録開始からの時間(ミリ秒)
+    };
+}
+
+#endif
@@ -0,0 +1,36 @@
+#pragma once
+#ifndef HASH_H
+#define HASH_H
+#include <cstdint>
+#include <cstddef>
+
+namespace Lib
+{
+    // FNV-1a(64bit)
+    class Hash
+    {
+    public:
+        static const uint64_t OFFSET_BASIS = 14695981039346656037ULL;
+        static const uint64_t PRIME        = 1099511628211ULL;
+
+        // 引数dataからsize_バイト分のハッシュ値を求める(seed_で連結可能)
+        static uint64_t fnv1a(const void *data, const size_t size_, const uint64_t seed_ = OFFSET_BASIS)
+        {
+            auto     bytes = static_cast<const uint8_t*>(data);
+            uint64_t hash  = seed_;
+            for (size_t i = 0; i < size_; ++i) {
+                hash ^= bytes[i];
+                hash *= PRIME;
+            }
+            return hash;
+        }
+
+        // 2つのハッシュ値を合成する
+        static uint64_t combine(const uint64_t hash_, const uint64_t value_)
+        {
+            return fnv1a(&value_, sizeof(value_), hash_);
+        }
+    };
+}
+
+#endif
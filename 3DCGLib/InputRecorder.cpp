@@ -0,0 +1,147 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include "InputRecorder.h"
+
+namespace Lib
+{
+    namespace
+    {
+        const char MAGIC[4] = { 'L', 'I', 'N', 'P' };
+    }
+
+    // コンストラクタ
+    InputRecorder::InputRecorder(const std::vector<uint8_t> &_keys)
+        : keys(_keys), mode(Mode::Off), frameCount(0), position(0), simulationRate(0.0f)
+    {
+        if (keys.size() > InputLogHeader::MAX_KEYS) {
+            keys.resize(InputLogHeader::MAX_KEYS);
+        }
+    }
+
+    // デストラクタ
+    InputRecorder::~InputRecorder()
+    {
+        stop();
+    }
+
+    // 記録の開始
+    bool InputRecorder::startRecording(const std::string &path, const float _simulationRate)
+    {
+        stop();
+        ofs.open(path, std::ios::binary | std::ios::trunc);
+        if (!ofs) {
+            return false;
+        }
+
+        InputLogHeader header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, MAGIC, sizeof(header.magic));
+        header.version        = VERSION;
+        header.headerSize     = sizeof(InputLogHeader);
+        header.keyCount       = static_cast<uint32_t>(keys.size());
+        std::copy(keys.begin(), keys.end(), header.keys);
+        header.simulationRate = _simulationRate;
+        ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        if (!ofs) {
+            ofs.close();
+            return false;
+        }
+
+        mode           = Mode::Record;
+        frameCount     = 0;
+        position       = 0;
+        simulationRate = _simulationRate;
+        return true;
+    }
+
+    // 再生の開始
+    bool InputRecorder::startReplay(const std::string &path)
+    {
+        stop();
+        std::ifstream ifs(path, std::ios::binary);
+        if (!ifs) {
+            return false;
+        }
+
+        InputLogHeader header;
+        ifs.read(reinterpret_cast<char*>(&header), sizeof(header));
+        if (!ifs || std::memcmp(header.magic, MAGIC, sizeof(header.magic)) != 0 || header.version != VERSION ||
+            header.headerSize != sizeof(InputLogHeader) || header.keyCount > InputLogHeader::MAX_KEYS) {
+            return false;
+        }
+
+        // 記録時のキーの並びを現在の並びへ変換する表
+        uint32_t remap[InputLogHeader::MAX_KEYS];
+        for (uint32_t i = 0; i < header.keyCount; ++i) {
+            remap[i] = keyBit(header.keys[i]);
+        }
+
+        // フレーム数が書かれていなければ(記録中に終了した)、読めるところまで読む
+        frames.clear();
+        if (header.frameCount > 0) {
+            frames.reserve(header.frameCount);
+        }
+        InputLogFrame frame;
+        while (ifs.read(reinterpret_cast<char*>(&frame), sizeof(frame))) {
+            uint32_t mapped = frame.keys & REDRAW_BIT;
+            for (uint32_t i = 0; i < header.keyCount; ++i) {
+                if (frame.keys & (1u << i)) {
+                    mapped |= remap[i];
+                }
+            }
+            frames.push_back(InputLogFrame{ frame.deltaTime, mapped });
+            if (header.frameCount > 0 && frames.size() == header.frameCount) {
+                break;
+            }
+        }
+
+        mode           = Mode::Replay;
+        frameCount     = static_cast<uint32_t>(frames.size());
+        position       = 0;
+        simulationRate = header.simulationRate;
+        return true;
+    }
+
+    // 停止
+    void InputRecorder::stop()
+    {
+        if (mode == Mode::Record) {
+            // ヘッダーのフレーム数を書き込む
+            ofs.seekp(offsetof(InputLogHeader, frameCount));
+            ofs.write(reinterpret_cast<const char*>(&frameCount), sizeof(frameCount));
+            ofs.close();
+        }
+        frames.clear();
+        frames.shrink_to_fit();
+        mode = Mode::Off;
+    }
+
+    // 1フレーム分の記録
+    void InputRecorder::record(const float deltaTime, const uint32_t _keys)
+    {
+        if (mode != Mode::Record) {
+            return;
+        }
+        InputLogFrame frame{ deltaTime, _keys };
+        ofs.write(reinterpret_cast<const char*>(&frame), sizeof(frame));
+        ++frameCount;
+    }
+
+    // 次のフレームの取り出し
+    bool InputRecorder::next(InputLogFrame &frame)
+    {
+        if (mode != Mode::Replay || position >= frames.size()) {
+            return false;
+        }
+        frame = frames[position++];
+        return true;
+    }
+
+    // キーのビット
+    uint32_t InputRecorder::keyBit(const uint8_t key) const
+    {
+        auto it = std::find(keys.begin(), keys.end(), key);
+        return it != keys.end() ? 1u << static_cast<uint32_t>(it - keys.begin()) : 0;
+    }
+}
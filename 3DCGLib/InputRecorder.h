@@ -0,0 +1,93 @@
+#pragma once
+#ifndef INPUTRECORDER_H
+#define INPUTRECORDER_H
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace Lib
+{
+    // 入力の記録ファイルのヘッダー(ファイル先頭にそのまま配置される)
+    // ヘッダーの後にInputLogFrameの配列(frameCount個)が続く
+    struct InputLogHeader
+    {
+        static const uint32_t MAX_KEYS = 31; // 最上位ビットは再描画の要求に使う
+
+        char     magic[4];       // "LINP"
+        uint32_t version;
+        uint32_t headerSize;
+        uint32_t frameCount;     // 記録中は0(閉じる時に書き込む)
+        uint32_t keyCount;
+        uint8_t  keys[32];       // n番目のキーの仮想キーコード(フレームのkeysのnビット目)
+        float    simulationRate; // 記録時のシミュレーションの更新回数/秒(再生時の確認用)
+        uint32_t reserved;
+    };
+
+    // 1フレーム分の入力
+    struct InputLogFrame
+    {
+        float    deltaTime; // 前のフレームからの時間(ミリ秒)
+        uint32_t keys;      // 押されているキー(InputLogHeader::keysの順)と再描画の要求(最上位ビット)
+    };
+
+    // フレームごとの入力と経過時間の記録・再生
+    //
+    // 記録時は毎フレームの先頭でrecord()し、再生時はnext()で記録した値を取り出して実際の入力と時計の代わりに使う
+    // 1フレーム8バイトで、ファイルへは書き込みながら記録する(フレーム数は閉じる時にヘッダーへ書く)
+    class InputRecorder
+    {
+    public:
+        static const uint32_t VERSION     = 1;
+        static const uint32_t REDRAW_BIT  = 1u << InputLogHeader::MAX_KEYS;
+
+        enum class Mode
+        {
+            Off,
+            Record,
+            Replay,
+        };
+
+        // _keysは記録するキーの仮想キーコード(MAX_KEYS個まで)
+        explicit InputRecorder(const std::vector<uint8_t> &_keys);
+        ~InputRecorder();
+
+        // 記録を開始する(既存のファイルは上書きする)
+        bool startRecording(const std::string &path, const float simulationRate);
+        // 再生するファイルを読み込む(キーの並びが異なる場合も、一致するキーは再生する)
+        bool startReplay(const std::string &path);
+        // 記録中ならフレーム数を書き込んで閉じる
+        void stop();
+
+        // 1フレーム分を記録する
+        void record(const float deltaTime, const uint32_t keys);
+        // 次のフレームを取り出す(最後まで再生したらfalse)
+        bool next(InputLogFrame &frame);
+
+        // keyのビット(記録対象でなければ0)
+        uint32_t keyBit(const uint8_t key) const;
+
+        Mode     getMode() const { return mode; }
+        bool     isRecording() const { return mode == Mode::Record; }
+        bool     isReplaying() const { return mode == Mode::Replay; }
+        uint32_t getFrameCount() const { return frameCount; }
+        // 再生したフレーム数
+        uint32_t getPosition() const { return position; }
+        float    getSimulationRate() const { return simulationRate; }
+
+    private:
+        // コピーの禁止
+        InputRecorder(const InputRecorder &) = delete;
+        InputRecorder& operator=(const InputRecorder &) = delete;
+
+        std::vector<uint8_t>       keys;
+        Mode                       mode;
+        std::ofstream              ofs;
+        std::vector<InputLogFrame> frames; // 再生するフレーム(ファイルのキーの並びから変換済み)
+        uint32_t                   frameCount;
+        uint32_t                   position;
+        float                      simulationRate;
+    };
+}
+
+#endif
@@ -0,0 +1,118 @@
+#include <algorithm>
+#include <chrono>
+#include "InstanceBatch.h"
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE__)
+#include <xmmintrin.h>
+#define INSTANCE_BATCH_SSE
+#endif
+
+namespace Lib
+{
+    // インスタンスデータを詰める
+    void packInstances(const Matrix *worlds, const uint32_t *materials, const size_t count, InstanceData *out)
+    {
+        for (size_t i = 0; i < count; ++i) {
+            auto &world = worlds[i];
+#ifdef INSTANCE_BATCH_SSE
+            __m128 row0 = _mm_loadu_ps(&world.m11);
+            __m128 row1 = _mm_loadu_ps(&world.m21);
+            __m128 row2 = _mm_loadu_ps(&world.m31);
+            __m128 row3 = _mm_loadu_ps(&world.m41);
+            _MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+            _mm_storeu_ps(out[i].world[0], row0);
+            _mm_storeu_ps(out[i].world[1], row1);
+            _mm_storeu_ps(out[i].world[2], row2);
+#else
+            for (int row = 0; row < 3; ++row) {
+                for (int column = 0; column < 4; ++column) {
+                    out[i].world[row][column] = world.mat4x4[column][row];
+                }
+            }
+#endif
+            out[i].material = materials[i];
+        }
+    }
+
+    // コンストラクタ
+    InstanceBatch::InstanceBatch()
+        : batchCount(0), indexNodes(INDEX_NODE_SIZE, 64),
+          batchIndices(16, std::hash<NativeResource>(), std::equal_to<NativeResource>(), IndexAllocator(indexNodes)),
+          lastIndex(0), instanceCount(0), stats{ 0, 0, 0, 0.0f }
+    {
+    }
+
+    // 登録の破棄
+    void InstanceBatch::clear()
+    {
+        for (size_t i = 0; i < batchCount; ++i) {
+            batches[i].worlds.clear();
+            batches[i].materials.clear();
+        }
+        batchCount    = 0;
+        instanceCount = 0;
+        batchIndices.clear();
+    }
+
+    // インスタンスの追加
+    void InstanceBatch::add(const Mesh &mesh, const Matrix &world, const uint32_t material)
+    {
+        // メッシュは頂点バッファで区別する
+        auto index = lastIndex;
+        if (index >= batchCount || batches[index].mesh.vertexBuffer != mesh.vertexBuffer) {
+            auto found = batchIndices.find(mesh.vertexBuffer);
+            if (found != batchIndices.end()) {
+                index = found->second;
+            }
+            else {
+                index = batchCount++;
+                if (index == batches.size()) {
+                    batches.emplace_back();
+                }
+                batches[index].mesh = mesh;
+                batchIndices.emplace(mesh.vertexBuffer, index);
+            }
+            lastIndex = index;
+        }
+
+        batches[index].worlds.push_back(world);
+        batches[index].materials.push_back(material);
+        ++instanceCount;
+    }
+
+    // 描画の記録
+    void InstanceBatch::record(CommandList &commands, const NativeResource instanceBuffer, const uint32_t capacity)
+    {
+        stats = Stats{ 0, 0, 0, 0.0f };
+        auto total = std::min(instanceCount, capacity);
+        stats.dropped = instanceCount - total;
+        if (total == 0) {
+            return;
+        }
+
+        // 全メッシュ分をまとめて1回で転送する(記録先へ直接詰めるのでコピーは増えない)
+        auto start = std::chrono::steady_clock::now();
+        auto data  = reinterpret_cast<InstanceData*>(commands.updateBufferRange(instanceBuffer, 0, total * sizeof(InstanceData)));
+        uint32_t offset = 0;
+        for (size_t i = 0; i < batchCount && offset < total; ++i) {
+            auto count = std::min(static_cast<uint32_t>(batches[i].worlds.size()), total - offset);
+            packInstances(batches[i].worlds.data(), batches[i].materials.data(), count, data + offset);
+            offset += count;
+        }
+        stats.packTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        // メッシュごとに描画(インスタンスの位置は開始インスタンスで指定する)
+        commands.setVertexBuffer(instanceBuffer, sizeof(InstanceData), 0, 1);
+        offset = 0;
+        for (size_t i = 0; i < batchCount && offset < total; ++i) {
+            auto &mesh  = batches[i].mesh;
+            auto  count = std::min(static_cast<uint32_t>(batches[i].worlds.size()), total - offset);
+            commands.setVertexBuffer(mesh.vertexBuffer, mesh.vertexStride);
+            commands.setIndexBuffer(mesh.indexBuffer, mesh.indexFormat);
+            commands.drawIndexedInstanced(mesh.indexCount, count, 0, 0, offset);
+            offset += count;
+            ++stats.batches;
+        }
+        stats.instances = total;
+    }
+}
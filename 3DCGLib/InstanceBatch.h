@@ -0,0 +1,85 @@
+#pragma once
+#ifndef INSTANCEBATCH_H
+#define INSTANCEBATCH_H
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "Matrix.h"
+#include "CommandList.h"
+#include "PoolAllocator.h"
+
+namespace Lib
+{
+    // インスタンスごとのデータ(頂点バッファのスロット1)
+    struct InstanceData
+    {
+        float    world[3][4]; // ワールド行列を転置した上3行(アフィン変換のみ)
+        uint32_t material;    // マテリアル表の番号
+    };
+    static_assert(sizeof(InstanceData) == 52, "InstanceDataの配置が入力レイアウトと一致しない");
+
+    // 行列とマテリアル番号をインスタンスデータへ詰める(SSEが使えれば4x4の転置をまとめて行う)
+    void packInstances(const Matrix *worlds, const uint32_t *materials, const size_t count, InstanceData *out);
+
+    // 同じメッシュのインスタンスをまとめ、メッシュごとに1回のDrawIndexedInstancedで描く
+    class InstanceBatch
+    {
+    public:
+        // 描画するメッシュ
+        struct Mesh
+        {
+            NativeResource vertexBuffer;
+            NativeResource indexBuffer;
+            IndexFormat    indexFormat;
+            uint32_t       indexCount;
+            uint32_t       vertexStride;
+        };
+
+        // 統計情報(record()ごとに更新)
+        struct Stats
+        {
+            uint32_t instances; // 描画したインスタンス数
+            uint32_t dropped;   // インスタンスバッファに収まらず描かなかった数
+            uint32_t batches;   // メッシュの種類(DrawIndexedInstancedの回数)
+            float    packTime;  // ミリ秒
+        };
+
+        InstanceBatch();
+
+        // 登録を破棄する(確保済みのメモリは再利用する)
+        void clear();
+        void add(const Mesh &mesh, const Matrix &world, const uint32_t material = 0);
+
+        // インスタンスデータの転送とメッシュごとの描画を記録する
+        // ※入力レイアウト・シェーダー・定数バッファは呼び出し側で設定しておくこと
+        void record(CommandList &commands, const NativeResource instanceBuffer, const uint32_t capacity);
+
+        uint32_t     size() const { return instanceCount; }
+        const Stats &getStats() const { return stats; }
+
+    private:
+        // メッシュ1種類分のインスタンス
+        struct Batch
+        {
+            Mesh                  mesh;
+            std::vector<Matrix>   worlds;
+            std::vector<uint32_t> materials;
+        };
+
+        // 頂点バッファ→batchesの番号(clear()のたびにノードを作り直すので、ヒープではなくプールから確保する)
+        using IndexAllocator = PoolAllocator<std::pair<const NativeResource, size_t>>;
+        using IndexMap       = std::unordered_map<NativeResource, size_t, std::hash<NativeResource>, std::equal_to<NativeResource>, IndexAllocator>;
+        static const size_t INDEX_NODE_SIZE = 64; // ハッシュ表のノードの大きさの上限
+
+        std::vector<Batch> batches;
+        size_t             batchCount; // 今回使っているbatchesの数(残りは再利用待ち)
+        FixedPool          indexNodes;
+        IndexMap           batchIndices;
+        size_t   lastIndex;            // 直前に追加したメッシュ(連続して同じメッシュなら検索を省く)
+        uint32_t instanceCount;
+        Stats    stats;
+    };
+}
+
+#endif
@@ -0,0 +1,155 @@
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <cstring>
+#include "InstancedRenderer.h"
+#include "Hash.h"
+#include "RenderQueue.h"
+
+namespace Lib
+{
+    namespace
+    {
+        // 共有リソースのキー
+        const uint64_t INSTANCE_BUFFER = Hash::fnv1a("InstanceBuffer", 14);
+        const uint64_t MATERIAL_TABLE  = Hash::fnv1a("MaterialTable",  13);
+
+        // マテリアル表の番号(表の内容はインスタンスごとなので、バッファも共有しない)
+        std::atomic<uint64_t> nextMaterialTable(0);
+
+        // 既定のマテリアル(Modelと同じ)
+        const Color DEFAULT_MATERIAL(0.6f, 0.8f, 0.4f, 0.0f);
+    }
+
+    // コンストラクタ
+    InstancedRenderer::InstancedRenderer(const uint32_t _capacity)
+        : materialCount(0), materialsDirty(true), capacity(_capacity)
+    {
+        std::memset(materials.data(), 0, sizeof(materials));
+        addMaterial(DEFAULT_MATERIAL, DEFAULT_MATERIAL);
+        clear();
+        init();
+    }
+
+    // デストラクタ
+    InstancedRenderer::~InstancedRenderer()
+    {
+    }
+
+    // マテリアルの追加
+    uint32_t InstancedRenderer::addMaterial(const Color &ambient, const Color &diffuse)
+    {
+        if (materialCount >= MAX_MATERIALS) {
+            return 0;
+        }
+        auto &material = materials[materialCount];
+        std::memcpy(material.ambient, ambient.rgba, sizeof(material.ambient));
+        std::memcpy(material.diffuse, diffuse.rgba, sizeof(material.diffuse));
+        materialsDirty = true;
+        return materialCount++;
+    }
+
+    // 登録の破棄
+    void InstancedRenderer::clear()
+    {
+        batch.clear();
+        std::fill(boundsMin, boundsMin + 3,  FLT_MAX);
+        std::fill(boundsMax, boundsMax + 3, -FLT_MAX);
+    }
+
+    // インスタンスの追加
+    void InstancedRenderer::add(const Model &model, const Matrix &world, const uint32_t material)
+    {
+        batch.add(model.getInstanceMesh(), world, material < materialCount ? material : 0);
+        const float position[3] = { world.m41, world.m42, world.m43 };
+        for (int k = 0; k < 3; ++k) {
+            boundsMin[k] = std::min(boundsMin[k], position[k]);
+            boundsMax[k] = std::max(boundsMax[k], position[k]);
+        }
+    }
+
+    // 描画順のソートキー
+    uint64_t InstancedRenderer::getSortKey(const Matrix &view, const float farZ) const
+    {
+        float viewZ = batch.size() > 0 ? RenderQueue::nearestViewDepth(view, boundsMin, boundsMax) : farZ;
+        return RenderQueue::makeOpaqueKey(vertexShader.getHandle().index, materialTable.getHandle().index, instanceBuffer.getHandle().index, viewZ / farZ);
+    }
+
+    // 描画コマンドの記録
+    void InstancedRenderer::render(CommandList &commands)
+    {
+        if (batch.size() == 0 || !vertexShader || !pixelShader || !vertexLayout || !instanceBuffer || !materialTable) {
+            return;
+        }
+
+        // マテリアル表は変更があった時だけ転送する
+        if (materialsDirty) {
+            commands.updateBuffer(materialTable.get(), materials.data(), sizeof(materials));
+            materialsDirty = false;
+        }
+
+        auto cbFrame = DirectX11::getInstance().getFrameConstantBuffer();
+        commands.setInputLayout(vertexLayout.get());
+        commands.setPrimitiveTopology(PrimitiveTopology::TriangleList);
+        commands.setVertexShader(vertexShader.get());
+        commands.setVSConstantBuffer(0, cbFrame);
+        commands.setVSConstantBuffer(3, materialTable.get());
+        commands.setPixelShader(pixelShader.get());
+        commands.setPSConstantBuffer(0, cbFrame);
+
+        batch.record(commands, instanceBuffer.get(), capacity);
+    }
+
+    // シェーダー・入力レイアウト・バッファの取得
+    HRESULT InstancedRenderer::init()
+    {
+        auto &registry = DirectX11::getInstance().getResourceRegistry();
+
+        auto vsKey = Model::makeShaderKey("VertexShader.hlsl", "VSInstanced", "vs_4_0");
+        auto psKey = Model::makeShaderKey("PixelShader.hlsl",  "PSInstanced", "ps_4_0");
+
+        vertexShader = registry.find(ResourceType::VertexShader, vsKey);
+        vertexLayout = registry.find(ResourceType::InputLayout,  vsKey);
+        if (!vertexShader || !vertexLayout) {
+            auto VSBlob = Model::shaderCompile("VertexShader.hlsl", "VSInstanced", "vs_4_0");
+            if (VSBlob == nullptr) {
+                MessageBox(nullptr, L"shaderCompile()の失敗(VSInstanced)", L"Error", MB_OK);
+                return E_FAIL;
+            }
+
+            vertexShader = registry.getShader(ResourceType::VertexShader, vsKey, VSBlob->data(), VSBlob->size());
+            vertexLayout = registry.getInputLayout(vsKey, VertexLayout::PositionNormalInstanced, VSBlob->data(), VSBlob->size());
+            if (!vertexShader || !vertexLayout) {
+                MessageBox(nullptr, L"VSInstancedの作成の失敗", L"Error", MB_OK);
+                return E_FAIL;
+            }
+        }
+
+        pixelShader = registry.find(ResourceType::PixelShader, psKey);
+        if (!pixelShader) {
+            auto PSBlob = Model::shaderCompile("PixelShader.hlsl", "PSInstanced", "ps_4_0");
+            if (PSBlob == nullptr) {
+                MessageBox(nullptr, L"shaderCompile()の失敗(PSInstanced)", L"Error", MB_OK);
+                return E_FAIL;
+            }
+
+            pixelShader = registry.getShader(ResourceType::PixelShader, psKey, PSBlob->data(), PSBlob->size());
+            if (!pixelShader) {
+                MessageBox(nullptr, L"PSInstancedの作成の失敗", L"Error", MB_OK);
+                return E_FAIL;
+            }
+        }
+
+        // インスタンスバッファは毎フレーム転送し直すので容量ごとに共有する
+        // マテリアル表は変更があった時しか転送しないので、他のInstancedRendererの表で上書きされないよう1つずつ作る
+        auto tableKey  = Hash::combine(MATERIAL_TABLE, nextMaterialTable.fetch_add(1));
+        instanceBuffer = registry.getBuffer(ResourceType::VertexBuffer, Hash::combine(INSTANCE_BUFFER, static_cast<uint64_t>(capacity)), capacity * sizeof(InstanceData), sizeof(InstanceData), nullptr);
+        materialTable  = registry.getBuffer(ResourceType::ConstantBuffer, tableKey, sizeof(materials), 0, nullptr);
+        if (!instanceBuffer || !materialTable) {
+            MessageBox(nullptr, L"createBuffer()の失敗", L"Error", MB_OK);
+            return E_FAIL;
+        }
+
+        return S_OK;
+    }
+}
@@ -0,0 +1,66 @@
+#pragma once
+#ifndef INSTANCEDRENDERER_H
+#define INSTANCEDRENDERER_H
+#include <array>
+#include "DirectX11.h"
+#include "InstanceBatch.h"
+#include "Model.h"
+
+namespace Lib
+{
+    // 多数のModelをメッシュごとに1回のDrawIndexedInstancedで描く
+    // ※インスタンスごとの定数転送がないので、CPUの負荷はインスタンス数にほとんど依存しない
+    class InstancedRenderer
+    {
+    public:
+        static const uint32_t MAX_MATERIALS = 256;
+
+        // capacityは1フレームに描けるインスタンス数の上限
+        explicit InstancedRenderer(const uint32_t _capacity = 16384);
+        ~InstancedRenderer();
+
+        // マテリアル表へ追加して番号を返す(満杯なら0)
+        uint32_t addMaterial(const Color &ambient, const Color &diffuse);
+
+        // フレームごとに登録し直す
+        void clear();
+        void add(const Model &model, const Matrix &world, const uint32_t material = 0);
+
+        // 描画コマンドの記録(フレーム定数は更新済みであること)
+        void render(CommandList &commands);
+
+        // 描画順のソートキー(不透明。深度は登録したインスタンスの位置のAABBの最も手前の点)
+        uint64_t getSortKey(const Matrix &view, const float farZ) const;
+
+        const InstanceBatch::Stats &getStats() const { return batch.getStats(); }
+
+    private:
+        HRESULT init();
+
+        // マテリアル定数(Model::Materialと同じ配置)
+        struct Material
+        {
+            float ambient[4];
+            float diffuse[4];
+        };
+
+        ResourceRef vertexShader;
+        ResourceRef pixelShader;
+        ResourceRef vertexLayout;
+        ResourceRef instanceBuffer;
+        ResourceRef materialTable;
+
+        std::array<Material, MAX_MATERIALS> materials;
+        uint32_t materialCount;
+        bool     materialsDirty;
+
+        InstanceBatch batch;
+        uint32_t      capacity;
+
+        // 登録したインスタンスの位置のAABB(clear()で空に戻る)
+        float boundsMin[3];
+        float boundsMax[3];
+    };
+}
+
+#endif
@@ -0,0 +1,316 @@
+#include <algorithm>
+#include <chrono>
+#include "JobSystem.h"
+#include "Profiler.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace Lib
+{
+    namespace
+    {
+        // 1スレッドあたりの分割数の目安(盗まれる余地を残しつつ、分割のコストを抑える)
+        const size_t SPLIT_PER_THREAD = 8;
+
+        // 呼び出したスレッドが属するシステムとワーカー番号
+        struct ThreadContext
+        {
+            const JobSystem *system;
+            unsigned         index;
+        };
+        thread_local ThreadContext currentThread = { nullptr, 0 };
+
+        // 呼び出したスレッドを論理コアに固定する
+        void pinCurrentThread(const unsigned core)
+        {
+#ifdef _WIN32
+            SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(1) << (core % (sizeof(DWORD_PTR) * 8)));
+#elif defined(__linux__)
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(core % CPU_SETSIZE, &set);
+            pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+            (void)core;
+#endif
+        }
+    }
+
+    // コンストラクタ
+    JobSystem::JobSystem(const unsigned _threadCount, const bool pinThreads)
+        : threadCount(_threadCount != 0 ? _threadCount : std::max(1u, std::thread::hardware_concurrency())),
+          queued(0), sleeping(0), quit(false)
+    {
+        // 最後の1つは作成したスレッドとワーカー以外のスレッドが使う
+        for (unsigned i = 0; i <= threadCount; ++i) {
+            auto worker = std::make_unique<Worker>();
+            worker->jobs = std::make_unique<Job[]>(MAX_JOBS);
+            for (uint32_t k = 0; k < MAX_JOBS; ++k) {
+                worker->jobs[k].unfinished = 0;
+            }
+            worker->allocated    = 0;
+            worker->executed     = 0;
+            worker->steals       = 0;
+            worker->failedSteals = 0;
+            worker->idleTime     = 0;
+            worker->stealTime    = 0;
+            worker->ringWaits    = 0;
+            workers.push_back(std::move(worker));
+        }
+
+        // 作成したスレッドは0番目のワーカー(固定はしない)
+        currentThread = ThreadContext{ this, 0 };
+        threads.reserve(threadCount - 1);
+        for (unsigned i = 1; i < threadCount; ++i) {
+            threads.emplace_back(&JobSystem::workerMain, this, i, pinThreads);
+        }
+    }
+
+    // デストラクタ(実行待ちのジョブは実行されずに破棄される)
+    JobSystem::~JobSystem()
+    {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            quit = true;
+        }
+        wake.notify_all();
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        if (currentThread.system == this) {
+            currentThread = ThreadContext{ nullptr, 0 };
+        }
+    }
+
+    // 何もしないジョブの作成
+    JobSystem::Job * JobSystem::createEmpty(Job *parent)
+    {
+        auto job = allocate(parent);
+        job->invoke = nullptr;
+        return job;
+    }
+
+    // リングからの確保
+    JobSystem::Job * JobSystem::allocate(Job *parent)
+    {
+        auto  index  = getWorkerIndex();
+        auto &worker = *workers[index];
+        for (uint32_t probe = 1; ; ++probe) {
+            // 終わったジョブの位置だけを取る(外部用のリングは複数のスレッドが使うので、取得は不可分に行う)
+            auto job      = &worker.jobs[worker.allocated.fetch_add(1) % MAX_JOBS];
+            int32_t empty = 0;
+            if (job->unfinished.compare_exchange_strong(empty, 1)) {
+                job->parent = parent;
+                if (parent != nullptr) {
+                    parent->unfinished.fetch_add(1);
+                }
+                return job;
+            }
+
+            // 使用中の位置は上書きせずに飛ばし、一周しても空きがなければ他のジョブを手伝ってから探し直す
+            if (probe % MAX_JOBS == 0) {
+                worker.ringWaits.fetch_add(1);
+                if (auto next = getJob(index)) {
+                    execute(next, index);
+                }
+                else {
+                    std::this_thread::yield();
+                }
+            }
+        }
+    }
+
+    // 実行待ちにする
+    void JobSystem::run(Job *job)
+    {
+        auto &worker = *workers[getWorkerIndex()];
+        {
+            std::lock_guard<std::mutex> lock(worker.mutex);
+            worker.queue.push_back(job);
+        }
+        queued.fetch_add(1);
+
+        // 眠っているワーカーがいれば1つ起こす
+        // (待ちに入る直前のワーカーを取りこぼさないよう、sleepMutexを経由してから通知する)
+        if (sleeping.load() > 0) {
+            { std::lock_guard<std::mutex> lock(sleepMutex); }
+            wake.notify_one();
+        }
+    }
+
+    // 完了まで他のジョブを実行しながら待つ
+    void JobSystem::wait(const Job *job)
+    {
+        auto index = getWorkerIndex();
+        while (!isFinished(job)) {
+            if (auto next = getJob(index)) {
+                execute(next, index);
+            }
+            else {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    // 区間を分割して並列に処理する
+    void JobSystem::parallelFor(const size_t count, const RangeFunc &func, const size_t minGrain)
+    {
+        if (count == 0) {
+            return;
+        }
+        size_t grain = std::max<size_t>(std::max<size_t>(minGrain, 1), count / (threadCount * SPLIT_PER_THREAD));
+        if (threadCount <= 1 || count <= grain) {
+            func(0, count);
+            return;
+        }
+
+        // 実行しない空の親に全ての子をぶら下げ、親の完了を待つ
+        auto root = createEmpty();
+        splitRange(0, count, grain, func, root);
+        finish(root);
+        wait(root);
+    }
+
+    // 統計情報
+    JobSystem::Stats JobSystem::getStats() const
+    {
+        Stats stats = { 0, 0, 0, 0.0f, 0.0f, 0 };
+        for (auto &worker : workers) {
+            stats.executed     += worker->executed.load();
+            stats.steals       += worker->steals.load();
+            stats.failedSteals += worker->failedSteals.load();
+            stats.idleTime     += worker->idleTime.load() / 1000.0f;
+            stats.stealTime    += worker->stealTime.load() / 1000000.0f;
+            stats.ringWaits    += worker->ringWaits.load();
+        }
+        return stats;
+    }
+
+    // 統計情報のリセット
+    void JobSystem::resetStats()
+    {
+        for (auto &worker : workers) {
+            worker->executed     = 0;
+            worker->steals       = 0;
+            worker->failedSteals = 0;
+            worker->idleTime     = 0;
+            worker->stealTime    = 0;
+            worker->ringWaits    = 0;
+        }
+    }
+
+    // ワーカースレッドの処理
+    void JobSystem::workerMain(const unsigned index, const bool pin)
+    {
+        currentThread = ThreadContext{ this, index };
+        Profiler::getInstance().setThreadName("worker " + std::to_string(index));
+        if (pin) {
+            pinCurrentThread(index);
+        }
+
+        auto &worker = *workers[index];
+        while (!quit.load()) {
+            if (auto job = getJob(index)) {
+                execute(job, index);
+                continue;
+            }
+
+            // 仕事がなければ積まれるまで眠る
+            auto start = std::chrono::steady_clock::now();
+            {
+                std::unique_lock<std::mutex> lock(sleepMutex);
+                sleeping.fetch_add(1);
+                wake.wait(lock, [&]() { return queued.load() > 0 || quit.load(); });
+                sleeping.fetch_sub(1);
+            }
+            auto idle = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+            worker.idleTime.fetch_add(static_cast<uint64_t>(idle));
+        }
+    }
+
+    // ワーカー番号
+    unsigned JobSystem::getWorkerIndex() const
+    {
+        return currentThread.system == this ? currentThread.index : threadCount;
+    }
+
+    // 自分のキューの末尾から取り出し、なければ他のキューの先頭から盗む
+    JobSystem::Job * JobSystem::getJob(const unsigned index)
+    {
+        if (queued.load() == 0) {
+            return nullptr;
+        }
+        {
+            auto &own = *workers[index];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.queue.empty()) {
+                auto job = own.queue.back();
+                own.queue.pop_back();
+                queued.fetch_sub(1);
+                return job;
+            }
+        }
+        // 外部用のキューも含めて盗む
+        auto &thief = *workers[index];
+        auto start  = std::chrono::steady_clock::now();
+        auto addStealTime = [&]() {
+            auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+            thief.stealTime.fetch_add(static_cast<uint64_t>(elapsed));
+        };
+        auto workerCount = static_cast<unsigned>(workers.size());
+        for (unsigned k = 1; k < workerCount; ++k) {
+            auto &victim = *workers[(index + k) % workerCount];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.queue.empty()) {
+                auto job = victim.queue.front();
+                victim.queue.pop_front();
+                queued.fetch_sub(1);
+                thief.steals.fetch_add(1);
+                addStealTime();
+                return job;
+            }
+        }
+        thief.failedSteals.fetch_add(1);
+        addStealTime();
+        return nullptr;
+    }
+
+    // 実行
+    void JobSystem::execute(Job *job, const unsigned index)
+    {
+        PROFILE_SCOPE("JobSystem::execute");
+        if (job->invoke != nullptr) {
+            job->invoke(job);
+        }
+        workers[index]->executed.fetch_add(1);
+        finish(job);
+    }
+
+    // 完了の通知(子が全て終わっていれば親へ伝える)
+    void JobSystem::finish(Job *job)
+    {
+        // 0になった直後に作成元のリングで再利用されることがあるので、親は減らす前に読む
+        auto parent = job->parent;
+        if (job->unfinished.fetch_sub(1) == 1 && parent != nullptr) {
+            finish(parent);
+        }
+    }
+
+    // 区間をgrain以下になるまで半分ずつ子ジョブへ渡し、残りをこのスレッドで処理する
+    void JobSystem::splitRange(const size_t begin, const size_t end, const size_t grain, const RangeFunc &func, Job *parent)
+    {
+        size_t last = end;
+        while (last - begin > grain) {
+            size_t middle = begin + (last - begin) / 2;
+            run(create([this, middle, last, grain, &func, parent]() { splitRange(middle, last, grain, func, parent); }, parent));
+            last = middle;
+        }
+        func(begin, last);
+    }
+}
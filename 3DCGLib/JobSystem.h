@@ -0,0 +1,136 @@
+#pragma once
+#ifndef JOBSYSTEM_H
+#define JOBSYSTEM_H
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace Lib
+{
+    // ワークスティーリングによるジョブの実行
+    //
+    // スレッドごとに両端キューを持ち、自分のキューは末尾から(最近積んだものから)取り出し、
+    // 空になったら他のスレッドのキューの先頭から(古い大きな仕事から)盗む
+    // ジョブは親を持てる。子が全て終わるまで親は完了しないので、親を待てばfork/joinになる
+    //
+    // 作成したスレッドを0番目のワーカーとして扱う(wait()の間は他のジョブを手伝う)
+    // それ以外のスレッドはまとめて最後の1つ(外部用)のキューとリングを使い、ワーカーはそこからも盗む
+    class JobSystem
+    {
+    public:
+        static const uint32_t MAX_JOBS     = 4096; // スレッドごとに同時に存在できるジョブ数(リングで再利用する)
+        static const size_t   PAYLOAD_SIZE = 64;   // ジョブに直接持たせる関数オブジェクトの大きさの上限
+
+        // 区間[begin, end)を処理する関数
+        using RangeFunc = std::function<void(const size_t begin, const size_t end)>;
+
+        // ジョブ(create()で作成し、run()で実行待ちにする)
+        // 関数オブジェクトはpayloadへコピーして持つので、作成でヒープを使わない
+        struct Job
+        {
+            void                (*invoke)(Job *job); // payloadの関数を呼ぶ(nullptrなら何もしない)
+            Job                  *parent;
+            std::atomic<int32_t>  unfinished; // 自身と未完了の子の数
+            alignas(std::max_align_t) unsigned char payload[PAYLOAD_SIZE];
+        };
+
+        // 統計情報(ワーカーごとの合計。resetStats()まで累積)
+        struct Stats
+        {
+            uint64_t executed;      // 実行したジョブ数
+            uint64_t steals;        // 他のスレッドから盗んだジョブ数
+            uint64_t failedSteals;  // 盗もうとして空だった回数
+            float    idleTime;      // 仕事がなく眠っていた時間の合計(ミリ秒)
+            float    stealTime;     // 他のキューを探していた時間の合計(ミリ秒。成功・失敗の両方)
+            uint64_t ringWaits;     // リングを一周しても空きがなく、他のジョブを手伝って待った回数
+        };
+
+        // threadCountが0の場合はハードウェアのスレッド数
+        // pinThreadsがtrueならワーカーnをn番目の論理コアに固定する
+        explicit JobSystem(const unsigned _threadCount = 0, const bool pinThreads = false);
+        ~JobSystem();
+
+        // ジョブの作成(parentを指定するとparentはこのジョブの完了も待つ)
+        // funcはPAYLOAD_SIZE以下で、コピーと破棄が自明なもの(参照や値をキャプチャしたラムダなど)
+        // ※リングの位置は完了したジョブのものだけを再利用する。作成したジョブは必ずrun()すること
+        template <class Func>
+        Job *create(const Func &func, Job *parent = nullptr)
+        {
+            static_assert(sizeof(Func) <= PAYLOAD_SIZE, "job function is too large for the inline payload");
+            static_assert(alignof(Func) <= alignof(std::max_align_t), "job function is over-aligned");
+            static_assert(std::is_trivially_copyable<Func>::value && std::is_trivially_destructible<Func>::value,
+                "job function must be trivially copyable and destructible");
+            auto job = allocate(parent);
+            new (job->payload) Func(func);
+            job->invoke = [](Job *self) { (*reinterpret_cast<Func*>(self->payload))(); };
+            return job;
+        }
+        // 何もしないジョブ(子をぶら下げて待つための親)
+        Job *createEmpty(Job *parent = nullptr);
+        // 実行待ちにする
+        void run(Job *job);
+        // jobと子孫が完了するまで、他のジョブを実行しながら待つ
+        void wait(const Job *job);
+        bool isFinished(const Job *job) const { return job->unfinished.load() <= 0; }
+
+        // [0, count)を分割して並列に処理する(完了まで戻らない)
+        // 区間を半分ずつ子ジョブへ分けていき、grain以下になったら実行する
+        // grainは少なくともminGrainで、スレッド数に対して細かくなりすぎないよう自動で決まる
+        void parallelFor(const size_t count, const RangeFunc &func, const size_t minGrain = 1);
+
+        unsigned getThreadCount() const { return threadCount; }
+        Stats    getStats() const;
+        void    resetStats();
+
+    private:
+        // コピーの禁止
+        JobSystem(const JobSystem &) = delete;
+        JobSystem& operator=(const JobSystem &) = delete;
+
+        // ワーカーごとの状態
+        struct Worker
+        {
+            std::mutex             mutex;    // queueの保護(盗む側と競合するため)
+            std::deque<Job*>       queue;
+            std::unique_ptr<Job[]> jobs;     // ジョブのリング
+            std::atomic<uint32_t>  allocated;
+            std::atomic<uint64_t>  executed;
+            std::atomic<uint64_t>  steals;
+            std::atomic<uint64_t>  failedSteals;
+            std::atomic<uint64_t>  idleTime;  // マイクロ秒
+            std::atomic<uint64_t>  stealTime; // ナノ秒
+            std::atomic<uint64_t>  ringWaits;
+        };
+
+        void workerMain(const unsigned index, const bool pin);
+        // 呼び出したスレッドのワーカー番号(このシステムのワーカー以外は外部用のthreadCount)
+        unsigned getWorkerIndex() const;
+        // リングから確保する(使用中の位置は飛ばし、空きがなければ手伝いながら待つ)
+        Job *allocate(Job *parent);
+        // 自分のキューから取り出し、なければ盗む
+        Job *getJob(const unsigned index);
+        void execute(Job *job, const unsigned index);
+        void finish(Job *job);
+        void splitRange(const size_t begin, const size_t end, const size_t grain, const RangeFunc &func, Job *parent);
+
+        unsigned                             threadCount;
+        std::vector<std::unique_ptr<Worker>> workers; // threadCount個のワーカーと外部用の1つ
+        std::vector<std::thread>             threads;
+        std::atomic<uint32_t>                queued;   // キューに積まれているジョブの数
+        std::atomic<uint32_t>                sleeping; // 眠っているワーカーの数
+        std::mutex                           sleepMutex;
+        std::condition_variable              wake;
+        std::atomic<bool>                    quit;
+    };
+}
+
+#endif
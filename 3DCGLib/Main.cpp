@@ -1,17 +1,56 @@
 #include <Windows.h>
+#include <shellapi.h>
+#include <atomic>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
 #include <sstream>
-#include <locale>
+#include <cstdio>
+#include <vector>
 #include "Window.h"
 #include "DirectX11.h"
 #include "Model.h"
+#include "InstancedRenderer.h"
+#include "PrimitiveTables.h"
+#include "RenderQueue.h"
+#include "StaticBatcher.h"
+#include "TransformHierarchy.h"
 #include "Matrix.h"
 #include "MyMath.h"
-#include "Time.h"
+#include "FrameCapture.h"
+#include "FrameScheduler.h"
+#include "FrameStats.h"
+#include "InputRecorder.h"
+#include "Profiler.h"
+#include "SimulationThread.h"
+#include "TripleBuffer.h"
 
 using namespace Lib;
 
-const float FPS   = 60.0f;   // sfps
-const float SPEED = 0.001f; // f̈ړx
+const float FPS   = 60.0f;   // 実行したいfps(0なら上限なし)
+const float SPEED = 0.001f; // モデルの移動速度
+const float SIMULATION_RATE = 50.0f; // シミュレーションの更新回数/秒(描画のfpsとは独立)
+const DWORD IDLE_WAIT = 250;         // 画面に変化がない時に入力を待って眠る最大時間(ミリ秒)
+const int   STATS_DUMP_INTERVAL = 10; // フレーム時間の統計をファイルへ書き出す間隔(秒)
+const uint32_t CAPTURE_BUFFERS = 4; // 画像の書き出しで描画と書き出しの間に置けるフレーム数
+const int   INSTANCE_GRID = 100; // インスタンス描画の確認用に並べる球体の数(一辺)
+const int   STATIC_GRID   = 40;  // 静的バッチの確認用に並べる立方体の数(一辺)
+const float NEAR_Z = 0.01f;  // 射影の近い平面
+const float FAR_Z  = 100.0f; // 射影の遠い平面(描画順のキーの深度はこれで正規化する)
+
+#pragma comment(lib, "shell32.lib")
+
+// ワイド文字列のパスをマルチバイト文字列に変換
+static std::string toPath(const wchar_t *path)
+{
+    int length = WideCharToMultiByte(CP_ACP, 0, path, -1, nullptr, 0, nullptr, nullptr);
+    if (length <= 1) {
+        return std::string();
+    }
+    std::string result(length - 1, '\0');
+    WideCharToMultiByte(CP_ACP, 0, path, -1, &result[0], length, nullptr, nullptr);
+    return result;
+}
 
 int WINAPI wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance, _In_ LPWSTR lpCmdLine, _In_ int nCmdShow)
 {
@@ -20,103 +59,590 @@ int WINAPI wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance,
     UNREFERENCED_PARAMETER(lpCmdLine);
     UNREFERENCED_PARAMETER(nCmdShow);
 
-    // EBhE̍쐬
+    // コマンドライン
+    //   --record <path>  毎フレームの入力と経過時間を記録する
+    //   --replay <path>  記録した入力と経過時間で実行し、最後まで再生したら終了する
+    //   --unthrottled    再生時にフレームの間隔を待たずにできるだけ速く進める
+    //   --capture <path> 起動時からフレームの画像を書き出す(.y4m/.ppm/それ以外はRGBAのまま。「C」で止める)
+    std::string recordPath;
+    std::string replayPath;
+    std::string capturePath;
+    bool unthrottled = false;
+    int argc = 0;
+    if (auto argv = CommandLineToArgvW(GetCommandLineW(), &argc)) {
+        for (int i = 1; i < argc; ++i) {
+            if (wcscmp(argv[i], L"--record") == 0 && i + 1 < argc) {
+                recordPath = toPath(argv[++i]);
+            }
+            else if (wcscmp(argv[i], L"--replay") == 0 && i + 1 < argc) {
+                replayPath = toPath(argv[++i]);
+            }
+            else if (wcscmp(argv[i], L"--capture") == 0 && i + 1 < argc) {
+                capturePath = toPath(argv[++i]);
+            }
+            else if (wcscmp(argv[i], L"--unthrottled") == 0) {
+                unthrottled = true;
+            }
+        }
+        LocalFree(argv);
+    }
+
+    Profiler::getInstance().setThreadName("main");
+
+    // ウィンドウの作成
     auto w = std::make_shared<Lib::Window>(L"3DCGLib", 1026, 768);
 
-    // DirectX̃CX^X̎擾
+    // DirectXのインスタンスの取得
     auto& directX = Lib::DirectX11::getInstance();
     directX.initDevice(w);
 
-    // ViewMatrix̏
-    Vector3 eye = Vector3(0.0f, 1.0f, -5.0f); // J̍W
-    Vector3 at  = Vector3(0.0f, 1.0f,  0.0f); // Ώ
-    Vector3 up  = Vector3::UP;                // ݂̃[hW̏
+    // ViewMatrixの初期化
+    Vector3 eye = Vector3(0.0f, 1.0f, -5.0f); // カメラの座標
+    Vector3 at  = Vector3(0.0f, 1.0f,  0.0f); // 注視対象
+    Vector3 up  = Vector3::UP;                // 現在のワールド座標の上方向
     auto view   = Matrix::LookAtLH(eye, at, up);
     directX.setViewMatrix(view);
 
-    // ProjectionMatrix̏
+    // ProjectionMatrixの初期化
     LONG windowWidth  = w->getWindowRect().right  - w->getWindowRect().left;
     LONG windowHeight = w->getWindowRect().bottom - w->getWindowRect().top;
-    auto projection   = Matrix::perspectiveFovLH(MyMath::PIDIV2, windowWidth / static_cast<float>(windowHeight), 0.01f, 100.0f);
+    auto projection   = Matrix::perspectiveFovLH(MyMath::PIDIV2, windowWidth / static_cast<float>(windowHeight), NEAR_Z, FAR_Z);
     directX.setProjectionMatrix(projection);
     
-    // f̍쐬
+    // モデルの作成(シェーダーの読み込み時間を計測)
+    auto startupBegin = std::chrono::steady_clock::now();
     Model model = Model(36);
+    auto startupTime  = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - startupBegin).count();
+
+    // コンパイルが発生していればコールドスタート、キャッシュのみならウォームスタート
+    auto shaderStats = directX.getShaderCache().getStats();
+    std::ostringstream startupOss;
+    startupOss << (shaderStats.compiles > 0 ? "cold" : "warm") << " startup: " << startupTime << "ms"
+               << " (compiles: " << shaderStats.compiles << " " << shaderStats.compileTime << "ms"
+               << ", disk hits: " << shaderStats.diskHits << " " << shaderStats.diskTime << "ms"
+               << ", memory hits: " << shaderStats.memoryHits << ", invalidated: " << shaderStats.invalidations << ")" << std::endl;
+    auto resourceStats = directX.getResourceRegistry().getStats();
+    startupOss << "gpu resources: " << resourceStats.resources << " (" << resourceStats.bytes << " bytes"
+               << ", references: " << resourceStats.references << ", created: " << resourceStats.creates
+               << " " << resourceStats.createTime << "ms)" << std::endl;
+    auto memoryStats = directX.getMemoryStats();
+    startupOss << "gpu memory: " << memoryStats.total << " bytes (resources: " << memoryStats.resourceBytes
+               << ", render targets: " << memoryStats.renderTargetBytes << ")" << std::endl;
+    OutputDebugStringA(startupOss.str().c_str());
     Matrix world;
     world = Matrix::Identify;
 
-    float posX = 0.0f;
-    float posY = 0.0f;
-    float posZ = 0.0f;
+    // 「I」を押している間だけ床一面の球体をインスタンス描画で表示する
+    InstancedRenderer instanced;
+    std::vector<Matrix> gridWorlds; // 「M」で同じ球体を1つずつ描く時のワールド行列
+    uint32_t instanceMaterials[] = {
+        0,
+        instanced.addMaterial(Color(0.8f, 0.3f, 0.3f), Color(0.8f, 0.3f, 0.3f)),
+        instanced.addMaterial(Color(0.3f, 0.4f, 0.8f), Color(0.3f, 0.4f, 0.8f)),
+    };
+    for (int z = 0; z < INSTANCE_GRID; ++z) {
+        for (int x = 0; x < INSTANCE_GRID; ++x) {
+            auto instanceWorld = Matrix::scale(0.04f) * Matrix::translate((x - INSTANCE_GRID / 2) * 0.1f, -1.0f, z * 0.1f);
+            instanced.add(model, instanceWorld, instanceMaterials[(x + z) % ARRAYSIZE(instanceMaterials)]);
+            gridWorlds.push_back(instanceWorld);
+        }
+    }
+    // 「M」を押している間だけ同じ球体をModelの描画で1つずつ表示する(記録は常駐ワーカーで並列に行う)
+    ParallelRecorder gridRecorder(directX.getJobSystem());
+
+    // ライトの位置を示す小さな球体(ライトのノードの子として動かす)
+    TransformHierarchy transforms;
+    auto lightNode = transforms.create();
+    auto gizmoNode = transforms.create(lightNode);
+    transforms.setPosition(lightNode, directX.getLightPosition());
+    transforms.setScale(gizmoNode, Vector3(0.1f, 0.1f, 0.1f));
+    Model lightGizmo = Model(16);
+    lightGizmo.setMaterial(Color(1.0f, 1.0f, 0.6f), Color(1.0f, 1.0f, 0.6f));
 
-    // 
-    MessageBox(w->getHWND(), L"uWvuAvuSvuDvŃf̉]", L"", MB_OK | MB_ICONINFORMATION);
+    // 記録・再生する入力(移動キーと切り替えのキー)
+    const BYTE MOVE_KEYS[]  = { 'W', 'S', 'A', 'D', 'E', 'Q' }; // 奥/手前, 左/右, 上/下
+    const BYTE INPUT_KEYS[] = { 'W', 'S', 'A', 'D', 'E', 'Q', 'P', 'R', 'I', 'B', 'C', 'M' };
+    InputRecorder input(std::vector<uint8_t>(INPUT_KEYS, INPUT_KEYS + ARRAYSIZE(INPUT_KEYS)));
+    if (!replayPath.empty()) {
+        if (!input.startReplay(replayPath)) {
+            MessageBox(w->getHWND(), L"入力の記録の読み込みに失敗しました", L"Error", MB_OK);
+            return 1;
+        }
+    }
+    else if (!recordPath.empty()) {
+        if (!input.startRecording(recordPath, SIMULATION_RATE)) {
+            MessageBox(w->getHWND(), L"入力の記録ファイルを作成できません", L"Error", MB_OK);
+            return 1;
+        }
+    }
+
+    // 説明(再生時は止まらないように出さない)
+    if (!input.isReplaying()) {
+        MessageBox(w->getHWND(), L"「W」「A」「S」「D」でモデルの回転\n「P」でプロファイルの計測開始・保存\n「R」で描画の負荷の集計の開始・終了", L"操作説明", MB_OK | MB_ICONINFORMATION);
+    }
+
+    // 「B」を押している間だけ奥の壁一面の立方体を静的バッチで表示する
+    StaticBatcher staticBatch(directX.getResourceRegistry());
+    std::vector<StaticBatcher::Handle> staticHandles;
+    for (int y = 0; y < STATIC_GRID; ++y) {
+        for (int x = 0; x < STATIC_GRID; ++x) {
+            auto cubeWorld = Matrix::scale(0.1f) * Matrix::translate((x - STATIC_GRID / 2) * 0.25f, (y - STATIC_GRID / 2) * 0.25f, 6.0f);
+            staticHandles.push_back(staticBatch.add(PrimitiveTables::cube(), cubeWorld));
+        }
+    }
+
+    // 描画順(不透明は状態ごとにまとめて手前から描く)。要素の番号はDrawItemで、DRAW_GRID以降は「M」の格子の球体
+    enum DrawItem : uint32_t { DRAW_MODEL, DRAW_GIZMO, DRAW_INSTANCED, DRAW_STATIC, DRAW_GRID };
+    RenderQueue drawQueue;
+
+    // 描画の負荷の集計中は、キューの順に描いた場合のオーバードローを粗いタイルで見積もる
+    OverdrawEstimator overdraw;
+    Matrix viewProjection;
+    // ワールド座標のAABBを射影した矩形を、最も手前の深度で描く
+    auto estimateBox = [&](const float min[3], const float max[3]) {
+        float ndcMin[2] = {  FLT_MAX,  FLT_MAX };
+        float ndcMax[2] = { -FLT_MAX, -FLT_MAX };
+        float nearest   = 1.0f;
+        bool  projected = false;
+        for (int corner = 0; corner < 8; ++corner) {
+            float x = (corner & 1) ? max[0] : min[0];
+            float y = (corner & 2) ? max[1] : min[1];
+            float z = (corner & 4) ? max[2] : min[2];
+            float w = x * viewProjection.m14 + y * viewProjection.m24 + z * viewProjection.m34 + viewProjection.m44;
+            // 近い平面より手前の角は除く
+            if (w < NEAR_Z) {
+                continue;
+            }
+            float px = (x * viewProjection.m11 + y * viewProjection.m21 + z * viewProjection.m31 + viewProjection.m41) / w;
+            float py = (x * viewProjection.m12 + y * viewProjection.m22 + z * viewProjection.m32 + viewProjection.m42) / w;
+            float pz = (x * viewProjection.m13 + y * viewProjection.m23 + z * viewProjection.m33 + viewProjection.m43) / w;
+            ndcMin[0] = std::min(ndcMin[0], px);
+            ndcMin[1] = std::min(ndcMin[1], py);
+            ndcMax[0] = std::max(ndcMax[0], px);
+            ndcMax[1] = std::max(ndcMax[1], py);
+            nearest   = std::min(nearest, std::max(pz, 0.0f));
+            projected = true;
+        }
+        if (projected) {
+            overdraw.draw(ndcMin[0], ndcMin[1], ndcMax[0], ndcMax[1], nearest);
+        }
+    };
+    // 単位球のメッシュをworldで変換した境界球を描く
+    auto estimateSphere = [&](const Matrix &sphereWorld) {
+        float radius = 0.0f;
+        for (int row = 0; row < 3; ++row) {
+            auto &axis = sphereWorld.mat4x4[row];
+            radius = std::max(radius, std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]));
+        }
+        const float min[3] = { sphereWorld.m41 - radius, sphereWorld.m42 - radius, sphereWorld.m43 - radius };
+        const float max[3] = { sphereWorld.m41 + radius, sphereWorld.m42 + radius, sphereWorld.m43 + radius };
+        estimateBox(min, max);
+    };
+
+    // シミュレーションの結果(前後のステップの状態を持ち、描画側で補間する)
+    struct SceneSnapshot
+    {
+        Vector3 lightPosition[2]; // [0]:1つ前のステップ [1]:最新のステップ
+        Matrix  gizmoWorld[2];
+        SimulationThread::Clock::time_point time; // 最新のステップの時刻
+    };
+    transforms.update();
+    SceneSnapshot scene = {
+        { directX.getLightPosition(), directX.getLightPosition() },
+        { transforms.getWorldMatrix(gizmoNode), transforms.getWorldMatrix(gizmoNode) },
+        SimulationThread::Clock::now()
+    };
+    TripleBuffer<SceneSnapshot> snapshots(scene);
+
+    // 移動キーの状態(描画スレッドで書き、シミュレーションスレッドで読む)。MOVE_KEYSのn番目がnビット目
+    std::atomic<uint32_t> moveKeys(0);
+
+    // ライトの移動は別スレッドで固定の時間刻みで進める(ここから先、transformsとsceneはシミュレーションスレッドだけが触る)
+    auto stepScene = [&](const float stepTime) {
+        auto keys = moveKeys.load(std::memory_order_relaxed);
+        // plus番目のキーなら正、minus番目のキーなら負の向きに1ステップ分動かす
+        auto axis = [&](const int plus, const int minus) {
+            return (keys & (1u << plus)) ? SPEED * stepTime : (keys & (1u << minus)) ? -SPEED * stepTime : 0.0f;
+        };
+        PROFILE_SCOPE("stepScene");
+        scene.lightPosition[0] = scene.lightPosition[1];
+        scene.gizmoWorld[0]    = scene.gizmoWorld[1];
+        scene.lightPosition[1].translate(axis(3, 2), axis(4, 5), axis(0, 1));
+        if (scene.lightPosition[1] != transforms.getPosition(lightNode)) {
+            transforms.setPosition(lightNode, scene.lightPosition[1]);
+        }
+        transforms.update();
+        if (transforms.isChanged(gizmoNode)) {
+            scene.gizmoWorld[1] = transforms.getWorldMatrix(gizmoNode);
+        }
+    };
+    auto publishScene = [&](const SimulationThread::Clock::time_point time) {
+        scene.time = time;
+        snapshots.getWriteBuffer() = scene;
+        snapshots.publish();
+    };
+    SimulationThread simulation(SIMULATION_RATE, stepScene, publishScene);
+    // 記録・再生時は同じ結果になるよう、メインスレッドで記録した経過時間だけ進める
+    bool deterministic = input.getMode() != InputRecorder::Mode::Off;
+    if (!deterministic) {
+        simulation.start();
+    }
 
-    // XV
-    Time time = Time();
-    int fps = 0;
+    // 更新処理
+    FrameScheduler scheduler(FPS);
+    // フレーム時間の分布(目標のfpsの1.5フレーム分を超えたら引っかかりとみなす)
+    FrameStats frameStats(1.5f * 1000.0f / (FPS > 0.0f ? FPS : 60.0f));
+    bool presentedLast = false; // 前のフレームを描画したか(眠っていた間の間隔は数えない)
+    int statsSeconds = 0;
     float countTime = 0.0f;
     float deltaTime = 0.0f;
-    std::ostringstream oss;
-    WCHAR wcstr[50];
-    size_t size = 0;
-    setlocale(LC_ALL, "japanese"); // mbstowcs_sׂ̈̏
+    bool shownInstanced = false;
+    bool shownStatic    = false;
+    bool shownModels    = false;
+    bool profileKeyDown = false;
+    bool renderStatsKeyDown = false;
+    bool captureKeyDown = false;
+    // デバッグ出力の文字列(ループ内でヒープを使わないよう固定長のバッファに書く)
+    char message[256];
+    // フレームの画像の書き出し(描画スレッドはバッファを渡すだけで、変換と書き込みは別スレッド)
+    FrameCapture capture;
+    auto startCapture = [&]() {
+        auto path = capturePath.empty() ? std::string("capture.y4m") : capturePath;
+        FrameCapture::Settings settings{ FrameCapture::formatFromPath(path), directX.getBackBufferWidth(), directX.getBackBufferHeight(),
+            FPS > 0.0f ? FPS : 60.0f, CAPTURE_BUFFERS, FrameCapture::Policy::Drop };
+        if (capture.start(path, settings)) {
+            directX.setFrameCapture(&capture);
+            OutputDebugStringA(("capture started: " + path + "\n").c_str());
+        }
+        else {
+            OutputDebugStringA("capture start failed\n");
+        }
+    };
+    auto stopCapture = [&]() {
+        directX.setFrameCapture(nullptr);
+        capture.stop();
+        auto stats = capture.getStats();
+        snprintf(message, sizeof(message), "capture: %llu frames written (%llu bytes, dropped %llu, max queued %u) write %.1fms%s\n",
+            static_cast<unsigned long long>(stats.written), static_cast<unsigned long long>(stats.bytesWritten),
+            static_cast<unsigned long long>(stats.dropped), stats.maxQueued, stats.writeTime, stats.failed ? " failed" : "");
+        OutputDebugStringA(message);
+    };
+    if (!capturePath.empty()) {
+        startCapture();
+    }
+    // 実際の時計でのフレームの開始時刻(再生時は経過時間が記録の値になるため、フレーム時間はこちらで測る)
+    auto runBegin   = std::chrono::steady_clock::now();
+    auto frameBegin = runBegin;
  
     while (w->Update().message != WM_QUIT) {
-        directX.begineFrame();
+        // FPSの固定(次のフレームの開始時刻まで眠って待つ)
+        deltaTime = unthrottled && input.isReplaying() ? 0.0f : scheduler.waitForNextFrame();
+        auto frameNow  = std::chrono::steady_clock::now();
+        auto frameTime = std::chrono::duration<float, std::milli>(frameNow - frameBegin).count();
+        frameBegin = frameNow;
 
-        // FPŠŒ
-        if (!time.timeOver(1000.0f / FPS)) {
-            continue;
+        // このフレームの入力(再生時は記録した入力と経過時間に置き換える)
+        uint32_t inputKeys = 0;
+        if (input.isReplaying()) {
+            InputLogFrame frame;
+            if (!input.next(frame)) {
+                break;
+            }
+            deltaTime = frame.deltaTime;
+            inputKeys = frame.keys;
         }
-
-        deltaTime = time.getDeltaTime();
+        else {
+            for (auto key : INPUT_KEYS) {
+                if (w->getKeyDown(key)) {
+                    inputKeys |= input.keyBit(key);
+                }
+            }
+            if (w->consumeRedrawRequest()) {
+                inputKeys |= InputRecorder::REDRAW_BIT;
+            }
+            input.record(deltaTime, inputKeys);
+        }
+        auto keyDown = [&](const BYTE key) { return (inputKeys & input.keyBit(key)) != 0; };
         countTime += deltaTime;
+        PROFILE_SCOPE("frame");
+        auto updateBegin = std::chrono::steady_clock::now();
 
-        // 1bɂPs
+        // 1秒に１回行う処理
         if (countTime > 1000.0f) {
-            // fpsfobKɏo
-            oss.str("");
-            oss << "fps: " << fps << std::endl;
-            mbstowcs_s(&size, wcstr, 20, oss.str().c_str(), _TRUNCATE);
-            OutputDebugString(wcstr);
-            // ϐ̃Zbg
-            fps = 0;
+            // 直近のフレーム時間の分布をデバッガに出力(平均では隠れる引っかかりを見る)
+            auto frameSummary = frameStats.getSummary(FrameStats::FRAME);
+            snprintf(message, sizeof(message), "frame p50: %.2fms p95: %.2fms p99: %.2fms max: %.2fms hitches: %u (budget %.2fms, presented: %llu skipped: %llu)\n",
+                frameSummary.p50, frameSummary.p95, frameSummary.p99, frameSummary.max, frameStats.getWindowHitches(), frameStats.getBudget(),
+                static_cast<unsigned long long>(directX.getPresentedFrames()), static_cast<unsigned long long>(directX.getSkippedFrames()));
+            OutputDebugStringA(message);
+            auto updateSummary  = frameStats.getSummary(FrameStats::UPDATE);
+            auto renderSummary  = frameStats.getSummary(FrameStats::RENDER);
+            auto presentSummary = frameStats.getSummary(FrameStats::PRESENT);
+            snprintf(message, sizeof(message), "cpu p99 update: %.2fms render: %.2fms present: %.2fms\n",
+                updateSummary.p99, renderSummary.p99, presentSummary.p99);
+            OutputDebugStringA(message);
+            // 一定間隔でファイルへ書き出す
+            if (++statsSeconds % STATS_DUMP_INTERVAL == 0) {
+                frameStats.appendCsv("frame_stats.csv");
+                frameStats.writeJson("frame_stats.json");
+                if (directX.getRenderStats().isEnabled()) {
+                    directX.getRenderStats().writeJson("render_stats.json", directX.getResourceRegistry(), directX.getMemoryStats().renderTargetBytes);
+                }
+            }
+            // フレーム間隔のばらつきと待ち方
+            auto pacing = scheduler.getStats();
+            snprintf(message, sizeof(message), "frame: %.3fms jitter: %.3fms late: %u (max %.3fms) sleep: %.1fms spin: %.1fms\n",
+                pacing.averageTime, pacing.jitter, pacing.lateFrames, pacing.maxLateness, pacing.sleepTime, pacing.spinTime);
+            OutputDebugStringA(message);
+            scheduler.resetStats();
+            // シミュレーションスレッド
+            auto simulationStats = simulation.getStats();
+            snprintf(message, sizeof(message), "simulation: %llu steps (dropped %llu) update: %.3fms\n",
+                static_cast<unsigned long long>(simulationStats.steps), static_cast<unsigned long long>(simulationStats.droppedSteps), simulationStats.updateTime);
+            OutputDebugStringA(message);
+            // 定数バッファの転送量
+            int length = snprintf(message, sizeof(message), "upload: %u bytes/frame", directX.getUploadBytes());
+            if (auto ring = directX.getUploadRing()) {
+                length += snprintf(message + length, sizeof(message) - length, " ring stalls: %u used: %u/%u",
+                    ring->getStats().stalls, ring->getUsed(), ring->getCapacity());
+            }
+            snprintf(message + length, sizeof(message) - length, "\n");
+            OutputDebugStringA(message);
+            // フレーム内の一時メモリ
+            auto arenaStats = directX.getFrameArena().getStats();
+            snprintf(message, sizeof(message), "frame arena: %zu/%zu bytes (high water: %zu, overflows: %u)\n",
+                arenaStats.used, arenaStats.capacity, arenaStats.highWater, arenaStats.overflows);
+            OutputDebugStringA(message);
+            // 描画の負荷(集計を始めてからの1フレームあたりの平均)
+            auto &renderStats = directX.getRenderStats();
+            if (renderStats.isEnabled() && renderStats.getFrames() > 0) {
+                auto average = renderStats.getAverage();
+                auto memory  = directX.getMemoryStats();
+                snprintf(message, sizeof(message), "render: draws %u triangles %llu state changes %u (eliminated %u) constants %u bytes buffers %u bytes, gpu memory %llu bytes\n",
+                    average.drawCalls, static_cast<unsigned long long>(average.triangles), average.stateChanges, average.eliminated,
+                    average.constantBytes, average.bufferBytes, static_cast<unsigned long long>(memory.total));
+                OutputDebugStringA(message);
+                snprintf(message, sizeof(message), "draw order: %u items state changes %u -> %u overdraw %.2f\n",
+                    average.queuedDraws, average.unsortedChanges, average.sortedChanges, RenderStats::getOverdraw(average));
+                OutputDebugStringA(message);
+            }
+            // 変数のリセット
             countTime = 0.0f;
         }
-        time.reset();
-        ++fps;
+        // 移動キーをシミュレーションスレッドへ渡す
+        uint32_t keys = 0;
+        for (size_t i = 0; i < ARRAYSIZE(MOVE_KEYS); ++i) {
+            if (keyDown(MOVE_KEYS[i])) {
+                keys |= 1u << i;
+            }
+        }
+        moveKeys.store(keys, std::memory_order_relaxed);
+        if (keys != 0) {
+            simulation.resume();
+        }
+        if (deterministic) {
+            simulation.advance(deltaTime);
+        }
 
-        // ړ        
-        posX = posY = posZ = 0.0f;
+        // 最新のシミュレーションの結果を受け取り、前のステップとの間を補間して描く
+        snapshots.update();
+        auto &snapshot = snapshots.getReadBuffer();
+        auto  alpha    = simulation.getInterpolation(snapshot.time);
+        directX.setLightPosition(MyMath::lerp(snapshot.lightPosition[0], snapshot.lightPosition[1], alpha));
+        auto gizmoWorld = MyMath::lerp(snapshot.gizmoWorld[0], snapshot.gizmoWorld[1], alpha);
+        lightGizmo.setWorldMatrix(gizmoWorld);
 
-        if (w->getKeyDown('W')) {
-            posZ = SPEED * deltaTime;
+        // 「P」でプロファイラの計測を切り替える(止めた時に実行ディレクトリへ書き出す)
+        bool profileKey = keyDown('P');
+        if (profileKey && !profileKeyDown) {
+            auto &profiler = Profiler::getInstance();
+            if (profiler.isEnabled()) {
+                profiler.setEnabled(false);
+                bool saved = profiler.exportChromeTrace("profile.json") && profiler.exportBinary("profile.bin");
+                OutputDebugStringA(saved ? "profile saved: profile.json profile.bin\n" : "profile save failed\n");
+            }
+            else {
+                profiler.clear();
+                profiler.setEnabled(true);
+                OutputDebugStringA("profiling started\n");
+            }
         }
-        else if (w->getKeyDown('S')) {
-            posZ = -SPEED * deltaTime;
+        profileKeyDown = profileKey;
+
+        // 「R」で描画の負荷の集計を切り替える(止めた時に実行ディレクトリへ書き出す)
+        bool renderStatsKey = keyDown('R');
+        if (renderStatsKey && !renderStatsKeyDown) {
+            auto &renderStats = directX.getRenderStats();
+            if (renderStats.isEnabled()) {
+                renderStats.setEnabled(false);
+                bool saved = renderStats.writeJson("render_stats.json", directX.getResourceRegistry(), directX.getMemoryStats().renderTargetBytes);
+                OutputDebugStringA(saved ? "render stats saved: render_stats.json\n" : "render stats save failed\n");
+            }
+            else {
+                renderStats.reset();
+                renderStats.setEnabled(true);
+                OutputDebugStringA("render stats started\n");
+            }
         }
-        if (w->getKeyDown('A')) {
-            posX = -SPEED * deltaTime;
+        renderStatsKeyDown = renderStatsKey;
+
+        // 「C」で画像の書き出しを切り替える
+        bool captureKey = keyDown('C');
+        if (captureKey && !captureKeyDown) {
+            if (capture.isRunning()) {
+                stopCapture();
+            }
+            else {
+                startCapture();
+            }
         }
-        else if (w->getKeyDown('D')) {
-            posX = SPEED * deltaTime;
+        captureKeyDown = captureKey;
+        // 書き出し中は変化がなくても毎フレーム描画する(動画のフレームを欠かさない)
+        if (capture.isRunning()) {
+            directX.markSceneChanged();
         }
-        if (w->getKeyDown('E')) {
-            posY = SPEED * deltaTime;
+
+        // 表示の切り替えとウィンドウの再描画の要求
+        bool showInstanced = keyDown('I');
+        bool showStatic    = keyDown('B');
+        bool showModels    = keyDown('M');
+        if (showInstanced != shownInstanced || showStatic != shownStatic || showModels != shownModels || (inputKeys & InputRecorder::REDRAW_BIT) != 0) {
+            shownInstanced = showInstanced;
+            shownStatic    = showStatic;
+            shownModels    = showModels;
+            directX.markSceneChanged();
         }
-        else if (w->getKeyDown('Q')) {
-            posY = -SPEED * deltaTime;
+
+        // 何も変わっていなければ描画もPresentもせず、前のフレームの画像をそのまま表示しておく
+        if (!directX.isSceneChanged()) {
+            directX.skipFrame();
+            presentedLast = false;
+            // 入力がなく動きも止まっていれば、シミュレーションも止めてメッセージが届くまで眠る
+            if (keys == 0) {
+                simulation.pause();
+                if (!input.isReplaying()) {
+                    w->waitForMessage(IDLE_WAIT);
+                    // 眠っていた間をフレームの遅れとして数えない
+                    scheduler.resume();
+                }
+            }
+            continue;
         }
 
-        // Cg̃f̐
-        model.getLightPos().translate(posX, posY, posZ);
+        // 描画
+        auto renderBegin = std::chrono::steady_clock::now();
+        directX.begineFrame();
+        directX.updateFrameConstants();
+        auto &view = directX.getViewMatrix();
+        viewProjection = view * directX.getProjectionMatrix();
+        if (showStatic) {
+            staticBatch.cull(viewProjection);
+        }
+
+        // 描画順の決定
+        drawQueue.clear();
+        drawQueue.push(model.getSortKey(view, FAR_Z), DRAW_MODEL);
+        drawQueue.push(lightGizmo.getSortKey(view, FAR_Z), DRAW_GIZMO);
+        if (showInstanced) {
+            drawQueue.push(instanced.getSortKey(view, FAR_Z), DRAW_INSTANCED);
+        }
+        StaticBatcher::Bounds staticBounds;
+        if (showStatic && staticBatch.getVisibleBounds(staticBounds)) {
+            drawQueue.push(model.getSortKey(view, FAR_Z, staticBounds), DRAW_STATIC);
+        }
+        if (showModels) {
+            for (uint32_t i = 0; i < gridWorlds.size(); ++i) {
+                drawQueue.push(model.getSortKey(view, FAR_Z, gridWorlds[i]), DRAW_GRID + i);
+            }
+        }
+        drawQueue.sort();
 
-        // `
-        model.render(Lib::Color(Lib::Color::BLUE));
+        // キューの順に記録する(格子の球体は並列に記録し、他の描画の後にまとめて実行する)
+        // 並列に記録する格子の球体(キューの順)はフレームアリーナに置く(記録が終わるこのフレームの間だけ使う)
+        auto &commands = directX.getCommandList();
+        FrameVector<uint32_t> gridOrder{ FrameAllocator<uint32_t>(directX.getFrameArena()) };
+        gridOrder.reserve(gridWorlds.size());
+        for (auto &item : drawQueue.getItems()) {
+            switch (item.index) {
+            case DRAW_MODEL:     model.render(commands);                    break;
+            case DRAW_GIZMO:     lightGizmo.render(commands);               break;
+            case DRAW_INSTANCED: instanced.render(commands);                break;
+            case DRAW_STATIC:    model.renderStatic(commands, staticBatch); break;
+            default:             gridOrder.push_back(item.index - DRAW_GRID); break;
+            }
+        }
+        if (!gridOrder.empty()) {
+            gridRecorder.record(gridOrder.size(), [&](CommandList &gridCommands, const size_t begin, const size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    model.render(gridCommands, gridWorlds[gridOrder[i]]);
+                }
+            });
+            directX.submit(gridRecorder);
+        }
+
+        // 描画順による状態の切り替え数の変化とオーバードローの見積もり
+        auto &frameRenderStats = directX.getRenderStats();
+        if (frameRenderStats.isEnabled()) {
+            frameRenderStats.addQueue(drawQueue.getStats());
+            overdraw.clear();
+            for (auto &item : drawQueue.getItems()) {
+                switch (item.index) {
+                case DRAW_MODEL:
+                    estimateSphere(model.getWorldMatrix());
+                    break;
+                case DRAW_GIZMO:
+                    estimateSphere(lightGizmo.getWorldMatrix());
+                    break;
+                case DRAW_INSTANCED:
+                    for (auto &instanceWorld : gridWorlds) {
+                        estimateSphere(instanceWorld);
+                    }
+                    break;
+                case DRAW_STATIC:
+                    for (auto handle : staticHandles) {
+                        if (staticBatch.isVisible(handle)) {
+                            estimateBox(staticBatch.getBounds(handle).min, staticBatch.getBounds(handle).max);
+                        }
+                    }
+                    break;
+                default:
+                    estimateSphere(gridWorlds[item.index - DRAW_GRID]);
+                    break;
+                }
+            }
+            frameRenderStats.addOverdraw(overdraw);
+        }
 
         directX.endFrame();
+
+        // 更新・描画・Presentの時間と、続けて描画したフレームの間隔を記録する
+        auto renderEnd   = std::chrono::steady_clock::now();
+        auto presentTime = directX.getPresentTime();
+        frameStats.record(FrameStats::UPDATE, std::chrono::duration<float, std::milli>(renderBegin - updateBegin).count());
+        frameStats.record(FrameStats::RENDER, std::chrono::duration<float, std::milli>(renderEnd - renderBegin).count() - presentTime);
+        frameStats.record(FrameStats::PRESENT, presentTime);
+        if (presentedLast) {
+            frameStats.recordFrame(input.isReplaying() ? frameTime : deltaTime);
+        }
+        presentedLast = true;
     }
 
+    simulation.stop();
+    if (capture.isRunning()) {
+        stopCapture();
+    }
+
+    // 再生の結果(同じ記録を変更の前後で再生して比べる)
+    if (input.isReplaying()) {
+        auto runTime       = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - runBegin).count();
+        auto frameSummary  = frameStats.getTotalSummary(FrameStats::FRAME);
+        auto renderSummary = frameStats.getTotalSummary(FrameStats::RENDER);
+        snprintf(message, sizeof(message), "replay: %u/%u frames in %.1fms (presented: %llu) frame p50: %.3fms p99: %.3fms render p50: %.3fms p99: %.3fms\n",
+            input.getPosition(), input.getFrameCount(), runTime, static_cast<unsigned long long>(directX.getPresentedFrames()),
+            frameSummary.p50, frameSummary.p99, renderSummary.p50, renderSummary.p99);
+        OutputDebugStringA(message);
+        frameStats.writeJson("replay_stats.json");
+    }
+    input.stop();
     return 0;
 }
\ No newline at end of file
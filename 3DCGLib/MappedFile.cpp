@@ -0,0 +1,123 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Lib
+{
+    // コンストラクタ
+    MappedFile::MappedFile()
+        : mapped(nullptr), mappedSize(0)
+#ifdef _WIN32
+        , fileHandle(INVALID_HANDLE_VALUE), mappingHandle(nullptr)
+#else
+        , fd(-1)
+#endif
+    {
+    }
+
+    // デストラクタ
+    MappedFile::~MappedFile()
+    {
+        close();
+    }
+
+    // ファイルをマップする
+    bool MappedFile::open(const std::string &path)
+    {
+        close();
+
+#ifdef _WIN32
+        fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (fileHandle == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0) {
+            close();
+            return false;
+        }
+        mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mappingHandle == nullptr) {
+            close();
+            return false;
+        }
+        mapped = static_cast<const uint8_t*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+        if (mapped == nullptr) {
+            close();
+            return false;
+        }
+        mappedSize = static_cast<size_t>(fileSize.QuadPart);
+#else
+        fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0) {
+            close();
+            return false;
+        }
+        void *ptr = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (ptr == MAP_FAILED) {
+            close();
+            return false;
+        }
+        mapped     = static_cast<const uint8_t*>(ptr);
+        mappedSize = static_cast<size_t>(st.st_size);
+#endif
+        return true;
+    }
+
+    // マップを解除する
+    void MappedFile::close()
+    {
+#ifdef _WIN32
+        if (mapped != nullptr) {
+            UnmapViewOfFile(mapped);
+        }
+        if (mappingHandle != nullptr) {
+            CloseHandle(mappingHandle);
+        }
+        if (fileHandle != INVALID_HANDLE_VALUE) {
+            CloseHandle(fileHandle);
+        }
+        mappingHandle = nullptr;
+        fileHandle    = INVALID_HANDLE_VALUE;
+#else
+        if (mapped != nullptr) {
+            munmap(const_cast<uint8_t*>(mapped), mappedSize);
+        }
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        fd = -1;
+#endif
+        mapped     = nullptr;
+        mappedSize = 0;
+    }
+
+    bool MappedFile::isOpen() const
+    {
+        return mapped != nullptr;
+    }
+
+    const uint8_t *MappedFile::data() const
+    {
+        return mapped;
+    }
+
+    size_t MappedFile::size() const
+    {
+        return mappedSize;
+    }
+}
@@ -0,0 +1,42 @@
+#pragma once
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+namespace Lib
+{
+    // 読み込み専用のメモリマップドファイル
+    class MappedFile
+    {
+    public:
+        MappedFile();
+        ~MappedFile();
+
+        // ファイルをマップする(失敗時はfalse)
+        bool open(const std::string &path);
+        // マップを解除する
+        void close();
+
+        bool isOpen() const;
+        const uint8_t *data() const;
+        size_t size() const;
+
+    private:
+        // コピーの禁止
+        MappedFile(const MappedFile &) = delete;
+        MappedFile& operator=(const MappedFile &) = delete;
+
+        const uint8_t *mapped;
+        size_t         mappedSize;
+#ifdef _WIN32
+        void *fileHandle;
+        void *mappingHandle;
+#else
+        int fd;
+#endif
+    };
+}
+
+#endif
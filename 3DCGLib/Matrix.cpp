@@ -6,7 +6,7 @@ namespace Lib
     {
         *this = Matrix::Zero;
     }
-    // Rs[RXgN^
+    // コピーコンストラクタ
     Matrix::Matrix(const Matrix &other)
         :m11(other.m11), m12(other.m12), m13(other.m13), m14(other.m14),
          m21(other.m21), m22(other.m22), m23(other.m23), m24(other.m24),
@@ -14,7 +14,7 @@ namespace Lib
          m41(other.m41), m42(other.m42), m43(other.m43), m44(other.m44)
     {
     }
-    // RXgN^
+    // コンストラクタ
     Matrix::Matrix(
         const float& _m11, const float& _m12, const float& _m13, const float& _m14,
         const float& _m21, const float& _m22, const float& _m23, const float& _m24,
@@ -28,7 +28,7 @@ namespace Lib
     {
     }
 
-    // sړ
+    // 平行移動
     Matrix Matrix::translate(const Vector3& vec)
     {
         Matrix tmp = Matrix::Identify;
@@ -45,7 +45,7 @@ namespace Lib
         tmp.m43 = z;
         return tmp;
     }
-    // x]
+    // x軸回転
     Matrix Matrix::rotateX(const float angle)
     {
         Matrix tmp = Matrix::Identify;
@@ -55,7 +55,7 @@ namespace Lib
         tmp.m33 =  std::cos(angle);
         return tmp;
     }
-    // y]
+    // y軸回転
     Matrix Matrix::rotateY(const float angle)
     {
         Matrix tmp = Matrix::Identify;
@@ -65,7 +65,7 @@ namespace Lib
         tmp.m33 =  std::cos(angle);
         return tmp;
     }
-    // z]
+    // z軸回転
     Matrix Matrix::rotateZ(const float angle)
     {
         Matrix tmp = Matrix::Identify;
@@ -75,7 +75,7 @@ namespace Lib
         tmp.m22 =  std::cos(angle);
         return tmp;
     }
-    // gk
+    // 拡大縮小
     Matrix Matrix::scale(const float scale)
     {
         Matrix tmp = Matrix::Identify;
@@ -92,7 +92,7 @@ namespace Lib
         tmp.m33 = scaleZ;
         return tmp;
     }
-    // ]u
+    // 転置
     Matrix Matrix::transpose(const Matrix matrix)
     {
         return Matrix(
@@ -102,7 +102,7 @@ namespace Lib
             matrix.m14, matrix.m24, matrix.m34, matrix.m44
         );
     }
-    // Wnr[s̍쐬
+    // 左手座標系ビュー行列の作成
     Matrix Matrix::LookAtLH(const Vector3 &cameraPos, const Vector3 &cameraTarget, const Vector3 &cameraUpVec)
     {
         Vector3 zAxis = (cameraTarget - cameraPos).normalize();
@@ -116,7 +116,7 @@ namespace Lib
             -xAxis.dot(cameraPos), -yAxis.dot(cameraPos), -zAxis.dot(cameraPos), 1.0f
         );
     }
-    // Wnp[XyNeBuˉes쐬
+    // 左手座標系パースペクティブ射影行列を作成
     Matrix Matrix::perspectiveFovLH(float fieldOfViewY, float aspectRatio, float znearPlane, float zfarPlane)
     {
         float h = 1.0f / std::tan(fieldOfViewY / 2.0f);
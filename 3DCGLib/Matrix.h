@@ -8,7 +8,7 @@ namespace Lib
     class Matrix
     {
     public:
-// unioňx
+// unionの警告を消すため
 #pragma warning(disable:4201)
         union
         {
@@ -23,11 +23,11 @@ namespace Lib
             float mat16[16];
         };
 #pragma warning(default:4201)
-        // ftHgRXgN^
+        // デフォルトコンストラクタ
         Matrix();
-        // Rs[RXgN^
+        // コピーコンストラクタ
         Matrix(const Matrix &other);
-        // RXgN^
+        // コンストラクタ
         Matrix(
             const float& _m11, const float& _m12, const float& _m13, const float& _m14,
             const float& _m21, const float& _m22, const float& _m23, const float& _m24,
@@ -35,31 +35,31 @@ namespace Lib
             const float& _m41, const float& _m42, const float& _m43, const float& _m44
         );
 
-        // sړ
+        // 平行移動
         static Matrix translate(const Vector3& vec);
         static Matrix translate(const float x, const float y, const float z);
 
-        // x]
+        // x軸回転
         static Matrix rotateX(const float angle);
-        // y]
+        // y軸回転
         static Matrix rotateY(const float angle);
-        // z]
+        // z軸回転
         static Matrix rotateZ(const float angle);
 
-        // gk
+        // 拡大縮小
         static Matrix scale(const float scale);
         static Matrix scale(const float scaleX, const float scaleY, const float scaleZ);
 
-        // ]u
+        // 転置
         static Matrix transpose(const Matrix matrix);
 
-        // Wnr[s̍쐬
+        // 左手座標系ビュー行列の作成
         static Matrix LookAtLH(const Vector3 &cameraPos, const Vector3 &cameraTarget, const Vector3 &cameraUpVec);
 
-        // Wnp[XyNeBuˉes쐬
+        // 左手座標系パースペクティブ射影行列を作成
         static Matrix perspectiveFovLH(float fieldOfViewY, float aspectRatio, float znearPlane, float zfarPlane);
 
-        // ZqI[o[[h
+        // 演算子オーバーロード
         Matrix& operator+=(const Matrix& other)
         {
             return *this = *this + other;
@@ -80,6 +80,19 @@ namespace Lib
         {
             return *this = *this / other;
         }
+        bool operator==(const Matrix& other) const
+        {
+            for (int i = 0; i < 16; ++i) {
+                if (mat16[i] != other.mat16[i]) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        bool operator!=(const Matrix& other) const
+        {
+            return !(*this == other);
+        }
         Matrix operator+(const Matrix& other) const
         {
             return Matrix(
@@ -0,0 +1,216 @@
+#include <cstring>
+#include <fstream>
+#include "MeshCache.h"
+#include "Hash.h"
+
+namespace Lib
+{
+    namespace
+    {
+        // アライメントに切り上げる
+        uint64_t alignUp(const uint64_t value, const uint64_t alignment)
+        {
+            return (value + alignment - 1) / alignment * alignment;
+        }
+
+        // パディングを書き込む
+        void writePadding(std::ofstream &ofs, const uint64_t size)
+        {
+            static const char ZERO[MeshCache::BLOB_ALIGNMENT] = {};
+            ofs.write(ZERO, static_cast<std::streamsize>(size));
+        }
+    }
+
+    // コンストラクタ
+    MeshCache::MeshCache()
+        : header(nullptr)
+    {
+    }
+
+    // デストラクタ
+    MeshCache::~MeshCache()
+    {
+    }
+
+    // 書き出し(単一LOD)
+    bool MeshCache::write(const std::string &path, const MeshView &mesh)
+    {
+        return write(path, std::vector<MeshView>{ mesh });
+    }
+
+    // 書き出し
+    bool MeshCache::write(const std::string &path, const std::vector<MeshView> &lods)
+    {
+        if (lods.empty() || lods.size() > MeshCacheHeader::MAX_LOD) {
+            return false;
+        }
+
+        // 全LODが16bitで収まる場合のみ16bitで格納する
+        auto indexFormat = IndexFormat::UInt16;
+        for (auto &lod : lods) {
+            if (lod.indexFormat == IndexFormat::UInt32) {
+                indexFormat = IndexFormat::UInt32;
+            }
+        }
+        const uint32_t indexStride = indexFormat == IndexFormat::UInt16 ? 2 : 4;
+
+        MeshCacheHeader header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, "LMSH", 4);
+        header.version      = VERSION;
+        header.headerSize   = sizeof(MeshCacheHeader);
+        header.vertexStride = sizeof(SimpleVertex);
+        header.vertexLayout = LAYOUT_POSITION | LAYOUT_NORMAL;
+        header.indexFormat  = static_cast<uint32_t>(indexFormat);
+        header.lodCount     = static_cast<uint32_t>(lods.size());
+
+        // 頂点・インデックスを連結する(LODごとにbaseVertexで参照)
+        std::vector<SimpleVertex> vertices;
+        std::vector<uint8_t>      indices;
+        for (uint32_t i = 0; i < header.lodCount; ++i) {
+            auto &lod   = lods[i];
+            auto &entry = header.lods[i];
+            entry.indexOffset = header.indexCount;
+            entry.indexCount  = lod.indexCount;
+            entry.baseVertex  = header.vertexCount;
+            entry.vertexCount = lod.vertexCount;
+
+            vertices.insert(vertices.end(), lod.vertices, lod.vertices + lod.vertexCount);
+            if (lod.indexFormat == indexFormat) {
+                auto src = static_cast<const uint8_t*>(lod.indices);
+                indices.insert(indices.end(), src, src + lod.indexCount * indexStride);
+            }
+            else {
+                // 16bit -> 32bitへの拡張
+                auto src = static_cast<const uint16_t*>(lod.indices);
+                for (uint32_t k = 0; k < lod.indexCount; ++k) {
+                    uint32_t index = src[k];
+                    auto bytes = reinterpret_cast<const uint8_t*>(&index);
+                    indices.insert(indices.end(), bytes, bytes + sizeof(index));
+                }
+            }
+
+            header.vertexCount += lod.vertexCount;
+            header.indexCount  += lod.indexCount;
+        }
+
+        // バウンディングボックスは最も詳細なLODから求める
+        MeshData::computeBounds(lods[0], header.boundsMin, header.boundsMax);
+
+        header.vertexBytes  = vertices.size() * sizeof(SimpleVertex);
+        header.indexBytes   = indices.size();
+        header.vertexOffset = alignUp(sizeof(MeshCacheHeader), BLOB_ALIGNMENT);
+        header.indexOffset  = alignUp(header.vertexOffset + header.vertexBytes, BLOB_ALIGNMENT);
+        header.checksum     = computeChecksum(vertices.data(), header.vertexBytes, indices.data(), header.indexBytes);
+
+        std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+        if (!ofs) {
+            return false;
+        }
+        ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        writePadding(ofs, header.vertexOffset - sizeof(header));
+        ofs.write(reinterpret_cast<const char*>(vertices.data()), static_cast<std::streamsize>(header.vertexBytes));
+        writePadding(ofs, header.indexOffset - (header.vertexOffset + header.vertexBytes));
+        ofs.write(reinterpret_cast<const char*>(indices.data()), static_cast<std::streamsize>(header.indexBytes));
+
+        return static_cast<bool>(ofs);
+    }
+
+    // 読み込み
+    bool MeshCache::open(const std::string &path, const bool verifyChecksum)
+    {
+        close();
+        if (!file.open(path)) {
+            return false;
+        }
+
+        // ヘッダーの検証
+        auto size = static_cast<uint64_t>(file.size());
+        if (size < sizeof(MeshCacheHeader)) {
+            close();
+            return false;
+        }
+        // ※ブロブの範囲は壊れたヘッダーで加算があふれないよう、位置を確かめてから残りの大きさと比べる
+        auto h = reinterpret_cast<const MeshCacheHeader*>(file.data());
+        if (std::memcmp(h->magic, "LMSH", 4) != 0 ||
+            h->version != VERSION ||
+            h->headerSize != sizeof(MeshCacheHeader) ||
+            h->vertexStride != sizeof(SimpleVertex) ||
+            (h->indexFormat != 16 && h->indexFormat != 32) ||
+            h->lodCount == 0 || h->lodCount > MeshCacheHeader::MAX_LOD ||
+            h->vertexOffset % BLOB_ALIGNMENT != 0 || h->indexOffset % BLOB_ALIGNMENT != 0 ||
+            h->vertexOffset > size || h->vertexBytes > size - h->vertexOffset ||
+            h->indexOffset > size || h->indexBytes > size - h->indexOffset ||
+            h->vertexBytes != static_cast<uint64_t>(h->vertexCount) * h->vertexStride ||
+            h->indexBytes  != static_cast<uint64_t>(h->indexCount) * (h->indexFormat / 8)) {
+            close();
+            return false;
+        }
+        for (uint32_t i = 0; i < h->lodCount; ++i) {
+            auto &lod = h->lods[i];
+            if (static_cast<uint64_t>(lod.indexOffset) + lod.indexCount > h->indexCount ||
+                static_cast<uint64_t>(lod.baseVertex) + lod.vertexCount > h->vertexCount) {
+                close();
+                return false;
+            }
+        }
+
+        // チェックサムの検証(全ページに触れるため任意)
+        if (verifyChecksum) {
+            auto checksum = computeChecksum(file.data() + h->vertexOffset, h->vertexBytes, file.data() + h->indexOffset, h->indexBytes);
+            if (checksum != h->checksum) {
+                close();
+                return false;
+            }
+        }
+
+        header = h;
+        return true;
+    }
+
+    // 解放
+    void MeshCache::close()
+    {
+        file.close();
+        header = nullptr;
+    }
+
+    bool MeshCache::isOpen() const
+    {
+        return header != nullptr;
+    }
+
+    const MeshCacheHeader &MeshCache::getHeader() const
+    {
+        return *header;
+    }
+
+    uint32_t MeshCache::getLodCount() const
+    {
+        return header != nullptr ? header->lodCount : 0;
+    }
+
+    // 指定LODの参照
+    MeshView MeshCache::getLod(const uint32_t lod) const
+    {
+        MeshView mesh = {};
+        if (header == nullptr || lod >= header->lodCount) {
+            return mesh;
+        }
+        auto &entry       = header->lods[lod];
+        auto  indexStride = header->indexFormat / 8;
+        mesh.vertices    = reinterpret_cast<const SimpleVertex*>(file.data() + header->vertexOffset) + entry.baseVertex;
+        mesh.vertexCount = entry.vertexCount;
+        mesh.indices     = file.data() + header->indexOffset + static_cast<uint64_t>(entry.indexOffset) * indexStride;
+        mesh.indexCount  = entry.indexCount;
+        mesh.indexFormat = static_cast<IndexFormat>(header->indexFormat);
+        return mesh;
+    }
+
+    // チェックサムの計算
+    uint64_t MeshCache::computeChecksum(const void *vertices, const uint64_t vertexBytes, const void *indices, const uint64_t indexBytes)
+    {
+        auto hash = Hash::fnv1a(vertices, static_cast<size_t>(vertexBytes));
+        return Hash::fnv1a(indices, static_cast<size_t>(indexBytes), hash);
+    }
+}
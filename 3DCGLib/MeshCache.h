@@ -0,0 +1,82 @@
+#pragma once
+#ifndef MESHCACHE_H
+#define MESHCACHE_H
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "MeshData.h"
+#include "MappedFile.h"
+
+namespace Lib
+{
+    // LODテーブルの要素
+    struct MeshCacheLod
+    {
+        uint32_t indexOffset; // インデックスブロブ内の開始位置(要素数)
+        uint32_t indexCount;
+        uint32_t baseVertex;  // 頂点ブロブ内の開始位置(要素数)
+        uint32_t vertexCount;
+    };
+
+    // ファイルヘッダー(ファイル先頭にそのまま配置される)
+    struct MeshCacheHeader
+    {
+        static const uint32_t MAX_LOD = 8;
+
+        char         magic[4];     // "LMSH"
+        uint32_t     version;
+        uint32_t     headerSize;
+        uint32_t     vertexStride;
+        uint32_t     vertexLayout; // MeshCache::LAYOUT_*の組み合わせ
+        uint32_t     indexFormat;  // 16 or 32
+        uint32_t     vertexCount;
+        uint32_t     indexCount;
+        float        boundsMin[3];
+        float        boundsMax[3];
+        uint32_t     lodCount;
+        uint32_t     reserved;
+        MeshCacheLod lods[MAX_LOD];
+        uint64_t     vertexOffset; // ファイル先頭からのバイト位置
+        uint64_t     vertexBytes;
+        uint64_t     indexOffset;
+        uint64_t     indexBytes;
+        uint64_t     checksum;     // 頂点・インデックスブロブのFNV-1a
+    };
+
+    // バイナリメッシュキャッシュ
+    class MeshCache
+    {
+    public:
+        static const uint32_t VERSION        = 1;
+        static const uint32_t BLOB_ALIGNMENT = 64;
+        static const uint32_t LAYOUT_POSITION = 1 << 0;
+        static const uint32_t LAYOUT_NORMAL   = 1 << 1;
+
+        MeshCache();
+        ~MeshCache();
+
+        // 書き出し(lods[0]が最も詳細なLOD)
+        static bool write(const std::string &path, const std::vector<MeshView> &lods);
+        static bool write(const std::string &path, const MeshView &mesh);
+
+        // 読み込み(ヘッダーの検証のみ行い、データはマップしたまま参照する)
+        bool open(const std::string &path, const bool verifyChecksum = false);
+        void close();
+
+        bool isOpen() const;
+        const MeshCacheHeader &getHeader() const;
+        uint32_t getLodCount() const;
+
+        // 指定LODの参照(マップされたメモリを直接指す)
+        MeshView getLod(const uint32_t lod) const;
+
+        // ブロブのチェックサムを計算する
+        static uint64_t computeChecksum(const void *vertices, const uint64_t vertexBytes, const void *indices, const uint64_t indexBytes);
+
+    private:
+        MappedFile             file;
+        const MeshCacheHeader *header;
+    };
+}
+
+#endif
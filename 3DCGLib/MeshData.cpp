@@ -0,0 +1,130 @@
+#include <algorithm>
+#include <cmath>
+#include <cfloat>
+#include "MeshData.h"
+#include "PrimitiveTables.h"
+#include "Profiler.h"
+#include "MyMath.h"
+
+namespace Lib
+{
+    // 参照の作成
+    MeshView MeshData::view() const
+    {
+        MeshView mesh;
+        mesh.vertices    = vertices.data();
+        mesh.vertexCount = static_cast<uint32_t>(vertices.size());
+        if (!indices32.empty()) {
+            mesh.indices     = indices32.data();
+            mesh.indexCount  = static_cast<uint32_t>(indices32.size());
+            mesh.indexFormat = IndexFormat::UInt32;
+        }
+        else {
+            mesh.indices     = indices16.data();
+            mesh.indexCount  = static_cast<uint32_t>(indices16.size());
+            mesh.indexFormat = IndexFormat::UInt16;
+        }
+        return mesh;
+    }
+
+    // インデックス数
+    uint32_t MeshData::indexCount() const
+    {
+        return static_cast<uint32_t>(indices32.empty() ? indices16.size() : indices32.size());
+    }
+
+    // AABBの計算
+    void MeshData::computeBounds(const MeshView &mesh, float boundsMin[3], float boundsMax[3])
+    {
+        for (int k = 0; k < 3; ++k) {
+            boundsMin[k] =  FLT_MAX;
+            boundsMax[k] = -FLT_MAX;
+        }
+        for (uint32_t i = 0; i < mesh.vertexCount; ++i) {
+            for (int k = 0; k < 3; ++k) {
+                boundsMin[k] = std::min(boundsMin[k], mesh.vertices[i].pos[k]);
+                boundsMax[k] = std::max(boundsMax[k], mesh.vertices[i].pos[k]);
+            }
+        }
+        if (mesh.vertexCount == 0) {
+            for (int k = 0; k < 3; ++k) {
+                boundsMin[k] = boundsMax[k] = 0.0f;
+            }
+        }
+    }
+
+    // 立方体の作成
+    MeshData MeshData::createCube()
+    {
+        PROFILE_SCOPE("MeshData::createCube");
+        // 頂点・インデックスは静的テーブルからコピーする
+        auto table = PrimitiveTables::cube();
+        MeshData mesh;
+        mesh.vertices.assign(table.vertices, table.vertices + table.vertexCount);
+        auto indices = static_cast<const uint16_t*>(table.indices);
+        mesh.indices16.assign(indices, indices + table.indexCount);
+
+        return mesh;
+    }
+
+    // 球体の作成
+    MeshData MeshData::createSphere(const int SEGMENT)
+    {
+        PROFILE_SCOPE("MeshData::createSphere");
+        MeshData mesh;
+
+        // 頂点の作成
+        const int COUNT = (SEGMENT + 1) * (SEGMENT / 2 + 1);
+        mesh.vertices.resize(COUNT);
+        auto &vertices = mesh.vertices;
+
+        for (int i = 0; i <= (SEGMENT / 2); ++i) {
+            float irad = MyMath::PI * 2.0f / static_cast<float>(SEGMENT) * static_cast<float>(i);
+            float y = static_cast<float>(std::cos(irad));
+            float r = static_cast<float>(std::sin(irad));
+            for (int j = 0; j <= SEGMENT; ++j) {
+                float jrad = MyMath::PI * 2.0f / static_cast<float>(SEGMENT) * static_cast<float>(j);
+                float x = r * static_cast<float>(std::cos(jrad));
+                float z = r * static_cast<float>(std::sin(jrad));
+                int   inx = i * (SEGMENT + 1) + j;
+                vertices[inx].pos[0] = x;
+                vertices[inx].pos[1] = y;
+                vertices[inx].pos[2] = z;
+                vertices[inx].normal[0] = x;
+                vertices[inx].normal[1] = y;
+                vertices[inx].normal[2] = z;
+            }
+        }
+
+        // インデックスの作成
+        const int COUNT2 = SEGMENT * 3 + SEGMENT * (SEGMENT / 2 - 1) * 6;
+        mesh.indices16.resize(COUNT2);
+        auto &indices = mesh.indices16;
+
+        int count = 0;
+        int i = 0;
+        for (int j = 0; j < SEGMENT; ++j) {
+            indices[count]     = static_cast<uint16_t>(i * (SEGMENT + 1) + j);
+            indices[count + 1] = static_cast<uint16_t>((i + 1) * (SEGMENT + 1) + j + 1);
+            indices[count + 2] = static_cast<uint16_t>((i + 1) * (SEGMENT + 1) + j);
+            count += 3;
+        }
+        for (i = 1; i < SEGMENT / 2; ++i) {
+            for (int j = 0; j < SEGMENT; ++j) {
+                indices[count]     = static_cast<uint16_t>(i * (SEGMENT + 1) + j);
+                indices[count + 1] = static_cast<uint16_t>(i * (SEGMENT + 1) + j + 1);
+                indices[count + 2] = static_cast<uint16_t>((i + 1) * (SEGMENT + 1) + j);
+                count += 3;
+                indices[count]     = static_cast<uint16_t>(i * (SEGMENT + 1) + j + 1);
+                indices[count + 1] = static_cast<uint16_t>((i + 1) * (SEGMENT + 1) + j + 1);
+                indices[count + 2] = static_cast<uint16_t>((i + 1) * (SEGMENT + 1) + j);
+                count += 3;
+            }
+        }
+        // ※最下段(i = SEGMENT / 2)は上のループで既に閉じているため、
+        //   範囲外の頂点を参照する三角形は作らない
+        indices.resize(count);
+
+        return mesh;
+    }
+}
@@ -0,0 +1,63 @@
+#pragma once
+#ifndef MESHDATA_H
+#define MESHDATA_H
+#include <cstdint>
+#include <vector>
+
+namespace Lib
+{
+    // 頂点フォーマット(POSITION + NORMAL)
+    struct SimpleVertex
+    {
+        float pos[3];
+        float normal[3];
+    };
+
+    // インデックスのビット幅
+    enum class IndexFormat : uint32_t
+    {
+        UInt16 = 16,
+        UInt32 = 32,
+    };
+
+    // メッシュの参照(メモリは所有しない)
+    struct MeshView
+    {
+        const SimpleVertex *vertices;
+        uint32_t            vertexCount;
+        const void         *indices;
+        uint32_t            indexCount;
+        IndexFormat         indexFormat;
+
+        // インデックス1つ分のバイト数
+        uint32_t indexStride() const
+        {
+            return indexFormat == IndexFormat::UInt16 ? 2 : 4;
+        }
+    };
+
+    // CPU側のメッシュデータ
+    class MeshData
+    {
+    public:
+        std::vector<SimpleVertex> vertices;
+        std::vector<uint16_t>     indices16;
+        std::vector<uint32_t>     indices32;
+
+        // 参照の作成
+        MeshView view() const;
+
+        // インデックス数
+        uint32_t indexCount() const;
+
+        // AABBの計算
+        static void computeBounds(const MeshView &mesh, float boundsMin[3], float boundsMax[3]);
+
+        // 立方体の作成
+        static MeshData createCube();
+        // 球体の作成
+        static MeshData createSphere(const int SEGMENT);
+    };
+}
+
+#endif
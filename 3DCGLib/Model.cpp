@@ -1,476 +1,463 @@
 #include <d3dcompiler.h>
-#include <vector>
+#include <filesystem>
+#include <string>
 #include "Model.h"
+#include "MeshCache.h"
+#include "ObjLoader.h"
 #include "MyMath.h"
+#include "PrimitiveTables.h"
+#include "Profiler.h"
+#include "Hash.h"
+#include "RenderQueue.h"
 
 namespace Lib
 {
-    // RXgN^
+    namespace
+    {
+        // 共有リソースのキー
+        const uint64_t MESH_CUBE   = Hash::fnv1a("cube",   4);
+        const uint64_t MESH_SPHERE = Hash::fnv1a("sphere", 6);
+        const uint64_t CB_OBJECT   = Hash::fnv1a("ObjectConstants", 15);
+        const uint64_t CB_MATERIAL = Hash::fnv1a("MaterialConstants", 17);
+        const uint64_t MESH_FILE   = Hash::fnv1a("file",   4);
+
+        // 実行時に生成したメッシュのキャッシュの保存先(実行ディレクトリ)
+        const char MESH_CACHE_DIRECTORY[] = "MeshCache";
+
+        // 既定のマテリアル
+        const Color DEFAULT_MATERIAL(0.6f, 0.8f, 0.4f, 0.0f);
+    }
+
+    // コンストラクタ
     Model::Model()
     {
         world = Matrix::Identify;
-        light = Vector3(-2.0, 2.0, -1.0);
         vertexCount = 0;
+        indexFormat = IndexFormat::UInt16;
         init();
     }
 
-    // RXgN^íj
+    // コンストラクタ（球体）
     Model::Model(const int SEGMENT)
     {
         world = Matrix::Identify;
-        light = Vector3(-2.0, 2.0, -1.0);
         vertexCount = 0;
+        indexFormat = IndexFormat::UInt16;
         initSqhere(SEGMENT);
     }
 
-    // fXgN^
+    // コンストラクタ（メッシュ）
+    Model::Model(const MeshView &mesh)
+    {
+        world = Matrix::Identify;
+        vertexCount = 0;
+        indexFormat = IndexFormat::UInt16;
+        initMesh(makeMeshKey(mesh), mesh);
+    }
+
+    // コンストラクタ（メッシュファイル）
+    Model::Model(const std::string &path)
+    {
+        world = Matrix::Identify;
+        vertexCount = 0;
+        indexFormat = IndexFormat::UInt16;
+        initFile(path);
+    }
+
+    // デストラクタ
     Model::~Model()
     {
     }
 
-    // f̕`
+    // モデルの描画
     void Model::render(Color &color)
     {
         auto &directX = DirectX11::getInstance();
+        directX.updateFrameConstants();
+        render(directX.getCommandList());
+    }
 
-        float lightPos[4]         = {  light.x, light.y, light.z,  0.0f };
-        float lightDiffuse[4]     = {  1.0f, 1.0f,  1.0f,  0.0f };
-        float lightAttenuate[4]   = {  1.0f, 0.1f,  0.1f,  0.0f };
-        float lightAmbient[4]     = {  0.2f, 0.2f,  0.2f,  0.0f };
-        float materialDiffuse[4]  = {  0.6f, 0.8f,  0.4f,  0.0f };
-        float materialAmbient[4]  = {  0.6f, 0.8f,  0.4f,  0.0f };
-
-        // RX^gobt@̐ݒ
-        ConstantBufferMatrix cbm;
-        cbm.world           = Matrix::transpose(world);
-        cbm.view            = Matrix::transpose(directX.getViewMatrix());
-        cbm.projection      = Matrix::transpose(directX.getProjectionMatrix());
-        directX.getDeviceContext()->UpdateSubresource(constantBufferMatrix.Get(), 0, nullptr, &cbm, 0, 0);
-
-        float eye[4] = { -directX.getViewMatrix().m41, -directX.getViewMatrix().m42, -directX.getViewMatrix().m43, 1.0f };
-        ConstantBufferLight cbl;
-        memcpy(cbl.eyePos,               eye,              sizeof(eye));
-        memcpy(cbl.ambient,              lightAmbient,     sizeof(lightAmbient));
-        memcpy(cbl.pointLight.pos,       lightPos,         sizeof(lightPos));
-        memcpy(cbl.pointLight.diffuse,   lightDiffuse,     sizeof(lightDiffuse));
-        memcpy(cbl.pointLight.attenuate, lightAttenuate,   sizeof(lightAttenuate));
-        memcpy(cbl.material.ambient,     materialAmbient,  sizeof(materialAmbient));
-        memcpy(cbl.material.diffuse,     materialDiffuse,  sizeof(materialDiffuse));
-        directX.getDeviceContext()->UpdateSubresource(constantBufferLight.Get(), 0, nullptr, &cbl, 0, 0);
-
-        directX.getDeviceContext()->VSSetShader(vertexShader.Get(), nullptr, 0);
-        directX.getDeviceContext()->VSSetConstantBuffers(0, 1, constantBufferMatrix.GetAddressOf());
-        directX.getDeviceContext()->PSSetShader(pixelShader.Get(), nullptr, 0);
-        directX.getDeviceContext()->PSSetConstantBuffers(0, 1, constantBufferLight.GetAddressOf());
-        directX.getDeviceContext()->DrawIndexed(vertexCount, 0, 0);
-
-        // Cgpf
-        auto mtLight  = Matrix::Identify;
-        auto mttLight = Matrix::translate(Vector3(lightPos[0], lightPos[1], lightPos[2]));
-        auto mtsLight = Matrix::scale(0.1f, 0.1f, 0.1f);
-        mtLight = mtsLight * mttLight;
-       
-        cbm.world      = Matrix::transpose(mtLight);
-        directX.getDeviceContext()->UpdateSubresource(constantBufferMatrix.Get(), 0, nullptr, &cbm, 0, 0);
-
-        directX.getDeviceContext()->VSSetShader(vertexShader.Get(), nullptr, 0);
-        directX.getDeviceContext()->VSSetConstantBuffers(0, 1, constantBufferMatrix.GetAddressOf());
-        directX.getDeviceContext()->PSSetShader(pixelShader.Get(), nullptr, 0);
-        directX.getDeviceContext()->DrawIndexed(vertexCount, 0, 0);
+    // モデルの描画コマンドの記録
+    void Model::render(CommandList &commands) const
+    {
+        render(commands, world);
     }
 
-    // [hsݒ
+    // ワールド行列を指定した描画コマンドの記録
+    void Model::render(CommandList &commands, const Matrix &_world) const
+    {
+        PROFILE_SCOPE("Model::render");
+        auto &directX = DirectX11::getInstance();
+
+        // 共有リソースの実体
+        auto vs         = vertexShader.get();
+        auto ps         = pixelShader.get();
+        auto layout     = vertexLayout.get();
+        auto vb         = vertexBuffer.get();
+        auto ib         = indexBuffer.get();
+        auto cbFrame    = directX.getFrameConstantBuffer();
+        auto cbMaterial = materialConstantBuffer.get();
+
+        // オブジェクト定数の更新(ビュー・射影・ライトはフレーム定数で1回だけ転送される)
+        setObjectConstants(commands, _world);
+
+        // 頂点・インデックスバッファをセット(設定済みの状態は記録時に省かれる)
+        commands.setInputLayout(layout);
+        commands.setVertexBuffer(vb, sizeof(SimpleVertex));
+        commands.setIndexBuffer(ib, indexFormat);
+        commands.setPrimitiveTopology(PrimitiveTopology::TriangleList);
+
+        commands.setVertexShader(vs);
+        commands.setVSConstantBuffer(0, cbFrame);
+        commands.setPixelShader(ps);
+        commands.setPSConstantBuffer(0, cbFrame);
+        commands.setPSConstantBuffer(1, cbMaterial);
+        commands.drawIndexed(vertexCount);
+    }
+
+    // 静的バッチの描画コマンドの記録
+    void Model::renderStatic(CommandList &commands, StaticBatcher &batcher) const
+    {
+        PROFILE_SCOPE("Model::renderStatic");
+        auto &directX = DirectX11::getInstance();
+        auto  cbFrame = directX.getFrameConstantBuffer();
+
+        commands.setInputLayout(vertexLayout.get());
+        commands.setPrimitiveTopology(PrimitiveTopology::TriangleList);
+        commands.setVertexShader(vertexShader.get());
+        commands.setVSConstantBuffer(0, cbFrame);
+        setObjectConstants(commands, Matrix::Identify);
+        commands.setPixelShader(pixelShader.get());
+        commands.setPSConstantBuffer(0, cbFrame);
+        commands.setPSConstantBuffer(1, materialConstantBuffer.get());
+
+        batcher.record(commands);
+    }
+
+    // オブジェクト定数の転送と設定
+    // ※転送用リングに直接書き込めればUpdateSubresourceのコピーを省ける
+    void Model::setObjectConstants(CommandList &commands, const Matrix &_world) const
+    {
+        auto &directX   = DirectX11::getInstance();
+        auto allocation = directX.allocateUpload(sizeof(ObjectConstants));
+        if (allocation) {
+            reinterpret_cast<ObjectConstants*>(allocation.data)->world = Matrix::transpose(_world);
+            commands.setVSConstantBuffer(2, directX.getUploadBuffer(), allocation.offset, allocation.size);
+            return;
+        }
+
+        ObjectConstants cbo;
+        cbo.world = Matrix::transpose(_world);
+        commands.updateBuffer(objectConstantBuffer.get(), &cbo, sizeof(cbo));
+        commands.setVSConstantBuffer(2, objectConstantBuffer.get());
+    }
+
+    // ワールド行列を設定
     void Model::setWorldMatrix(Matrix & _world)
     {
-        world = _world;
+        if (world != _world) {
+            world = _world;
+            DirectX11::getInstance().markSceneChanged();
+        }
     }
 
-    // [hs擾
+    // ワールド行列を取得
     Matrix Model::getWorldMatrix() const
     {
         return world;
     }
 
-    Vector3& Model::getLightPos()
+    // マテリアルを設定
+    void Model::setMaterial(const Color & ambient, const Color & diffuse)
     {
-        return light;
+        initMaterial(ambient, diffuse);
+        DirectX11::getInstance().markSceneChanged();
     }
 
-    // 
+    // インスタンス描画で使うメッシュ
+    InstanceBatch::Mesh Model::getInstanceMesh() const
+    {
+        return InstanceBatch::Mesh{ vertexBuffer.get(), indexBuffer.get(), indexFormat, static_cast<uint32_t>(vertexCount), sizeof(SimpleVertex) };
+    }
+
+    // 描画順のソートキー
+    // ※シェーダー・マテリアル・メッシュはレジストリのスロット番号で区別する
+    uint64_t Model::getSortKey(const Matrix &view, const float farZ) const
+    {
+        return getSortKey(view, farZ, world);
+    }
+
+    // ワールド行列を指定したソートキー
+    uint64_t Model::getSortKey(const Matrix &view, const float farZ, const Matrix &_world) const
+    {
+        float viewZ = _world.m41 * view.m13 + _world.m42 * view.m23 + _world.m43 * view.m33 + view.m43;
+        return RenderQueue::makeOpaqueKey(vertexShader.getHandle().index, materialConstantBuffer.getHandle().index, vertexBuffer.getHandle().index, viewZ / farZ);
+    }
+
+    // 静的バッチのソートキー(頂点はワールド座標なので、メッシュの代わりに0を使う)
+    uint64_t Model::getSortKey(const Matrix &view, const float farZ, const StaticBatcher::Bounds &bounds) const
+    {
+        float viewZ = RenderQueue::nearestViewDepth(view, bounds.min, bounds.max);
+        return RenderQueue::makeOpaqueKey(vertexShader.getHandle().index, materialConstantBuffer.getHandle().index, 0, viewZ / farZ);
+    }
+
+    // 初期化
     HRESULT Model::init()
     {
-        auto &directX = DirectX11::getInstance();
-        auto hr = S_OK;
+        return initMesh(MESH_CUBE, PrimitiveTables::cube());
+    }
 
-        // VertexShader̓ǂݍ
-        auto VSBlob = shaderCompile(L"VertexShader.hlsl", "VS", "vs_4_0");
-        if (VSBlob == nullptr) {
-            MessageBox(nullptr, L"shaderCompile()̎s(VS)", L"Error", MB_OK);
-            return hr;
+    // 初期化（球体）
+    HRESULT Model::initSqhere(const int SEGMENT)
+    {
+        PROFILE_SCOPE("Model::initSqhere");
+        // 同じ分割数の球体が登録済みなら頂点の生成も省く
+        auto meshKey = Hash::combine(MESH_SPHERE, static_cast<uint64_t>(SEGMENT));
+        if (findMeshBuffers(meshKey)) {
+            return initShaders();
         }
 
-        // VertexShader̍쐬
-        hr = directX.getDevice()->CreateVertexShader(VSBlob->GetBufferPointer(), VSBlob->GetBufferSize(), nullptr, vertexShader.GetAddressOf());
-        if (FAILED(hr)) {
-            MessageBox(nullptr, L"VSRpCs", L"Error", MB_OK);
-            return hr;
+        // 分割数が既定値ならコンパイル時に生成済みのテーブルを使う
+        MeshView table;
+        if (PrimitiveTables::sphere(SEGMENT, table)) {
+            return initMesh(meshKey, table);
         }
 
-        // InputLayou̒`
-        D3D11_INPUT_ELEMENT_DESC layout[] = {
-            { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0,  0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-            {   "NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 12, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-        };
-        UINT numElements = ARRAYSIZE(layout);
+        // それ以外は前回生成した頂点をキャッシュから読み込む
+        std::error_code ec;
+        std::filesystem::create_directories(MESH_CACHE_DIRECTORY, ec);
+        auto cachePath = (std::filesystem::path(MESH_CACHE_DIRECTORY) / ("sphere_" + std::to_string(SEGMENT) + ".lmsh")).string();
+        return initCachedMesh(meshKey, cachePath, [SEGMENT](MeshData &mesh) {
+            mesh = MeshData::createSphere(SEGMENT);
+            return true;
+        });
+    }
 
-        // InputLayout̍쐬
-        hr = directX.getDevice()->CreateInputLayout(layout, numElements, VSBlob->GetBufferPointer(), VSBlob->GetBufferSize(), vertexLayout.GetAddressOf());
-        if (FAILED(hr)) {
-            MessageBox(nullptr, L"CreateInputLayout̎s : ", L"Error", MB_OK);
-            return hr;
+    // 初期化（メッシュファイル）
+    HRESULT Model::initFile(const std::string &path)
+    {
+        PROFILE_SCOPE("Model::initFile");
+        auto meshKey = Hash::fnv1a(path.data(), path.size(), MESH_FILE);
+        auto extension = std::filesystem::path(path).extension().string();
+        if (extension == ".lmsh") {
+            return initCachedMesh(meshKey, path, nullptr);
         }
 
-        // InputLayoutZbg
-        directX.getDeviceContext()->IASetInputLayout(vertexLayout.Get());
-
-        // PixelShader̓ǂݍ
-        auto PSBlob = shaderCompile(L"PixelShader.hlsl", "PS", "ps_4_0");
-        if (PSBlob == nullptr) {
-            MessageBox(nullptr, L"shaderCompile()̎s(PS)", L"Error", MB_OK);
-            return hr;
+        // OBJの方が新しければ書き出し直す
+        auto cachePath = path + ".lmsh";
+        std::error_code ec;
+        auto sourceTime = std::filesystem::last_write_time(path, ec);
+        if (!ec) {
+            auto cacheTime = std::filesystem::last_write_time(cachePath, ec);
+            if (!ec && cacheTime < sourceTime) {
+                std::filesystem::remove(cachePath, ec);
+            }
         }
+        return initCachedMesh(meshKey, cachePath, [&path](MeshData &mesh) {
+            return ObjLoader::load(path, mesh);
+        });
+    }
 
-        // VertexShader̍쐬
-        hr = directX.getDevice()->CreatePixelShader(PSBlob->GetBufferPointer(), PSBlob->GetBufferSize(), nullptr, pixelShader.GetAddressOf());
+    // 初期化（メッシュキャッシュ）
+    // ※キャッシュはマップしたメモリをそのまま頂点・インデックスバッファの初期値に渡し、作成後に閉じる
+    HRESULT Model::initCachedMesh(const uint64_t meshKey, const std::string &cachePath, const std::function<bool(MeshData &mesh)> &generate)
+    {
+        auto hr = initShaders();
         if (FAILED(hr)) {
-            MessageBox(nullptr, L"createPixelShader()̎s", L"Error", MB_OK);
             return hr;
         }
-
-        // VertexBuffer̒`
-        SimpleVertex vertices[] =
-        {
-            { { -1.0f,  1.0f, -1.0f }, {  0.0f,  1.0f,  0.0f} },
-            { {  1.0f,  1.0f, -1.0f }, {  0.0f,  1.0f,  0.0f} },
-            { {  1.0f,  1.0f,  1.0f }, {  0.0f,  1.0f,  0.0f} },
-            { { -1.0f,  1.0f,  1.0f }, {  0.0f,  1.0f,  0.0f} },
-
-            { { -1.0f, -1.0f, -1.0f }, {  0.0f, -1.0f,  0.0f} },
-            { {  1.0f, -1.0f, -1.0f }, {  0.0f, -1.0f,  0.0f} },
-            { {  1.0f, -1.0f,  1.0f }, {  0.0f, -1.0f,  0.0f} },
-            { { -1.0f, -1.0f,  1.0f }, {  0.0f, -1.0f,  0.0f} },
-
-            { { -1.0f, -1.0f,  1.0f }, { -1.0f,  0.0f,  0.0f} },
-            { { -1.0f, -1.0f, -1.0f }, { -1.0f,  0.0f,  0.0f} },
-            { { -1.0f,  1.0f, -1.0f }, { -1.0f,  0.0f,  0.0f} },
-            { { -1.0f,  1.0f,  1.0f }, { -1.0f,  0.0f,  0.0f} },
-
-            { {  1.0f, -1.0f,  1.0f }, {  1.0f,  0.0f,  0.0f} },
-            { {  1.0f, -1.0f, -1.0f }, {  1.0f,  0.0f,  0.0f} },
-            { {  1.0f,  1.0f, -1.0f }, {  1.0f,  0.0f,  0.0f} },
-            { {  1.0f,  1.0f,  1.0f }, {  1.0f,  0.0f,  0.0f} },
-
-            { { -1.0f, -1.0f, -1.0f }, {  0.0f,  0.0f, -1.0f} },
-            { {  1.0f, -1.0f, -1.0f }, {  0.0f,  0.0f, -1.0f} },
-            { {  1.0f,  1.0f, -1.0f }, {  0.0f,  0.0f, -1.0f} },
-            { { -1.0f,  1.0f, -1.0f }, {  0.0f,  0.0f, -1.0f} },
-
-            { { -1.0f, -1.0f,  1.0f }, {  0.0f,  0.0f,  1.0f} },
-            { {  1.0f, -1.0f,  1.0f }, {  0.0f,  0.0f,  1.0f} },
-            { {  1.0f,  1.0f,  1.0f }, {  0.0f,  0.0f,  1.0f} },
-            { { -1.0f,  1.0f,  1.0f }, {  0.0f,  0.0f,  1.0f} },
-        };
-
-        D3D11_BUFFER_DESC bd;
-        ZeroMemory(&bd, sizeof(bd));
-        bd.Usage = D3D11_USAGE_DEFAULT;
-        bd.ByteWidth = sizeof(SimpleVertex) * 24;
-        bd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-        bd.CPUAccessFlags = 0;
-
-        D3D11_SUBRESOURCE_DATA initData;
-        ZeroMemory(&initData, sizeof(initData));
-        initData.pSysMem = vertices;
-        hr = directX.getDevice()->CreateBuffer(&bd, &initData, vertexBuffer.GetAddressOf());
-        if (FAILED(hr)) {
-            MessageBox(nullptr, L"createBuffer()̎s", L"Error", MB_OK);
-            return hr;
+        if (findMeshBuffers(meshKey)) {
+            return S_OK;
         }
 
-        // VertexBufferZbg
-        UINT stride = sizeof(SimpleVertex);
-        UINT offset = 0;
-        directX.getDeviceContext()->IASetVertexBuffers(0, 1, vertexBuffer.GetAddressOf(), &stride, &offset);
-
-        // _obt@̍쐬
-        WORD indices[] =
-        {
-             3,  1,  0,
-             2,  1,  3,
-
-             6,  4,  5,
-             7,  4,  6,
-             
-            11,  9,  8,
-            10,  9, 11,
-
-            14, 12, 13,
-            15, 12, 14,
-
-            19, 17, 16,
-            18, 17, 19,
-
-            22, 20, 21,
-            23, 20, 22
-        };
-        vertexCount = 36;
-
-        bd.Usage = D3D11_USAGE_DEFAULT;
-        bd.ByteWidth = sizeof(WORD) * vertexCount; // 36_A12Op`
-        bd.BindFlags = D3D11_BIND_INDEX_BUFFER;
-        bd.CPUAccessFlags = 0;
-        initData.pSysMem = indices;
-        hr = directX.getDevice()->CreateBuffer(&bd, &initData, indexBuffer.GetAddressOf());
-        if (FAILED(hr)) {
-            MessageBox(nullptr, L"createBuffer()̎s", L"Error", MB_OK);
-            return hr;
+        MeshCache cache;
+        if (cache.open(cachePath)) {
+            return initMeshBuffers(meshKey, cache.getLod(0));
         }
 
-        // _obt@Zbg
-        directX.getDeviceContext()->IASetIndexBuffer(indexBuffer.Get(), DXGI_FORMAT_R16_UINT, 0);
-
-        // PrimitiveTopologyZbg
-        directX.getDeviceContext()->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-
-        // ConstantBuffer̍쐬
-        bd.Usage          = D3D11_USAGE_DEFAULT;
-        bd.ByteWidth      = sizeof(ConstantBufferMatrix);
-        bd.BindFlags      = D3D11_BIND_CONSTANT_BUFFER;
-        bd.CPUAccessFlags = 0;
-        hr = directX.getDevice()->CreateBuffer(&bd, nullptr, constantBufferMatrix.GetAddressOf());
-        if (FAILED(hr)) {
-            MessageBox(nullptr, L"createBuffer()̎s", L"Error", MB_OK);
-            return hr;
+        MeshData mesh;
+        if (!generate || !generate(mesh) || mesh.indexCount() == 0) {
+            MessageBox(nullptr, L"メッシュの読み込みに失敗しました", L"Error", MB_OK);
+            return E_FAIL;
         }
+        // 書き出せなくても描画はできる(次回も生成し直すだけ)
+        MeshCache::write(cachePath, mesh.view());
+        return initMeshBuffers(meshKey, mesh.view());
+    }
 
-        bd.Usage          = D3D11_USAGE_DEFAULT;
-        bd.ByteWidth      = sizeof(ConstantBufferLight);
-        bd.BindFlags      = D3D11_BIND_CONSTANT_BUFFER;
-        bd.CPUAccessFlags = 0;
-        hr = directX.getDevice()->CreateBuffer(&bd, nullptr, constantBufferLight.GetAddressOf());
+    // 初期化（メッシュ）
+    HRESULT Model::initMesh(const uint64_t meshKey, const MeshView &mesh)
+    {
+        auto hr = initShaders();
         if (FAILED(hr)) {
-            MessageBox(nullptr, L"createBuffer()̎s", L"Error", MB_OK);
             return hr;
         }
-
-        return S_OK;
+        if (findMeshBuffers(meshKey)) {
+            return S_OK;
+        }
+        return initMeshBuffers(meshKey, mesh);
     }
 
-    // íj
-    HRESULT Model::initSqhere(const int SEGMENT)
+    // シェーダー・入力レイアウト・コンスタントバッファの取得(全Modelで共有)
+    HRESULT Model::initShaders()
     {
-        auto &directX = DirectX11::getInstance();
-        auto hr = S_OK;
+        auto &directX  = DirectX11::getInstance();
+        auto &registry = directX.getResourceRegistry();
+
+        auto vsKey = makeShaderKey("VertexShader.hlsl", "VS", "vs_4_0");
+        auto psKey = makeShaderKey("PixelShader.hlsl",  "PS", "ps_4_0");
+
+        vertexShader = registry.find(ResourceType::VertexShader, vsKey);
+        vertexLayout = registry.find(ResourceType::InputLayout,  vsKey);
+        if (!vertexShader || !vertexLayout) {
+            // VertexShaderの読み込み
+            auto VSBlob = shaderCompile("VertexShader.hlsl", "VS", "vs_4_0");
+            if (VSBlob == nullptr) {
+                MessageBox(nullptr, L"shaderCompile()の失敗(VS)", L"Error", MB_OK);
+                return E_FAIL;
+            }
 
-        // VertexShader̓ǂݍ
-        auto VSBlob = shaderCompile(L"VertexShader.hlsl", "VS", "vs_4_0");
-        if (VSBlob == nullptr) {
-            MessageBox(nullptr, L"shaderCompile()̎s(VS)", L"Error", MB_OK);
-            return hr;
-        }
+            // VertexShaderの作成
+            vertexShader = registry.getShader(ResourceType::VertexShader, vsKey, VSBlob->data(), VSBlob->size());
+            if (!vertexShader) {
+                MessageBox(nullptr, L"VSコンパイル失敗", L"Error", MB_OK);
+                return E_FAIL;
+            }
 
-        // VertexShader̍쐬
-        hr = directX.getDevice()->CreateVertexShader(VSBlob->GetBufferPointer(), VSBlob->GetBufferSize(), nullptr, vertexShader.GetAddressOf());
-        if (FAILED(hr)) {
-            MessageBox(nullptr, L"VSRpCs", L"Error", MB_OK);
-            return hr;
+            // InputLayoutの作成
+            vertexLayout = registry.getInputLayout(vsKey, VertexLayout::PositionNormal, VSBlob->data(), VSBlob->size());
+            if (!vertexLayout) {
+                MessageBox(nullptr, L"CreateInputLayoutの失敗 : ", L"Error", MB_OK);
+                return E_FAIL;
+            }
         }
 
-        // InputLayou̒`
-        D3D11_INPUT_ELEMENT_DESC layout[] = {
-            { "POSITION", 0,    DXGI_FORMAT_R32G32B32_FLOAT, 0,  0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-            {   "NORMAL", 0,    DXGI_FORMAT_R32G32B32_FLOAT, 0, 12, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-        };
-        UINT numElements = ARRAYSIZE(layout);
+        pixelShader = registry.find(ResourceType::PixelShader, psKey);
+        if (!pixelShader) {
+            // PixelShaderの読み込み
+            auto PSBlob = shaderCompile("PixelShader.hlsl", "PS", "ps_4_0");
+            if (PSBlob == nullptr) {
+                MessageBox(nullptr, L"shaderCompile()の失敗(PS)", L"Error", MB_OK);
+                return E_FAIL;
+            }
 
-        // InputLayout̍쐬
-        hr = directX.getDevice()->CreateInputLayout(layout, numElements, VSBlob->GetBufferPointer(), VSBlob->GetBufferSize(), vertexLayout.GetAddressOf());
-        if (FAILED(hr)) {
-            MessageBox(nullptr, L"CreateInputLayout̎s(VS)", L"Error", MB_OK);
-            return hr;
+            // PixelShaderの作成
+            pixelShader = registry.getShader(ResourceType::PixelShader, psKey, PSBlob->data(), PSBlob->size());
+            if (!pixelShader) {
+                MessageBox(nullptr, L"createPixelShader()の失敗", L"Error", MB_OK);
+                return E_FAIL;
+            }
         }
 
-        // InputLayoutZbg
-        directX.getDeviceContext()->IASetInputLayout(vertexLayout.Get());
-        
-        // PixelShader̓ǂݍ
-        auto PSBlobLight = shaderCompile(L"PixelShader.hlsl", "PS", "ps_4_0");
-        if (PSBlobLight == nullptr) {
-            MessageBox(nullptr, L"shaderCompile()̎s(VS)", L"Error", MB_OK);
-            return hr;
+        // オブジェクト定数の作成(描画直前に更新するので共有できる)
+        objectConstantBuffer = registry.getBuffer(ResourceType::ConstantBuffer, CB_OBJECT, sizeof(ObjectConstants), 0, nullptr);
+        if (!objectConstantBuffer) {
+            MessageBox(nullptr, L"createBuffer()の失敗", L"Error", MB_OK);
+            return E_FAIL;
         }
 
-        // PixelShader̍쐬
-        hr = directX.getDevice()->CreatePixelShader(PSBlobLight->GetBufferPointer(), PSBlobLight->GetBufferSize(), nullptr, pixelShader.GetAddressOf());
-        if (FAILED(hr)) {
-            MessageBox(nullptr, L"createPixelShader()̎s", L"Error", MB_OK);
-            return hr;
-        }
+        return initMaterial(DEFAULT_MATERIAL, DEFAULT_MATERIAL);
+    }
 
-        // VertexBuffer̒`
-        const int COUNT = (SEGMENT + 1) * (SEGMENT / 2 + 1);
-        std::vector<SimpleVertex> vertices(COUNT);
-        
-        for (int i = 0; i <= (SEGMENT / 2); ++i) {
-            float irad = MyMath::PI * 2.0f / static_cast<float>(SEGMENT) * static_cast<float>(i);
-            float y = static_cast<float>(std::cosf(irad));
-            float r = static_cast<float>(std::sinf(irad));
-            for (int j = 0; j <= SEGMENT; ++j) {
-                float jrad = MyMath::PI * 2.0f / static_cast<float>(SEGMENT) * static_cast<float>(j);
-                float x = r * static_cast<float>(std::cosf(jrad));
-                float z = r * static_cast<float>(std::sinf(jrad));
-                int   inx = i * (SEGMENT + 1) + j;                
-                vertices[inx].pos[0] = x;
-                vertices[inx].pos[1] = y;
-                vertices[inx].pos[2] = z;
-                vertices[inx].normal[0] = x;
-                vertices[inx].normal[1] = y;
-                vertices[inx].normal[2] = z;                
-            }
-        }
+    // マテリアル定数の取得
+    // ※内容から識別子を求め、作成時に初期値を渡すので描画中の転送は発生しない
+    HRESULT Model::initMaterial(const Color &ambient, const Color &diffuse)
+    {
+        auto &registry = DirectX11::getInstance().getResourceRegistry();
 
-        D3D11_BUFFER_DESC bd;
-        ZeroMemory(&bd, sizeof(bd));
-        bd.Usage = D3D11_USAGE_DEFAULT;
-        bd.ByteWidth = sizeof(SimpleVertex) * COUNT;
-        bd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-        bd.CPUAccessFlags = 0;
-
-        D3D11_SUBRESOURCE_DATA initData;
-        ZeroMemory(&initData, sizeof(initData));
-        initData.pSysMem = vertices.data();
-        hr = directX.getDevice()->CreateBuffer(&bd, &initData, vertexBuffer.GetAddressOf());
-        if (FAILED(hr)) {
-            MessageBox(nullptr, L"createBuffer()̎s", L"Error", MB_OK);
-            return hr;
-        }
+        Material material;
+        memcpy(material.ambient, ambient.rgba, sizeof(material.ambient));
+        memcpy(material.diffuse, diffuse.rgba, sizeof(material.diffuse));
+        auto key = Hash::fnv1a(&material, sizeof(material), CB_MATERIAL);
 
-        // VertexBufferZbg
-        UINT stride = sizeof(SimpleVertex);
-        UINT offset = 0;
-        directX.getDeviceContext()->IASetVertexBuffers(0, 1, vertexBuffer.GetAddressOf(), &stride, &offset);
-
-        // _obt@̍쐬
-        const int COUNT2 = SEGMENT * 3 + SEGMENT * (SEGMENT / 2 - 1) * 6 + SEGMENT * 3;
-        std::vector<WORD> indices(COUNT2);
-
-        int count = 0;
-        int i = 0;
-        for (int j = 0; j < SEGMENT; ++j) {
-            indices[count] = i * (SEGMENT + 1) + j;
-            indices[count + 1] = (i + 1) * (SEGMENT + 1) + j + 1;
-            indices[count + 2] = (i + 1) * (SEGMENT + 1) + j;
-            count += 3;
-        }
-        for (i = 1; i < SEGMENT / 2; ++i) {
-            for (int j = 0; j < SEGMENT; ++j) {
-                indices[count] = i * (SEGMENT + 1) + j;
-                indices[count + 1] = i * (SEGMENT + 1) + j + 1;
-                indices[count + 2] = (i + 1) * (SEGMENT + 1) + j;
-                count += 3;
-                indices[count] = i * (SEGMENT + 1) + j + 1;
-                indices[count + 1] = (i + 1) * (SEGMENT + 1) + j + 1;
-                indices[count + 2] = (i + 1) * (SEGMENT + 1) + j;
-                count += 3;
-            }
-        }
-        i = SEGMENT / 2;
-        for (int j = 0; j < SEGMENT; ++j) {
-            indices[count] = i * (SEGMENT + 1) + j;
-            indices[count + 1] = (i + 1) * (SEGMENT + 1) + j + 1;
-            indices[count + 2] = (i + 1) * (SEGMENT + 1) + j;
-            count += 3;
+        materialConstantBuffer = registry.getBuffer(ResourceType::ConstantBuffer, key, sizeof(Material), 0, &material);
+        if (!materialConstantBuffer) {
+            MessageBox(nullptr, L"createBuffer()の失敗", L"Error", MB_OK);
+            return E_FAIL;
         }
 
-        vertexCount = count;
+        return S_OK;
+    }
 
-        bd.Usage = D3D11_USAGE_DEFAULT;
-        bd.ByteWidth = sizeof(WORD) * count; // 36_A12Op`
-        bd.BindFlags = D3D11_BIND_INDEX_BUFFER;
-        bd.CPUAccessFlags = 0;
-        initData.pSysMem = indices.data();
-        hr = directX.getDevice()->CreateBuffer(&bd, &initData, indexBuffer.GetAddressOf());
-        if (FAILED(hr)) {
-            MessageBox(nullptr, L"createBuffer()̎s", L"Error", MB_OK);
-            return hr;
+    // 登録済みの頂点・インデックスバッファを探す
+    bool Model::findMeshBuffers(const uint64_t meshKey)
+    {
+        auto &registry = DirectX11::getInstance().getResourceRegistry();
+
+        vertexBuffer = registry.find(ResourceType::VertexBuffer, meshKey);
+        indexBuffer  = registry.find(ResourceType::IndexBuffer,  meshKey);
+        if (!vertexBuffer || !indexBuffer) {
+            vertexBuffer.reset();
+            indexBuffer.reset();
+            return false;
         }
 
-        // _obt@Zbg
-        directX.getDeviceContext()->IASetIndexBuffer(indexBuffer.Get(), DXGI_FORMAT_R16_UINT, 0);
-
-        // PrimitiveTopologyZbg
-        directX.getDeviceContext()->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+        // インデックス数と形式はバッファの情報から求める
+        auto info   = registry.getInfo(indexBuffer.getHandle());
+        vertexCount = static_cast<int>(info.bytes / info.stride);
+        indexFormat = info.stride == sizeof(uint16_t) ? IndexFormat::UInt16 : IndexFormat::UInt32;
+        return true;
+    }
 
-        // ConstantBuffer̍쐬
-        bd.Usage          = D3D11_USAGE_DEFAULT;
-        bd.ByteWidth      = sizeof(ConstantBufferMatrix);
-        bd.BindFlags      = D3D11_BIND_CONSTANT_BUFFER;
-        bd.CPUAccessFlags = 0;
-        hr = directX.getDevice()->CreateBuffer(&bd, nullptr, constantBufferMatrix.GetAddressOf());
-        if (FAILED(hr)) {
-            MessageBox(nullptr, L"createBuffer()̎s", L"Error", MB_OK);
-            return hr;
+    // 頂点・インデックスバッファの作成
+    // ※meshのメモリはCreateBuffer()の間だけ参照する(マップされたキャッシュをそのまま渡せる)
+    HRESULT Model::initMeshBuffers(const uint64_t meshKey, const MeshView &mesh)
+    {
+        PROFILE_SCOPE("Model::initMeshBuffers");
+        auto &registry = DirectX11::getInstance().getResourceRegistry();
+
+        // VertexBufferの作成
+        vertexBuffer = registry.getBuffer(ResourceType::VertexBuffer, meshKey, sizeof(SimpleVertex) * mesh.vertexCount, sizeof(SimpleVertex), mesh.vertices);
+        if (!vertexBuffer) {
+            MessageBox(nullptr, L"createBuffer()の失敗", L"Error", MB_OK);
+            return E_FAIL;
         }
 
-        bd.Usage          = D3D11_USAGE_DEFAULT;
-        bd.ByteWidth      = sizeof(ConstantBufferLight);
-        bd.BindFlags      = D3D11_BIND_CONSTANT_BUFFER;
-        bd.CPUAccessFlags = 0;
-        hr = directX.getDevice()->CreateBuffer(&bd, nullptr, constantBufferLight.GetAddressOf());
-        if (FAILED(hr)) {
-            MessageBox(nullptr, L"createBuffer()̎s", L"Error", MB_OK);
-            return hr;
+        // IndexBufferの作成
+        vertexCount = static_cast<int>(mesh.indexCount);
+        indexFormat = mesh.indexFormat;
+
+        indexBuffer = registry.getBuffer(ResourceType::IndexBuffer, meshKey, mesh.indexStride() * mesh.indexCount, mesh.indexStride(), mesh.indices);
+        if (!indexBuffer) {
+            MessageBox(nullptr, L"createBuffer()の失敗", L"Error", MB_OK);
+            return E_FAIL;
         }
 
         return S_OK;
     }
 
-    // VF[_[̓ǂݍ
-    Microsoft::WRL::ComPtr<ID3DBlob> Model::shaderCompile(WCHAR * filename, LPCSTR entryPoint, LPCSTR shaderModel)
+    // シェーダーの識別子
+    uint64_t Model::makeShaderKey(const std::string &filename, const std::string &entryPoint, const std::string &shaderModel)
     {
-        Microsoft::WRL::ComPtr<ID3DBlob> blobOut = nullptr;
-        Microsoft::WRL::ComPtr<ID3DBlob> errorBlob = nullptr;
+        auto hash = Hash::fnv1a(filename.data(), filename.size());
+        hash = Hash::fnv1a(entryPoint.data(), entryPoint.size(), Hash::combine(hash, entryPoint.size()));
+        hash = Hash::fnv1a(shaderModel.data(), shaderModel.size(), Hash::combine(hash, shaderModel.size()));
+        return hash;
+    }
 
-        DWORD shaderFlags = D3DCOMPILE_ENABLE_STRICTNESS;
+    // メッシュの内容から識別子を求める
+    uint64_t Model::makeMeshKey(const MeshView &mesh)
+    {
+        auto hash = Hash::fnv1a(mesh.vertices, sizeof(SimpleVertex) * mesh.vertexCount);
+        hash = Hash::combine(hash, static_cast<uint64_t>(mesh.indexFormat));
+        return Hash::fnv1a(mesh.indices, mesh.indexStride() * mesh.indexCount, hash);
+    }
+
+    // シェーダーの読み込み
+    // ※同じソース・エントリーポイント・プロファイル・フラグならキャッシュ済みのバイトコードを共有する
+    ShaderBytecode Model::shaderCompile(const std::string &filename, const std::string &entryPoint, const std::string &shaderModel)
+    {
+        uint32_t shaderFlags = D3DCOMPILE_ENABLE_STRICTNESS;
 #if defined(DEBUG) || defined(_DEBUG)
         shaderFlags |= D3DCOMPILE_DEBUG;
 #endif
 
-        auto hr = D3DCompileFromFile(
-            filename,
-            nullptr,
-            nullptr,
-            entryPoint,
-            shaderModel,
-            shaderFlags,
-            0,
-            blobOut.GetAddressOf(),
-            errorBlob.GetAddressOf()
-        );
-
-        if (FAILED(hr)) {
-            if (errorBlob != nullptr) {
-                MessageBox(nullptr, static_cast<LPWSTR>(errorBlob->GetBufferPointer()), nullptr, MB_OK);
-            }
-            if (errorBlob) {
-                MessageBox(nullptr, static_cast<LPWSTR>(errorBlob->GetBufferPointer()), nullptr, MB_OK);
-                errorBlob.Get()->Release();
-            }
-        }
-        if (errorBlob) {
-            errorBlob.Get()->Release();
+        std::string error;
+        auto bytecode = DirectX11::getInstance().getShaderCache().getFromFile(filename, entryPoint, shaderModel, shaderFlags, {}, &error);
+        if (bytecode == nullptr && !error.empty()) {
+            MessageBoxA(nullptr, error.c_str(), nullptr, MB_OK);
         }
 
-        return Microsoft::WRL::ComPtr<ID3DBlob>(blobOut);
+        return bytecode;
     }
-}
\ No newline at end of file
+}
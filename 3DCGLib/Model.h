@@ -1,8 +1,14 @@
 #pragma once
 #ifndef MODEL_H
 #define MODEL_H
+#include <functional>
+#include <string>
 #include "DirectX11.h"
+#include "InstanceBatch.h"
 #include "Matrix.h"
+#include "MeshData.h"
+#include "ResourceRegistry.h"
+#include "StaticBatcher.h"
 
 namespace Lib
 {
@@ -13,65 +19,82 @@ namespace Lib
     public:
         Model();
         Model(const int SEGMENT);
+        Model(const MeshView &mesh);
+        // メッシュファイルから(.lmshはマップしてそのまま使い、それ以外はOBJとして解析して隣に.lmshを書き出す)
+        explicit Model(const std::string &path);
         ~Model();
 
         void render(Color &color);
+        // 指定のコマンドリストへ記録する(別スレッドから呼び出せる)
+        void render(CommandList &commands) const;
+        // ワールド行列を指定して記録する(同じModelを並列に多数描く場合)
+        void render(CommandList &commands, const Matrix &_world) const;
 
         void setWorldMatrix(Matrix &_world);
         Matrix getWorldMatrix() const;
 
-        Vector3& getLightPos();
+        // マテリアルを設定(同じ内容のModel間でバッファを共有する)
+        void setMaterial(const Color &ambient, const Color &diffuse);
+
+        // このModelのシェーダーとマテリアルで静的バッチを描く(頂点はワールド座標に変換済み)
+        void renderStatic(CommandList &commands, StaticBatcher &batcher) const;
+
+        // インスタンス描画で使うメッシュ
+        InstanceBatch::Mesh getInstanceMesh() const;
+
+        // 描画順のソートキー(不透明。深度はビュー空間のzをfarZで割った値)
+        uint64_t getSortKey(const Matrix &view, const float farZ) const;
+        // ワールド行列を指定したソートキー(render(commands, _world)で描く場合)
+        uint64_t getSortKey(const Matrix &view, const float farZ, const Matrix &_world) const;
+        // renderStatic()で描く場合のソートキー(深度はboundsの最も手前の点)
+        uint64_t getSortKey(const Matrix &view, const float farZ, const StaticBatcher::Bounds &bounds) const;
         
     private:
         HRESULT init();
         HRESULT initSqhere(const int SEGMENT);
-        ComPtr<ID3DBlob> shaderCompile(WCHAR* filename, LPCSTR entryPoint, LPCSTR shaderModel);
+        HRESULT initMesh(const uint64_t meshKey, const MeshView &mesh);
+        HRESULT initFile(const std::string &path);
+        // メッシュキャッシュから作る(開けなければgenerateで作ってキャッシュへ書き出す)
+        HRESULT initCachedMesh(const uint64_t meshKey, const std::string &cachePath, const std::function<bool(MeshData &mesh)> &generate);
+        HRESULT initShaders();
+        HRESULT initMeshBuffers(const uint64_t meshKey, const MeshView &mesh);
+        bool    findMeshBuffers(const uint64_t meshKey);
+        static uint64_t makeMeshKey(const MeshView &mesh);
 
-        struct SimpleVertex
-        {
-            float pos[3];
-            float normal[3];
-        };
+        // シェーダーの読み込み(InstancedRendererと共有する)
+        friend class InstancedRenderer;
+        static uint64_t makeShaderKey(const std::string &filename, const std::string &entryPoint, const std::string &shaderModel);
+        static ShaderBytecode shaderCompile(const std::string &filename, const std::string &entryPoint, const std::string &shaderModel);
 
-        struct ConstantBufferMatrix
-        {
-            Matrix world;
-            Matrix view;
-            Matrix projection;
-        };
+        HRESULT initMaterial(const Color &ambient, const Color &diffuse);
+        // オブジェクト定数の転送と設定
+        void setObjectConstants(CommandList &commands, const Matrix &_world) const;
 
-        struct Light
+        // オブジェクト定数(b2。描画ごとに更新)
+        struct ObjectConstants
         {
-            float pos[4];
-            float diffuse[4];
-            float attenuate[4];
+            Matrix world;
         };
 
+        // マテリアル定数(b1。内容ごとに作成し、更新しない)
         struct Material
         {
             float ambient[4];
             float diffuse[4];
         };
 
-        struct ConstantBufferLight
-        {
-            float    eyePos[4];
-            float    ambient[4];
-            Light    pointLight;
-            Material material;
-        };
-
-        ComPtr<ID3D11VertexShader>     vertexShader;
-        ComPtr<ID3D11PixelShader>      pixelShader;
-        ComPtr<ID3D11InputLayout>      vertexLayout;
-        ComPtr<ID3D11Buffer>           vertexBuffer;
-        ComPtr<ID3D11Buffer>           indexBuffer;
-        ComPtr<ID3D11Buffer>           constantBufferMatrix;
-        ComPtr<ID3D11Buffer>           constantBufferLight;
+        // 同じシェーダー・メッシュを使うModel間で共有される
+        ResourceRef vertexShader;
+        ResourceRef pixelShader;
+        ResourceRef vertexLayout;
+        ResourceRef vertexBuffer;
+        ResourceRef indexBuffer;
+        ResourceRef objectConstantBuffer;
+        ResourceRef materialConstantBuffer;
 
         Matrix world;
-        Vector3 light;
         int vertexCount;
+        IndexFormat indexFormat;
     };
 }
 #endif
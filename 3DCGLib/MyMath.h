@@ -4,7 +4,9 @@
 #include <algorithm>
 #undef max
 #undef min
+#ifdef _WIN32
 #include <DirectXMath.h>
+#endif
 namespace Lib
 {
     class MyMath
@@ -15,14 +17,21 @@ namespace Lib
         static const float PIDIV4;
         static const float PI2;
 
-        // value_min_`max_͈̔͂ɐ
+        // 引数value_を引数min_～引数max_の範囲に制限する
         template <class T>
         static T clamp(const T value_, const T max_, const T min_)
         {
             return std::min(std::max(min_, value_), max_);
         }
 
-        // value_limitȏ̏ꍇvalue_0ɁA܂0ȉ̏ꍇvalue_limit_
+        // 引数a_と引数b_の間を引数t_(0～1)で線形補間する
+        template <class T>
+        static T lerp(const T &a_, const T &b_, const float t_)
+        {
+            return a_ + (b_ - a_) * t_;
+        }
+
+        // 引数value_がlimit以上の場合value_を0に、また0以下の場合value_をlimit_に
         template <class T>
         static T rollup(const T value_, const T limit_) {
             if (value_ < 0) {
@@ -0,0 +1,153 @@
+#include "NullRenderDevice.h"
+
+namespace Lib
+{
+    // 生成数の合計
+    uint32_t NullRenderDevice::Counters::totalCreated() const
+    {
+        uint32_t total = 0;
+        for (auto count : created) {
+            total += count;
+        }
+        return total;
+    }
+
+    // 解放数の合計
+    uint32_t NullRenderDevice::Counters::totalReleased() const
+    {
+        uint32_t total = 0;
+        for (auto count : released) {
+            total += count;
+        }
+        return total;
+    }
+
+    // コンストラクタ
+    NullRenderDevice::NullRenderDevice()
+        : serial(0)
+    {
+        resetCounters();
+    }
+
+    // デストラクタ
+    NullRenderDevice::~NullRenderDevice()
+    {
+    }
+
+    // シェーダーの作成
+    NativeResource NullRenderDevice::createShader(const ResourceType type, const void *bytecode, const size_t size)
+    {
+        if (bytecode == nullptr || size == 0) {
+            return nullptr;
+        }
+        return create(type);
+    }
+
+    // 入力レイアウトの作成
+    NativeResource NullRenderDevice::createInputLayout(const VertexLayout layout, const void *bytecode, const size_t size)
+    {
+        (void)layout;
+        if (bytecode == nullptr || size == 0) {
+            return nullptr;
+        }
+        return create(ResourceType::InputLayout);
+    }
+
+    // バッファの作成
+    NativeResource NullRenderDevice::createBuffer(const ResourceType type, const uint32_t byteWidth, const void *initData)
+    {
+        (void)initData;
+        if (byteWidth == 0) {
+            return nullptr;
+        }
+        return create(type);
+    }
+
+    // 解放
+    void NullRenderDevice::release(const ResourceType type, NativeResource resource)
+    {
+        if (resource != nullptr) {
+            ++released[static_cast<size_t>(type)];
+        }
+    }
+
+    // 呼び出し回数の取得
+    NullRenderDevice::Counters NullRenderDevice::getCounters() const
+    {
+        Counters counters;
+        for (size_t i = 0; i < TYPE_COUNT; ++i) {
+            counters.created[i]  = created[i];
+            counters.released[i] = released[i];
+        }
+        return counters;
+    }
+
+    // 呼び出し回数のリセット
+    void NullRenderDevice::resetCounters()
+    {
+        for (size_t i = 0; i < TYPE_COUNT; ++i) {
+            created[i]  = 0;
+            released[i] = 0;
+        }
+    }
+
+    // ダミーオブジェクトの作成(0以外の連番を返す)
+    NativeResource NullRenderDevice::create(const ResourceType type)
+    {
+        ++created[static_cast<size_t>(type)];
+        return reinterpret_cast<NativeResource>(++serial);
+    }
+
+    // API呼び出しの合計
+    uint64_t NullRenderContext::Counters::totalCalls() const
+    {
+        uint64_t total = 0;
+        for (auto count : calls) {
+            total += count;
+        }
+        return total;
+    }
+
+    // コンストラクタ
+    NullRenderContext::NullRenderContext()
+    {
+        resetCounters();
+    }
+
+    // デストラクタ
+    NullRenderContext::~NullRenderContext()
+    {
+    }
+
+    // コマンドの実行
+    void NullRenderContext::execute(const CommandList &list)
+    {
+        for (auto &command : list.getCommands()) {
+            ++counters.calls[static_cast<size_t>(command.type)];
+            switch (command.type) {
+            case CommandType::UpdateBuffer:
+                counters.updateBytes += command.arg1;
+                break;
+            case CommandType::DrawIndexed:
+                ++counters.draws;
+                counters.indices += command.arg0;
+                break;
+            case CommandType::DrawIndexedInstanced:
+                ++counters.draws;
+                counters.indices += static_cast<uint64_t>(command.arg0) * command.arg3;
+                break;
+            default:
+                break;
+            }
+        }
+    }
+
+    // 呼び出し回数のリセット
+    void NullRenderContext::resetCounters()
+    {
+        counters.calls.fill(0);
+        counters.draws       = 0;
+        counters.indices     = 0;
+        counters.updateBytes = 0;
+    }
+}
@@ -0,0 +1,78 @@
+#pragma once
+#ifndef NULLRENDERDEVICE_H
+#define NULLRENDERDEVICE_H
+#include <array>
+#include <atomic>
+#include "RenderDevice.h"
+#include "CommandList.h"
+
+namespace Lib
+{
+    // 何も描画しないバックエンド(テストやヘッドレス計測用)
+    // API呼び出し回数だけを数える
+    class NullRenderDevice : public RenderDevice
+    {
+    public:
+        static const size_t TYPE_COUNT = static_cast<size_t>(ResourceType::Count);
+
+        // 呼び出し回数
+        struct Counters
+        {
+            std::array<uint32_t, TYPE_COUNT> created;
+            std::array<uint32_t, TYPE_COUNT> released;
+
+            uint32_t totalCreated() const;
+            uint32_t totalReleased() const;
+            uint32_t live() const { return totalCreated() - totalReleased(); }
+        };
+
+        NullRenderDevice();
+        ~NullRenderDevice();
+
+        NativeResource createShader(const ResourceType type, const void *bytecode, const size_t size) override;
+        NativeResource createInputLayout(const VertexLayout layout, const void *bytecode, const size_t size) override;
+        NativeResource createBuffer(const ResourceType type, const uint32_t byteWidth, const void *initData) override;
+        void release(const ResourceType type, NativeResource resource) override;
+
+        Counters getCounters() const;
+        void     resetCounters();
+
+    private:
+        NativeResource create(const ResourceType type);
+
+        std::atomic<uintptr_t> serial;
+        std::array<std::atomic<uint32_t>, TYPE_COUNT> created;
+        std::array<std::atomic<uint32_t>, TYPE_COUNT> released;
+    };
+
+    // 何も描画しないコマンド実行(API呼び出し回数だけを数える)
+    class NullRenderContext : public RenderContext
+    {
+    public:
+        static const size_t COMMAND_COUNT = static_cast<size_t>(CommandType::Count);
+
+        // 呼び出し回数
+        struct Counters
+        {
+            std::array<uint64_t, COMMAND_COUNT> calls;
+            uint64_t draws;
+            uint64_t indices;
+            uint64_t updateBytes;
+
+            uint64_t totalCalls() const;
+        };
+
+        NullRenderContext();
+        ~NullRenderContext();
+
+        void execute(const CommandList &list) override;
+
+        const Counters &getCounters() const { return counters; }
+        void resetCounters();
+
+    private:
+        Counters counters;
+    };
+}
+
+#endif
@@ -0,0 +1,654 @@
+#include <algorithm>
+#include <chrono>
+#include <cfloat>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include "ObjLoader.h"
+#include "MappedFile.h"
+
+namespace Lib
+{
+    namespace
+    {
+        const int32_t NONE = INT32_MIN;
+
+        // 三角形の頂点(位置・法線インデックスの組)
+        struct Corner
+        {
+            int32_t position;
+            int32_t normal;
+        };
+
+        // 相対インデックスの補正情報
+        struct Fixup
+        {
+            uint32_t corner;
+            bool     position;
+        };
+
+        // スレッドごとの解析結果
+        struct Chunk
+        {
+            std::vector<float>  positions;
+            std::vector<float>  normals;
+            std::vector<Corner> corners;
+            std::vector<Fixup>  fixups;
+            uint32_t            positionBase;
+            uint32_t            normalBase;
+            bool                failed;
+        };
+
+        float elapsed(const std::chrono::steady_clock::time_point &start)
+        {
+            return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        // [0, count)をthreadCount分割して並列に処理する
+        template <class F>
+        void parallelFor(const size_t count, const unsigned threadCount, F func)
+        {
+            if (threadCount <= 1 || count < threadCount) {
+                func(0, count, 0);
+                return;
+            }
+            std::vector<std::thread> threads;
+            threads.reserve(threadCount - 1);
+            for (unsigned t = 1; t < threadCount; ++t) {
+                size_t begin = count * t / threadCount;
+                size_t end   = count * (t + 1) / threadCount;
+                threads.emplace_back([=]() { func(begin, end, t); });
+            }
+            func(0, count / threadCount, 0);
+            for (auto &th : threads) {
+                th.join();
+            }
+        }
+
+        bool isSpace(const char c)
+        {
+            return c == ' ' || c == '\t' || c == '\r';
+        }
+
+        const char *skipSpace(const char *p, const char *end)
+        {
+            while (p < end && isSpace(*p)) {
+                ++p;
+            }
+            return p;
+        }
+
+        // 10の累乗(doubleで正確に表せるもの)
+        const double POW10[] = {
+            1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+        };
+        const uint64_t MAX_EXACT_MANTISSA = 1ull << 53;
+
+        bool isDigit(const char c)
+        {
+            return c >= '0' && c <= '9';
+        }
+
+        // strtofでの浮動小数点数の読み込み
+        // strtofは終端のない範囲を読めないので、1つの数を短いバッファへ写してから変換する
+        const char *parseFloatSlow(const char *p, const char *end, float &value)
+        {
+            const size_t MAX_LENGTH = 63;
+            char   text[MAX_LENGTH + 1];
+            size_t length = 0;
+            while (p + length < end && !isSpace(p[length]) && p[length] != '\n') {
+                if (length == MAX_LENGTH) {
+                    return nullptr;
+                }
+                text[length] = p[length];
+                ++length;
+            }
+            text[length] = '\0';
+
+            char *stop = nullptr;
+            value = std::strtof(text, &stop);
+            return stop != text ? p + (stop - text) : nullptr;
+        }
+
+        // 浮動小数点数の読み込み
+        // 仮数が2^53以下・指数が±22以内の10進数は、doubleの1回の乗除算で正しく丸めた値になる(ClingerのFast Path)
+        // それをfloatへ丸める時に丸めの中間点に当たった場合と、それ以外の表記はstrtofで読み直す
+        // (std::from_charsの浮動小数点数版はv141のツールセットのSTLにない)
+        const char *parseFloat(const char *p, const char *end, float &value)
+        {
+            p = skipSpace(p, end);
+            const char *begin = p;
+            bool negative = false;
+            if (p < end && (*p == '+' || *p == '-')) {
+                negative = *p == '-';
+                ++p;
+            }
+
+            uint64_t mantissa = 0;
+            int      digits   = 0; // 仮数の桁数(先頭の0を除く)
+            int      exponent = 0;
+            bool     found    = false;
+            for (; p < end && isDigit(*p); ++p) {
+                mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+                digits  += mantissa != 0 ? 1 : 0;
+                found    = true;
+            }
+            if (p < end && *p == '.') {
+                for (++p; p < end && isDigit(*p); ++p) {
+                    mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+                    digits  += mantissa != 0 ? 1 : 0;
+                    --exponent;
+                    found    = true;
+                }
+            }
+            if (found && p < end && (*p == 'e' || *p == 'E')) {
+                const char *q = p + 1;
+                bool negativeExponent = false;
+                if (q < end && (*q == '+' || *q == '-')) {
+                    negativeExponent = *q == '-';
+                    ++q;
+                }
+                if (q < end && isDigit(*q)) {
+                    int value10 = 0;
+                    for (; q < end && isDigit(*q); ++q) {
+                        value10 = std::min(value10 * 10 + (*q - '0'), 10000);
+                    }
+                    exponent += negativeExponent ? -value10 : value10;
+                    p = q;
+                }
+            }
+
+            // 桁数・指数が範囲外、inf・nan・16進数などはstrtofに任せる
+            if (!found || digits > 19 || mantissa > MAX_EXACT_MANTISSA || exponent < -22 || exponent > 22 ||
+                (p < end && !isSpace(*p) && *p != '\n')) {
+                return parseFloatSlow(begin, end, value);
+            }
+
+            double number = static_cast<double>(mantissa);
+            number = exponent < 0 ? number / POW10[-exponent] : number * POW10[exponent];
+            if (number == 0.0) {
+                value = negative ? -0.0f : 0.0f;
+                return p;
+            }
+            if (number < FLT_MIN || number > FLT_MAX) {
+                return parseFloatSlow(begin, end, value);
+            }
+            // doubleの値がfloatの2つの値のちょうど中間なら、元の10進数がどちらに近いか分からない
+            float rounded = static_cast<float>(number);
+            if (static_cast<double>(rounded) != number) {
+                float other = std::nextafter(rounded, static_cast<float>(number < rounded ? 0.0f : FLT_MAX));
+                if ((static_cast<double>(rounded) + static_cast<double>(other)) * 0.5 == number) {
+                    return parseFloatSlow(begin, end, value);
+                }
+            }
+            value = negative ? -rounded : rounded;
+            return p;
+        }
+
+        // インデックスの読み込み(OBJのインデックスをチャンク内の0始まりに変換する)
+        const char *parseIndex(const char *p, const char *end, const uint32_t localCount, int32_t &index, bool &relative)
+        {
+            bool negative = p < end && *p == '-';
+            if (negative) {
+                ++p;
+            }
+            int64_t value = 0;
+            const char *digits = p;
+            while (p < end && *p >= '0' && *p <= '9') {
+                value = value * 10 + (*p - '0');
+                if (value > INT32_MAX) {
+                    return nullptr;
+                }
+                ++p;
+            }
+            if (p == digits || value == 0) {
+                return nullptr;
+            }
+            relative = negative;
+            index    = relative ? static_cast<int32_t>(localCount) - static_cast<int32_t>(value) : static_cast<int32_t>(value) - 1;
+            return p;
+        }
+
+        // 1チャンク分の解析
+        void parseChunk(const char *p, const char *end, Chunk &chunk)
+        {
+            std::vector<Corner> polygon;
+            while (p < end) {
+                const char *lineEnd = std::find(p, end, '\n');
+                const char *q = skipSpace(p, lineEnd);
+
+                if (lineEnd - q >= 2 && q[0] == 'v' && isSpace(q[1])) {
+                    // 頂点座標
+                    float xyz[3];
+                    q += 2;
+                    for (int k = 0; k < 3 && q != nullptr; ++k) {
+                        q = parseFloat(q, lineEnd, xyz[k]);
+                    }
+                    if (q == nullptr) {
+                        chunk.failed = true;
+                        return;
+                    }
+                    chunk.positions.insert(chunk.positions.end(), xyz, xyz + 3);
+                }
+                else if (lineEnd - q >= 3 && q[0] == 'v' && q[1] == 'n' && isSpace(q[2])) {
+                    // 法線
+                    float xyz[3];
+                    q += 3;
+                    for (int k = 0; k < 3 && q != nullptr; ++k) {
+                        q = parseFloat(q, lineEnd, xyz[k]);
+                    }
+                    if (q == nullptr) {
+                        chunk.failed = true;
+                        return;
+                    }
+                    chunk.normals.insert(chunk.normals.end(), xyz, xyz + 3);
+                }
+                else if (lineEnd - q >= 2 && q[0] == 'f' && isSpace(q[1])) {
+                    // 面(p, p/t, p//n, p/t/n)
+                    polygon.clear();
+                    q = skipSpace(q + 2, lineEnd);
+                    bool relativePosition[64] = {};
+                    bool relativeNormal[64]   = {};
+                    while (q < lineEnd && *q != '#') {
+                        Corner corner = { NONE, NONE };
+                        bool relP = false;
+                        bool relN = false;
+                        q = parseIndex(q, lineEnd, static_cast<uint32_t>(chunk.positions.size() / 3), corner.position, relP);
+                        if (q == nullptr) {
+                            chunk.failed = true;
+                            return;
+                        }
+                        if (q < lineEnd && *q == '/') {
+                            ++q;
+                            // テクスチャ座標は読み飛ばす
+                            while (q < lineEnd && *q != '/' && !isSpace(*q)) {
+                                ++q;
+                            }
+                            if (q < lineEnd && *q == '/') {
+                                q = parseIndex(q + 1, lineEnd, static_cast<uint32_t>(chunk.normals.size() / 3), corner.normal, relN);
+                                if (q == nullptr) {
+                                    chunk.failed = true;
+                                    return;
+                                }
+                            }
+                        }
+                        if (polygon.size() < 64) {
+                            relativePosition[polygon.size()] = relP;
+                            relativeNormal[polygon.size()]   = relN;
+                        }
+                        polygon.push_back(corner);
+                        q = skipSpace(q, lineEnd);
+                    }
+                    if (polygon.size() < 3 || polygon.size() > 64) {
+                        chunk.failed = true;
+                        return;
+                    }
+
+                    // 扇形に三角形分割
+                    for (size_t k = 1; k + 1 < polygon.size(); ++k) {
+                        const size_t tri[3] = { 0, k, k + 1 };
+                        for (auto c : tri) {
+                            auto cornerIndex = static_cast<uint32_t>(chunk.corners.size());
+                            if (relativePosition[c]) {
+                                chunk.fixups.push_back({ cornerIndex, true });
+                            }
+                            if (relativeNormal[c]) {
+                                chunk.fixups.push_back({ cornerIndex, false });
+                            }
+                            chunk.corners.push_back(polygon[c]);
+                        }
+                    }
+                }
+                // それ以外(vt, g, o, usemtl, コメントなど)は無視する
+
+                p = lineEnd + 1;
+            }
+        }
+
+        // 64bitキーの撹拌
+        uint64_t mix(uint64_t key)
+        {
+            key ^= key >> 33;
+            key *= 0xff51afd7ed558ccdULL;
+            key ^= key >> 33;
+            key *= 0xc4ceb9fe1a85ec53ULL;
+            key ^= key >> 33;
+            return key;
+        }
+
+        uint64_t makeKey(const Corner &corner)
+        {
+            return (static_cast<uint64_t>(static_cast<uint32_t>(corner.position)) << 32) | static_cast<uint32_t>(corner.normal);
+        }
+
+        // オープンアドレス法のハッシュテーブル(キー -> 頂点番号)
+        class WeldTable
+        {
+        public:
+            WeldTable() : count(0), mask(0) {}
+
+            // 予想される登録数で確保しておく
+            void reserve(const size_t expected)
+            {
+                size_t capacity = 1024;
+                while (capacity < expected * 2) {
+                    capacity *= 2;
+                }
+                keys.assign(capacity, 0);
+                values.assign(capacity, UINT32_MAX);
+                mask  = capacity - 1;
+                count = 0;
+            }
+
+            // 未登録ならnextを登録して返す
+            uint32_t insert(const uint64_t key, const uint64_t hash, const uint32_t next)
+            {
+                if ((count + 1) * 2 > keys.size()) {
+                    grow();
+                }
+                size_t slot = static_cast<size_t>(hash) & mask;
+                while (values[slot] != UINT32_MAX) {
+                    if (keys[slot] == key) {
+                        return values[slot];
+                    }
+                    slot = (slot + 1) & mask;
+                }
+                keys[slot]   = key;
+                values[slot] = next;
+                ++count;
+                return next;
+            }
+
+        private:
+            void grow()
+            {
+                std::vector<uint64_t> oldKeys;
+                std::vector<uint32_t> oldValues;
+                oldKeys.swap(keys);
+                oldValues.swap(values);
+                size_t capacity = std::max<size_t>(1024, oldKeys.size() * 2);
+                keys.assign(capacity, 0);
+                values.assign(capacity, UINT32_MAX);
+                mask = capacity - 1;
+                for (size_t i = 0; i < oldKeys.size(); ++i) {
+                    if (oldValues[i] == UINT32_MAX) {
+                        continue;
+                    }
+                    size_t slot = static_cast<size_t>(mix(oldKeys[i])) & mask;
+                    while (values[slot] != UINT32_MAX) {
+                        slot = (slot + 1) & mask;
+                    }
+                    keys[slot]   = oldKeys[i];
+                    values[slot] = oldValues[i];
+                }
+            }
+
+            std::vector<uint64_t> keys;
+            std::vector<uint32_t> values;
+            size_t                count;
+            size_t                mask;
+        };
+    }
+
+    // ファイルから読み込む
+    bool ObjLoader::load(const std::string &path, MeshData &mesh, const unsigned threadCount, Stats *stats)
+    {
+        MappedFile file;
+        if (!file.open(path)) {
+            return false;
+        }
+        return parse(reinterpret_cast<const char*>(file.data()), file.size(), mesh, threadCount, stats);
+    }
+
+    // メモリ上のテキストから読み込む
+    bool ObjLoader::parse(const char *text, const size_t size, MeshData &mesh, const unsigned threadCount, Stats *stats)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        unsigned threads = threadCount != 0 ? threadCount : std::max(1u, std::thread::hardware_concurrency());
+        // 小さなファイルは分割しない
+        const size_t MIN_CHUNK = 256 * 1024;
+        threads = static_cast<unsigned>(std::max<size_t>(1, std::min<size_t>(threads, size / MIN_CHUNK)));
+
+        // 行単位でチャンクに分割して並列に解析する
+        std::vector<Chunk> chunks(threads);
+        std::vector<const char*> bounds(threads + 1);
+        const char *end = text + size;
+        bounds[0]       = text;
+        bounds[threads] = end;
+        for (unsigned t = 1; t < threads; ++t) {
+            const char *p = text + size * t / threads;
+            p = std::find(std::max(p, bounds[t - 1]), end, '\n');
+            bounds[t] = p < end ? p + 1 : end;
+        }
+        parallelFor(threads, threads, [&](size_t begin, size_t last, unsigned) {
+            for (size_t t = begin; t < last; ++t) {
+                chunks[t].failed = false;
+                parseChunk(bounds[t], bounds[t + 1], chunks[t]);
+            }
+        });
+
+        // チャンクごとのオフセットを求めて相対インデックスを補正する
+        uint32_t positionCount = 0;
+        uint32_t normalCount   = 0;
+        size_t   cornerCount   = 0;
+        for (auto &chunk : chunks) {
+            if (chunk.failed) {
+                return false;
+            }
+            chunk.positionBase = positionCount;
+            chunk.normalBase   = normalCount;
+            positionCount += static_cast<uint32_t>(chunk.positions.size() / 3);
+            normalCount   += static_cast<uint32_t>(chunk.normals.size() / 3);
+            cornerCount   += chunk.corners.size();
+            for (auto &fix : chunk.fixups) {
+                auto &corner = chunk.corners[fix.corner];
+                if (fix.position) {
+                    corner.position += static_cast<int32_t>(chunk.positionBase);
+                }
+                else {
+                    corner.normal += static_cast<int32_t>(chunk.normalBase);
+                }
+            }
+        }
+        if (cornerCount >= UINT32_MAX) {
+            return false;
+        }
+
+        // 全チャンクの面を1つの配列に連結し、範囲外参照を検出する
+        std::vector<Corner> corners;
+        corners.reserve(cornerCount);
+        for (auto &chunk : chunks) {
+            corners.insert(corners.end(), chunk.corners.begin(), chunk.corners.end());
+        }
+        bool invalid = false;
+        for (auto &corner : corners) {
+            if (corner.position < 0 || corner.position >= static_cast<int32_t>(positionCount) ||
+                (corner.normal != NONE && (corner.normal < 0 || corner.normal >= static_cast<int32_t>(normalCount)))) {
+                invalid = true;
+                break;
+            }
+        }
+        if (invalid) {
+            return false;
+        }
+        auto parseTime = elapsed(start);
+        auto weldStart = std::chrono::steady_clock::now();
+
+        // ハッシュでシャードに分割し、シャードごとに並列で頂点を共有する
+        const unsigned shards = threads;
+        std::vector<std::vector<uint32_t>> counts(threads, std::vector<uint32_t>(shards, 0));
+        auto shardOf = [&](const Corner &corner) {
+            return static_cast<unsigned>((mix(makeKey(corner)) >> 40) % shards);
+        };
+        parallelFor(corners.size(), threads, [&](size_t begin, size_t last, unsigned t) {
+            for (size_t c = begin; c < last; ++c) {
+                ++counts[t][shardOf(corners[c])];
+            }
+        });
+        // (スレッド, シャード)ごとの書き込み位置(元の順序を保つ)
+        std::vector<size_t> shardBegin(shards + 1, 0);
+        std::vector<std::vector<size_t>> offsets(threads, std::vector<size_t>(shards, 0));
+        size_t offset = 0;
+        for (unsigned s = 0; s < shards; ++s) {
+            shardBegin[s] = offset;
+            for (unsigned t = 0; t < threads; ++t) {
+                offsets[t][s] = offset;
+                offset += counts[t][s];
+            }
+        }
+        shardBegin[shards] = offset;
+        std::vector<uint32_t> partition(corners.size());
+        parallelFor(corners.size(), threads, [&](size_t begin, size_t last, unsigned t) {
+            for (size_t c = begin; c < last; ++c) {
+                partition[offsets[t][shardOf(corners[c])]++] = static_cast<uint32_t>(c);
+            }
+        });
+
+        // シャード内での頂点番号を決める
+        std::vector<uint32_t> localIndex(corners.size());
+        std::vector<std::vector<Corner>> uniques(shards);
+        parallelFor(shards, threads, [&](size_t begin, size_t last, unsigned) {
+            for (size_t s = begin; s < last; ++s) {
+                WeldTable table;
+                // 閉じたメッシュでは1頂点を平均4~6面が共有する
+                table.reserve((shardBegin[s + 1] - shardBegin[s]) / 4);
+                for (size_t k = shardBegin[s]; k < shardBegin[s + 1]; ++k) {
+                    auto &corner = corners[partition[k]];
+                    auto  key    = makeKey(corner);
+                    auto  next   = static_cast<uint32_t>(uniques[s].size());
+                    auto  index  = table.insert(key, mix(key), next);
+                    if (index == next) {
+                        uniques[s].push_back(corner);
+                    }
+                    localIndex[partition[k]] = index;
+                }
+            }
+        });
+
+        // 頂点配列の作成
+        std::vector<uint32_t> vertexBase(shards + 1, 0);
+        for (unsigned s = 0; s < shards; ++s) {
+            vertexBase[s + 1] = vertexBase[s] + static_cast<uint32_t>(uniques[s].size());
+        }
+        const uint32_t vertexCount = vertexBase[shards];
+        auto positionAt = [&](const int32_t index) -> const float* {
+            for (auto &chunk : chunks) {
+                if (static_cast<uint32_t>(index) < chunk.positionBase + chunk.positions.size() / 3) {
+                    return &chunk.positions[(index - chunk.positionBase) * 3];
+                }
+            }
+            return nullptr;
+        };
+        auto normalAt = [&](const int32_t index) -> const float* {
+            for (auto &chunk : chunks) {
+                if (static_cast<uint32_t>(index) < chunk.normalBase + chunk.normals.size() / 3) {
+                    return &chunk.normals[(index - chunk.normalBase) * 3];
+                }
+            }
+            return nullptr;
+        };
+        mesh.vertices.resize(vertexCount);
+        bool missingNormal = false;
+        parallelFor(shards, threads, [&](size_t begin, size_t last, unsigned) {
+            for (size_t s = begin; s < last; ++s) {
+                for (size_t k = 0; k < uniques[s].size(); ++k) {
+                    auto &vertex = mesh.vertices[vertexBase[s] + k];
+                    auto  pos    = positionAt(uniques[s][k].position);
+                    std::copy(pos, pos + 3, vertex.pos);
+                    if (uniques[s][k].normal != NONE) {
+                        auto normal = normalAt(uniques[s][k].normal);
+                        std::copy(normal, normal + 3, vertex.normal);
+                    }
+                    else {
+                        vertex.normal[0] = vertex.normal[1] = vertex.normal[2] = 0.0f;
+                    }
+                }
+            }
+        });
+
+        // インデックス配列の作成(頂点数に応じて16/32bitを選ぶ)
+        mesh.indices16.clear();
+        mesh.indices32.clear();
+        const bool use16 = vertexCount <= 0xFFFF;
+        if (use16) {
+            mesh.indices16.resize(corners.size());
+        }
+        else {
+            mesh.indices32.resize(corners.size());
+        }
+        parallelFor(corners.size(), threads, [&](size_t begin, size_t last, unsigned) {
+            for (size_t c = begin; c < last; ++c) {
+                uint32_t index = vertexBase[shardOf(corners[c])] + localIndex[c];
+                if (use16) {
+                    mesh.indices16[c] = static_cast<uint16_t>(index);
+                }
+                else {
+                    mesh.indices32[c] = index;
+                }
+            }
+        });
+
+        // 法線のない頂点は面法線の平均で補う
+        for (auto &corner : corners) {
+            if (corner.normal == NONE) {
+                missingNormal = true;
+                break;
+            }
+        }
+        if (missingNormal) {
+            for (size_t c = 0; c + 2 < corners.size(); c += 3) {
+                uint32_t tri[3];
+                for (int k = 0; k < 3; ++k) {
+                    tri[k] = use16 ? mesh.indices16[c + k] : mesh.indices32[c + k];
+                }
+                auto a = mesh.vertices[tri[0]].pos;
+                auto b = mesh.vertices[tri[1]].pos;
+                auto d = mesh.vertices[tri[2]].pos;
+                float e1[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+                float e2[3] = { d[0] - a[0], d[1] - a[1], d[2] - a[2] };
+                float n[3]  = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+                for (int k = 0; k < 3; ++k) {
+                    if (corners[c + k].normal != NONE) {
+                        continue;
+                    }
+                    auto &normal = mesh.vertices[tri[k]].normal;
+                    normal[0] += n[0];
+                    normal[1] += n[1];
+                    normal[2] += n[2];
+                }
+            }
+            for (size_t s = 0; s < shards; ++s) {
+                for (size_t k = 0; k < uniques[s].size(); ++k) {
+                    if (uniques[s][k].normal != NONE) {
+                        continue;
+                    }
+                    auto &normal = mesh.vertices[vertexBase[s] + k].normal;
+                    float len = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+                    if (len > 0.0f) {
+                        normal[0] /= len;
+                        normal[1] /= len;
+                        normal[2] /= len;
+                    }
+                }
+            }
+        }
+
+        if (stats != nullptr) {
+            stats->bytes     = size;
+            stats->threads   = threads;
+            stats->positions = positionCount;
+            stats->normals   = normalCount;
+            stats->triangles = static_cast<uint32_t>(corners.size() / 3);
+            stats->vertices  = vertexCount;
+            stats->parseTime = parseTime;
+            stats->weldTime  = elapsed(weldStart);
+            stats->totalTime = elapsed(start);
+        }
+
+        return true;
+    }
+}
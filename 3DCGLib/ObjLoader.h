@@ -0,0 +1,38 @@
+#pragma once
+#ifndef OBJLOADER_H
+#define OBJLOADER_H
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "MeshData.h"
+
+namespace Lib
+{
+    // Wavefront OBJローダー
+    // ※v/vn/fのみ対応。多角形は扇形に三角形分割し、位置と法線の組で頂点を共有する
+    class ObjLoader
+    {
+    public:
+        // 計測結果
+        struct Stats
+        {
+            uint64_t bytes;
+            uint32_t threads;
+            uint32_t positions;
+            uint32_t normals;
+            uint32_t triangles;
+            uint32_t vertices;
+            float    parseTime; // ミリ秒
+            float    weldTime;  // ミリ秒
+            float    totalTime; // ミリ秒
+        };
+
+        // ファイルから読み込む(threadCountが0の場合はコア数)
+        static bool load(const std::string &path, MeshData &mesh, const unsigned threadCount = 0, Stats *stats = nullptr);
+
+        // メモリ上のテキストから読み込む
+        static bool parse(const char *text, const size_t size, MeshData &mesh, const unsigned threadCount = 0, Stats *stats = nullptr);
+    };
+}
+
+#endif
@@ -0,0 +1,62 @@
+#include <algorithm>
+#include <chrono>
+#include "ParallelRecorder.h"
+
+namespace Lib
+{
+    // コンストラクタ
+    ParallelRecorder::ParallelRecorder(JobSystem &_jobs)
+        : jobs(_jobs), threadCount(_jobs.getThreadCount()), sliceCount(0), stats{ 0, 0, 0, 0, 0, 0.0f }
+    {
+    }
+
+    // デストラクタ
+    ParallelRecorder::~ParallelRecorder()
+    {
+    }
+
+    // 記録
+    void ParallelRecorder::record(const size_t count, const RecordFunc &func)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        // 区間の数(少なすぎる要素を分けてもジョブの受け渡しの方が高くつく)
+        sliceCount = std::min<size_t>(threadCount, (count + MIN_SLICE - 1) / MIN_SLICE);
+        sliceCount = std::max<size_t>(sliceCount, 1);
+        while (lists.size() < sliceCount) {
+            lists.push_back(std::make_unique<CommandList>());
+        }
+        ordered.clear();
+        for (size_t slice = 0; slice < sliceCount; ++slice) {
+            ordered.push_back(lists[slice].get());
+        }
+
+        auto recordSlice = [&](const size_t slice) {
+            auto &list = *lists[slice];
+            list.reset();
+            func(list, count * slice / sliceCount, count * (slice + 1) / sliceCount);
+        };
+
+        jobs.parallelFor(sliceCount, [&](const size_t begin, const size_t end) {
+            for (size_t slice = begin; slice < end; ++slice) {
+                recordSlice(slice);
+            }
+        });
+
+        stats = Stats{ static_cast<uint32_t>(sliceCount), 0, 0, 0, 0, 0.0f };
+        for (size_t slice = 0; slice < sliceCount; ++slice) {
+            auto &listStats = lists[slice]->getStats();
+            stats.recorded    += listStats.recorded;
+            stats.eliminated  += listStats.eliminated;
+            stats.draws       += listStats.draws;
+            stats.updateBytes += listStats.updateBytes;
+        }
+        stats.recordTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // 区間の順に実行する
+    void ParallelRecorder::submit(RenderContext &context) const
+    {
+        context.executeParallel(ordered);
+    }
+}
@@ -0,0 +1,62 @@
+#pragma once
+#ifndef PARALLELRECORDER_H
+#define PARALLELRECORDER_H
+#include <functional>
+#include <memory>
+#include <vector>
+#include "CommandList.h"
+#include "JobSystem.h"
+
+namespace Lib
+{
+    // 描画対象を連続した区間に分け、スレッドごとのCommandListへ並列に記録する
+    // 区間の順に結合して実行するので、結果はスレッドの実行順に依存しない
+    // 記録はjobsの常駐ワーカーで行い、CommandListと実行順の配列は次のフレームでも使い回す
+    class ParallelRecorder
+    {
+    public:
+        static const size_t MIN_SLICE = 256; // 1区間あたりの最小要素数
+
+        // 統計情報
+        struct Stats
+        {
+            uint32_t slices;
+            uint32_t recorded;
+            uint32_t eliminated;
+            uint32_t draws;
+            uint32_t updateBytes;
+            float    recordTime; // 記録にかかった時間(ミリ秒)
+        };
+
+        // 区間[begin, end)の要素をcommandsへ記録する関数
+        using RecordFunc = std::function<void(CommandList &commands, const size_t begin, const size_t end)>;
+
+        // jobsの寿命はこのオブジェクトより長いこと
+        explicit ParallelRecorder(JobSystem &_jobs);
+        ~ParallelRecorder();
+
+        // count個の要素を記録する(前回の記録は破棄される)
+        void record(const size_t count, const RecordFunc &func);
+        // 区間の順に実行する
+        void submit(RenderContext &context) const;
+
+        size_t             getSliceCount() const { return sliceCount; }
+        const CommandList &getList(const size_t slice) const { return *lists[slice]; }
+        unsigned           getThreadCount() const { return threadCount; }
+        const Stats       &getStats() const { return stats; }
+
+    private:
+        // コピーの禁止
+        ParallelRecorder(const ParallelRecorder &) = delete;
+        ParallelRecorder& operator=(const ParallelRecorder &) = delete;
+
+        JobSystem &jobs;
+        unsigned   threadCount;
+        size_t     sliceCount;
+        std::vector<std::unique_ptr<CommandList>> lists;
+        std::vector<const CommandList*>           ordered; // 実行する区間のリスト(submit()で渡す)
+        Stats      stats;
+    };
+}
+
+#endif
@@ -1,51 +1,80 @@
 struct PS_INPUT
 {
-    float4 Pos : SV_POSITION; // ݂̃sNZʒu
-    float4 PosW : POSITION0;  // IuWFNg̃[hW
-    float4 NorW : NORMAL0;  // @
+    float4 Pos : SV_POSITION; // 現在のピクセル位置
+    float4 PosW : POSITION0;  // オブジェクトのワールド座標
+    float4 NorW : NORMAL0;  // 法線
 };
 
-// _
+// 点光源
 struct Light
 {
-    float4 pos;       // W
-    float4 diffuse;   // gU
-    float4 attenuate; // 
+    float4 pos;       // 座標
+    float4 diffuse;   // 拡散
+    float4 attenuate; // 減衰
 };
 
-// }eA
+// マテリアル
 struct Material
 {
-    float4 ambient;  // 
-    float4 diffuse;  // gU
+    float4 ambient;  // 環境反射
+    float4 diffuse;  // 拡散反射
 };
 
-cbuffer ConstantBuffer : register(b0)
+// フレーム定数(フレームに1回だけ更新)
+cbuffer FrameConstants : register(b0)
 {
+    matrix   View;
+    matrix   Projection;
+    matrix   ViewProjection;
     float4   eyePos;
     float4   ambient;
     Light    pointLight;
+};
+
+// マテリアル定数(内容ごとに作成し、更新しない)
+cbuffer MaterialConstants : register(b1)
+{
     Material material;
 };
 
-float4 PS(PS_INPUT input) : SV_TARGET
+// ランバート反射モデル
+float3 lambert(float3 posW, float3 norW, float3 materialAmbient, float3 materialDiffuse)
 {
-    float3 n;  // Kꂽ@xNg
-    float3 l;  // _̕
-    float  d;  // _̋
-    float  a;  // 
-    float3 iA; // 
-    float3 iD; // gU
+    float3 n;  // 正規化された法線ベクトル
+    float3 l;  // 点光源の方向
+    float  d;  // 点光源の距離
+    float  a;  // 減衰
+    float3 iA; // 環境反射
+    float3 iD; // 拡散反射
 
-    // -- o[g˃f --
-    n = normalize(input.NorW.xyz);
-    l = pointLight.pos.xyz - input.PosW.xyz;
+    n = normalize(norW);
+    l = pointLight.pos.xyz - posW;
     d = length(l);
     l = normalize(l);
     a = saturate(1.0 / (pointLight.attenuate.x + pointLight.attenuate.y * d + pointLight.attenuate.z * d * d));
 
-    iA = material.ambient.xyz * ambient.xyz;
-    iD = saturate(dot(l, n)) * material.diffuse.xyz * pointLight.diffuse.xyz * a;
+    iA = materialAmbient * ambient.xyz;
+    iD = saturate(dot(l, n)) * materialDiffuse * pointLight.diffuse.xyz * a;
+
+    return saturate(iA + iD);
+}
+
+float4 PS(PS_INPUT input) : SV_TARGET
+{
+    return float4(lambert(input.PosW.xyz, input.NorW.xyz, material.ambient.xyz, material.diffuse.xyz), 1.0);
+}
+
+struct PS_INSTANCED_INPUT
+{
+    float4 Pos     : SV_POSITION;
+    float4 PosW    : POSITION0;
+    float4 NorW    : TEXCOORD0;
+    float4 Ambient : COLOR0;   // マテリアル(頂点シェーダーで表から引いたもの)
+    float4 Diffuse : COLOR1;
+};
 
-    return float4(saturate(iA + iD), 1.0);
+// インスタンス描画
+float4 PSInstanced(PS_INSTANCED_INPUT input) : SV_TARGET
+{
+    return float4(lambert(input.PosW.xyz, input.NorW.xyz, input.Ambient.xyz, input.Diffuse.xyz), 1.0);
 }
\ No newline at end of file
@@ -0,0 +1,52 @@
+#include <algorithm>
+#include "PoolAllocator.h"
+
+namespace Lib
+{
+    // コンストラクタ
+    FixedPool::FixedPool(const size_t _blockSize, const size_t _blocksPerChunk)
+        : blockSize(0), blocksPerChunk(std::max<size_t>(_blocksPerChunk, 1)), freeList(nullptr), stats{ 0, 0, 0 }
+    {
+        // フリーリストのポインタが入り、どの型にも使えるようにmax_align_tの倍数に揃える
+        const size_t align = alignof(std::max_align_t);
+        blockSize = (std::max(_blockSize, sizeof(FreeBlock)) + align - 1) / align * align;
+    }
+
+    // 確保
+    void * FixedPool::allocate()
+    {
+        if (freeList == nullptr) {
+            addChunk();
+        }
+        auto block = freeList;
+        freeList = block->next;
+        ++stats.used;
+        stats.highWater = std::max(stats.highWater, stats.used);
+        return block;
+    }
+
+    // 解放
+    void FixedPool::free(void *block)
+    {
+        if (block == nullptr) {
+            return;
+        }
+        auto freeBlock = static_cast<FreeBlock*>(block);
+        freeBlock->next = freeList;
+        freeList = freeBlock;
+        --stats.used;
+    }
+
+    // チャンクを追加して全ブロックをフリーリストへつなぐ
+    void FixedPool::addChunk()
+    {
+        chunks.push_back(std::make_unique<uint8_t[]>(blockSize * blocksPerChunk));
+        auto memory = chunks.back().get();
+        for (size_t i = blocksPerChunk; i > 0; --i) {
+            auto block = reinterpret_cast<FreeBlock*>(memory + (i - 1) * blockSize);
+            block->next = freeList;
+            freeList = block;
+        }
+        ++stats.chunks;
+    }
+}
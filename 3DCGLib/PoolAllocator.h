@@ -0,0 +1,130 @@
+#pragma once
+#ifndef POOLALLOCATOR_H
+#define POOLALLOCATOR_H
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace Lib
+{
+    // 固定サイズのブロックのプール
+    // チャンク単位でまとめて確保し、解放したブロックはフリーリストで再利用する
+    // ※スレッドセーフではない(スレッドごとにプールを持つ)
+    class FixedPool
+    {
+    public:
+        // 統計情報
+        struct Stats
+        {
+            size_t used;      // 使用中のブロック数
+            size_t highWater; // 使用中のブロック数の最大
+            size_t chunks;    // 確保したチャンク数
+        };
+
+        FixedPool(const size_t _blockSize, const size_t _blocksPerChunk = 256);
+
+        void *allocate();
+        void  free(void *block);
+
+        size_t getBlockSize() const { return blockSize; }
+        const Stats &getStats() const { return stats; }
+
+    private:
+        // コピーの禁止
+        FixedPool(const FixedPool &) = delete;
+        FixedPool& operator=(const FixedPool &) = delete;
+
+        void addChunk();
+
+        // 空きブロックの先頭に次の空きブロックへのポインタを置く
+        struct FreeBlock
+        {
+            FreeBlock *next;
+        };
+
+        size_t     blockSize;
+        size_t     blocksPerChunk;
+        FreeBlock *freeList;
+        std::vector<std::unique_ptr<uint8_t[]>> chunks;
+        Stats      stats;
+    };
+
+    // 型付きのオブジェクトプール
+    template <class T>
+    class ObjectPool
+    {
+    public:
+        explicit ObjectPool(const size_t blocksPerChunk = 256)
+            : pool(sizeof(T) < sizeof(void*) ? sizeof(void*) : sizeof(T), blocksPerChunk)
+        {
+        }
+
+        template <class... Args>
+        T *create(Args&&... args)
+        {
+            return new (pool.allocate()) T(std::forward<Args>(args)...);
+        }
+        void destroy(T *object)
+        {
+            if (object != nullptr) {
+                object->~T();
+                pool.free(object);
+            }
+        }
+
+        const FixedPool::Stats &getStats() const { return pool.getStats(); }
+
+    private:
+        FixedPool pool;
+    };
+
+    // FixedPoolから確保するSTLのアロケータ(std::listやstd::mapなどのノード用)
+    // 1要素ずつの確保でブロックに収まるものだけをプールから取り、それ以外はヒープから確保する
+    template <class T>
+    class PoolAllocator
+    {
+    public:
+        using value_type = T;
+
+        PoolAllocator(FixedPool &_pool) : pool(&_pool) {}
+        template <class U>
+        PoolAllocator(const PoolAllocator<U> &other) : pool(other.getPool()) {}
+
+        T *allocate(const size_t count)
+        {
+            if (fits(count)) {
+                return static_cast<T*>(pool->allocate());
+            }
+            return static_cast<T*>(::operator new(sizeof(T) * count));
+        }
+        void deallocate(T *p, const size_t count)
+        {
+            if (fits(count)) {
+                pool->free(p);
+            }
+            else {
+                ::operator delete(p);
+            }
+        }
+
+        FixedPool *getPool() const { return pool; }
+
+        template <class U>
+        bool operator==(const PoolAllocator<U> &other) const { return pool == other.getPool(); }
+        template <class U>
+        bool operator!=(const PoolAllocator<U> &other) const { return pool != other.getPool(); }
+
+    private:
+        bool fits(const size_t count) const
+        {
+            return count == 1 && sizeof(T) <= pool->getBlockSize() && alignof(T) <= alignof(std::max_align_t);
+        }
+
+        FixedPool *pool;
+    };
+}
+
+#endif
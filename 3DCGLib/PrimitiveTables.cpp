@@ -0,0 +1,91 @@
+#include "PrimitiveTables.h"
+#include "MyMath.h"
+
+namespace Lib
+{
+    namespace
+    {
+        // 立方体(24頂点、12三角形)
+        constexpr PrimitiveTable<24, 36> CUBE =
+        {
+            {{
+                { { -1.0f,  1.0f, -1.0f }, {  0.0f,  1.0f,  0.0f} },
+                { {  1.0f,  1.0f, -1.0f }, {  0.0f,  1.0f,  0.0f} },
+                { {  1.0f,  1.0f,  1.0f }, {  0.0f,  1.0f,  0.0f} },
+                { { -1.0f,  1.0f,  1.0f }, {  0.0f,  1.0f,  0.0f} },
+
+                { { -1.0f, -1.0f, -1.0f }, {  0.0f, -1.0f,  0.0f} },
+                { {  1.0f, -1.0f, -1.0f }, {  0.0f, -1.0f,  0.0f} },
+                { {  1.0f, -1.0f,  1.0f }, {  0.0f, -1.0f,  0.0f} },
+                { { -1.0f, -1.0f,  1.0f }, {  0.0f, -1.0f,  0.0f} },
+
+                { { -1.0f, -1.0f,  1.0f }, { -1.0f,  0.0f,  0.0f} },
+                { { -1.0f, -1.0f, -1.0f }, { -1.0f,  0.0f,  0.0f} },
+                { { -1.0f,  1.0f, -1.0f }, { -1.0f,  0.0f,  0.0f} },
+                { { -1.0f,  1.0f,  1.0f }, { -1.0f,  0.0f,  0.0f} },
+
+                { {  1.0f, -1.0f,  1.0f }, {  1.0f,  0.0f,  0.0f} },
+                { {  1.0f, -1.0f, -1.0f }, {  1.0f,  0.0f,  0.0f} },
+                { {  1.0f,  1.0f, -1.0f }, {  1.0f,  0.0f,  0.0f} },
+                { {  1.0f,  1.0f,  1.0f }, {  1.0f,  0.0f,  0.0f} },
+
+                { { -1.0f, -1.0f, -1.0f }, {  0.0f,  0.0f, -1.0f} },
+                { {  1.0f, -1.0f, -1.0f }, {  0.0f,  0.0f, -1.0f} },
+                { {  1.0f,  1.0f, -1.0f }, {  0.0f,  0.0f, -1.0f} },
+                { { -1.0f,  1.0f, -1.0f }, {  0.0f,  0.0f, -1.0f} },
+
+                { { -1.0f, -1.0f,  1.0f }, {  0.0f,  0.0f,  1.0f} },
+                { {  1.0f, -1.0f,  1.0f }, {  0.0f,  0.0f,  1.0f} },
+                { {  1.0f,  1.0f,  1.0f }, {  0.0f,  0.0f,  1.0f} },
+                { { -1.0f,  1.0f,  1.0f }, {  0.0f,  0.0f,  1.0f} },
+            }},
+            {{
+                 3,  1,  0,   2,  1,  3,
+                 6,  4,  5,   7,  4,  6,
+                11,  9,  8,  10,  9, 11,
+                14, 12, 13,  15, 12, 14,
+                19, 17, 16,  18, 17, 19,
+                22, 20, 21,  23, 20, 22,
+            }}
+        };
+
+        // 球体(SEGMENT固定)
+        constexpr auto SPHERE_16 = makeSphereTable<16>();
+        constexpr auto SPHERE_36 = makeSphereTable<36>();
+        constexpr auto SPHERE_64 = makeSphereTable<64>();
+
+        // 正二十面体球(細分化レベル固定)
+        constexpr auto ICOSPHERE_0 = makeIcosphereTable<0>();
+        constexpr auto ICOSPHERE_1 = makeIcosphereTable<1>();
+        constexpr auto ICOSPHERE_2 = makeIcosphereTable<2>();
+        constexpr auto ICOSPHERE_3 = makeIcosphereTable<3>();
+    }
+
+    // 立方体
+    MeshView PrimitiveTables::cube()
+    {
+        return CUBE.view();
+    }
+
+    // 球体
+    bool PrimitiveTables::sphere(const int SEGMENT, MeshView &mesh)
+    {
+        switch (SEGMENT) {
+        case 16: mesh = SPHERE_16.view(); return true;
+        case 36: mesh = SPHERE_36.view(); return true;
+        case 64: mesh = SPHERE_64.view(); return true;
+        default: return false;
+        }
+    }
+
+    // 正二十面体球
+    MeshView PrimitiveTables::icosphere(const int level)
+    {
+        switch (MyMath::clamp(level, ICOSPHERE_MAX_LEVEL, 0)) {
+        case 0:  return ICOSPHERE_0.view();
+        case 1:  return ICOSPHERE_1.view();
+        case 2:  return ICOSPHERE_2.view();
+        default: return ICOSPHERE_3.view();
+        }
+    }
+}
@@ -0,0 +1,241 @@
+#pragma once
+#ifndef PRIMITIVETABLES_H
+#define PRIMITIVETABLES_H
+#include <array>
+#include <cstdint>
+#include "MeshData.h"
+
+namespace Lib
+{
+    // コンパイル時計算用の数学関数
+    class ConstMath
+    {
+    public:
+        static constexpr double PI = 3.14159265358979323846;
+
+        // 正弦(テイラー展開)
+        static constexpr double sin(double x)
+        {
+            // [-PI, PI]に正規化
+            while (x >  PI) { x -= 2.0 * PI; }
+            while (x < -PI) { x += 2.0 * PI; }
+            double term   = x;
+            double result = x;
+            for (int n = 1; n < 12; ++n) {
+                term   *= -x * x / ((2.0 * n) * (2.0 * n + 1.0));
+                result += term;
+            }
+            return result;
+        }
+
+        // 余弦
+        static constexpr double cos(const double x)
+        {
+            return sin(x + PI / 2.0);
+        }
+
+        // 平方根(ニュートン法)
+        static constexpr double sqrt(const double x)
+        {
+            if (x <= 0.0) {
+                return 0.0;
+            }
+            double r = x > 1.0 ? x : 1.0;
+            for (int i = 0; i < 64; ++i) {
+                double next = 0.5 * (r + x / r);
+                if (next == r) {
+                    break;
+                }
+                r = next;
+            }
+            return r;
+        }
+    };
+
+    // コンパイル時に生成されるメッシュ
+    template <int VERTEX, int INDEX>
+    struct PrimitiveTable
+    {
+        std::array<SimpleVertex, VERTEX> vertices;
+        std::array<uint16_t, INDEX>      indices;
+
+        MeshView view() const
+        {
+            return MeshView{ vertices.data(), static_cast<uint32_t>(VERTEX), indices.data(), static_cast<uint32_t>(INDEX), IndexFormat::UInt16 };
+        }
+    };
+
+    // 球体(MeshData::createSphere()と同じ頂点・インデックスの並び)
+    template <int SEGMENT>
+    using SphereTable = PrimitiveTable<(SEGMENT + 1) * (SEGMENT / 2 + 1), SEGMENT * 3 + SEGMENT * (SEGMENT / 2 - 1) * 6>;
+
+    template <int SEGMENT>
+    constexpr SphereTable<SEGMENT> makeSphereTable()
+    {
+        static_assert(SEGMENT >= 4 && SEGMENT % 2 == 0, "SEGMENT must be an even number >= 4");
+        static_assert((SEGMENT + 1) * (SEGMENT / 2 + 1) <= 0xFFFF, "too many vertices for 16bit indices");
+
+        SphereTable<SEGMENT> table{};
+
+        // 緯度・経度ごとの三角関数は一度だけ求める
+        double cosTable[SEGMENT + 1] = {};
+        double sinTable[SEGMENT + 1] = {};
+        for (int k = 0; k <= SEGMENT; ++k) {
+            double rad = ConstMath::PI * 2.0 / SEGMENT * k;
+            cosTable[k] = ConstMath::cos(rad);
+            sinTable[k] = ConstMath::sin(rad);
+        }
+
+        // std::array::operator[]は評価ステップが多いので先頭ポインタで書き込む
+        SimpleVertex *v = table.vertices.data();
+        for (int i = 0; i <= SEGMENT / 2; ++i) {
+            double y = cosTable[i];
+            double r = sinTable[i];
+            for (int j = 0; j <= SEGMENT; ++j, ++v) {
+                v->pos[0] = v->normal[0] = static_cast<float>(r * cosTable[j]);
+                v->pos[1] = v->normal[1] = static_cast<float>(y);
+                v->pos[2] = v->normal[2] = static_cast<float>(r * sinTable[j]);
+            }
+        }
+
+        uint16_t *index = table.indices.data();
+        for (int j = 0; j < SEGMENT; ++j) {
+            index[0] = static_cast<uint16_t>(j);
+            index[1] = static_cast<uint16_t>((SEGMENT + 1) + j + 1);
+            index[2] = static_cast<uint16_t>((SEGMENT + 1) + j);
+            index += 3;
+        }
+        for (int i = 1; i < SEGMENT / 2; ++i) {
+            for (int j = 0; j < SEGMENT; ++j) {
+                const int top    = i * (SEGMENT + 1) + j;
+                const int bottom = top + (SEGMENT + 1);
+                index[0] = static_cast<uint16_t>(top);
+                index[1] = static_cast<uint16_t>(top + 1);
+                index[2] = static_cast<uint16_t>(bottom);
+                index[3] = static_cast<uint16_t>(top + 1);
+                index[4] = static_cast<uint16_t>(bottom + 1);
+                index[5] = static_cast<uint16_t>(bottom);
+                index += 6;
+            }
+        }
+
+        return table;
+    }
+
+    // 正二十面体を細分化した球体
+    template <int LEVEL>
+    using IcosphereTable = PrimitiveTable<10 * (1 << (2 * LEVEL)) + 2, 60 * (1 << (2 * LEVEL))>;
+
+    template <int LEVEL>
+    constexpr IcosphereTable<LEVEL> makeIcosphereTable()
+    {
+        constexpr int VERTEX = 10 * (1 << (2 * LEVEL)) + 2;
+        constexpr int INDEX  = 60 * (1 << (2 * LEVEL));
+        constexpr int DEGREE = 6; // 1頂点あたりの最大辺数
+
+        // 位置はdoubleで計算し、最後にfloatへ変換する
+        // (作業領域はstd::arrayではなく配列にして評価ステップを抑える)
+        double   pos[VERTEX * 3] = {};
+        uint16_t tri[2][INDEX]   = {};
+        int vertexCount = 0;
+        int indexCount  = 0;
+
+        auto addVertex = [&](double x, double y, double z) {
+            double len = ConstMath::sqrt(x * x + y * y + z * z);
+            pos[vertexCount * 3 + 0] = x / len;
+            pos[vertexCount * 3 + 1] = y / len;
+            pos[vertexCount * 3 + 2] = z / len;
+            return static_cast<uint16_t>(vertexCount++);
+        };
+
+        // 正二十面体
+        const double t = (1.0 + ConstMath::sqrt(5.0)) / 2.0;
+        addVertex(-1,  t,  0); addVertex( 1,  t,  0); addVertex(-1, -t,  0); addVertex( 1, -t,  0);
+        addVertex( 0, -1,  t); addVertex( 0,  1,  t); addVertex( 0, -1, -t); addVertex( 0,  1, -t);
+        addVertex( t,  0, -1); addVertex( t,  0,  1); addVertex(-t,  0, -1); addVertex(-t,  0,  1);
+        const uint16_t FACES[60] =
+        {
+            0, 11,  5,   0,  5,  1,   0,  1,  7,   0,  7, 10,   0, 10, 11,
+            1,  5,  9,   5, 11,  4,  11, 10,  2,  10,  7,  6,   7,  1,  8,
+            3,  9,  4,   3,  4,  2,   3,  2,  6,   3,  6,  8,   3,  8,  9,
+            4,  9,  5,   2,  4, 11,   6,  2, 10,   8,  6,  7,   9,  8,  1,
+        };
+        for (int i = 0; i < 60; ++i) {
+            tri[0][indexCount++] = FACES[i];
+        }
+
+        // 各辺を4分割(中点は頂点ごとの隣接表で共有する)
+        for (int level = 0; level < LEVEL; ++level) {
+            uint16_t neighbor[VERTEX * DEGREE] = {};
+            uint16_t midpoint[VERTEX * DEGREE] = {};
+            uint8_t  degree[VERTEX]            = {};
+
+            auto split = [&](uint16_t a, uint16_t b) {
+                uint16_t lo = a < b ? a : b;
+                uint16_t hi = a < b ? b : a;
+                for (int k = 0; k < degree[lo]; ++k) {
+                    if (neighbor[lo * DEGREE + k] == hi) {
+                        return midpoint[lo * DEGREE + k];
+                    }
+                }
+                uint16_t m = addVertex(
+                    pos[a * 3 + 0] + pos[b * 3 + 0],
+                    pos[a * 3 + 1] + pos[b * 3 + 1],
+                    pos[a * 3 + 2] + pos[b * 3 + 2]);
+                neighbor[lo * DEGREE + degree[lo]] = hi;
+                midpoint[lo * DEGREE + degree[lo]] = m;
+                ++degree[lo];
+                return m;
+            };
+
+            // 2つのバッファを交互に使う
+            const uint16_t *src = tri[level % 2];
+            uint16_t       *dst = tri[(level + 1) % 2];
+            for (int i = 0; i < indexCount; i += 3) {
+                uint16_t a  = src[i];
+                uint16_t b  = src[i + 1];
+                uint16_t c  = src[i + 2];
+                uint16_t ab = split(a, b);
+                uint16_t bc = split(b, c);
+                uint16_t ca = split(c, a);
+                dst[0] = a;  dst[1]  = ab; dst[2]  = ca;
+                dst[3] = b;  dst[4]  = bc; dst[5]  = ab;
+                dst[6] = c;  dst[7]  = ca; dst[8]  = bc;
+                dst[9] = ab; dst[10] = bc; dst[11] = ca;
+                dst += 12;
+            }
+            indexCount *= 4;
+        }
+
+        IcosphereTable<LEVEL> table{};
+        SimpleVertex *vertices = table.vertices.data();
+        for (int i = 0; i < VERTEX; ++i) {
+            for (int k = 0; k < 3; ++k) {
+                vertices[i].pos[k]    = static_cast<float>(pos[i * 3 + k]);
+                vertices[i].normal[k] = static_cast<float>(pos[i * 3 + k]);
+            }
+        }
+        // 巻き順は立方体・球体と同じ
+        uint16_t *indices = table.indices.data();
+        for (int i = 0; i < INDEX; ++i) {
+            indices[i] = tri[LEVEL % 2][i];
+        }
+        return table;
+    }
+
+    // 静的な読み込み専用データとして埋め込まれた基本形状
+    class PrimitiveTables
+    {
+    public:
+        static const int ICOSPHERE_MAX_LEVEL = 3;
+
+        // 立方体
+        static MeshView cube();
+        // 球体(SEGMENTが16, 36, 64の場合のみ。見つかればtrue)
+        static bool sphere(const int SEGMENT, MeshView &mesh);
+        // 正二十面体球(levelは0～ICOSPHERE_MAX_LEVEL)
+        static MeshView icosphere(const int level);
+    };
+}
+
+#endif
@@ -0,0 +1,306 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <thread>
+#include <unordered_map>
+#include "Profiler.h"
+
+namespace Lib
+{
+    namespace
+    {
+        const uint32_t PROFILE_FILE_VERSION = 1;
+
+        // リングを作る前に設定されたスレッドの名前(計測しないスレッドにはリングを作らない)
+        thread_local std::string threadName;
+
+        // JSONの文字列として書き出す
+        void writeJsonString(std::ofstream &ofs, const char *text)
+        {
+            ofs.put('"');
+            for (auto p = text; *p != '\0'; ++p) {
+                char c = *p;
+                if (c == '"' || c == '\\') {
+                    ofs.put('\\');
+                    ofs.put(c);
+                }
+                else if (static_cast<unsigned char>(c) < 0x20) {
+                    char escaped[8];
+                    snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                    ofs << escaped;
+                }
+                else {
+                    ofs.put(c);
+                }
+            }
+            ofs.put('"');
+        }
+
+        // uint16_tの長さ + 文字列として書き出す
+        void writeString(std::ofstream &ofs, const std::string &text)
+        {
+            auto length = static_cast<uint16_t>(std::min<size_t>(text.size(), UINT16_MAX));
+            ofs.write(reinterpret_cast<const char*>(&length), sizeof(length));
+            ofs.write(text.data(), length);
+        }
+    }
+
+    thread_local uint32_t ProfileScope::depth = 0;
+
+    // スレッドが終了した時にリングを返す
+    struct Profiler::ThreadSlot
+    {
+        Profiler     *profiler = nullptr;
+        ThreadBuffer *buffer   = nullptr;
+        uint32_t      index    = 0;
+        bool          full     = false;
+
+        ~ThreadSlot()
+        {
+            if (buffer != nullptr) {
+                profiler->releaseThreadBuffer(index);
+            }
+        }
+    };
+
+    // コンストラクタ
+    Profiler::Profiler()
+        : enabled(false), threadCount(0), startTime(now())
+    {
+        for (auto &buffer : buffers) {
+            buffer = nullptr;
+        }
+    }
+
+    // デストラクタ
+    Profiler::~Profiler()
+    {
+        for (auto &buffer : buffers) {
+            delete buffer.exchange(nullptr);
+        }
+    }
+
+    // 計測の有効・無効
+    void Profiler::setEnabled(const bool _enabled)
+    {
+        enabled.store(_enabled, std::memory_order_relaxed);
+    }
+
+    // 現在の時刻
+    uint64_t Profiler::now()
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    // 区間の記録
+    void Profiler::record(const char *name, const uint64_t begin, const uint64_t end, const uint32_t depth)
+    {
+        auto buffer = getThreadBuffer();
+        if (buffer == nullptr) {
+            return;
+        }
+        // 書き込むのはこのスレッドだけなので、読み込み側へ見えるようにheadをreleaseで進めるだけでよい
+        auto head  = buffer->head.load(std::memory_order_relaxed);
+        auto &event = buffer->events[head % EVENTS_PER_THREAD];
+        event.name     = name;
+        event.begin    = begin;
+        event.duration = static_cast<uint32_t>(std::min<uint64_t>(end - begin, UINT32_MAX));
+        event.depth    = depth;
+        buffer->head.store(head + 1, std::memory_order_release);
+    }
+
+    // スレッドの名前
+    void Profiler::setThreadName(const std::string &name)
+    {
+        threadName = name;
+        std::lock_guard<std::mutex> lock(nameMutex);
+        for (auto &buffer : buffers) {
+            auto p = buffer.load(std::memory_order_acquire);
+            if (p != nullptr && p->owner == std::this_thread::get_id()) {
+                p->name = name;
+            }
+        }
+    }
+
+    // 記録を全て捨てる
+    void Profiler::clear()
+    {
+        for (auto &buffer : buffers) {
+            if (auto p = buffer.load(std::memory_order_acquire)) {
+                p->head.store(0, std::memory_order_release);
+            }
+        }
+    }
+
+    // Chromeのトレース形式で書き出す
+    bool Profiler::exportChromeTrace(const std::string &path) const
+    {
+        std::ofstream ofs(path, std::ios::trunc);
+        if (!ofs) {
+            return false;
+        }
+
+        auto threads = collect();
+        char number[128];
+        ofs << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        bool first = true;
+        for (size_t tid = 0; tid < threads.size(); ++tid) {
+            auto buffer = buffers[tid].load(std::memory_order_acquire);
+            if (buffer == nullptr) {
+                continue;
+            }
+            // スレッド名
+            {
+                std::lock_guard<std::mutex> lock(nameMutex);
+                snprintf(number, sizeof(number), "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%zu,\"args\":{\"name\":", first ? "" : ",", tid);
+                ofs << number;
+                writeJsonString(ofs, buffer->name.c_str());
+                ofs << "}}";
+                first = false;
+            }
+            // 区間(開始時刻はマイクロ秒)
+            for (auto &event : threads[tid]) {
+                ofs << ",\n{\"name\":";
+                writeJsonString(ofs, event.name);
+                double ts = event.begin >= startTime ? (event.begin - startTime) / 1000.0 : 0.0;
+                snprintf(number, sizeof(number), ",\"ph\":\"X\",\"pid\":1,\"tid\":%zu,\"ts\":%.3f,\"dur\":%.3f}", tid, ts, event.duration / 1000.0);
+                ofs << number;
+            }
+        }
+        ofs << "\n]}\n";
+        return static_cast<bool>(ofs);
+    }
+
+    // バイナリ形式で書き出す
+    bool Profiler::exportBinary(const std::string &path) const
+    {
+        auto threads = collect();
+
+        // 名前は同じ文字列を1つにまとめて番号で参照する
+        std::vector<std::string>                  names;
+        std::unordered_map<std::string, uint16_t> nameIndices;
+        std::vector<ProfileFileEvent>             events;
+        for (size_t tid = 0; tid < threads.size(); ++tid) {
+            for (auto &event : threads[tid]) {
+                auto found = nameIndices.find(event.name);
+                if (found == nameIndices.end()) {
+                    found = nameIndices.emplace(event.name, static_cast<uint16_t>(names.size())).first;
+                    names.push_back(event.name);
+                }
+                ProfileFileEvent fileEvent;
+                fileEvent.begin    = event.begin >= startTime ? event.begin - startTime : 0;
+                fileEvent.duration = event.duration;
+                fileEvent.name     = found->second;
+                fileEvent.thread   = static_cast<uint8_t>(tid);
+                fileEvent.depth    = static_cast<uint8_t>(std::min<uint32_t>(event.depth, UINT8_MAX));
+                events.push_back(fileEvent);
+            }
+        }
+
+        ProfileFileHeader header;
+        std::memcpy(header.magic, "LPRF", sizeof(header.magic));
+        header.version     = PROFILE_FILE_VERSION;
+        header.headerSize  = sizeof(ProfileFileHeader);
+        header.nameCount   = static_cast<uint32_t>(names.size());
+        header.threadCount = static_cast<uint32_t>(threads.size());
+        header.eventCount  = static_cast<uint32_t>(events.size());
+        header.startTime   = startTime;
+
+        std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+        if (!ofs) {
+            return false;
+        }
+        ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        for (auto &name : names) {
+            writeString(ofs, name);
+        }
+        {
+            std::lock_guard<std::mutex> lock(nameMutex);
+            for (size_t tid = 0; tid < threads.size(); ++tid) {
+                auto buffer = buffers[tid].load(std::memory_order_acquire);
+                writeString(ofs, buffer != nullptr ? buffer->name : std::string());
+            }
+        }
+        ofs.write(reinterpret_cast<const char*>(events.data()), static_cast<std::streamsize>(events.size() * sizeof(ProfileFileEvent)));
+        return static_cast<bool>(ofs);
+    }
+
+    // 統計情報
+    Profiler::Stats Profiler::getStats() const
+    {
+        Stats stats = { 0, 0, 0 };
+        for (auto &buffer : buffers) {
+            if (auto p = buffer.load(std::memory_order_acquire)) {
+                auto head = p->head.load(std::memory_order_acquire);
+                stats.recorded    += head;
+                stats.overwritten += head > EVENTS_PER_THREAD ? head - EVENTS_PER_THREAD : 0;
+                ++stats.threads;
+            }
+        }
+        return stats;
+    }
+
+    // 呼び出したスレッドのリング
+    Profiler::ThreadBuffer * Profiler::getThreadBuffer()
+    {
+        thread_local ThreadSlot slot;
+        if (slot.buffer == nullptr && !slot.full) {
+            std::lock_guard<std::mutex> lock(slotMutex);
+            if (!freeSlots.empty()) {
+                // 終了したスレッドのリングを空にして使う(残っていた記録は捨てる)
+                slot.index  = freeSlots.back();
+                slot.buffer = buffers[slot.index].load(std::memory_order_relaxed);
+                freeSlots.pop_back();
+                slot.buffer->head.store(0, std::memory_order_release);
+            }
+            else {
+                auto index = threadCount.load(std::memory_order_relaxed);
+                if (index >= MAX_THREADS) {
+                    slot.full = true;
+                    return nullptr;
+                }
+                slot.index  = index;
+                slot.buffer = new ThreadBuffer();
+                slot.buffer->head = 0;
+                buffers[index].store(slot.buffer, std::memory_order_release);
+                threadCount.store(index + 1, std::memory_order_release);
+            }
+            slot.profiler = this;
+
+            std::lock_guard<std::mutex> nameLock(nameMutex);
+            slot.buffer->owner = std::this_thread::get_id();
+            slot.buffer->name  = threadName.empty() ? "thread " + std::to_string(slot.index) : threadName;
+        }
+        return slot.buffer;
+    }
+
+    // 終了したスレッドのリングを返す
+    void Profiler::releaseThreadBuffer(const uint32_t index)
+    {
+        std::lock_guard<std::mutex> lock(slotMutex);
+        freeSlots.push_back(index);
+    }
+
+    // スレッドごとに記録の残っているイベントを古い順に集める
+    // ※記録中のスレッドがあると、リングを一周して上書きされた直後の古いイベントが混ざることがある
+    std::vector<std::vector<Profiler::Event>> Profiler::collect() const
+    {
+        auto count = std::min(threadCount.load(), MAX_THREADS);
+        std::vector<std::vector<Event>> threads(count);
+        for (uint32_t tid = 0; tid < count; ++tid) {
+            auto buffer = buffers[tid].load(std::memory_order_acquire);
+            if (buffer == nullptr) {
+                continue;
+            }
+            auto head  = buffer->head.load(std::memory_order_acquire);
+            auto first = head > EVENTS_PER_THREAD ? head - EVENTS_PER_THREAD : 0;
+            threads[tid].reserve(static_cast<size_t>(head - first));
+            for (auto i = first; i < head; ++i) {
+                threads[tid].push_back(buffer->events[i % EVENTS_PER_THREAD]);
+            }
+        }
+        return threads;
+    }
+}
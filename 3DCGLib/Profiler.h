@@ -0,0 +1,159 @@
+#pragma once
+#ifndef PROFILER_H
+#define PROFILER_H
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Singleton.h"
+
+namespace Lib
+{
+    // プロファイルのバイナリ形式のファイルヘッダー(ファイル先頭にそのまま配置される)
+    // ヘッダーの後に名前の表(nameCount個。uint16_tの長さ + 文字列)、スレッド名の表(threadCount個。同じ形式)、
+    // ProfileFileEventの配列(eventCount個)が続く
+    struct ProfileFileHeader
+    {
+        char     magic[4];    // "LPRF"
+        uint32_t version;
+        uint32_t headerSize;
+        uint32_t nameCount;
+        uint32_t threadCount;
+        uint32_t eventCount;
+        uint64_t startTime;   // 計測開始の時刻(steady_clockのナノ秒)
+    };
+
+    // プロファイルのバイナリ形式のイベント
+    struct ProfileFileEvent
+    {
+        uint64_t begin;    // startTimeからのナノ秒
+        uint32_t duration; // ナノ秒(約4.3秒で飽和する)
+        uint16_t name;     // 名前の表の番号
+        uint8_t  thread;   // スレッド名の表の番号
+        uint8_t  depth;    // 同じスレッドで囲んでいる区間の数
+    };
+
+    // 区間の計測を記録するプロファイラ
+    //
+    // スレッドごとにリングバッファを持ち、記録にロックは要らない(いっぱいになると古いものから上書きする)
+    // 時刻はsteady_clockのナノ秒。区間の名前は文字列リテラルなど、プログラムの終了まで有効なものを渡すこと
+    // 無効の間はProfileScopeは時刻も取らない
+    class Profiler : public Singleton<Profiler>
+    {
+    public:
+        static const uint32_t EVENTS_PER_THREAD = 64 * 1024; // スレッドごとのリングの大きさ
+        static const uint32_t MAX_THREADS       = 64;
+
+        // 1つの区間
+        struct Event
+        {
+            const char *name;
+            uint64_t    begin;    // ナノ秒
+            uint32_t    duration; // ナノ秒
+            uint32_t    depth;
+        };
+
+        // 統計情報
+        struct Stats
+        {
+            uint64_t recorded;    // 記録した区間の数
+            uint64_t overwritten; // リングが一周して上書きされた区間の数
+            uint32_t threads;     // リングの数(終了したスレッドのリングは次のスレッドが使い回す)
+        };
+
+        ~Profiler();
+
+        void setEnabled(const bool _enabled);
+        bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+
+        // 現在の時刻(ナノ秒)
+        static uint64_t now();
+        // 区間を記録する(呼び出したスレッドのリングへ)
+        void record(const char *name, const uint64_t begin, const uint64_t end, const uint32_t depth);
+        // 呼び出したスレッドの名前(書き出し時に使う)
+        void setThreadName(const std::string &name);
+        // 記録を全て捨てる(どのスレッドも記録していない時に呼ぶ)
+        void clear();
+
+        // Chromeのトレース形式(chrome://tracing、Perfettoで開ける)で書き出す
+        bool exportChromeTrace(const std::string &path) const;
+        // バイナリ形式で書き出す
+        bool exportBinary(const std::string &path) const;
+
+        Stats getStats() const;
+
+    private:
+        friend class Singleton<Profiler>;
+        Profiler();
+
+        // スレッドごとの記録
+        struct ThreadBuffer
+        {
+            std::array<Event, EVENTS_PER_THREAD> events;
+            std::atomic<uint64_t>                head; // 記録した数(次に書く位置)
+            std::string                          name;
+            std::thread::id                      owner;
+        };
+
+        // スレッドが終了した時にリングを返す
+        struct ThreadSlot;
+
+        // 呼び出したスレッドのリング(初めての呼び出しで空いたものを借りるか作る。MAX_THREADSを超えたらnullptr)
+        ThreadBuffer *getThreadBuffer();
+        // 終了したスレッドのリングを次のスレッドへ回す
+        void releaseThreadBuffer(const uint32_t index);
+        // 書き出すイベントをスレッドごとに集める
+        std::vector<std::vector<Event>> collect() const;
+
+        std::atomic<bool>     enabled;
+        std::atomic<uint32_t> threadCount;
+        std::array<std::atomic<ThreadBuffer*>, MAX_THREADS> buffers; // 作成したスレッドが設定し、デストラクタで解放する
+        std::mutex            slotMutex;
+        std::vector<uint32_t> freeSlots; // 終了したスレッドのリングの番号
+        mutable std::mutex    nameMutex;
+        uint64_t              startTime;
+    };
+
+    // スコープの間を1つの区間として記録する
+    class ProfileScope
+    {
+    public:
+        explicit ProfileScope(const char *_name)
+            : name(_name), begin(0), level(0)
+        {
+            if (Profiler::getInstance().isEnabled()) {
+                level = depth++;
+                begin = Profiler::now();
+            }
+        }
+        ~ProfileScope()
+        {
+            if (begin != 0) {
+                auto end = Profiler::now();
+                --depth;
+                Profiler::getInstance().record(name, begin, end, level);
+            }
+        }
+
+    private:
+        // コピーの禁止
+        ProfileScope(const ProfileScope &) = delete;
+        ProfileScope& operator=(const ProfileScope &) = delete;
+
+        static thread_local uint32_t depth; // このスレッドで計測中の区間の数
+
+        const char *name;
+        uint64_t    begin;
+        uint32_t    level;
+    };
+}
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b)  PROFILE_CONCAT_(a, b)
+// 現在のスコープを名前nameの区間として計測する
+#define PROFILE_SCOPE(name) ::Lib::ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+
+#endif
@@ -0,0 +1,50 @@
+#pragma once
+#ifndef RENDERDEVICE_H
+#define RENDERDEVICE_H
+#include <cstddef>
+#include <cstdint>
+
+namespace Lib
+{
+    // GPUリソースの種類
+    enum class ResourceType : uint8_t
+    {
+        VertexShader,
+        PixelShader,
+        InputLayout,
+        VertexBuffer,
+        IndexBuffer,
+        ConstantBuffer,
+        UploadBuffer,   // CPUから毎フレーム書き込む定数バッファ(UploadRing用)
+        Count,
+    };
+
+    // 頂点レイアウト
+    enum class VertexLayout : uint32_t
+    {
+        PositionNormal,          // SimpleVertex
+        PositionNormalInstanced, // SimpleVertex + InstanceData(スロット1)
+    };
+
+    // バックエンド固有のオブジェクト(D3D11ではID3D11*、Nullでは連番)
+    using NativeResource = void*;
+
+    // リソース生成を行うバックエンドのインターフェース
+    // 生成したオブジェクトの所有権は呼び出し側に移り、release()で解放する
+    class RenderDevice
+    {
+    public:
+        virtual ~RenderDevice() {}
+
+        // シェーダーの作成(typeはVertexShaderかPixelShader)
+        virtual NativeResource createShader(const ResourceType type, const void *bytecode, const size_t size) = 0;
+        // 入力レイアウトの作成(bytecodeは頂点シェーダー)
+        virtual NativeResource createInputLayout(const VertexLayout layout, const void *bytecode, const size_t size) = 0;
+        // バッファの作成(typeはVertexBuffer, IndexBuffer, ConstantBuffer, UploadBuffer。initDataはnullptr可)
+        virtual NativeResource createBuffer(const ResourceType type, const uint32_t byteWidth, const void *initData) = 0;
+        // 解放
+        virtual void release(const ResourceType type, NativeResource resource) = 0;
+    };
+}
+
+#endif
@@ -0,0 +1,208 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include "RenderQueue.h"
+
+namespace Lib
+{
+    namespace
+    {
+        const uint32_t STATE_BITS = RenderQueue::SHADER_BITS + RenderQueue::MATERIAL_BITS + RenderQueue::MESH_BITS;
+        const uint64_t STATE_MASK = (1ULL << STATE_BITS) - 1;
+
+        // 状態部分(shader | material | mesh)
+        uint64_t packState(const uint32_t shader, const uint32_t material, const uint32_t mesh)
+        {
+            const uint64_t shaderMask   = (1ULL << RenderQueue::SHADER_BITS)   - 1;
+            const uint64_t materialMask = (1ULL << RenderQueue::MATERIAL_BITS) - 1;
+            const uint64_t meshMask     = (1ULL << RenderQueue::MESH_BITS)     - 1;
+            return ((shader   & shaderMask)   << (RenderQueue::MATERIAL_BITS + RenderQueue::MESH_BITS))
+                 | ((material & materialMask) << RenderQueue::MESH_BITS)
+                 |  (mesh     & meshMask);
+        }
+    }
+
+    // コンストラクタ
+    RenderQueue::RenderQueue()
+        : stats{ 0, 0, 0, 0, 0.0f }
+    {
+    }
+
+    // 不透明のキー
+    uint64_t RenderQueue::makeOpaqueKey(const uint32_t shader, const uint32_t material, const uint32_t mesh, const float depth)
+    {
+        uint64_t quantized = quantizeDepth(depth);
+        uint64_t bucket    = quantized >> (DEPTH_BITS - DEPTH_BUCKET_BITS);
+        return (static_cast<uint64_t>(RenderLayer::Opaque) << 62)
+             | (bucket << (62 - DEPTH_BUCKET_BITS))
+             | (packState(shader, material, mesh) << DEPTH_BITS)
+             | quantized;
+    }
+
+    // 半透明のキー
+    uint64_t RenderQueue::makeTransparentKey(const uint32_t shader, const uint32_t material, const uint32_t mesh, const float depth)
+    {
+        uint64_t inverted = ((1ULL << DEPTH_BITS) - 1) - quantizeDepth(depth);
+        return (static_cast<uint64_t>(RenderLayer::Transparent) << 62)
+             | (inverted << (62 - DEPTH_BITS))
+             | (packState(shader, material, mesh) << 4);
+    }
+
+    // 任意の層のキー
+    uint64_t RenderQueue::makeKey(const RenderLayer layer, const uint64_t order)
+    {
+        return (static_cast<uint64_t>(layer) << 62) | (order & ((1ULL << 62) - 1));
+    }
+
+    // AABBの最も手前の点の深度
+    float RenderQueue::nearestViewDepth(const Matrix &view, const float min[3], const float max[3])
+    {
+        // ビュー空間のzは各軸について独立なので、係数の符号で小さくなる側を選ぶ
+        float x = view.m13 > 0.0f ? min[0] : max[0];
+        float y = view.m23 > 0.0f ? min[1] : max[1];
+        float z = view.m33 > 0.0f ? min[2] : max[2];
+        return x * view.m13 + y * view.m23 + z * view.m33 + view.m43;
+    }
+
+    // キーから状態の部分を取り出す(層も含める)
+    uint64_t RenderQueue::getStateBits(const uint64_t key)
+    {
+        auto layer = static_cast<RenderLayer>(key >> 62);
+        uint64_t state = 0;
+        switch (layer) {
+        case RenderLayer::Opaque:      state = (key >> DEPTH_BITS) & STATE_MASK; break;
+        case RenderLayer::Transparent: state = (key >> 4) & STATE_MASK;          break;
+        default:                       break;
+        }
+        return (static_cast<uint64_t>(layer) << STATE_BITS) | state;
+    }
+
+    // 隣り合う要素で状態が変わる回数
+    uint32_t RenderQueue::countStateChanges(const std::vector<Item> &items)
+    {
+        uint32_t changes = 0;
+        for (size_t i = 0; i < items.size(); ++i) {
+            if (i == 0 || getStateBits(items[i].key) != getStateBits(items[i - 1].key)) {
+                ++changes;
+            }
+        }
+        return changes;
+    }
+
+    // 全要素の削除(確保済みのメモリは再利用する)
+    void RenderQueue::clear()
+    {
+        items.clear();
+    }
+
+    // 追加
+    void RenderQueue::push(const uint64_t key, const uint32_t index)
+    {
+        items.push_back(Item{ key, index });
+    }
+
+    // 基数ソート(8bitずつ、下位から安定に並べる)
+    void RenderQueue::sort()
+    {
+        auto start = std::chrono::steady_clock::now();
+        const size_t count = items.size();
+        stats.items              = static_cast<uint32_t>(count);
+        stats.stateChangesBefore = countStateChanges(items);
+        stats.radixPasses        = 0;
+
+        // 全桁のヒストグラムを一度に求める
+        std::array<std::array<uint32_t, 256>, 8> histograms = {};
+        for (auto &item : items) {
+            for (int pass = 0; pass < 8; ++pass) {
+                ++histograms[pass][(item.key >> (pass * 8)) & 0xFF];
+            }
+        }
+
+        scratch.resize(count);
+        for (int pass = 0; pass < 8; ++pass) {
+            auto &histogram = histograms[pass];
+            // 全要素が同じ値の桁は並べ替える必要がない
+            if (count == 0 || histogram[(items[0].key >> (pass * 8)) & 0xFF] == count) {
+                continue;
+            }
+            uint32_t offset = 0;
+            for (auto &bucket : histogram) {
+                auto n = bucket;
+                bucket = offset;
+                offset += n;
+            }
+            for (auto &item : items) {
+                scratch[histogram[(item.key >> (pass * 8)) & 0xFF]++] = item;
+            }
+            items.swap(scratch);
+            ++stats.radixPasses;
+        }
+
+        stats.stateChangesAfter = countStateChanges(items);
+        stats.sortTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // 深度の量子化
+    uint32_t RenderQueue::quantizeDepth(const float depth)
+    {
+        const float maxValue = static_cast<float>((1u << DEPTH_BITS) - 1);
+        float d = std::min(std::max(depth, 0.0f), 1.0f);
+        return static_cast<uint32_t>(d * maxValue);
+    }
+
+    // コンストラクタ
+    OverdrawEstimator::OverdrawEstimator(const int _width, const int _height)
+        : width(_width), height(_height), depthBuffer(static_cast<size_t>(_width * _height), 1.0f), shaded(0)
+    {
+    }
+
+    // クリア
+    void OverdrawEstimator::clear()
+    {
+        std::fill(depthBuffer.begin(), depthBuffer.end(), 1.0f);
+        shaded = 0;
+    }
+
+    // 矩形の描画
+    uint32_t OverdrawEstimator::draw(const float minX, const float minY, const float maxX, const float maxY, const float depth)
+    {
+        // NDC(-1～1)をタイル座標へ
+        auto toTile = [](const float v, const int size) {
+            int t = static_cast<int>((v * 0.5f + 0.5f) * size);
+            return std::min(std::max(t, 0), size - 1);
+        };
+        if (maxX < -1.0f || minX > 1.0f || maxY < -1.0f || minY > 1.0f) {
+            return 0;
+        }
+        int x0 = toTile(minX, width);
+        int x1 = toTile(maxX, width);
+        int y0 = toTile(minY, height);
+        int y1 = toTile(maxY, height);
+
+        uint32_t passed = 0;
+        for (int y = y0; y <= y1; ++y) {
+            for (int x = x0; x <= x1; ++x) {
+                auto &d = depthBuffer[y * width + x];
+                if (depth < d) {
+                    d = depth;
+                    ++passed;
+                }
+            }
+        }
+        shaded += passed;
+        return passed;
+    }
+
+    // 1回以上描かれたタイル数
+    uint32_t OverdrawEstimator::getCovered() const
+    {
+        return static_cast<uint32_t>(std::count_if(depthBuffer.begin(), depthBuffer.end(), [](const float d) { return d < 1.0f; }));
+    }
+
+    // オーバードロー率
+    float OverdrawEstimator::getOverdraw() const
+    {
+        auto covered = getCovered();
+        return covered != 0 ? static_cast<float>(shaded) / covered : 0.0f;
+    }
+}
@@ -0,0 +1,110 @@
+#pragma once
+#ifndef RENDERQUEUE_H
+#define RENDERQUEUE_H
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Matrix.h"
+
+namespace Lib
+{
+    // 描画の層(ソートキーの最上位)
+    enum class RenderLayer : uint8_t
+    {
+        Opaque      = 0,
+        Transparent = 1,
+        Overlay     = 2,
+    };
+
+    // 64bitのソートキーで描画順を決めるキュー
+    //
+    // 不透明:   layer(2) | 深度の大区分(4) | shader(10) | material(12) | mesh(12) | 深度(24)
+    // 半透明:   layer(2) | 深度の反転(24) | shader(10) | material(12) | mesh(12) | 0(4)
+    //
+    // 不透明は手前の区分から順に、区分内では状態ごとにまとめて手前から描く(early-Zを活かす)
+    // 半透明は奥から順に描く
+    class RenderQueue
+    {
+    public:
+        static const uint32_t SHADER_BITS       = 10;
+        static const uint32_t MATERIAL_BITS     = 12;
+        static const uint32_t MESH_BITS         = 12;
+        static const uint32_t DEPTH_BITS        = 24;
+        static const uint32_t DEPTH_BUCKET_BITS = 4;
+
+        // キューの要素
+        struct Item
+        {
+            uint64_t key;
+            uint32_t index; // 呼び出し側のオブジェクト番号
+        };
+
+        // 統計情報(sort()ごとに更新)
+        struct Stats
+        {
+            uint32_t items;
+            uint32_t stateChangesBefore; // 登録順に描いた場合の状態変更数
+            uint32_t stateChangesAfter;  // ソート後の状態変更数
+            uint32_t radixPasses;        // 実際に行った基数ソートのパス数
+            float    sortTime;           // ミリ秒
+        };
+
+        RenderQueue();
+
+        // 不透明のキー(depthはビュー空間の深度を0～1に正規化した値)
+        static uint64_t makeOpaqueKey(const uint32_t shader, const uint32_t material, const uint32_t mesh, const float depth);
+        // 半透明のキー
+        static uint64_t makeTransparentKey(const uint32_t shader, const uint32_t material, const uint32_t mesh, const float depth);
+        // 任意の層のキー(Overlayなど。登録順を保つにはorderに連番を渡す)
+        static uint64_t makeKey(const RenderLayer layer, const uint64_t order);
+        // AABBのうち最も手前の点のビュー空間の深度(まとめて描くバッチのキーに使う)
+        static float nearestViewDepth(const Matrix &view, const float min[3], const float max[3]);
+
+        // キーから状態(shader, material, mesh)の部分を取り出す
+        static uint64_t getStateBits(const uint64_t key);
+        // 隣り合う要素で状態が変わる回数
+        static uint32_t countStateChanges(const std::vector<Item> &items);
+
+        void clear();
+        void push(const uint64_t key, const uint32_t index);
+        // 基数ソート(キーが等しい要素は登録順を保つ)
+        void sort();
+
+        const std::vector<Item> &getItems() const { return items; }
+        const Stats             &getStats() const { return stats; }
+        size_t size() const { return items.size(); }
+
+    private:
+        static uint32_t quantizeDepth(const float depth);
+
+        std::vector<Item> items;
+        std::vector<Item> scratch;
+        Stats             stats;
+    };
+
+    // 画面を粗いタイルに分けた深度バッファ
+    // ソフトウェア上でearly-Zによる棄却を再現し、オーバードローを見積もる
+    class OverdrawEstimator
+    {
+    public:
+        OverdrawEstimator(const int _width = 64, const int _height = 36);
+
+        void clear();
+        // NDC座標の矩形を深度depth(0～1)で描く。深度テストを通過したタイル数を返す
+        uint32_t draw(const float minX, const float minY, const float maxX, const float maxY, const float depth);
+
+        uint32_t getShaded() const { return shaded; }
+        // 1回以上描かれたタイル数
+        uint32_t getCovered() const;
+        // 塗られたタイル数 / 覆われたタイル数(1が最小)
+        float    getOverdraw() const;
+
+    private:
+        int                width;
+        int                height;
+        std::vector<float> depthBuffer;
+        uint32_t           shaded;
+    };
+}
+
+#endif
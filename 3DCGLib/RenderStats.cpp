@@ -0,0 +1,254 @@
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include "RenderStats.h"
+
+namespace Lib
+{
+    // コンストラクタ
+    RenderStats::RenderStats()
+        : enabled(false), counting(false)
+    {
+        current = Frame{};
+        last    = Frame{};
+        reset();
+    }
+
+    // 有効・無効の切り替え
+    void RenderStats::setEnabled(const bool _enabled)
+    {
+        enabled  = _enabled;
+        counting = false;
+    }
+
+    // フレームの集計を始める
+    void RenderStats::beginFrame()
+    {
+        if (!enabled) {
+            return;
+        }
+        current  = Frame{};
+        counting = true;
+    }
+
+    // 実行するコマンドリストを数える
+    void RenderStats::count(const CommandList &list)
+    {
+        if (!counting) {
+            return;
+        }
+        for (auto &command : list.getCommands()) {
+            switch (command.type) {
+            case CommandType::DrawIndexed:
+                ++current.drawCalls;
+                ++current.instances;
+                current.triangles += command.arg0 / 3;
+                break;
+            case CommandType::DrawIndexedInstanced:
+                ++current.drawCalls;
+                current.instances += command.arg3;
+                current.triangles += static_cast<uint64_t>(command.arg0 / 3) * command.arg3;
+                break;
+            case CommandType::UpdateBuffer:
+                // 範囲指定の更新は定数バッファには使えない
+                if (command.arg3 != 0) {
+                    current.bufferBytes += command.arg1;
+                }
+                else {
+                    current.constantBytes += command.arg1;
+                }
+                break;
+            default:
+                ++current.stateChanges;
+                break;
+            }
+        }
+        current.eliminated += list.getStats().eliminated;
+        ++current.commandLists;
+    }
+
+    // 転送用リングの定数を加える
+    void RenderStats::addConstantBytes(const uint32_t bytes)
+    {
+        if (counting) {
+            current.constantBytes += bytes;
+        }
+    }
+
+    // 描画順のソートの結果を加える
+    void RenderStats::addQueue(const RenderQueue::Stats &queueStats)
+    {
+        if (counting) {
+            current.queuedDraws     += queueStats.items;
+            current.unsortedChanges += queueStats.stateChangesBefore;
+            current.sortedChanges   += queueStats.stateChangesAfter;
+        }
+    }
+
+    // オーバードローの見積もりを加える
+    void RenderStats::addOverdraw(const OverdrawEstimator &estimator)
+    {
+        if (counting) {
+            current.shadedTiles  += estimator.getShaded();
+            current.coveredTiles += estimator.getCovered();
+        }
+    }
+
+    // オーバードロー率
+    float RenderStats::getOverdraw(const Frame &frame)
+    {
+        return frame.coveredTiles != 0 ? static_cast<float>(frame.shadedTiles) / frame.coveredTiles : 0.0f;
+    }
+
+    // フレームの集計を終える
+    void RenderStats::endFrame()
+    {
+        if (!counting) {
+            return;
+        }
+        counting = false;
+        last     = current;
+
+        peak.drawCalls     = std::max(peak.drawCalls,     last.drawCalls);
+        peak.instances     = std::max(peak.instances,     last.instances);
+        peak.triangles     = std::max(peak.triangles,     last.triangles);
+        peak.stateChanges  = std::max(peak.stateChanges,  last.stateChanges);
+        peak.eliminated    = std::max(peak.eliminated,    last.eliminated);
+        peak.constantBytes = std::max(peak.constantBytes, last.constantBytes);
+        peak.bufferBytes   = std::max(peak.bufferBytes,   last.bufferBytes);
+        peak.commandLists  = std::max(peak.commandLists,  last.commandLists);
+        peak.queuedDraws     = std::max(peak.queuedDraws,     last.queuedDraws);
+        peak.unsortedChanges = std::max(peak.unsortedChanges, last.unsortedChanges);
+        peak.sortedChanges   = std::max(peak.sortedChanges,   last.sortedChanges);
+        peak.shadedTiles     = std::max(peak.shadedTiles,     last.shadedTiles);
+        peak.coveredTiles    = std::max(peak.coveredTiles,    last.coveredTiles);
+
+        total.drawCalls     += last.drawCalls;
+        total.instances     += last.instances;
+        total.triangles     += last.triangles;
+        total.stateChanges  += last.stateChanges;
+        total.eliminated    += last.eliminated;
+        total.constantBytes += last.constantBytes;
+        total.bufferBytes   += last.bufferBytes;
+        total.commandLists  += last.commandLists;
+        total.queuedDraws     += last.queuedDraws;
+        total.unsortedChanges += last.unsortedChanges;
+        total.sortedChanges   += last.sortedChanges;
+        total.shadedTiles     += last.shadedTiles;
+        total.coveredTiles    += last.coveredTiles;
+        ++frames;
+    }
+
+    // 累計と最大を捨てる
+    void RenderStats::reset()
+    {
+        peak   = Frame{};
+        total  = Total{};
+        frames = 0;
+    }
+
+    // 1フレームあたりの平均
+    RenderStats::Frame RenderStats::getAverage() const
+    {
+        if (frames == 0) {
+            return Frame{};
+        }
+        auto average = [&](const uint64_t sum) { return static_cast<uint32_t>(sum / frames); };
+        return Frame{
+            average(total.drawCalls),
+            average(total.instances),
+            total.triangles / frames,
+            average(total.stateChanges),
+            average(total.eliminated),
+            average(total.constantBytes),
+            average(total.bufferBytes),
+            average(total.commandLists),
+            average(total.queuedDraws),
+            average(total.unsortedChanges),
+            average(total.sortedChanges),
+            average(total.shadedTiles),
+            average(total.coveredTiles)
+        };
+    }
+
+    // GPUメモリの見積もり
+    RenderStats::Memory RenderStats::measureMemory(const ResourceRegistry &registry, const uint64_t renderTargetBytes)
+    {
+        auto stats = registry.getStats();
+
+        Memory memory;
+        memory.typeCount         = stats.typeCount;
+        memory.typeBytes         = stats.typeBytes;
+        memory.resourceBytes     = stats.bytes;
+        memory.renderTargetBytes = renderTargetBytes;
+        memory.total             = stats.bytes + renderTargetBytes;
+        return memory;
+    }
+
+    // JSONで書き出す
+    bool RenderStats::writeJson(const std::string &path, const ResourceRegistry &registry, const uint64_t renderTargetBytes) const
+    {
+        std::ofstream ofs(path, std::ios::trunc);
+        if (!ofs) {
+            return false;
+        }
+        char line[512];
+        auto writeFrame = [&](const char *label, const Frame &frame) {
+            snprintf(line, sizeof(line), "  \"%s\": {\"draw_calls\": %u, \"instances\": %u, \"triangles\": %llu, \"state_changes\": %u, \"eliminated\": %u, "
+                "\"constant_bytes\": %u, \"buffer_bytes\": %u, \"command_lists\": %u, "
+                "\"queued_draws\": %u, \"unsorted_changes\": %u, \"sorted_changes\": %u, \"shaded_tiles\": %u, \"covered_tiles\": %u, \"overdraw\": %.3f},\n",
+                label, frame.drawCalls, frame.instances, static_cast<unsigned long long>(frame.triangles), frame.stateChanges, frame.eliminated,
+                frame.constantBytes, frame.bufferBytes, frame.commandLists,
+                frame.queuedDraws, frame.unsortedChanges, frame.sortedChanges, frame.shadedTiles, frame.coveredTiles, getOverdraw(frame));
+            ofs << line;
+        };
+
+        snprintf(line, sizeof(line), "{\n  \"frames\": %llu,\n", static_cast<unsigned long long>(frames));
+        ofs << line;
+        writeFrame("last", last);
+        writeFrame("average", getAverage());
+        writeFrame("peak", peak);
+
+        // 種類ごとのメモリ
+        auto memory = measureMemory(registry, renderTargetBytes);
+        snprintf(line, sizeof(line), "  \"memory\": {\n    \"total\": %llu,\n    \"render_targets\": %llu,\n    \"resources\": %llu,\n    \"types\": {",
+            static_cast<unsigned long long>(memory.total), static_cast<unsigned long long>(memory.renderTargetBytes), static_cast<unsigned long long>(memory.resourceBytes));
+        ofs << line;
+        for (size_t i = 0; i < ResourceRegistry::TYPE_COUNT; ++i) {
+            snprintf(line, sizeof(line), "%s\n      \"%s\": {\"count\": %u, \"bytes\": %llu}", i == 0 ? "" : ",",
+                typeName(static_cast<ResourceType>(i)), memory.typeCount[i], static_cast<unsigned long long>(memory.typeBytes[i]));
+            ofs << line;
+        }
+        ofs << "\n    }\n  },\n";
+
+        // リソースごとのメモリ(大きい順)
+        auto resources = registry.getResources();
+        std::sort(resources.begin(), resources.end(), [](const ResourceRegistry::ResourceInfo &a, const ResourceRegistry::ResourceInfo &b) {
+            return a.bytes > b.bytes;
+        });
+        ofs << "  \"resources\": [";
+        for (size_t i = 0; i < resources.size(); ++i) {
+            auto &info = resources[i];
+            snprintf(line, sizeof(line), "%s\n    {\"type\": \"%s\", \"key\": \"%016llx\", \"bytes\": %u, \"stride\": %u, \"references\": %u}",
+                i == 0 ? "" : ",", typeName(info.type), static_cast<unsigned long long>(info.key), info.bytes, info.stride, info.refCount);
+            ofs << line;
+        }
+        ofs << (resources.empty() ? "]\n}\n" : "\n  ]\n}\n");
+        return static_cast<bool>(ofs);
+    }
+
+    // リソースの種類の名前
+    const char * RenderStats::typeName(const ResourceType type)
+    {
+        switch (type) {
+        case ResourceType::VertexShader:   return "vertex_shader";
+        case ResourceType::PixelShader:    return "pixel_shader";
+        case ResourceType::InputLayout:    return "input_layout";
+        case ResourceType::VertexBuffer:   return "vertex_buffer";
+        case ResourceType::IndexBuffer:    return "index_buffer";
+        case ResourceType::ConstantBuffer: return "constant_buffer";
+        case ResourceType::UploadBuffer:   return "upload_buffer";
+        default:                           return "unknown";
+        }
+    }
+}
@@ -0,0 +1,116 @@
+#pragma once
+#ifndef RENDERSTATS_H
+#define RENDERSTATS_H
+#include <array>
+#include <cstdint>
+#include <string>
+#include "CommandList.h"
+#include "RenderQueue.h"
+#include "ResourceRegistry.h"
+
+namespace Lib
+{
+    // 描画の負荷とGPUメモリの集計
+    //
+    // 実行するコマンドリストを数え、フレームごとの描画回数・三角形数・状態の変更・定数の転送量を求める
+    // 無効の間はcount()も呼ばれない(DirectX11が有効かを確かめてから渡す)
+    // 描画順のソートによる状態の切り替え数の変化と、オーバードローの見積もりも呼び出し側から受け取る
+    // メモリはレジストリに登録したリソースの作成時の大きさ(ByteWidth)と、レンダーターゲットから見積もる
+    class RenderStats
+    {
+    public:
+        // 1フレームの集計
+        struct Frame
+        {
+            uint32_t drawCalls;
+            uint32_t instances;     // インスタンス描画のインスタンス数の合計(通常の描画は1つと数える)
+            uint64_t triangles;     // インデックス数 / 3 × インスタンス数
+            uint32_t stateChanges;  // 実行した設定のコマンド数(冗長なものは記録時に取り除かれている)
+            uint32_t eliminated;    // 記録時に取り除かれた冗長な設定の数
+            uint32_t constantBytes; // 定数バッファへ転送したバイト数(UpdateBufferと転送用リング)
+            uint32_t bufferBytes;   // 頂点・インスタンスバッファへ転送したバイト数
+            uint32_t commandLists;  // 実行したコマンドリストの数
+            uint32_t queuedDraws;     // 描画順を決めたキューの要素数
+            uint32_t unsortedChanges; // 登録順に描いた場合の状態の切り替え数
+            uint32_t sortedChanges;   // ソート後の状態の切り替え数
+            uint32_t shadedTiles;     // オーバードローの見積もりで深度テストを通過したタイル数
+            uint32_t coveredTiles;    // 同じく1回以上描かれたタイル数
+        };
+
+        // GPUメモリの見積もり(バイト)
+        struct Memory
+        {
+            std::array<uint32_t, ResourceRegistry::TYPE_COUNT> typeCount;
+            std::array<uint64_t, ResourceRegistry::TYPE_COUNT> typeBytes;
+            uint64_t resourceBytes;     // レジストリのリソースの合計
+            uint64_t renderTargetBytes; // バックバッファと深度バッファ
+            uint64_t total;
+        };
+
+        RenderStats();
+
+        void setEnabled(const bool _enabled);
+        bool isEnabled() const { return enabled; }
+
+        // フレームの集計を始める
+        void beginFrame();
+        // 実行するコマンドリストを数える
+        void count(const CommandList &list);
+        // 転送用リングから割り当てた定数のバイト数を加える
+        void addConstantBytes(const uint32_t bytes);
+        // 描画順のソートの結果を加える
+        void addQueue(const RenderQueue::Stats &queueStats);
+        // 描画順どおりに描いたオーバードローの見積もりを加える
+        void addOverdraw(const OverdrawEstimator &estimator);
+        // フレームの集計を終えて直前のフレームとする
+        void endFrame();
+        // 累計と最大を捨てる
+        void reset();
+
+        // 直前のフレーム
+        const Frame &getLastFrame() const { return last; }
+        // reset()からの1フレームあたりの平均と最大
+        Frame        getAverage() const;
+        const Frame &getPeak() const { return peak; }
+        uint64_t     getFrames() const { return frames; }
+        // 塗られたタイル数 / 覆われたタイル数(見積もりがなければ0)
+        static float getOverdraw(const Frame &frame);
+
+        // GPUメモリの見積もり
+        static Memory measureMemory(const ResourceRegistry &registry, const uint64_t renderTargetBytes);
+
+        // 直前のフレーム・平均・最大と、GPUメモリ(種類ごと・リソースごと)をJSONで書き出す
+        bool writeJson(const std::string &path, const ResourceRegistry &registry, const uint64_t renderTargetBytes) const;
+
+        static const char *typeName(const ResourceType type);
+
+    private:
+        bool     enabled;
+        bool     counting; // beginFrame()からendFrame()の間
+        Frame    current;
+        Frame    last;
+        Frame    peak;
+        uint64_t frames;
+
+        // 平均を求めるための合計(あふれないよう64ビットで持つ)
+        struct Total
+        {
+            uint64_t drawCalls;
+            uint64_t instances;
+            uint64_t triangles;
+            uint64_t stateChanges;
+            uint64_t eliminated;
+            uint64_t constantBytes;
+            uint64_t bufferBytes;
+            uint64_t commandLists;
+            uint64_t queuedDraws;
+            uint64_t unsortedChanges;
+            uint64_t sortedChanges;
+            uint64_t shadedTiles;
+            uint64_t coveredTiles;
+        };
+        Total total;
+    };
+}
+
+#endif
@@ -0,0 +1,270 @@
+#include <chrono>
+#include "ResourceRegistry.h"
+
+namespace Lib
+{
+    // コンストラクタ
+    ResourceRef::ResourceRef()
+        : registry(nullptr), handle{ 0, 0 }
+    {
+    }
+
+    ResourceRef::ResourceRef(ResourceRegistry *_registry, const ResourceHandle _handle)
+        : registry(_registry), handle(_handle)
+    {
+    }
+
+    // コピーコンストラクタ
+    ResourceRef::ResourceRef(const ResourceRef &other)
+        : registry(other.registry), handle(other.handle)
+    {
+        if (registry != nullptr) {
+            registry->addRef(handle);
+        }
+    }
+
+    // ムーブコンストラクタ
+    ResourceRef::ResourceRef(ResourceRef &&other)
+        : registry(other.registry), handle(other.handle)
+    {
+        other.registry = nullptr;
+        other.handle   = { 0, 0 };
+    }
+
+    // デストラクタ
+    ResourceRef::~ResourceRef()
+    {
+        reset();
+    }
+
+    // コピー代入
+    ResourceRef& ResourceRef::operator=(const ResourceRef &other)
+    {
+        if (this != &other) {
+            if (other.registry != nullptr) {
+                other.registry->addRef(other.handle);
+            }
+            reset();
+            registry = other.registry;
+            handle   = other.handle;
+        }
+        return *this;
+    }
+
+    // ムーブ代入
+    ResourceRef& ResourceRef::operator=(ResourceRef &&other)
+    {
+        if (this != &other) {
+            reset();
+            registry       = other.registry;
+            handle         = other.handle;
+            other.registry = nullptr;
+            other.handle   = { 0, 0 };
+        }
+        return *this;
+    }
+
+    // 参照を手放す
+    void ResourceRef::reset()
+    {
+        if (registry != nullptr) {
+            registry->release(handle);
+        }
+        registry = nullptr;
+        handle   = { 0, 0 };
+    }
+
+    // バックエンドのオブジェクト
+    NativeResource ResourceRef::get() const
+    {
+        return registry != nullptr ? registry->getNative(handle) : nullptr;
+    }
+
+    // コンストラクタ
+    ResourceRegistry::ResourceRegistry(RenderDevice &_device)
+        : device(_device), creates(0), hits(0), destroys(0), createTime(0.0f)
+    {
+    }
+
+    // デストラクタ
+    // ※参照が残っていても解放する(ResourceRefはレジストリより先に破棄すること)
+    ResourceRegistry::~ResourceRegistry()
+    {
+        for (auto &slot : slots) {
+            if (slot.native != nullptr) {
+                device.release(slot.info.type, slot.native);
+            }
+        }
+    }
+
+    // 登録済みのリソースを探す
+    ResourceRef ResourceRegistry::find(const ResourceType type, const uint64_t key)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto &map = lookup[static_cast<size_t>(type)];
+        auto it = map.find(key);
+        if (it == map.end()) {
+            return ResourceRef();
+        }
+        auto &slot = slots[it->second];
+        ++slot.info.refCount;
+        ++hits;
+        return ResourceRef(this, { it->second, slot.generation });
+    }
+
+    // シェーダーの取得
+    ResourceRef ResourceRegistry::getShader(const ResourceType type, const uint64_t key, const void *bytecode, const size_t size)
+    {
+        return acquire(type, key, static_cast<uint32_t>(size), 0, [&]() {
+            return device.createShader(type, bytecode, size);
+        });
+    }
+
+    // 入力レイアウトの取得
+    ResourceRef ResourceRegistry::getInputLayout(const uint64_t key, const VertexLayout layout, const void *bytecode, const size_t size)
+    {
+        return acquire(ResourceType::InputLayout, key, 0, 0, [&]() {
+            return device.createInputLayout(layout, bytecode, size);
+        });
+    }
+
+    // バッファの取得
+    ResourceRef ResourceRegistry::getBuffer(const ResourceType type, const uint64_t key, const uint32_t byteWidth, const uint32_t stride, const void *initData)
+    {
+        return acquire(type, key, byteWidth, stride, [&]() {
+            return device.createBuffer(type, byteWidth, initData);
+        });
+    }
+
+    // バックエンドのオブジェクトの取得
+    // ※描画中に生成・解放と並行して呼ばないこと(スロット配列の再確保があるため)
+    NativeResource ResourceRegistry::getNative(const ResourceHandle handle) const
+    {
+        if (handle.index >= slots.size() || slots[handle.index].generation != handle.generation) {
+            return nullptr;
+        }
+        return slots[handle.index].native;
+    }
+
+    // リソースの情報の取得
+    ResourceRegistry::ResourceInfo ResourceRegistry::getInfo(const ResourceHandle handle) const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (handle.index >= slots.size() || slots[handle.index].generation != handle.generation) {
+            return ResourceInfo{ ResourceType::Count, 0, 0, 0, 0, 0.0f };
+        }
+        return slots[handle.index].info;
+    }
+
+    // 生存中の全リソース
+    std::vector<ResourceRegistry::ResourceInfo> ResourceRegistry::getResources() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<ResourceInfo> resources;
+        for (auto &slot : slots) {
+            if (slot.native != nullptr) {
+                resources.push_back(slot.info);
+            }
+        }
+        return resources;
+    }
+
+    // 統計情報の取得
+    ResourceRegistry::Stats ResourceRegistry::getStats() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Stats stats = {};
+        for (auto &slot : slots) {
+            if (slot.native == nullptr) {
+                continue;
+            }
+            auto type = static_cast<size_t>(slot.info.type);
+            ++stats.resources;
+            stats.references      += slot.info.refCount;
+            stats.bytes           += slot.info.bytes;
+            stats.typeCount[type] += 1;
+            stats.typeBytes[type] += slot.info.bytes;
+        }
+        stats.creates    = creates;
+        stats.hits       = hits;
+        stats.destroys   = destroys;
+        stats.createTime = createTime;
+        return stats;
+    }
+
+    // 取得または生成
+    template <class Create>
+    ResourceRef ResourceRegistry::acquire(const ResourceType type, const uint64_t key, const uint32_t bytes, const uint32_t stride, Create create)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto &map = lookup[static_cast<size_t>(type)];
+        auto it = map.find(key);
+        if (it != map.end()) {
+            auto &slot = slots[it->second];
+            ++slot.info.refCount;
+            ++hits;
+            return ResourceRef(this, { it->second, slot.generation });
+        }
+
+        auto start  = std::chrono::steady_clock::now();
+        auto native = create();
+        auto time   = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if (native == nullptr) {
+            return ResourceRef();
+        }
+        ++creates;
+        createTime += time;
+
+        uint32_t index;
+        if (!freeSlots.empty()) {
+            index = freeSlots.back();
+            freeSlots.pop_back();
+        }
+        else {
+            index = static_cast<uint32_t>(slots.size());
+            slots.push_back(Slot{ nullptr, {}, 0 });
+        }
+        auto &slot = slots[index];
+        slot.native = native;
+        slot.info   = ResourceInfo{ type, key, bytes, stride, 1, time };
+        ++slot.generation;
+        if (slot.generation == 0) {
+            slot.generation = 1;
+        }
+        map.emplace(key, index);
+
+        return ResourceRef(this, { index, slot.generation });
+    }
+
+    // 参照の追加
+    void ResourceRegistry::addRef(const ResourceHandle handle)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (handle.index < slots.size() && slots[handle.index].generation == handle.generation) {
+            ++slots[handle.index].info.refCount;
+        }
+    }
+
+    // 参照の解放(最後の参照なら破棄する)
+    void ResourceRegistry::release(const ResourceHandle handle)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (handle.index >= slots.size() || slots[handle.index].generation != handle.generation) {
+            return;
+        }
+        auto &slot = slots[handle.index];
+        if (--slot.info.refCount > 0) {
+            return;
+        }
+
+        device.release(slot.info.type, slot.native);
+        lookup[static_cast<size_t>(slot.info.type)].erase(slot.info.key);
+        slot.native = nullptr;
+        ++slot.generation;
+        if (slot.generation == 0) {
+            slot.generation = 1;
+        }
+        freeSlots.push_back(handle.index);
+        ++destroys;
+    }
+}
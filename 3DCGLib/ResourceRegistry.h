@@ -0,0 +1,140 @@
+#pragma once
+#ifndef RESOURCEREGISTRY_H
+#define RESOURCEREGISTRY_H
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "RenderDevice.h"
+
+namespace Lib
+{
+    class ResourceRegistry;
+
+    // レジストリ内のリソースを指すハンドル
+    struct ResourceHandle
+    {
+        uint32_t index;
+        uint32_t generation; // 0は無効
+
+        bool operator==(const ResourceHandle &other) const { return index == other.index && generation == other.generation; }
+        bool operator!=(const ResourceHandle &other) const { return !(*this == other); }
+    };
+
+    // 参照カウント付きのハンドル(コピーで参照が増え、破棄で減る)
+    class ResourceRef
+    {
+    public:
+        ResourceRef();
+        ResourceRef(const ResourceRef &other);
+        ResourceRef(ResourceRef &&other);
+        ~ResourceRef();
+
+        ResourceRef& operator=(const ResourceRef &other);
+        ResourceRef& operator=(ResourceRef &&other);
+
+        // 参照を手放す
+        void reset();
+
+        // バックエンドのオブジェクト
+        NativeResource get() const;
+        ResourceHandle getHandle() const { return handle; }
+
+        explicit operator bool() const { return registry != nullptr; }
+
+    private:
+        friend class ResourceRegistry;
+        // 参照カウントは増やさない(レジストリ側で加算済み)
+        ResourceRef(ResourceRegistry *_registry, const ResourceHandle _handle);
+
+        ResourceRegistry *registry;
+        ResourceHandle    handle;
+    };
+
+    // 種類とキーでGPUリソースを共有するレジストリ
+    // 同じキーのリソースは一度だけ生成され、最後の参照が消えた時に解放される
+    class ResourceRegistry
+    {
+    public:
+        static const size_t TYPE_COUNT = static_cast<size_t>(ResourceType::Count);
+
+        // リソースの情報
+        struct ResourceInfo
+        {
+            ResourceType type;
+            uint64_t     key;
+            uint32_t     bytes;      // 確保したメモリ量(シェーダーはバイトコードのサイズ)
+            uint32_t     stride;     // 要素のサイズ(バッファのみ)
+            uint32_t     refCount;
+            float        createTime; // 生成にかかった時間(ミリ秒)
+        };
+
+        // 統計情報
+        struct Stats
+        {
+            uint32_t resources;
+            uint32_t references;
+            uint64_t bytes;
+            std::array<uint32_t, TYPE_COUNT> typeCount;
+            std::array<uint64_t, TYPE_COUNT> typeBytes;
+            uint64_t creates;    // 生成した回数
+            uint64_t hits;       // 既存のリソースを返した回数
+            uint64_t destroys;   // 解放した回数
+            float    createTime; // 生成の累計(ミリ秒)
+        };
+
+        // deviceの寿命はこのオブジェクトより長いこと
+        explicit ResourceRegistry(RenderDevice &_device);
+        ~ResourceRegistry();
+
+        // 登録済みのリソースを探す(見つからなければ空のResourceRef)
+        ResourceRef find(const ResourceType type, const uint64_t key);
+
+        // 取得(未登録なら生成する。失敗時は空のResourceRef)
+        ResourceRef getShader(const ResourceType type, const uint64_t key, const void *bytecode, const size_t size);
+        ResourceRef getInputLayout(const uint64_t key, const VertexLayout layout, const void *bytecode, const size_t size);
+        ResourceRef getBuffer(const ResourceType type, const uint64_t key, const uint32_t byteWidth, const uint32_t stride, const void *initData);
+
+        NativeResource getNative(const ResourceHandle handle) const;
+        ResourceInfo   getInfo(const ResourceHandle handle) const;
+
+        // 生存中の全リソース
+        std::vector<ResourceInfo> getResources() const;
+        Stats getStats() const;
+
+    private:
+        friend class ResourceRef;
+
+        // コピーの禁止
+        ResourceRegistry(const ResourceRegistry &) = delete;
+        ResourceRegistry& operator=(const ResourceRegistry &) = delete;
+
+        struct Slot
+        {
+            NativeResource native;
+            ResourceInfo   info;
+            uint32_t       generation;
+        };
+
+        template <class Create>
+        ResourceRef acquire(const ResourceType type, const uint64_t key, const uint32_t bytes, const uint32_t stride, Create create);
+
+        void addRef(const ResourceHandle handle);
+        void release(const ResourceHandle handle);
+
+        RenderDevice &device;
+
+        mutable std::mutex                     mutex;
+        std::vector<Slot>                      slots;
+        std::vector<uint32_t>                  freeSlots;
+        std::array<std::unordered_map<uint64_t, uint32_t>, TYPE_COUNT> lookup; // 種類ごとにキー → スロット番号
+
+        uint64_t creates;
+        uint64_t hits;
+        uint64_t destroys;
+        float    createTime;
+    };
+}
+
+#endif
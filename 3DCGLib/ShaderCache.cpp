@@ -0,0 +1,365 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include "ShaderCache.h"
+#include "Hash.h"
+#include "Profiler.h"
+
+namespace Lib
+{
+    namespace
+    {
+        const uint32_t FILE_VERSION = 2;
+
+        // ディスクキャッシュのヘッダー
+        // ※ヘッダーの後に#includeしたファイルの記録(パスの長さ・パス・内容のハッシュ)、バイトコードの順に並ぶ
+        struct CacheFileHeader
+        {
+            char     magic[4]; // "LSHC"
+            uint32_t version;
+            uint64_t key;
+            uint64_t size;         // バイトコードのバイト数
+            uint64_t checksum;     // #includeの記録とバイトコードのFNV-1a
+            uint32_t includeCount;
+            uint32_t includeBytes; // #includeの記録のバイト数
+        };
+
+        // 長さ付きで文字列をハッシュに加える(区切りの曖昧さをなくすため)
+        uint64_t hashString(const uint64_t hash, const std::string &str)
+        {
+            auto h = Hash::combine(hash, static_cast<uint64_t>(str.size()));
+            return Hash::fnv1a(str.data(), str.size(), h);
+        }
+
+        // ファイルの内容のハッシュ
+        bool hashFile(const std::string &path, uint64_t &hash)
+        {
+            std::ifstream ifs(path, std::ios::binary);
+            if (!ifs) {
+                return false;
+            }
+            std::string code((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+            hash = Hash::fnv1a(code.data(), code.size());
+            return true;
+        }
+
+        float elapsed(const std::chrono::steady_clock::time_point &start)
+        {
+            return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+        }
+    }
+
+    // コンストラクタ
+    ShaderCache::ShaderCache(std::shared_ptr<IShaderCompiler> _compiler, const std::string &_directory)
+        : compiler(_compiler), directory(_directory),
+          requests(0), memoryHits(0), diskHits(0), compiles(0), failures(0), invalidations(0), diskMicroseconds(0), compileMicroseconds(0)
+    {
+        if (!directory.empty()) {
+            std::error_code ec;
+            std::filesystem::create_directories(directory, ec);
+        }
+    }
+
+    // デストラクタ
+    ShaderCache::~ShaderCache()
+    {
+    }
+
+    // キーの計算
+    uint64_t ShaderCache::makeKey(const ShaderSource &source, const uint64_t compilerVersion)
+    {
+        auto hash = Hash::combine(Hash::combine(Hash::OFFSET_BASIS, FILE_VERSION), compilerVersion);
+        hash = hashString(hash, source.code);
+        hash = hashString(hash, source.entryPoint);
+        hash = hashString(hash, source.profile);
+        hash = Hash::combine(hash, source.flags);
+        hash = Hash::combine(hash, static_cast<uint64_t>(source.defines.size()));
+        for (auto &define : source.defines) {
+            hash = hashString(hash, define.name);
+            hash = hashString(hash, define.value);
+        }
+        return hash;
+    }
+
+    // バイトコードの取得
+    ShaderBytecode ShaderCache::get(const ShaderSource &source, std::string *error)
+    {
+        ++requests;
+        const auto key = makeKey(source, compiler != nullptr ? compiler->getVersion() : 0);
+
+        // 失敗した場合はエラーを渡す
+        auto take = [error](const Result &result) {
+            if (result.bytecode == nullptr && error != nullptr) {
+                *error = result.error;
+            }
+            return result.bytecode;
+        };
+
+        // メモリキャッシュ(コンパイル中の場合は完了を待つ)
+        {
+            std::shared_lock<std::shared_mutex> lock(mutex);
+            auto it = entries.find(key);
+            if (it != entries.end()) {
+                auto future = it->second;
+                lock.unlock();
+                ++memoryHits;
+                return take(future.get());
+            }
+        }
+
+        // 未登録ならこのスレッドが担当する
+        std::promise<Result> promise;
+        {
+            std::unique_lock<std::shared_mutex> lock(mutex);
+            auto it = entries.find(key);
+            if (it != entries.end()) {
+                auto future = it->second;
+                lock.unlock();
+                ++memoryHits;
+                return take(future.get());
+            }
+            entries.emplace(key, promise.get_future().share());
+        }
+
+        // ディスクキャッシュ
+        auto bytecode = loadFromDisk(key);
+        if (bytecode != nullptr) {
+            ++diskHits;
+            promise.set_value(Result{ bytecode, std::string() });
+            return bytecode;
+        }
+
+        // コンパイル
+        auto start = std::chrono::steady_clock::now();
+        auto result = std::make_shared<std::vector<uint8_t>>();
+        std::vector<ShaderInclude> includes;
+        std::string message = compiler != nullptr ? std::string() : "no shader compiler";
+        bool succeeded = false;
+        {
+            PROFILE_SCOPE("ShaderCache::compile");
+            succeeded = compiler != nullptr && compiler->compile(source, *result, includes, message);
+        }
+        addTime(compileMicroseconds, elapsed(start));
+        ++compiles;
+
+        if (!succeeded) {
+            ++failures;
+            if (error != nullptr) {
+                *error = message;
+            }
+            // 失敗は記録せず、次回は再コンパイルする(待っていたスレッドにはエラーを渡す)
+            promise.set_value(Result{ nullptr, message });
+            std::unique_lock<std::shared_mutex> lock(mutex);
+            entries.erase(key);
+            return nullptr;
+        }
+
+        saveToDisk(key, *result, includes);
+        promise.set_value(Result{ result, std::string() });
+        return result;
+    }
+
+    // ファイルから読み込んで取得
+    ShaderBytecode ShaderCache::getFromFile(const std::string &path, const std::string &entryPoint, const std::string &profile, const uint32_t flags, const std::vector<ShaderDefine> &defines, std::string *error)
+    {
+        std::ifstream ifs(path, std::ios::binary);
+        if (!ifs) {
+            if (error != nullptr) {
+                *error = "cannot open " + path;
+            }
+            return nullptr;
+        }
+
+        ShaderSource source;
+        source.name       = path;
+        source.code.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+        source.entryPoint = entryPoint;
+        source.profile    = profile;
+        source.flags      = flags;
+        source.defines    = defines;
+        return get(source, error);
+    }
+
+    // メモリ上のキャッシュを破棄する
+    void ShaderCache::clearMemory()
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        entries.clear();
+    }
+
+    // 統計情報の取得
+    ShaderCache::Stats ShaderCache::getStats() const
+    {
+        Stats stats;
+        stats.requests      = requests;
+        stats.memoryHits    = memoryHits;
+        stats.diskHits      = diskHits;
+        stats.compiles      = compiles;
+        stats.failures      = failures;
+        stats.invalidations = invalidations;
+        stats.diskTime      = diskMicroseconds / 1000.0f;
+        stats.compileTime   = compileMicroseconds / 1000.0f;
+        return stats;
+    }
+
+    // 統計情報のリセット
+    void ShaderCache::resetStats()
+    {
+        requests            = 0;
+        memoryHits          = 0;
+        diskHits            = 0;
+        compiles            = 0;
+        failures            = 0;
+        invalidations       = 0;
+        diskMicroseconds    = 0;
+        compileMicroseconds = 0;
+    }
+
+    // #includeされたファイルの読み込み
+    bool ShaderCache::readInclude(const std::string &path, std::string &code, std::vector<ShaderInclude> &includes)
+    {
+        std::ifstream ifs(path, std::ios::binary);
+        if (!ifs) {
+            return false;
+        }
+        code.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+        includes.push_back(ShaderInclude{ path, Hash::fnv1a(code.data(), code.size()) });
+        return true;
+    }
+
+    // キャッシュファイルのパス
+    std::string ShaderCache::makePath(const uint64_t key) const
+    {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.cso", static_cast<unsigned long long>(key));
+        return (std::filesystem::path(directory) / name).string();
+    }
+
+    // ディスクから読み込む
+    // ※途中までしか書かれていないファイルや壊れたファイル、#includeしたファイルが変わったものは捨てる
+    ShaderBytecode ShaderCache::loadFromDisk(const uint64_t key)
+    {
+        PROFILE_SCOPE("ShaderCache::loadFromDisk");
+        if (directory.empty()) {
+            return nullptr;
+        }
+        auto start = std::chrono::steady_clock::now();
+        auto reject = [&]() -> ShaderBytecode {
+            ++invalidations;
+            addTime(diskMicroseconds, elapsed(start));
+            return nullptr;
+        };
+
+        auto path = makePath(key);
+        std::error_code ec;
+        auto fileSize = std::filesystem::file_size(path, ec);
+        std::ifstream ifs(path, std::ios::binary);
+        if (ec || !ifs) {
+            addTime(diskMicroseconds, elapsed(start));
+            return nullptr;
+        }
+        CacheFileHeader header;
+        ifs.read(reinterpret_cast<char*>(&header), sizeof(header));
+        // 大きさはファイルの長さと一致することを確かめてから確保する
+        if (!ifs || std::memcmp(header.magic, "LSHC", 4) != 0 || header.version != FILE_VERSION || header.key != key ||
+            fileSize < sizeof(header) || header.includeBytes > fileSize - sizeof(header) ||
+            header.size != fileSize - sizeof(header) - header.includeBytes) {
+            return reject();
+        }
+        std::vector<uint8_t> payload(static_cast<size_t>(fileSize - sizeof(header)));
+        ifs.read(reinterpret_cast<char*>(payload.data()), static_cast<std::streamsize>(payload.size()));
+        if (!ifs || Hash::fnv1a(payload.data(), payload.size()) != header.checksum) {
+            return reject();
+        }
+
+        // #includeしたファイルが変わっていないか
+        size_t position = 0;
+        for (uint32_t i = 0; i < header.includeCount; ++i) {
+            uint32_t length;
+            if (header.includeBytes - position < sizeof(length)) {
+                return reject();
+            }
+            std::memcpy(&length, payload.data() + position, sizeof(length));
+            position += sizeof(length);
+            uint64_t hash;
+            if (header.includeBytes - position < static_cast<uint64_t>(length) + sizeof(hash)) {
+                return reject();
+            }
+            std::string includePath(reinterpret_cast<const char*>(payload.data() + position), length);
+            position += length;
+            std::memcpy(&hash, payload.data() + position, sizeof(hash));
+            position += sizeof(hash);
+
+            uint64_t current = 0;
+            if (!hashFile(includePath, current) || current != hash) {
+                return reject();
+            }
+        }
+        if (position != header.includeBytes) {
+            return reject();
+        }
+
+        auto bytecode = std::make_shared<std::vector<uint8_t>>(payload.begin() + header.includeBytes, payload.end());
+        addTime(diskMicroseconds, elapsed(start));
+        return bytecode;
+    }
+
+    // ディスクへ書き出す(一時ファイルに書いてから置き換える)
+    void ShaderCache::saveToDisk(const uint64_t key, const std::vector<uint8_t> &bytecode, const std::vector<ShaderInclude> &includes)
+    {
+        if (directory.empty()) {
+            return;
+        }
+        auto start = std::chrono::steady_clock::now();
+
+        // #includeの記録とバイトコードを続けて並べる
+        std::vector<uint8_t> payload;
+        for (auto &include : includes) {
+            auto length = static_cast<uint32_t>(include.path.size());
+            auto bytes  = reinterpret_cast<const uint8_t*>(&length);
+            payload.insert(payload.end(), bytes, bytes + sizeof(length));
+            payload.insert(payload.end(), include.path.begin(), include.path.end());
+            bytes = reinterpret_cast<const uint8_t*>(&include.hash);
+            payload.insert(payload.end(), bytes, bytes + sizeof(include.hash));
+        }
+        auto includeBytes = static_cast<uint32_t>(payload.size());
+        payload.insert(payload.end(), bytecode.begin(), bytecode.end());
+
+        CacheFileHeader header;
+        std::memcpy(header.magic, "LSHC", 4);
+        header.version      = FILE_VERSION;
+        header.key          = key;
+        header.size         = bytecode.size();
+        header.checksum     = Hash::fnv1a(payload.data(), payload.size());
+        header.includeCount = static_cast<uint32_t>(includes.size());
+        header.includeBytes = includeBytes;
+
+        auto path = makePath(key);
+        std::ostringstream tmp;
+        tmp << path << '.' << std::this_thread::get_id() << ".tmp";
+        {
+            std::ofstream ofs(tmp.str(), std::ios::binary | std::ios::trunc);
+            ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            ofs.write(reinterpret_cast<const char*>(payload.data()), static_cast<std::streamsize>(payload.size()));
+        }
+        std::error_code ec;
+        std::filesystem::rename(tmp.str(), path, ec);
+        if (ec) {
+            std::filesystem::remove(tmp.str(), ec);
+        }
+
+        addTime(diskMicroseconds, elapsed(start));
+    }
+
+    // 経過時間の加算
+    void ShaderCache::addTime(std::atomic<uint64_t> &counter, const float milliseconds)
+    {
+        counter += static_cast<uint64_t>(milliseconds * 1000.0f);
+    }
+}
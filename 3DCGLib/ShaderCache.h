@@ -0,0 +1,128 @@
+#pragma once
+#ifndef SHADERCACHE_H
+#define SHADERCACHE_H
+#include <atomic>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Lib
+{
+    // マクロ定義
+    struct ShaderDefine
+    {
+        std::string name;
+        std::string value;
+    };
+
+    // コンパイル対象のシェーダー
+    struct ShaderSource
+    {
+        std::string               name;       // エラー表示用のファイル名
+        std::string               code;       // HLSLソース
+        std::string               entryPoint;
+        std::string               profile;    // "vs_4_0"など
+        uint32_t                  flags;      // D3DCOMPILE_*
+        std::vector<ShaderDefine> defines;
+    };
+
+    // コンパイル済みバイトコード(共有・変更不可)
+    using ShaderBytecode = std::shared_ptr<const std::vector<uint8_t>>;
+
+    // #includeで読み込んだファイル(内容が変わったらディスクキャッシュを使わない)
+    struct ShaderInclude
+    {
+        std::string path;
+        uint64_t    hash; // 内容のFNV-1a
+    };
+
+    // シェーダーコンパイラのインターフェース
+    class IShaderCompiler
+    {
+    public:
+        virtual ~IShaderCompiler() {}
+        // #includeで読み込んだファイルは全てincludesへ追加する(ShaderCache::readInclude()で読むと追加される)
+        virtual bool compile(const ShaderSource &source, std::vector<uint8_t> &bytecode, std::vector<ShaderInclude> &includes, std::string &error) = 0;
+        // コンパイラの版(キーに含めるので、変わると全てコンパイルし直す)
+        virtual uint64_t getVersion() const = 0;
+    };
+
+    // ソース・エントリーポイント・プロファイル・フラグ・マクロとコンパイラの版のハッシュをキーとするシェーダーキャッシュ
+    // メモリ上とディスク上の2段構成で、複数スレッドから同時に呼び出せる
+    // ディスクキャッシュには#includeしたファイルの内容のハッシュも保存し、読み込み時に変わっていれば捨ててコンパイルし直す
+    class ShaderCache
+    {
+    public:
+        // 統計情報
+        struct Stats
+        {
+            uint64_t requests;
+            uint64_t memoryHits;
+            uint64_t diskHits;
+            uint64_t compiles;
+            uint64_t failures;
+            uint64_t invalidations; // #includeしたファイルの変更や破損で捨てたディスクキャッシュの数
+            float    diskTime;      // ディスク読み書きの累計(ミリ秒)
+            float    compileTime;   // コンパイルの累計(ミリ秒)
+        };
+
+        // directoryが空の場合はディスクキャッシュを使わない
+        ShaderCache(std::shared_ptr<IShaderCompiler> _compiler, const std::string &_directory = "");
+        ~ShaderCache();
+
+        // キーの計算
+        static uint64_t makeKey(const ShaderSource &source, const uint64_t compilerVersion = 0);
+
+        // バイトコードの取得(失敗時はnullptr)
+        ShaderBytecode get(const ShaderSource &source, std::string *error = nullptr);
+        // ファイルから読み込んで取得
+        ShaderBytecode getFromFile(const std::string &path, const std::string &entryPoint, const std::string &profile, const uint32_t flags, const std::vector<ShaderDefine> &defines = {}, std::string *error = nullptr);
+
+        // メモリ上のキャッシュを破棄する
+        void clearMemory();
+
+        Stats getStats() const;
+        void  resetStats();
+
+        // #includeされたファイルを読み込み、includesへ追加する
+        static bool readInclude(const std::string &path, std::string &code, std::vector<ShaderInclude> &includes);
+
+    private:
+        // コピーの禁止
+        ShaderCache(const ShaderCache &) = delete;
+        ShaderCache& operator=(const ShaderCache &) = delete;
+
+        // 取得の結果(コンパイル中に待っていたスレッドにもエラーを渡す)
+        struct Result
+        {
+            ShaderBytecode bytecode;
+            std::string    error;
+        };
+
+        std::string makePath(const uint64_t key) const;
+        ShaderBytecode loadFromDisk(const uint64_t key);
+        void saveToDisk(const uint64_t key, const std::vector<uint8_t> &bytecode, const std::vector<ShaderInclude> &includes);
+        void addTime(std::atomic<uint64_t> &counter, const float milliseconds);
+
+        std::shared_ptr<IShaderCompiler> compiler;
+        std::string                      directory;
+
+        mutable std::shared_mutex                                mutex;
+        std::unordered_map<uint64_t, std::shared_future<Result>> entries;
+
+        std::atomic<uint64_t> requests;
+        std::atomic<uint64_t> memoryHits;
+        std::atomic<uint64_t> diskHits;
+        std::atomic<uint64_t> compiles;
+        std::atomic<uint64_t> failures;
+        std::atomic<uint64_t> invalidations;
+        std::atomic<uint64_t> diskMicroseconds;
+        std::atomic<uint64_t> compileMicroseconds;
+    };
+}
+
+#endif
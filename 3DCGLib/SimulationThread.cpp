@@ -0,0 +1,155 @@
+#include <algorithm>
+#include "FrameScheduler.h"
+#include "Profiler.h"
+#include "SimulationThread.h"
+
+namespace Lib
+{
+    // コンストラクタ
+    SimulationThread::SimulationThread(const float _stepRate, const StepFunc &_step, const PublishFunc &_publish)
+        : step(_step), publish(_publish), stepRate(std::max(_stepRate, 1.0f)), stepTime(1000.0f / stepRate),
+          running(false), paused(false), manual(false), manualTick(0), steps(0), droppedSteps(0), wakeups(0), updateTime(0)
+    {
+        period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / stepRate));
+    }
+
+    // デストラクタ
+    SimulationThread::~SimulationThread()
+    {
+        stop();
+    }
+
+    // スレッドを開始
+    void SimulationThread::start()
+    {
+        if (running.exchange(true)) {
+            return;
+        }
+        thread = std::thread(&SimulationThread::run, this);
+    }
+
+    // スレッドを停止(実行中のステップが終わるまで待つ)
+    void SimulationThread::stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(pauseMutex);
+            running = false;
+        }
+        pauseCondition.notify_one();
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+
+    // 一時停止
+    void SimulationThread::pause()
+    {
+        paused = true;
+    }
+
+    // 再開
+    void SimulationThread::resume()
+    {
+        if (!paused) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(pauseMutex);
+            paused = false;
+        }
+        pauseCondition.notify_one();
+    }
+
+    // 1つ前のステップからの補間の割合
+    float SimulationThread::getInterpolation(const Clock::time_point time) const
+    {
+        auto now = manual ? manualTime : Clock::now();
+        auto t   = std::chrono::duration<float>(now - time) / std::chrono::duration<float>(period);
+        return std::min(std::max(t, 0.0f), 1.0f);
+    }
+
+    // 仮想の時計でステップを進める
+    void SimulationThread::advance(const float elapsed)
+    {
+        if (!manual) {
+            // 時計の起点は固定の値にして、実行ごとに同じ時刻の並びにする
+            manual      = true;
+            manualStart = Clock::time_point();
+            manualTime  = manualStart;
+            manualTick  = 0;
+        }
+        manualTime += std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(elapsed));
+        // 止まっていた間のステップは進めない(再開した時刻から数え直す)
+        if (paused) {
+            manualStart = manualTime;
+            manualTick  = 0;
+            return;
+        }
+
+        auto     begin = Clock::now();
+        uint64_t due   = static_cast<uint64_t>((manualTime - manualStart) / period);
+        if (due <= manualTick) {
+            return;
+        }
+        if (due - manualTick > MAX_CATCHUP) {
+            droppedSteps += due - manualTick - MAX_CATCHUP;
+            manualTick = due - MAX_CATCHUP;
+        }
+        PROFILE_SCOPE("SimulationThread::update");
+        for (; manualTick < due; ++manualTick) {
+            step(stepTime);
+            ++steps;
+        }
+        publish(manualStart + period * static_cast<Clock::rep>(manualTick));
+
+        ++wakeups;
+        updateTime += std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - begin).count();
+    }
+
+    // 統計情報
+    SimulationThread::Stats SimulationThread::getStats() const
+    {
+        auto count = wakeups.load();
+        return Stats{ steps.load(), droppedSteps.load(), count > 0 ? updateTime.load() / 1000.0f / count : 0.0f };
+    }
+
+    // スレッドの処理
+    void SimulationThread::run()
+    {
+        Profiler::getInstance().setThreadName("simulation");
+        auto     startTime = Clock::now();
+        uint64_t tick      = 0; // 進めたステップ数(状態はstartTime + tick * periodの時刻のもの)
+        FrameScheduler scheduler(stepRate);
+        while (running) {
+            if (paused) {
+                std::unique_lock<std::mutex> lock(pauseMutex);
+                pauseCondition.wait(lock, [this] { return !paused || !running; });
+                // 止まっていた間のステップは進めない
+                startTime = Clock::now();
+                tick      = 0;
+                continue;
+            }
+            scheduler.waitForNextFrame();
+
+            // 現在時刻までのステップを進める(追いつけないほど遅れた分は捨てる)
+            auto     begin = Clock::now();
+            uint64_t due   = static_cast<uint64_t>((begin - startTime) / period);
+            if (due <= tick) {
+                continue;
+            }
+            if (due - tick > MAX_CATCHUP) {
+                droppedSteps += due - tick - MAX_CATCHUP;
+                tick = due - MAX_CATCHUP;
+            }
+            PROFILE_SCOPE("SimulationThread::update");
+            for (; tick < due; ++tick) {
+                step(stepTime);
+                ++steps;
+            }
+            publish(startTime + period * static_cast<Clock::rep>(tick));
+
+            ++wakeups;
+            updateTime += std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - begin).count();
+        }
+    }
+}
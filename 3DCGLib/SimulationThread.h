@@ -0,0 +1,94 @@
+#pragma once
+#ifndef SIMULATIONTHREAD_H
+#define SIMULATIONTHREAD_H
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace Lib
+{
+    // 固定の時間刻みでシミュレーションを進めるスレッド
+    //
+    // 描画とは別のスレッドで、stepRate回/秒の間隔でstepを呼ぶ(描画が遅れてもステップの長さは変わらない)
+    // 起きるたびに遅れている分のステップをまとめて進め、最後にpublishで結果を書き出す
+    // 結果はTripleBufferなどで描画スレッドへ渡し、描画側はgetInterpolation()で前後のステップの間を補間する
+    class SimulationThread
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        // 1ステップ進める(stepTimeはミリ秒)
+        using StepFunc    = std::function<void(const float stepTime)>;
+        // 結果を書き出す(timeは最後に進めたステップの時刻)
+        using PublishFunc = std::function<void(const Clock::time_point time)>;
+
+        // 1回に進めるステップ数の上限(これを超えた遅れは捨てる)
+        static const uint32_t MAX_CATCHUP = 5;
+
+        // 統計情報(startからの累計)
+        struct Stats
+        {
+            uint64_t steps;        // 進めたステップ数
+            uint64_t droppedSteps; // 遅れすぎて捨てたステップ数
+            float    updateTime;   // 1回の起床でのstepとpublishの処理時間の平均(ミリ秒)
+        };
+
+        SimulationThread(const float _stepRate, const StepFunc &_step, const PublishFunc &_publish);
+        ~SimulationThread();
+
+        void start();
+        void stop();
+        // 一時停止(入力がなく何も動かない間はスレッドを眠らせる)。再開後は止まっていた間の時間を進めない
+        void pause();
+        void resume();
+        bool isPaused() const { return paused; }
+
+        // スレッドを使わず、呼び出したスレッドでelapsedミリ秒分のステップを進める(start()とは併用しない)
+        // 時計は経過時間を足していく仮想のもので、同じelapsedの並びを渡せば同じステップの並びになる(入力の記録・再生用)
+        void advance(const float elapsed);
+        bool isManual() const { return manual; }
+
+        // 1ステップの長さ(ミリ秒)
+        float getStepTime() const { return stepTime; }
+        // timeの結果を現在の描画に使う場合の、1つ前のステップからの補間の割合(0～1)
+        // 描画は最大1ステップ遅れるが、ステップの間も滑らかに動く
+        float getInterpolation(const Clock::time_point time) const;
+
+        Stats getStats() const;
+
+    private:
+        // コピーの禁止
+        SimulationThread(const SimulationThread &) = delete;
+        SimulationThread& operator=(const SimulationThread &) = delete;
+
+        void run();
+
+        StepFunc          step;
+        PublishFunc       publish;
+        float             stepRate;
+        float             stepTime;
+        Clock::duration   period;
+        std::thread       thread;
+        std::atomic<bool> running;
+        std::atomic<bool> paused;
+        std::mutex              pauseMutex;
+        std::condition_variable pauseCondition;
+
+        // advance()で使う仮想の時計(呼び出したスレッドだけが触る)
+        bool              manual;
+        Clock::time_point manualStart;
+        Clock::time_point manualTime;
+        uint64_t          manualTick;
+
+        std::atomic<uint64_t> steps;
+        std::atomic<uint64_t> droppedSteps;
+        std::atomic<uint64_t> wakeups;
+        std::atomic<uint64_t> updateTime; // マイクロ秒
+    };
+}
+
+#endif
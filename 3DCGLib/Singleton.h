@@ -17,9 +17,9 @@ namespace Lib
 
     private:
         typedef std::unique_ptr<T> singleton_pointer_type;
-        // CX^X̐
+        // インスタンスの生成
         inline static T *createInstance() { return new T(); }
-        // CX^X̎擾
+        // インスタンスの取得
         inline static T &getReference(const singleton_pointer_type &ptr)
         {
             return *ptr;
@@ -29,7 +29,7 @@ namespace Lib
         Singleton() {}
 
     private:
-        // Rs[̋֎~
+        // コピーの禁止
         Singleton(const Singleton &) = delete;
         Singleton& operator=(const Singleton &) = delete;
         Singleton(Singleton&&) = delete;
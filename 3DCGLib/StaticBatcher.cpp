@@ -0,0 +1,414 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include "StaticBatcher.h"
+#include "Hash.h"
+
+namespace Lib
+{
+    namespace
+    {
+        // バッファを作り直す時の余裕(頻繁な作り直しを避ける)
+        uint32_t growCapacity(const uint32_t required)
+        {
+            return std::max(required + required / 2, 1024u);
+        }
+
+        // 法線の変換行列(worldの左上3x3の逆行列の転置)
+        // 余因子行列を行列式で割って求める。正規化し直すので、特異な場合は余因子行列のまま使う
+        void normalMatrix(const Matrix &world, float out[3][3])
+        {
+            auto &m = world.mat4x4;
+            for (int j = 0; j < 3; ++j) {
+                for (int k = 0; k < 3; ++k) {
+                    out[j][k] = m[(j + 1) % 3][(k + 1) % 3] * m[(j + 2) % 3][(k + 2) % 3] - m[(j + 1) % 3][(k + 2) % 3] * m[(j + 2) % 3][(k + 1) % 3];
+                }
+            }
+            float determinant = m[0][0] * out[0][0] + m[0][1] * out[0][1] + m[0][2] * out[0][2];
+            if (determinant != 0.0f) {
+                for (int j = 0; j < 3; ++j) {
+                    for (int k = 0; k < 3; ++k) {
+                        out[j][k] /= determinant;
+                    }
+                }
+            }
+        }
+
+        // レジストリのキー(プールの内容はバッチャーごとなので、バッチャーごとに番号を振る)
+        const uint64_t STATIC_BATCH = Hash::fnv1a("StaticBatch", 11);
+        std::atomic<uint64_t> nextBatcher(0);
+    }
+
+    const float StaticBatcher::COMPACT_THRESHOLD = 0.25f;
+
+    // コンストラクタ
+    StaticBatcher::StaticBatcher(ResourceRegistry &_registry)
+        : registry(_registry), bufferKey(Hash::combine(STATIC_BATCH, nextBatcher.fetch_add(1))),
+          vertexPoolSize(0), indexPoolSize(0), orderDirty(false), vertexCapacity(0), indexCapacity(0),
+          dirtyVertexBegin(0), dirtyVertexEnd(0), dirtyIndexBegin(0), dirtyIndexEnd(0),
+          stats{ 0, 0, 0, 0, 0, 0 }
+    {
+    }
+
+    // デストラクタ
+    StaticBatcher::~StaticBatcher()
+    {
+    }
+
+    // 追加
+    StaticBatcher::Handle StaticBatcher::add(const MeshView &mesh, const Matrix &world)
+    {
+        if (mesh.vertexCount == 0 || mesh.indexCount == 0) {
+            return INVALID_HANDLE;
+        }
+
+        Range range;
+        range.vertexCount = mesh.vertexCount;
+        range.indexCount  = mesh.indexCount;
+        range.firstVertex = allocate(freeVertices, vertexPoolSize, mesh.vertexCount);
+        range.firstIndex  = allocate(freeIndices,  indexPoolSize,  mesh.indexCount);
+        range.alive       = true;
+        range.visible     = true;
+        vertices.resize(vertexPoolSize);
+        indices.resize(indexPoolSize);
+
+        // 頂点をワールド座標へ変換(法線は逆行列の転置で変換し、拡縮が軸ごとに違っても面に垂直なままにする)
+        float normals[3][3];
+        normalMatrix(world, normals);
+        for (int k = 0; k < 3; ++k) {
+            range.bounds.min[k] =  HUGE_VALF;
+            range.bounds.max[k] = -HUGE_VALF;
+        }
+        for (uint32_t i = 0; i < mesh.vertexCount; ++i) {
+            auto &src = mesh.vertices[i];
+            auto &dst = vertices[range.firstVertex + i];
+            for (int k = 0; k < 3; ++k) {
+                dst.pos[k] = src.pos[0] * world.mat4x4[0][k] + src.pos[1] * world.mat4x4[1][k] + src.pos[2] * world.mat4x4[2][k] + world.mat4x4[3][k];
+                dst.normal[k] = src.normal[0] * normals[0][k] + src.normal[1] * normals[1][k] + src.normal[2] * normals[2][k];
+                range.bounds.min[k] = std::min(range.bounds.min[k], dst.pos[k]);
+                range.bounds.max[k] = std::max(range.bounds.max[k], dst.pos[k]);
+            }
+            float length = std::sqrt(dst.normal[0] * dst.normal[0] + dst.normal[1] * dst.normal[1] + dst.normal[2] * dst.normal[2]);
+            if (length > 0.0f) {
+                for (int k = 0; k < 3; ++k) {
+                    dst.normal[k] /= length;
+                }
+            }
+        }
+
+        // インデックスはプール内の頂点番号へ付け替える(常に32bit)
+        for (uint32_t i = 0; i < mesh.indexCount; ++i) {
+            uint32_t index = mesh.indexFormat == IndexFormat::UInt16 ? static_cast<const uint16_t*>(mesh.indices)[i] : static_cast<const uint32_t*>(mesh.indices)[i];
+            indices[range.firstIndex + i] = range.firstVertex + index;
+        }
+
+        markDirty(dirtyVertexBegin, dirtyVertexEnd, range.firstVertex, range.firstVertex + range.vertexCount);
+        markDirty(dirtyIndexBegin,  dirtyIndexEnd,  range.firstIndex,  range.firstIndex  + range.indexCount);
+
+        Handle handle;
+        if (!freeHandles.empty()) {
+            handle = freeHandles.back();
+            freeHandles.pop_back();
+            ranges[handle] = range;
+        }
+        else {
+            handle = static_cast<Handle>(ranges.size());
+            ranges.push_back(range);
+        }
+        drawOrder.push_back(handle);
+        orderDirty = true;
+        return handle;
+    }
+
+    // 削除
+    bool StaticBatcher::remove(const Handle handle)
+    {
+        if (handle >= ranges.size() || !ranges[handle].alive) {
+            return false;
+        }
+        auto &range = ranges[handle];
+        range.alive = false;
+        release(freeVertices, vertexPoolSize, range.firstVertex, range.vertexCount);
+        release(freeIndices,  indexPoolSize,  range.firstIndex,  range.indexCount);
+        vertices.resize(vertexPoolSize);
+        indices.resize(indexPoolSize);
+        dirtyVertexEnd = std::min(dirtyVertexEnd, vertexPoolSize);
+        dirtyIndexEnd  = std::min(dirtyIndexEnd,  indexPoolSize);
+
+        drawOrder.erase(std::find(drawOrder.begin(), drawOrder.end(), handle));
+        freeHandles.push_back(handle);
+        return true;
+    }
+
+    // 穴の割合(頂点とインデックスのプールの大きい方)
+    float StaticBatcher::getFragmentation() const
+    {
+        auto ratio = [](const std::vector<Block> &freeList, const uint32_t poolSize) {
+            if (poolSize == 0) {
+                return 0.0f;
+            }
+            uint32_t holes = 0;
+            for (auto &block : freeList) {
+                holes += block.count;
+            }
+            return static_cast<float>(holes) / poolSize;
+        };
+        return std::max(ratio(freeVertices, vertexPoolSize), ratio(freeIndices, indexPoolSize));
+    }
+
+    // 穴を詰める
+    void StaticBatcher::compact()
+    {
+        if (freeVertices.empty() && freeIndices.empty()) {
+            return;
+        }
+        sortDrawOrder();
+
+        // インデックス順に詰め直す(同じ順で頂点も並べるので、以降の追加も連続しやすい)
+        std::vector<SimpleVertex> newVertices;
+        std::vector<uint32_t>     newIndices;
+        newVertices.reserve(vertices.size());
+        newIndices.reserve(indices.size());
+        for (auto handle : drawOrder) {
+            auto &range = ranges[handle];
+            auto firstVertex = static_cast<uint32_t>(newVertices.size());
+            auto firstIndex  = static_cast<uint32_t>(newIndices.size());
+            newVertices.insert(newVertices.end(), vertices.begin() + range.firstVertex, vertices.begin() + range.firstVertex + range.vertexCount);
+            for (uint32_t i = 0; i < range.indexCount; ++i) {
+                newIndices.push_back(indices[range.firstIndex + i] - range.firstVertex + firstVertex);
+            }
+            range.firstVertex = firstVertex;
+            range.firstIndex  = firstIndex;
+        }
+
+        vertices.swap(newVertices);
+        indices.swap(newIndices);
+        vertexPoolSize = static_cast<uint32_t>(vertices.size());
+        indexPoolSize  = static_cast<uint32_t>(indices.size());
+        freeVertices.clear();
+        freeIndices.clear();
+        dirtyVertexBegin = 0;
+        dirtyVertexEnd   = vertexPoolSize;
+        dirtyIndexBegin  = 0;
+        dirtyIndexEnd    = indexPoolSize;
+        ++stats.compactions;
+    }
+
+    // 視錐台カリング
+    void StaticBatcher::cull(const Matrix &viewProjection)
+    {
+        // クリップ空間の各平面(Gribb-Hartmannの方法。列ベクトルの組み合わせで求める)
+        auto &m = viewProjection.mat4x4;
+        float planes[6][4];
+        for (int k = 0; k < 4; ++k) {
+            planes[0][k] = m[k][3] + m[k][0]; // 左
+            planes[1][k] = m[k][3] - m[k][0]; // 右
+            planes[2][k] = m[k][3] + m[k][1]; // 下
+            planes[3][k] = m[k][3] - m[k][1]; // 上
+            planes[4][k] = m[k][2];           // 近
+            planes[5][k] = m[k][3] - m[k][2]; // 遠
+        }
+
+        for (auto handle : drawOrder) {
+            auto &range = ranges[handle];
+            range.visible = true;
+            for (auto &plane : planes) {
+                // 平面の法線方向に最も進んだ頂点が裏側なら全体が外側
+                float x = plane[0] > 0.0f ? range.bounds.max[0] : range.bounds.min[0];
+                float y = plane[1] > 0.0f ? range.bounds.max[1] : range.bounds.min[1];
+                float z = plane[2] > 0.0f ? range.bounds.max[2] : range.bounds.min[2];
+                if (plane[0] * x + plane[1] * y + plane[2] * z + plane[3] < 0.0f) {
+                    range.visible = false;
+                    break;
+                }
+            }
+        }
+    }
+
+    // 全て表示
+    void StaticBatcher::setAllVisible()
+    {
+        for (auto handle : drawOrder) {
+            ranges[handle].visible = true;
+        }
+    }
+
+    // 見えている範囲全体のAABB
+    bool StaticBatcher::getVisibleBounds(Bounds &bounds) const
+    {
+        bool found = false;
+        for (auto handle : drawOrder) {
+            auto &range = ranges[handle];
+            if (!range.alive || !range.visible) {
+                continue;
+            }
+            if (!found) {
+                bounds = range.bounds;
+                found  = true;
+                continue;
+            }
+            for (int k = 0; k < 3; ++k) {
+                bounds.min[k] = std::min(bounds.min[k], range.bounds.min[k]);
+                bounds.max[k] = std::max(bounds.max[k], range.bounds.max[k]);
+            }
+        }
+        return found;
+    }
+
+    // 描画の記録
+    void StaticBatcher::record(CommandList &commands)
+    {
+        stats.ranges        = static_cast<uint32_t>(drawOrder.size());
+        stats.visibleRanges = 0;
+        stats.draws         = 0;
+        stats.bindings      = 0;
+        stats.uploadBytes   = 0;
+
+        if (getFragmentation() > COMPACT_THRESHOLD) {
+            compact();
+        }
+        upload(commands);
+        if (!vertexBuffer || !indexBuffer) {
+            return;
+        }
+        sortDrawOrder();
+
+        // 見えている範囲のうちインデックスが連続するものをまとめる
+        bool     bound = false;
+        uint32_t start = 0;
+        uint32_t count = 0;
+        auto flush = [&]() {
+            if (count == 0) {
+                return;
+            }
+            if (!bound) {
+                commands.setVertexBuffer(vertexBuffer.get(), sizeof(SimpleVertex));
+                commands.setIndexBuffer(indexBuffer.get(), IndexFormat::UInt32);
+                stats.bindings += 2;
+                bound = true;
+            }
+            commands.drawIndexed(count, start);
+            ++stats.draws;
+            count = 0;
+        };
+        for (auto handle : drawOrder) {
+            auto &range = ranges[handle];
+            if (!range.visible) {
+                flush();
+                continue;
+            }
+            ++stats.visibleRanges;
+            if (count != 0 && range.firstIndex != start + count) {
+                flush();
+            }
+            if (count == 0) {
+                start = range.firstIndex;
+            }
+            count += range.indexCount;
+        }
+        flush();
+    }
+
+    // 空きリストから確保
+    uint32_t StaticBatcher::allocate(std::vector<Block> &freeList, uint32_t &poolSize, const uint32_t count)
+    {
+        for (auto block = freeList.begin(); block != freeList.end(); ++block) {
+            if (block->count >= count) {
+                auto offset = block->offset;
+                block->offset += count;
+                block->count  -= count;
+                if (block->count == 0) {
+                    freeList.erase(block);
+                }
+                return offset;
+            }
+        }
+        auto offset = poolSize;
+        poolSize += count;
+        return offset;
+    }
+
+    // 空きリストへ返す
+    void StaticBatcher::release(std::vector<Block> &freeList, uint32_t &poolSize, const uint32_t offset, const uint32_t count)
+    {
+        // 位置順に挿入して前後と結合する
+        auto next = std::lower_bound(freeList.begin(), freeList.end(), offset, [](const Block &block, const uint32_t value) { return block.offset < value; });
+        auto it = freeList.insert(next, Block{ offset, count });
+        if (it + 1 != freeList.end() && it->offset + it->count == (it + 1)->offset) {
+            it->count += (it + 1)->count;
+            freeList.erase(it + 1);
+        }
+        if (it != freeList.begin() && (it - 1)->offset + (it - 1)->count == it->offset) {
+            (it - 1)->count += it->count;
+            it = freeList.erase(it) - 1;
+        }
+
+        // 末尾の空きはプールを縮めて消す
+        if (it->offset + it->count == poolSize) {
+            poolSize = it->offset;
+            freeList.erase(it);
+        }
+    }
+
+    // 転送が必要な範囲を広げる
+    void StaticBatcher::markDirty(uint32_t &dirtyBegin, uint32_t &dirtyEnd, const uint32_t begin, const uint32_t end)
+    {
+        if (dirtyBegin == dirtyEnd) {
+            dirtyBegin = begin;
+            dirtyEnd   = end;
+            return;
+        }
+        dirtyBegin = std::min(dirtyBegin, begin);
+        dirtyEnd   = std::max(dirtyEnd, end);
+    }
+
+    // GPUバッファの更新
+    void StaticBatcher::upload(CommandList &commands)
+    {
+        // 容量が足りなければ作り直して全体を転送する
+        // (古いバッファは先に手放し、新旧の両方を同時に持たない)
+        if (vertexPoolSize > vertexCapacity || !vertexBuffer) {
+            vertexBuffer.reset();
+            vertexCapacity = growCapacity(vertexPoolSize);
+            vertexBuffer   = registry.getBuffer(ResourceType::VertexBuffer, Hash::combine(bufferKey, vertexCapacity), vertexCapacity * sizeof(SimpleVertex), sizeof(SimpleVertex), nullptr);
+            dirtyVertexBegin = 0;
+            dirtyVertexEnd   = vertexPoolSize;
+        }
+        if (indexPoolSize > indexCapacity || !indexBuffer) {
+            indexBuffer.reset();
+            indexCapacity = growCapacity(indexPoolSize);
+            indexBuffer   = registry.getBuffer(ResourceType::IndexBuffer, Hash::combine(bufferKey, indexCapacity), indexCapacity * sizeof(uint32_t), sizeof(uint32_t), nullptr);
+            dirtyIndexBegin = 0;
+            dirtyIndexEnd   = indexPoolSize;
+        }
+        if (!vertexBuffer || !indexBuffer) {
+            return;
+        }
+
+        if (dirtyVertexBegin < dirtyVertexEnd) {
+            auto bytes = (dirtyVertexEnd - dirtyVertexBegin) * static_cast<uint32_t>(sizeof(SimpleVertex));
+            auto data  = commands.updateBufferRange(vertexBuffer.get(), dirtyVertexBegin * sizeof(SimpleVertex), bytes);
+            std::memcpy(data, vertices.data() + dirtyVertexBegin, bytes);
+            stats.uploadBytes += bytes;
+        }
+        if (dirtyIndexBegin < dirtyIndexEnd) {
+            auto bytes = (dirtyIndexEnd - dirtyIndexBegin) * static_cast<uint32_t>(sizeof(uint32_t));
+            auto data  = commands.updateBufferRange(indexBuffer.get(), dirtyIndexBegin * sizeof(uint32_t), bytes);
+            std::memcpy(data, indices.data() + dirtyIndexBegin, bytes);
+            stats.uploadBytes += bytes;
+        }
+        dirtyVertexBegin = dirtyVertexEnd = 0;
+        dirtyIndexBegin  = dirtyIndexEnd  = 0;
+    }
+
+    // 描画順(インデックス順)に並べる
+    void StaticBatcher::sortDrawOrder()
+    {
+        if (!orderDirty) {
+            return;
+        }
+        std::sort(drawOrder.begin(), drawOrder.end(), [this](const Handle a, const Handle b) { return ranges[a].firstIndex < ranges[b].firstIndex; });
+        orderDirty = false;
+    }
+}
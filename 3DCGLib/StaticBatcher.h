@@ -0,0 +1,137 @@
+#pragma once
+#ifndef STATICBATCHER_H
+#define STATICBATCHER_H
+#include <cstdint>
+#include <vector>
+#include "Matrix.h"
+#include "MeshData.h"
+#include "RenderDevice.h"
+#include "ResourceRegistry.h"
+#include "CommandList.h"
+
+namespace Lib
+{
+    // 動かないメッシュをワールド座標へ変換して共有の頂点・インデックスプールへ詰める
+    //
+    // 各メッシュはプール内の連続した範囲を持ち、カリングで見えている範囲のうち
+    // インデックスが連続するものを1回のDrawIndexedにまとめる
+    // 削除した範囲は空きリストで再利用し、compact()で穴を詰める
+    // GPUバッファはレジストリに登録するので、メモリの見積もり(RenderStats::measureMemory())に含まれる
+    class StaticBatcher
+    {
+    public:
+        using Handle = uint32_t;
+        static const Handle INVALID_HANDLE = 0xFFFFFFFF;
+        // record()で自動的にcompact()する穴の割合
+        static const float COMPACT_THRESHOLD;
+
+        // ワールド座標のAABB
+        struct Bounds
+        {
+            float min[3];
+            float max[3];
+        };
+
+        // 統計情報(record()ごとに更新。compactionsは通算)
+        struct Stats
+        {
+            uint32_t ranges;        // 登録中のメッシュ数
+            uint32_t visibleRanges; // カリングを通過したメッシュ数
+            uint32_t draws;         // DrawIndexedの回数
+            uint32_t bindings;      // 頂点・インデックスバッファの設定回数
+            uint32_t uploadBytes;   // 転送したバイト数
+            uint32_t compactions;
+        };
+
+        // registryの寿命はこのオブジェクトより長いこと
+        explicit StaticBatcher(ResourceRegistry &_registry);
+        ~StaticBatcher();
+
+        StaticBatcher(const StaticBatcher&) = delete;
+        StaticBatcher &operator=(const StaticBatcher&) = delete;
+
+        // worldで変換して追加する(削除したHandleの番号は再利用される)
+        Handle add(const MeshView &mesh, const Matrix &world);
+        bool   remove(const Handle handle);
+
+        // プール内の穴の割合(0～1。頂点とインデックスのプールの大きい方)
+        float getFragmentation() const;
+        // 穴を詰めて登録順(インデックス順)に並べ直す
+        void compact();
+
+        // 視錐台カリング(viewProjectionは行ベクトル規約、深度は0～1)
+        void cull(const Matrix &viewProjection);
+        void setAllVisible();
+
+        // バッファの更新と描画を記録する(シェーダーと定数は呼び出し側で設定しておくこと)
+        // ※穴がCOMPACT_THRESHOLDを超えていれば先に詰める
+        void record(CommandList &commands);
+
+        const Bounds &getBounds(const Handle handle) const { return ranges[handle].bounds; }
+        // 見えている範囲全体のAABB(見えている範囲がなければfalse)
+        bool          getVisibleBounds(Bounds &bounds) const;
+        bool          isVisible(const Handle handle) const { return ranges[handle].visible; }
+        uint32_t      getVertexCount() const { return static_cast<uint32_t>(vertices.size()); }
+        uint32_t      getIndexCount() const { return static_cast<uint32_t>(indices.size()); }
+        const Stats  &getStats() const { return stats; }
+
+    private:
+        // 1メッシュ分の範囲
+        struct Range
+        {
+            uint32_t firstVertex;
+            uint32_t vertexCount;
+            uint32_t firstIndex;
+            uint32_t indexCount;
+            Bounds   bounds;
+            bool     alive;
+            bool     visible;
+        };
+
+        // 空き領域
+        struct Block
+        {
+            uint32_t offset;
+            uint32_t count;
+        };
+
+        // 空きリストから確保(先頭から最初に収まる領域)。無ければpoolSizeの末尾を伸ばす
+        static uint32_t allocate(std::vector<Block> &freeList, uint32_t &poolSize, const uint32_t count);
+        // 空きリストへ返す(隣接する領域は結合し、末尾ならプールを縮める)
+        static void     release(std::vector<Block> &freeList, uint32_t &poolSize, const uint32_t offset, const uint32_t count);
+
+        // 転送が必要な範囲を広げる
+        static void markDirty(uint32_t &dirtyBegin, uint32_t &dirtyEnd, const uint32_t begin, const uint32_t end);
+        void upload(CommandList &commands);
+        void sortDrawOrder();
+
+        ResourceRegistry &registry;
+        uint64_t          bufferKey; // このバッチャーのバッファのキー(容量と組み合わせる)
+
+        std::vector<SimpleVertex> vertices;
+        std::vector<uint32_t>     indices;
+        uint32_t                  vertexPoolSize;
+        uint32_t                  indexPoolSize;
+        std::vector<Block>        freeVertices;
+        std::vector<Block>        freeIndices;
+
+        std::vector<Range>  ranges;      // Handleで引く
+        std::vector<Handle> freeHandles;
+        std::vector<Handle> drawOrder;   // 生きている範囲をインデックス順に並べたもの
+        bool                orderDirty;
+
+        // GPU側(容量は要素数)
+        ResourceRef    vertexBuffer;
+        ResourceRef    indexBuffer;
+        uint32_t       vertexCapacity;
+        uint32_t       indexCapacity;
+        uint32_t       dirtyVertexBegin; // 転送が必要な範囲 [begin, end)
+        uint32_t       dirtyVertexEnd;
+        uint32_t       dirtyIndexBegin;
+        uint32_t       dirtyIndexEnd;
+
+        Stats stats;
+    };
+}
+
+#endif
@@ -2,27 +2,27 @@
 
 namespace Lib
 {
-    // RXgN^
+    // コンストラクタ
     Time::Time()
     {
-        start = std::chrono::system_clock::now();
+        start = std::chrono::steady_clock::now();
     }
-    // fXgN^
+    // デストラクタ
     Time::~Time()
     {
     }
-    // DeltaTimeԂ
+    // DeltaTimeを返す
     float Time::getDeltaTime() const
     {
-        auto end = std::chrono::system_clock::now();
+        auto end = std::chrono::steady_clock::now();
         return std::chrono::duration<float, std::milli>(end - start).count();
     }
-    // Jňoߎ
+    // 開始からの経過時間
     float Time::getCurrentTime() const
     {
         return std::chrono::duration<float, std::milli>(start.time_since_epoch()).count();
     }
-    // œnԂo߂ĂtrueԂ(~b)
+    // 引数で渡した時間が経過していればtrueを返す(ミリ秒)
     bool Time::timeOver(const float limit)
     {
         if (limit <= getDeltaTime()) {
@@ -31,9 +31,9 @@ namespace Lib
 
         return false;
     }
-    // JnԂZbg
+    // 開始時間をリセット
     void Time::reset()
     {
-        start = std::chrono::system_clock::now();
+        start = std::chrono::steady_clock::now();
     }
 }
\ No newline at end of file
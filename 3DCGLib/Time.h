@@ -17,7 +17,7 @@ namespace Lib
         void reset();
 
     private:
-        std::chrono::time_point<std::chrono::system_clock> start;
+        std::chrono::time_point<std::chrono::steady_clock> start; // 単調増加の時計(システム時刻の変更で戻らない)
     };
 }
 
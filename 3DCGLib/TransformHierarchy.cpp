@@ -0,0 +1,332 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include "TransformHierarchy.h"
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE__)
+#include <xmmintrin.h>
+#define TRANSFORM_HIERARCHY_SSE
+#endif
+
+namespace Lib
+{
+    namespace
+    {
+        // 拡大→x回転→y回転→z回転→平行移動の行列(Matrix::scale() * rotateX() * rotateY() * rotateZ() * translate()と同じ)
+        void composeLocal(TransformHierarchy::Affine &out, const TransformHierarchy::Float3 &position, const TransformHierarchy::Float3 &rotation, const TransformHierarchy::Float3 &scale)
+        {
+            float sx = std::sin(rotation.x), cx = std::cos(rotation.x);
+            float sy = std::sin(rotation.y), cy = std::cos(rotation.y);
+            float sz = std::sin(rotation.z), cz = std::cos(rotation.z);
+
+            out.m11 = scale.x * (cy * cz);
+            out.m12 = scale.x * (cy * sz);
+            out.m13 = scale.x * (-sy);
+            out.m21 = scale.y * (sx * sy * cz - cx * sz);
+            out.m22 = scale.y * (sx * sy * sz + cx * cz);
+            out.m23 = scale.y * (sx * cy);
+            out.m31 = scale.z * (cx * sy * cz + sx * sz);
+            out.m32 = scale.z * (cx * sy * sz - sx * cz);
+            out.m33 = scale.z * (cx * cy);
+            out.m41 = position.x;
+            out.m42 = position.y;
+            out.m43 = position.z;
+        }
+
+        // アフィン変換どうしの積(4列目が(0, 0, 0, 1)であることを利用して計算を減らす)
+        void multiplyAffine(Matrix &out, const TransformHierarchy::Affine &a, const Matrix &b)
+        {
+#ifdef TRANSFORM_HIERARCHY_SSE
+            // 出力の各行 = aの行の要素 × bの各行 の和(bの4列目が(0, 0, 0, 1)なので出力の4列目も保たれる)
+            __m128 r0 = _mm_loadu_ps(&b.m11);
+            __m128 r1 = _mm_loadu_ps(&b.m21);
+            __m128 r2 = _mm_loadu_ps(&b.m31);
+            __m128 r3 = _mm_loadu_ps(&b.m41);
+            auto row = [&](const float x, const float y, const float z) {
+                return _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(x), r0), _mm_mul_ps(_mm_set1_ps(y), r1)), _mm_mul_ps(_mm_set1_ps(z), r2));
+            };
+            __m128 o0 = row(a.m11, a.m12, a.m13);
+            __m128 o1 = row(a.m21, a.m22, a.m23);
+            __m128 o2 = row(a.m31, a.m32, a.m33);
+            __m128 o3 = _mm_add_ps(row(a.m41, a.m42, a.m43), r3);
+            _mm_storeu_ps(&out.m11, o0);
+            _mm_storeu_ps(&out.m21, o1);
+            _mm_storeu_ps(&out.m31, o2);
+            _mm_storeu_ps(&out.m41, o3);
+#else
+            // 先に全て読み込んでおく(outとbが重なっていないことをコンパイラが仮定できないため)
+            const float r11 = b.m11, r12 = b.m12, r13 = b.m13;
+            const float r21 = b.m21, r22 = b.m22, r23 = b.m23;
+            const float r31 = b.m31, r32 = b.m32, r33 = b.m33;
+            const float r41 = b.m41, r42 = b.m42, r43 = b.m43;
+
+            out.m11 = a.m11 * r11 + a.m12 * r21 + a.m13 * r31;
+            out.m12 = a.m11 * r12 + a.m12 * r22 + a.m13 * r32;
+            out.m13 = a.m11 * r13 + a.m12 * r23 + a.m13 * r33;
+            out.m14 = 0.0f;
+            out.m21 = a.m21 * r11 + a.m22 * r21 + a.m23 * r31;
+            out.m22 = a.m21 * r12 + a.m22 * r22 + a.m23 * r32;
+            out.m23 = a.m21 * r13 + a.m22 * r23 + a.m23 * r33;
+            out.m24 = 0.0f;
+            out.m31 = a.m31 * r11 + a.m32 * r21 + a.m33 * r31;
+            out.m32 = a.m31 * r12 + a.m32 * r22 + a.m33 * r32;
+            out.m33 = a.m31 * r13 + a.m32 * r23 + a.m33 * r33;
+            out.m34 = 0.0f;
+            out.m41 = a.m41 * r11 + a.m42 * r21 + a.m43 * r31 + b.m41;
+            out.m42 = a.m41 * r12 + a.m42 * r22 + a.m43 * r32 + b.m42;
+            out.m43 = a.m41 * r13 + a.m42 * r23 + a.m43 * r33 + b.m43;
+            out.m44 = 1.0f;
+#endif
+        }
+    }
+
+    // コンストラクタ
+    TransformHierarchy::TransformHierarchy()
+        : firstDirty(NONE), changedBegin(0), stats{ 0, 0, 0, 0, 0.0f }
+    {
+    }
+
+    // 領域の予約
+    void TransformHierarchy::reserve(const size_t count)
+    {
+        positions.reserve(count);
+        rotations.reserve(count);
+        scales.reserve(count);
+        parents.reserve(count);
+        depths.reserve(count);
+        flags.reserve(count);
+        locals.reserve(count);
+        worlds.reserve(count);
+    }
+
+    // 全ノードの削除
+    void TransformHierarchy::clear()
+    {
+        positions.clear();
+        rotations.clear();
+        scales.clear();
+        parents.clear();
+        depths.clear();
+        flags.clear();
+        locals.clear();
+        worlds.clear();
+        firstDirty   = NONE;
+        changedBegin = 0;
+    }
+
+    // ノードの追加
+    TransformHierarchy::Node TransformHierarchy::create(const Node parent)
+    {
+        auto node = static_cast<Node>(parents.size());
+        if (parent != NONE && parent >= node) {
+            return NONE;
+        }
+        positions.push_back(Float3{ 0.0f, 0.0f, 0.0f });
+        rotations.push_back(Float3{ 0.0f, 0.0f, 0.0f });
+        scales.push_back(Float3{ 1.0f, 1.0f, 1.0f });
+        parents.push_back(parent);
+        depths.push_back(parent != NONE ? depths[parent] + 1 : 0);
+        flags.push_back(0);
+        locals.push_back(Affine{ 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f });
+        worlds.push_back(Matrix::Identify);
+        markDirty(node);
+        return node;
+    }
+
+    // 親の変更
+    bool TransformHierarchy::setParent(const Node node, const Node parent)
+    {
+        if (node >= size() || (parent != NONE && parent >= node)) {
+            return false;
+        }
+        parents[node] = parent;
+        // 子孫はnodeより後ろにしかないので、そこから深さを付け直す
+        for (size_t i = node; i < parents.size(); ++i) {
+            depths[i] = parents[i] != NONE ? depths[parents[i]] + 1 : 0;
+        }
+        markDirty(node);
+        return true;
+    }
+
+    // 位置
+    void TransformHierarchy::setPosition(const Node node, const Vector3 &position)
+    {
+        positions[node] = toFloat3(position);
+        markDirty(node);
+    }
+
+    // 回転
+    void TransformHierarchy::setRotation(const Node node, const Vector3 &rotation)
+    {
+        rotations[node] = toFloat3(rotation);
+        markDirty(node);
+    }
+
+    // 拡大率
+    void TransformHierarchy::setScale(const Node node, const Vector3 &scale)
+    {
+        scales[node] = toFloat3(scale);
+        markDirty(node);
+    }
+
+    // ローカルの変換をまとめて設定
+    void TransformHierarchy::setLocal(const Node node, const Vector3 &position, const Vector3 &rotation, const Vector3 &scale)
+    {
+        positions[node] = toFloat3(position);
+        rotations[node] = toFloat3(rotation);
+        scales[node]    = toFloat3(scale);
+        markDirty(node);
+    }
+
+    // 変更の記録
+    void TransformHierarchy::markDirty(const Node node)
+    {
+        flags[node] |= LOCAL_DIRTY;
+        firstDirty = std::min(firstDirty, node);
+    }
+
+    // 前回の更新の変更フラグを消す(firstDirty以降は更新時に付け直す)
+    void TransformHierarchy::clearChanged()
+    {
+        auto end = std::min<size_t>(firstDirty, flags.size());
+        for (size_t i = changedBegin; i < end; ++i) {
+            flags[i] &= ~WORLD_CHANGED;
+        }
+    }
+
+    // 配列の先頭をまとめる
+    TransformHierarchy::Arrays TransformHierarchy::getArrays()
+    {
+        return Arrays{ positions.data(), rotations.data(), scales.data(), parents.data(), flags.data(), locals.data(), worlds.data() };
+    }
+
+    // 1ノード分の計算
+    void TransformHierarchy::updateNode(const Arrays &arrays, const Node node)
+    {
+        auto &local = arrays.locals[node];
+        if (arrays.flags[node] & LOCAL_DIRTY) {
+            composeLocal(local, arrays.positions[node], arrays.rotations[node], arrays.scales[node]);
+        }
+        auto parent = arrays.parents[node];
+        if (parent != NONE) {
+            multiplyAffine(arrays.worlds[node], local, arrays.worlds[parent]);
+        }
+        else {
+            arrays.worlds[node] = Matrix(
+                local.m11, local.m12, local.m13, 0.0f,
+                local.m21, local.m22, local.m23, 0.0f,
+                local.m31, local.m32, local.m33, 0.0f,
+                local.m41, local.m42, local.m43, 1.0f
+            );
+        }
+        arrays.flags[node] = WORLD_CHANGED;
+    }
+
+    // 逐次の更新
+    void TransformHierarchy::update()
+    {
+        auto start = std::chrono::steady_clock::now();
+        const auto count = static_cast<Node>(size());
+        clearChanged();
+
+        // uint8_tの書き込みは他の配列と重なりうるとみなされるため、
+        // 配列の先頭と集計はローカル変数に置いてループ内で読み直させない
+        const auto arrays = getArrays();
+        uint32_t localCount   = 0;
+        uint32_t updatedCount = 0;
+        for (Node i = firstDirty; i < count; ++i) {
+            auto parent = arrays.parents[i];
+            auto flag   = arrays.flags[i];
+            if (flag & LOCAL_DIRTY) {
+                ++localCount;
+                ++updatedCount;
+                updateNode(arrays, i);
+            }
+            else if (parent != NONE && (arrays.flags[parent] & WORLD_CHANGED)) {
+                // 親の変更の伝播(最も多い場合。ローカル行列はそのまま使う)
+                ++updatedCount;
+                multiplyAffine(arrays.worlds[i], arrays.locals[i], arrays.worlds[parent]);
+                arrays.flags[i] = WORLD_CHANGED;
+            }
+            else {
+                arrays.flags[i] = flag & ~WORLD_CHANGED;
+            }
+        }
+
+        stats = Stats{ count, localCount, updatedCount, 0, 0.0f };
+        changedBegin = std::min(firstDirty, count);
+        firstDirty   = NONE;
+        stats.updateTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // 並列の更新
+    void TransformHierarchy::updateParallel(JobSystem &jobs)
+    {
+        const auto count = static_cast<Node>(size());
+        if (jobs.getThreadCount() <= 1 || firstDirty >= count || count - firstDirty < MIN_PARALLEL) {
+            update();
+            return;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        clearChanged();
+
+        // 変更の伝播だけを先に済ませ、深さごとの数を数える
+        stats = Stats{ count, 0, 0, 0, 0.0f };
+        levelOffsets.assign(1, 0);
+        for (Node i = firstDirty; i < count; ++i) {
+            auto parent = parents[i];
+            if ((flags[i] & LOCAL_DIRTY) || (parent != NONE && (flags[parent] & WORLD_CHANGED))) {
+                flags[i] |= WORLD_CHANGED;
+                stats.locals += flags[i] & LOCAL_DIRTY;
+                ++stats.updated;
+                if (depths[i] + 2 > levelOffsets.size()) {
+                    levelOffsets.resize(depths[i] + 2, 0);
+                }
+                ++levelOffsets[depths[i] + 1];
+            }
+            else {
+                flags[i] &= ~WORLD_CHANGED;
+            }
+        }
+        const auto levels = static_cast<uint32_t>(levelOffsets.size() - 1);
+        const auto arrays = getArrays();
+
+        // 平均の幅が狭い(深い鎖のような)階層では分割の方が高くつく
+        if (static_cast<size_t>(levels) * MIN_SLICE > stats.updated) {
+            for (Node i = firstDirty; i < count; ++i) {
+                if (flags[i] & WORLD_CHANGED) {
+                    updateNode(arrays, i);
+                }
+            }
+        }
+        else {
+            // 深さ順に並べる(同じ深さの中では添字の順を保つ)
+            for (uint32_t level = 0; level < levels; ++level) {
+                levelOffsets[level + 1] += levelOffsets[level];
+            }
+            order.resize(stats.updated);
+            levelCursors.assign(levelOffsets.begin(), levelOffsets.end() - 1);
+            for (Node i = firstDirty; i < count; ++i) {
+                if (flags[i] & WORLD_CHANGED) {
+                    order[levelCursors[depths[i]]++] = i;
+                }
+            }
+
+            // 階層ごとに分割して計算し、全て終わってから次の階層へ進む
+            for (uint32_t level = 0; level < levels; ++level) {
+                const Node *nodes = order.data() + levelOffsets[level];
+                jobs.parallelFor(levelOffsets[level + 1] - levelOffsets[level], [&](const size_t begin, const size_t end) {
+                    for (size_t i = begin; i < end; ++i) {
+                        updateNode(arrays, nodes[i]);
+                    }
+                }, MIN_SLICE);
+            }
+            stats.levels = levels;
+        }
+
+        changedBegin = firstDirty;
+        firstDirty   = NONE;
+        stats.updateTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+}
@@ -0,0 +1,133 @@
+#pragma once
+#ifndef TRANSFORMHIERARCHY_H
+#define TRANSFORMHIERARCHY_H
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "JobSystem.h"
+#include "Matrix.h"
+#include "Vector3.h"
+
+namespace Lib
+{
+    // 親子関係を持つ変換の集まり
+    //
+    // ノードは属性ごとの連続した配列(SoA)に保持し、親は必ず子より前に並ぶ(トポロジカル順)
+    // そのため、ワールド行列は先頭から1回走査するだけで親→子の順に求まる
+    // 変更されたノードとその子孫だけを再計算する
+    class TransformHierarchy
+    {
+    public:
+        using Node = uint32_t;
+        static const Node   NONE         = 0xFFFFFFFF;
+        static const size_t MIN_PARALLEL = 16384; // 並列に更新する最小ノード数
+        static const size_t MIN_SLICE    = 1024;  // 1つのジョブで計算する最小ノード数
+
+        // ローカル行列(4列目の(0, 0, 0, 1)を省いて転送量を減らす)
+        struct Affine
+        {
+            float m11, m12, m13;
+            float m21, m22, m23;
+            float m31, m32, m33;
+            float m41, m42, m43;
+        };
+
+        // 配列に置く位置・回転・拡大率(Vector3ではなくfloatだけを持つ)
+        struct Float3
+        {
+            float x, y, z;
+        };
+
+        // 統計情報(update()ごとに更新)
+        struct Stats
+        {
+            uint32_t nodes;
+            uint32_t locals;     // ローカル行列を作り直したノード数
+            uint32_t updated;    // ワールド行列を計算し直したノード数
+            uint32_t levels;     // 並列更新で処理した階層の数(逐次なら0)
+            float    updateTime; // ミリ秒
+        };
+
+        TransformHierarchy();
+
+        void reserve(const size_t count);
+        // 全ノードの削除
+        void clear();
+        // ノードの追加(parentは作成済みのノード。位置0、回転0、拡大1で作成する)
+        Node create(const Node parent = NONE);
+        // 親の変更(トポロジカル順を保つため、parentはnodeより前に作成したノードに限る)
+        bool setParent(const Node node, const Node parent);
+
+        // ローカルの変換(回転はx→y→zの順のオイラー角。ラジアン)
+        void setPosition(const Node node, const Vector3 &position);
+        void setRotation(const Node node, const Vector3 &rotation);
+        void setScale(const Node node, const Vector3 &scale);
+        void setLocal(const Node node, const Vector3 &position, const Vector3 &rotation, const Vector3 &scale);
+
+        Vector3 getPosition(const Node node) const { return toVector3(positions[node]); }
+        Vector3 getRotation(const Node node) const { return toVector3(rotations[node]); }
+        Vector3 getScale(const Node node)    const { return toVector3(scales[node]); }
+        Node    getParent(const Node node)   const { return parents[node]; }
+
+        // 変更されたノードと子孫のワールド行列を計算し直す
+        void update();
+        // 幅の広い階層向け。同じ深さのノードをjobsで並列に計算する
+        void updateParallel(JobSystem &jobs);
+
+        // ワールド行列(update()の後に有効)
+        const Matrix &getWorldMatrix(const Node node) const { return worlds[node]; }
+        // 直前のupdate()でワールド行列が変わったか
+        bool isChanged(const Node node) const { return (flags[node] & WORLD_CHANGED) != 0; }
+
+        size_t       size()     const { return parents.size(); }
+        const Stats &getStats() const { return stats; }
+
+    private:
+        // flagsのビット
+        static const uint8_t LOCAL_DIRTY   = 1; // ローカルの変換が変更された
+        static const uint8_t WORLD_CHANGED = 2; // 直前の更新でワールド行列が変わった
+
+        // 各配列の先頭(更新のループで使う)
+        struct Arrays
+        {
+            const Float3  *positions;
+            const Float3  *rotations;
+            const Float3  *scales;
+            const Node    *parents;
+            uint8_t       *flags;
+            Affine        *locals;
+            Matrix        *worlds;
+        };
+
+        static Float3  toFloat3(const Vector3 &v) { return Float3{ v.x, v.y, v.z }; }
+        static Vector3 toVector3(const Float3 &v) { return Vector3(v.x, v.y, v.z); }
+
+        void markDirty(const Node node);
+        Arrays getArrays();
+        // 前回の更新の変更フラグを消す
+        void clearChanged();
+        // 1ノード分の計算(親のワールド行列は計算済みであること)
+        static void updateNode(const Arrays &arrays, const Node node);
+
+        // 属性ごとの配列(添字がノード)
+        std::vector<Float3>   positions;
+        std::vector<Float3>   rotations;
+        std::vector<Float3>   scales;
+        std::vector<Node>     parents;
+        std::vector<uint32_t> depths;
+        std::vector<uint8_t>  flags;
+        std::vector<Affine>   locals;
+        std::vector<Matrix>   worlds;
+
+        // 並列更新の作業領域(変更されたノードを深さ順に並べたもの)
+        std::vector<Node>     order;
+        std::vector<uint32_t> levelOffsets;
+        std::vector<uint32_t> levelCursors; // 並べる時の各階層の書き込み位置
+
+        Node  firstDirty;   // 変更されたノードの最小の添字
+        Node  changedBegin; // 前回の更新で変更フラグを立てた範囲の先頭
+        Stats stats;
+    };
+}
+
+#endif
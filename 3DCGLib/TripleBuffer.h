@@ -0,0 +1,65 @@
+#pragma once
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace Lib
+{
+    // 1つの書き込みスレッドから1つの読み込みスレッドへ最新の値を渡すトリプルバッファ
+    //
+    // 書き込み側・読み込み側・受け渡し用の3つのバッファを持ち、受け渡し用の番号をアトミックに交換する
+    // どちらも相手を待たない(読み込み側が遅れた場合、間の値は上書きされて最新の値だけが届く)
+    template <class T>
+    class TripleBuffer
+    {
+    public:
+        explicit TripleBuffer(const T &initial = T())
+            : middle(1), back(2), front(0)
+        {
+            buffers.fill(initial);
+        }
+
+        // 書き込み側: 次に公開する値を書くバッファ
+        T &getWriteBuffer()
+        {
+            return buffers[back];
+        }
+        // 書き込み側: 書いた値を公開し、受け渡し用だったバッファを次の書き込み先にする
+        void publish()
+        {
+            back = middle.exchange(static_cast<uint8_t>(back | FRESH), std::memory_order_acq_rel) & INDEX_MASK;
+        }
+
+        // 読み込み側: 新しい値が公開されていれば受け取ってtrueを返す
+        bool update()
+        {
+            if ((middle.load(std::memory_order_relaxed) & FRESH) == 0) {
+                return false;
+            }
+            front = middle.exchange(front, std::memory_order_acq_rel) & INDEX_MASK;
+            return true;
+        }
+        // 読み込み側: 最後に受け取った値
+        const T &getReadBuffer() const
+        {
+            return buffers[front];
+        }
+
+    private:
+        // コピーの禁止
+        TripleBuffer(const TripleBuffer &) = delete;
+        TripleBuffer& operator=(const TripleBuffer &) = delete;
+
+        static const uint8_t INDEX_MASK = 3;
+        static const uint8_t FRESH      = 4; // 受け渡し用のバッファがまだ読まれていない
+
+        std::array<T, 3>     buffers;
+        std::atomic<uint8_t> middle; // 受け渡し用のバッファの番号 | FRESH
+        uint8_t              back;   // 書き込み側だけが触る
+        uint8_t              front;  // 読み込み側だけが触る
+    };
+}
+
+#endif
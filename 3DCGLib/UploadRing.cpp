@@ -0,0 +1,168 @@
+#include <algorithm>
+#include <chrono>
+#include "UploadRing.h"
+
+namespace Lib
+{
+    namespace
+    {
+        // alignment(2の累乗)の倍数に切り上げ
+        uint64_t alignUp(const uint64_t value, const uint64_t alignment)
+        {
+            return (value + alignment - 1) & ~(alignment - 1);
+        }
+    }
+
+    // コンストラクタ
+    SimulatedFence::SimulatedFence(const uint32_t _latency)
+        : latency(_latency), issued(0), completed(0), waits(0)
+    {
+    }
+
+    // フェンスの発行
+    uint64_t SimulatedFence::signal()
+    {
+        ++issued;
+        if (issued > latency) {
+            completed = std::max(completed, issued - latency);
+        }
+        return issued;
+    }
+
+    // 完了した値
+    uint64_t SimulatedFence::getCompletedValue()
+    {
+        return completed;
+    }
+
+    // 完了待ち
+    void SimulatedFence::wait(const uint64_t value)
+    {
+        if (completed < value) {
+            ++waits;
+            complete(value);
+        }
+    }
+
+    // 指定の値まで完了させる
+    void SimulatedFence::complete(const uint64_t value)
+    {
+        completed = std::max(completed, std::min(value, issued));
+    }
+
+    // コンストラクタ
+    UploadRing::UploadRing(const uint32_t _capacity, Fence &_fence)
+        : capacity(static_cast<uint32_t>(alignUp(std::max(_capacity, DEFAULT_ALIGNMENT), DEFAULT_ALIGNMENT))), fence(_fence), memory(nullptr),
+          head(0), tail(0), allocations(0), bytes(0), paddingBytes(0), wraps(0), failures(0), stalls(0), stallTime(0.0f),
+          stats{ 0, 0, 0, 0, 0, 0, 0.0f }
+    {
+    }
+
+    // 書き込み先の設定
+    void UploadRing::setMemory(uint8_t *_memory)
+    {
+        memory = _memory;
+    }
+
+    // フレームの開始
+    void UploadRing::beginFrame()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        reclaim();
+    }
+
+    // 割り当て
+    UploadRing::Allocation UploadRing::allocate(const uint32_t size, const uint32_t alignment)
+    {
+        if (size == 0 || size > capacity || memory == nullptr || alignment == 0 || alignment > DEFAULT_ALIGNMENT || (alignment & (alignment - 1)) != 0) {
+            ++failures;
+            return Allocation{ nullptr, 0, 0 };
+        }
+
+        auto current = head.load(std::memory_order_relaxed);
+        for (;;) {
+            // 末尾に収まらなければ次の周回の先頭から割り当てる
+            auto start   = alignUp(current, alignment);
+            bool wrapped = false;
+            if (start % capacity + size > capacity) {
+                start   = alignUp(start, capacity);
+                wrapped = true;
+            }
+            auto end = start + size;
+
+            // GPUが使用中の領域に追いつく場合は空きを作る
+            if (end - tail.load(std::memory_order_acquire) > capacity) {
+                if (!makeRoom(end)) {
+                    ++failures;
+                    return Allocation{ nullptr, 0, 0 };
+                }
+                current = head.load(std::memory_order_relaxed);
+                continue;
+            }
+
+            if (head.compare_exchange_weak(current, end, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+                ++allocations;
+                bytes        += size;
+                paddingBytes += static_cast<uint32_t>(start - current);
+                if (wrapped) {
+                    ++wraps;
+                }
+                auto offset = static_cast<uint32_t>(start % capacity);
+                return Allocation{ memory + offset, offset, size };
+            }
+        }
+    }
+
+    // フレームの終了
+    void UploadRing::endFrame()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        frames.push_back(FrameMark{ fence.signal(), head.load() });
+
+        stats = Stats{ allocations.exchange(0), bytes.exchange(0), paddingBytes.exchange(0), wraps.exchange(0), stalls, failures.exchange(0), stallTime };
+        stalls    = 0;
+        stallTime = 0.0f;
+    }
+
+    // 使用中のバイト数
+    uint32_t UploadRing::getUsed() const
+    {
+        return static_cast<uint32_t>(std::min<uint64_t>(head.load() - tail.load(), capacity));
+    }
+
+    // 空きを作る
+    bool UploadRing::makeRoom(const uint64_t end)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        reclaim();
+        while (end - tail.load() > capacity) {
+            // 現在のフレームだけで埋まっている
+            if (frames.empty()) {
+                return false;
+            }
+
+            // 最も古いフレームの完了を待つ
+            auto start = std::chrono::steady_clock::now();
+            auto mark  = frames.front();
+            fence.wait(mark.fenceValue);
+            frames.erase(frames.begin());
+            tail.store(mark.end, std::memory_order_release);
+            ++stalls;
+            stallTime += std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+        }
+        return true;
+    }
+
+    // 完了済みのフレームを回収
+    void UploadRing::reclaim()
+    {
+        if (frames.empty()) {
+            return;
+        }
+        auto completed = fence.getCompletedValue();
+        while (!frames.empty() && frames.front().fenceValue <= completed) {
+            tail.store(frames.front().end, std::memory_order_release);
+            frames.erase(frames.begin());
+        }
+    }
+}
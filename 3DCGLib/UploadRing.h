@@ -0,0 +1,140 @@
+#pragma once
+#ifndef UPLOADRING_H
+#define UPLOADRING_H
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace Lib
+{
+    // GPUの進行を表すフェンス
+    class Fence
+    {
+    public:
+        virtual ~Fence() {}
+
+        // それまでに発行した処理の完了を表す値を発行する(1から順に増える)
+        virtual uint64_t signal() = 0;
+        // GPUが完了した値
+        virtual uint64_t getCompletedValue() = 0;
+        // valueが完了するまで待つ
+        virtual void wait(const uint64_t value) = 0;
+    };
+
+    // CPUだけで動くフェンス(テストやヘッドレス計測用)
+    // signal()からlatency回後のsignal()で完了したことにする
+    class SimulatedFence : public Fence
+    {
+    public:
+        explicit SimulatedFence(const uint32_t _latency = 2);
+
+        uint64_t signal() override;
+        uint64_t getCompletedValue() override;
+        // 待つ代わりにその値まで完了させる
+        void wait(const uint64_t value) override;
+
+        // GPUの進行を手動で進める
+        void complete(const uint64_t value);
+        void setLatency(const uint32_t _latency) { latency = _latency; }
+
+        uint64_t getIssuedValue() const { return issued; }
+        uint32_t getWaitCount() const { return waits; }
+
+    private:
+        uint32_t latency;
+        uint64_t issued;
+        uint64_t completed;
+        uint32_t waits;
+    };
+
+    // フレーム単位で区切った線形の転送用リングバッファ
+    //
+    // 書き込み先はマップしたバッファ(setMemory()で渡す)で、割り当てはポインタを進めるだけ
+    // 各フレームの終わりにフェンスを発行し、GPUが使い終わった領域だけを再利用するので
+    // NO_OVERWRITEでマップしたまま書き込める
+    class UploadRing
+    {
+    public:
+        // D3D11.1で定数バッファの範囲を指定する単位(16定数)
+        static const uint32_t DEFAULT_ALIGNMENT = 256;
+
+        // 割り当て結果(失敗時はdataがnullptr)
+        struct Allocation
+        {
+            uint8_t  *data;
+            uint32_t  offset; // バッファ先頭からのバイト数
+            uint32_t  size;
+
+            explicit operator bool() const { return data != nullptr; }
+        };
+
+        // 統計情報(フレームごと)
+        struct Stats
+        {
+            uint32_t allocations;
+            uint32_t bytes;        // 要求されたバイト数
+            uint32_t paddingBytes; // 整列と折り返しで飛ばしたバイト数
+            uint32_t wraps;        // 先頭へ折り返した回数
+            uint32_t stalls;       // 空きを作るためにGPUを待った回数
+            uint32_t failures;     // 割り当てられなかった回数
+            float    stallTime;    // ミリ秒
+        };
+
+        // capacityはDEFAULT_ALIGNMENTの倍数に切り上げる。fenceの寿命はこのオブジェクトより長いこと
+        UploadRing(const uint32_t _capacity, Fence &_fence);
+
+        // 書き込み先(capacityバイト)。nullptrの間は割り当てに失敗する
+        void setMemory(uint8_t *_memory);
+
+        // 完了したフレームの領域を回収する(待たない)
+        void beginFrame();
+        // sizeバイトを割り当てる(alignmentは2の累乗でDEFAULT_ALIGNMENT以下。スレッドセーフ)
+        // ※空きがなければ古いフレームの完了を待ち、現在のフレームだけで埋まっている時は失敗する
+        Allocation allocate(const uint32_t size, const uint32_t alignment = DEFAULT_ALIGNMENT);
+        // フェンスを発行してフレームを閉じる(GPUへの実行依頼の後に呼ぶ)
+        void endFrame();
+
+        uint32_t getCapacity() const { return capacity; }
+        // GPUの完了を待っている領域と現在のフレームの使用量
+        uint32_t getUsed() const;
+        // 直前に閉じたフレームの統計
+        const Stats &getStats() const { return stats; }
+
+    private:
+        // 閉じたフレームの終端
+        struct FrameMark
+        {
+            uint64_t fenceValue;
+            uint64_t end;
+        };
+
+        // endが書き込めるまで古いフレームを回収する(必要なら待つ)
+        bool makeRoom(const uint64_t end);
+        // 完了済みのフレームを回収する(mutexを取得してから呼ぶ)
+        void reclaim();
+
+        uint32_t  capacity;
+        Fence    &fence;
+        uint8_t  *memory;
+
+        // 先頭からの通算位置(capacityで割った余りが実際の位置)
+        std::atomic<uint64_t> head; // 次に割り当てる位置
+        std::atomic<uint64_t> tail; // GPUが使用中の最も古い位置
+
+        std::mutex             mutex;
+        std::vector<FrameMark> frames; // 古い順(数フレーム分しか溜まらないので先頭の削除もvectorで足りる)
+
+        std::atomic<uint32_t> allocations;
+        std::atomic<uint32_t> bytes;
+        std::atomic<uint32_t> paddingBytes;
+        std::atomic<uint32_t> wraps;
+        std::atomic<uint32_t> failures;
+        uint32_t              stalls;
+        float                 stallTime;
+
+        Stats stats;
+    };
+}
+
+#endif
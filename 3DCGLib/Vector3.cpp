@@ -2,23 +2,23 @@
 
 namespace Lib
 {
-    // ftHgRXgN^
+    // デフォルトコンストラクタ
     Vector3::Vector3()
     {
         *this = Vector3::ZERO;
     }
 
-    // Rs[RXgN^
+    // コピーコンストラクタ
     Vector3::Vector3(const Vector3 &other)
     {
         *this = other;
     }
 
-    // fXgN^
+    // デストラクタ
     Vector3::~Vector3()
     {
     }
-    // RXgN^
+    // コンストラクタ
     Vector3::Vector3(
         const float _x,
         const float _y,
@@ -30,7 +30,7 @@ namespace Lib
         z = _z;
     }
 
-    // wWɈړ
+    // 指定座標に移動
     void Vector3::move(const float _x, const float _y, const float _z)
     {
         x = _x;
@@ -43,7 +43,7 @@ namespace Lib
         y = other.y;
         z = other.z;
     }
-    // W炷
+    // 座標を引数分ずらす
     void Vector3::translate(const float _x, const float _y, const float _z)
     {
         x += _x;
@@ -56,27 +56,27 @@ namespace Lib
         y += vec.y;
         z += vec.z;
     }
-    // ς߂
+    // 内積を求める
     float Vector3::dot(const Vector3 &other) const
     {
         return (x * other.x) + (y * other.y) + (z * other.z);
     }
-    // Oς߂
+    // 外積を求める
     Vector3 Vector3::cross(const Vector3 &other) const
     {
         return Vector3(y * other.z - z * other.y, z * other.x - x * other.z, x * other.y - y * other.x);
     }
-    // ߂
+    // 長さを求める
     float Vector3::length() const
     {
         return std::sqrt(dot(*this));
     }
-    // ߂
+    // 距離を求める
     float Vector3::distance(const Vector3 &other) const
     {
         return (*this - other).length();
     }
-    // K
+    // 正規化する
     Vector3 Vector3::normalize() const
     {
         const float len = this->length();
@@ -13,42 +13,42 @@ namespace Lib
         float y;
         float z;
 
-        // ftHgRXgN^
+        // デフォルトコンストラクタ
         Vector3();
 
-        // Rs[RXgN^
+        // コピーコンストラクタ
         Vector3(const Vector3 &other);
 
-        // fXgN^
+        // デストラクタ
         ~Vector3();
 
-        // RXgN^
+        // コンストラクタ
         Vector3(const float _x, const float _y, const float _z);
 
-        // wWɈړ
+        // 指定座標に移動
         void move(const float _x, const float _y, const float _z);
         void move(const Vector3 &other);
 
-        // W炷
+        // 座標を引数分ずらす
         void translate(const float _x, const float _y, const float _z);
         void translate(const Vector3 &vec);
 
-        // ς߂
+        // 内積を求める
         float dot(const Vector3 &other) const;
         
-        // Oς߂
+        // 外積を求める
         Vector3 cross(const Vector3 &other) const;
 
-        // ߂
+        // 長さを求める
         float length() const;
 
-        // ߂
+        // 距離を求める
         float distance(const Vector3 &other) const;
 
-        // K
+        // 正規化する
         Vector3 normalize() const;
 
-        // ZqI[o[[h
+        // 演算子オーバーロード
         Vector3 & operator+=(const Vector3 &other)
         {
             return *this = *this + other;
@@ -101,7 +101,7 @@ namespace Lib
             return false;
         }
 
-        // 萔
+        // 定数
         static const Vector3 ZERO;
         static const Vector3 UP;
         static const Vector3 DOWN;
@@ -1,15 +1,45 @@
-// RX^gobt@
-cbuffer ConstantBuffer : register(b0)
+// 点光源
+struct Light
 {
-    matrix World;           // [hs
-    matrix View;            // r[s
-    matrix Projection;      // ˉes
+    float4 pos;       // 座標
+    float4 diffuse;   // 拡散
+    float4 attenuate; // 減衰
+};
+
+// フレーム定数(フレームに1回だけ更新)
+cbuffer FrameConstants : register(b0)
+{
+    matrix View;            // ビュー行列
+    matrix Projection;      // 射影行列
+    matrix ViewProjection;  // ビュー射影行列
+    float4 eyePos;
+    float4 ambient;
+    Light  pointLight;
+}
+
+// オブジェクト定数(描画ごとに更新)
+cbuffer ObjectConstants : register(b2)
+{
+    matrix World;           // ワールド行列
+}
+
+// マテリアル
+struct Material
+{
+    float4 ambient;  // 環境反射
+    float4 diffuse;  // 拡散反射
+};
+
+// インスタンス描画のマテリアル表(インスタンスごとの番号で引く)
+cbuffer MaterialTable : register(b3)
+{
+    Material materials[256];
 }
 
 struct VS_INPUT
 {
-    float4 Pos : POSITION; // _ʒu
-    float3 Norm : NORMAL;  // @xNg
+    float4 Pos : POSITION; // 頂点位置
+    float3 Norm : NORMAL;  // 法線ベクトル
 };
 
 struct PS_INPUT
@@ -23,9 +53,43 @@ PS_INPUT VS(VS_INPUT input)
 {
     PS_INPUT output = (PS_INPUT)0;
     output.PosW = mul(input.Pos, World);
-    output.Pos  = mul(output.PosW, View);
-    output.Pos  = mul(output.Pos, Projection);
+    output.Pos  = mul(output.PosW, ViewProjection);
     output.NorW = mul(float4(input.Norm, 0.0), World);
 
+    return output;
+}
+
+struct VS_INSTANCED_INPUT
+{
+    float4 Pos      : POSITION; // 頂点位置
+    float3 Norm     : NORMAL;   // 法線ベクトル
+    float4 World0   : WORLD0;   // ワールド行列を転置した上3行
+    float4 World1   : WORLD1;
+    float4 World2   : WORLD2;
+    uint   Material : MATERIAL; // マテリアル表の番号
+};
+
+struct PS_INSTANCED_INPUT
+{
+    float4 Pos     : SV_POSITION;
+    float4 PosW    : POSITION0;
+    float4 NorW    : TEXCOORD0;
+    float4 Ambient : COLOR0;
+    float4 Diffuse : COLOR1;
+};
+
+// インスタンス描画
+PS_INSTANCED_INPUT VSInstanced(VS_INSTANCED_INPUT input)
+{
+    PS_INSTANCED_INPUT output = (PS_INSTANCED_INPUT)0;
+    float4 pos = float4(input.Pos.xyz, 1.0);
+    output.PosW = float4(dot(input.World0, pos), dot(input.World1, pos), dot(input.World2, pos), 1.0);
+    output.Pos  = mul(output.PosW, ViewProjection);
+    output.NorW = float4(dot(input.World0.xyz, input.Norm), dot(input.World1.xyz, input.Norm), dot(input.World2.xyz, input.Norm), 0.0);
+
+    Material material = materials[input.Material];
+    output.Ambient = material.ambient;
+    output.Diffuse = material.diffuse;
+
     return output;
 }
\ No newline at end of file
@@ -1,8 +1,15 @@
 #include "Window.h"
+#include "Profiler.h"
 
 namespace Lib
 {
-    // RXgN^
+    namespace
+    {
+        // ウィンドウプロシージャはstaticなので、再描画の要求はここに記録する(ウィンドウは1つだけ作る前提)
+        bool redrawRequested = true;
+    }
+
+    // コンストラクタ
     Window::Window(const LPCWSTR _windowName, const LONG _windowWidth, const LONG _windowHeight)
         :windowName(_windowName)
     {
@@ -10,26 +17,26 @@ namespace Lib
         Initialize();
     }
 
-    // fXgN^
+    // デストラクタ
     Window::~Window()
     {
     }
 
-    // 
+    // 初期化
     int Window::Initialize()
     {
         auto hInstance = GetModuleHandle(nullptr);
         auto nCmdShow  = SW_SHOWNORMAL;
 
         if (FAILED(InitWindow(hInstance, nCmdShow))) {
-            OutputDebugString(L"InitWindow()̎s");
+            OutputDebugString(L"InitWindow()の失敗");
             return 0;
         }
 
         return 0;
     }
     
-    // hWnd̎擾
+    // hWndの取得
     HWND Window::getHWND() const
     {
         return hWnd;
@@ -45,54 +52,54 @@ namespace Lib
         return keyTbl[key] & 0x80;
     }
     
-    // EBhȄ
+    // ウィンドウの初期化
     HRESULT Window::InitWindow(HINSTANCE hInstance, int nCmdShow)
     {
         WNDCLASSEX wcex;
-        wcex.cbSize        = sizeof(WNDCLASSEX);						 // \̂̃TCY
-        wcex.style         = CS_HREDRAW | CS_VREDRAW;					 // EBhEX^C
-        wcex.lpfnWndProc   = WndProck;							         // EBhEvV[W
-        wcex.cbClsExtra    = 0;									         // EBhENXɕt
-        wcex.cbWndExtra    = 0;									         // EBhEɕt
-        wcex.hInstance     = hInstance;								     // CX^Xnh
-        wcex.hIcon         = nullptr;									 // ACR
-        wcex.hCursor       = nullptr;									 // J[\
-        wcex.hbrBackground = reinterpret_cast<HBRUSH>(COLOR_WINDOW + 1); // wiF
-        wcex.lpszMenuName  = windowName;								 // j[
-        wcex.lpszClassName = windowName;								 // EBhENX̖O
-        wcex.hIconSm       = nullptr;									 // ACR
+        wcex.cbSize        = sizeof(WNDCLASSEX);						 // 構造体のサイズ
+        wcex.style         = CS_HREDRAW | CS_VREDRAW;					 // ウィンドウスタイル
+        wcex.lpfnWndProc   = WndProck;							         // ウィンドウプロシージャ
+        wcex.cbClsExtra    = 0;									         // ウィンドウクラスに付加したいメモリ
+        wcex.cbWndExtra    = 0;									         // ウィンドウに付加したいメモリ
+        wcex.hInstance     = hInstance;								     // インスタンスハンドル
+        wcex.hIcon         = nullptr;									 // アイコン
+        wcex.hCursor       = nullptr;									 // カーソル
+        wcex.hbrBackground = reinterpret_cast<HBRUSH>(COLOR_WINDOW + 1); // 背景色
+        wcex.lpszMenuName  = windowName;								 // メニュー
+        wcex.lpszClassName = windowName;								 // ウィンドウクラスの名前
+        wcex.hIconSm       = nullptr;									 // アイコン小
         if (!RegisterClassEx(&wcex)) {
-            OutputDebugString(L"RegisterClassEx()̎s");
+            OutputDebugString(L"RegisterClassEx()の失敗");
             return E_FAIL;
         }
 
-        // EBhE̍쐬
+        // ウィンドウの作成
         AdjustWindowRect(&windowRect, WS_OVERLAPPEDWINDOW, FALSE);
         hWnd = CreateWindow(
-            windowName,				// EBhENX
-            windowName,				// EBhE^Cg
-            WS_OVERLAPPEDWINDOW,    // ^ WS_MAXIMIZEBOX ^ WS_THICKFRAME | WS_VISIBLE,	// EBhEX^C
-            CW_USEDEFAULT,			// YW̏l
-            CW_USEDEFAULT,			// XW̏l
-            windowRect.right  - windowRect.left, // ̏l
-            windowRect.bottom - windowRect.top, // ̏l
-            nullptr,				// eEBhẼnh
-            nullptr,				// EBhEj[
-            hInstance,				// CX^Xnh
-            nullptr);				// 쐬p[^
+            windowName,				// ウィンドウクラス名
+            windowName,				// ウィンドウタイトル
+            WS_OVERLAPPEDWINDOW,    // ^ WS_MAXIMIZEBOX ^ WS_THICKFRAME | WS_VISIBLE,	// ウィンドウスタイル
+            CW_USEDEFAULT,			// Y座標の初期値
+            CW_USEDEFAULT,			// X座標の初期値
+            windowRect.right  - windowRect.left, // 幅の初期値
+            windowRect.bottom - windowRect.top, // 高さの初期値
+            nullptr,				// 親ウィンドウのハンドル
+            nullptr,				// ウィンドウメニュー
+            hInstance,				// インスタンスハンドル
+            nullptr);				// 作成パラメータ
         if (!hWnd) {
-            OutputDebugString(L"CreateWindow()̎s");
+            OutputDebugString(L"CreateWindow()の失敗");
             return E_FAIL;
         }
 
-        // {^̖
+        // 閉じるボタンの無効化
         // EnableMenuItem(GetSystemMenu(hWnd, NULL), SC_CLOSE, MF_DISABLED);
 
         ShowWindow(hWnd, nCmdShow);
 
         return S_OK;
     }
-    // EBhEvV[W
+    // ウィンドウプロシージャ
     LRESULT Window::WndProck(HWND _hWnd, UINT message, WPARAM wParam, LPARAM lParam)
     {
         PAINTSTRUCT ps;
@@ -103,12 +110,16 @@ namespace Lib
         case WM_PAINT:
             hdc = BeginPaint(_hWnd, &ps);
             EndPaint(_hWnd, &ps);
+            redrawRequested = true;
             break;
+        case WM_SIZE:
+            redrawRequested = true;
+            return DefWindowProc(_hWnd, message, wParam, lParam);
         case WM_DESTROY:
             PostQuitMessage(0);
             break;
         case WM_KEYDOWN:
-            // EscŏI
+            // Escで終了
             if (wParam == VK_ESCAPE) {
                 PostQuitMessage(0);
             }
@@ -119,19 +130,38 @@ namespace Lib
 
         return 0;
     }
-    // Abvf[g
+    // 再描画が必要か
+    bool Window::consumeRedrawRequest()
+    {
+        bool requested = redrawRequested;
+        redrawRequested = false;
+        return requested;
+    }
+    // メッセージが届くまで待つ
+    void Window::waitForMessage(const DWORD timeout)
+    {
+        PROFILE_SCOPE("Window::waitForMessage");
+        MsgWaitForMultipleObjects(0, nullptr, FALSE, timeout, QS_ALLINPUT);
+    }
+    // アップデート
     MSG Window::Update()
     {
         MSG msg = { 0 };
-        if (!GetKeyboardState(keyTbl)) {
-            MessageBox(hWnd, L"L[̎擾Ɏs", L"ERROR", MB_OK);
-        }
 
-        if (PeekMessage(&msg, nullptr, 0, 0, PM_REMOVE)) {
+        // 溜まっているメッセージを全て処理する(1フレームに1つずつだと入力が遅れる)
+        while (PeekMessage(&msg, nullptr, 0, 0, PM_REMOVE)) {
+            if (msg.message == WM_QUIT) {
+                break;
+            }
             TranslateMessage(&msg);
             DispatchMessage(&msg);
         }
 
+        // 処理したメッセージを反映したキーの状態
+        if (!GetKeyboardState(keyTbl)) {
+            MessageBox(hWnd, L"キー情報の取得に失敗", L"ERROR", MB_OK);
+        }
+
         return msg;
     }
 }
\ No newline at end of file
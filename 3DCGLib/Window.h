@@ -7,10 +7,10 @@
 #define WIN32_LEAN_AND_MEAN
 /*
 STRICT
-    EȌ^`FbNȂ悤ɂȂ
+    ・厳密な型チェックがおこなわれるようになる
 WIN32_LEAN_AND_MEAN
-    EKvŒ̃wb_̂݃CN[h
-    ERpCԂ̒Zk
+    ・必要最低限のヘッダのみインクルード
+    ・コンパイル時間の短縮
 */
 
 #include <Windows.h>
@@ -27,6 +27,10 @@ namespace Lib
         HWND getHWND() const;
         RECT getWindowRect() const;
         bool getKeyDown(BYTE key);
+        // 再描画が必要か(WM_PAINT・WM_SIZEを受け取った後の最初の呼び出しだけtrue)
+        bool consumeRedrawRequest();
+        // 入力などのメッセージが届くまでスレッドを眠らせる(ミリ秒)
+        void waitForMessage(const DWORD timeout = INFINITE);
 
     private:
         HRESULT InitWindow(HINSTANCE hInstance, int nCmdShow);
@@ -0,0 +1,168 @@
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <vector>
+#include "Benchmark.h"
+#include "CommandList.h"
+#include "FrameArena.h"
+#include "InstanceBatch.h"
+#include "PoolAllocator.h"
+#include "RenderQueue.h"
+#include "UploadRing.h"
+
+namespace Bench
+{
+    namespace
+    {
+        // 毎フレーム作っては消える小さなオブジェクト(エフェクトの粒など)
+        struct Particle
+        {
+            Lib::Matrix world;
+            float       life;
+        };
+
+        Lib::NativeResource fake(const uintptr_t id)
+        {
+            return reinterpret_cast<Lib::NativeResource>(id);
+        }
+
+        // ヒープから確保し、確保した回数を数えるアロケータ(このベンチマークの一時データだけを数える)
+        template <class T>
+        class CountingAllocator
+        {
+        public:
+            using value_type = T;
+
+            CountingAllocator(uint64_t &_allocations) : allocations(&_allocations) {}
+            template <class U>
+            CountingAllocator(const CountingAllocator<U> &other) : allocations(other.getCounter()) {}
+
+            T *allocate(const size_t count)
+            {
+                ++*allocations;
+                return std::allocator<T>().allocate(count);
+            }
+            void deallocate(T *p, const size_t count)
+            {
+                std::allocator<T>().deallocate(p, count);
+            }
+
+            uint64_t *getCounter() const { return allocations; }
+
+            template <class U>
+            bool operator==(const CountingAllocator<U> &other) const { return allocations == other.getCounter(); }
+            template <class U>
+            bool operator!=(const CountingAllocator<U> &other) const { return allocations != other.getCounter(); }
+
+        private:
+            uint64_t *allocations;
+        };
+    }
+
+    // フレームループ1回あたりのヒープ確保回数と時間(一時データをヒープに置く場合とフレームアリーナ・プールの場合)
+    // 数えるのは一時データの確保だけ(ヒープはCountingAllocatorの確保、アリーナとプールはヒープへのはみ出しとチャンクの追加)
+    int runAllocation(int argc, char **argv)
+    {
+        int objects = argc > 0 ? std::atoi(argv[0]) : 10000;
+        int frames  = argc > 1 ? std::atoi(argv[1]) : 200;
+        if (objects <= 0 || frames <= 10) {
+            return 1;
+        }
+        const int WARMUP = 10; // 容量が最高水位に達するまで
+
+        std::vector<Lib::Matrix> worlds(objects);
+        for (int i = 0; i < objects; ++i) {
+            worlds[i] = Lib::Matrix::translate(static_cast<float>(i % 100), 0.0f, static_cast<float>(i / 100));
+        }
+        Lib::InstanceBatch::Mesh mesh = { fake(100), fake(200), Lib::IndexFormat::UInt16, 2160, 24 };
+
+        // 毎フレームの処理(記録・ソート・定数の割り当ては両方で共通。一時データの置き場所だけが違う)
+        Lib::CommandList    list;
+        Lib::InstanceBatch  batch;
+        Lib::RenderQueue    queue;
+        Lib::SimulatedFence fence;
+        Lib::UploadRing     ring(1024 * 1024, fence);
+        std::vector<uint8_t> ringMemory(1024 * 1024);
+        ring.setMemory(ringMemory.data());
+        auto common = [&](const uint32_t *visible, const size_t count) {
+            list.reset();
+            batch.clear();
+            queue.clear();
+            ring.beginFrame();
+            for (size_t k = 0; k < count; ++k) {
+                auto i = visible[k];
+                batch.add(mesh, worlds[i]);
+                queue.push(Lib::RenderQueue::makeOpaqueKey(0, 0, i % 16, i / static_cast<float>(objects)), i);
+            }
+            queue.sort();
+            batch.record(list, fake(1), static_cast<uint32_t>(objects));
+            ring.allocate(256);
+            ring.endFrame();
+        };
+
+        Lib::FrameArena           arena(64 * 1024, 2);
+        Lib::ObjectPool<Particle> pool;
+        std::vector<Particle*>    live;
+        live.reserve(objects);
+
+        std::printf("mode, heap allocs/frame, ms/frame\n");
+        for (int mode = 0; mode < 2; ++mode) {
+            uint64_t heapAllocations = 0;
+            uint64_t allocations     = 0;
+            CountingAllocator<uint32_t> heap(heapAllocations);
+            CountingAllocator<Particle> particles(heapAllocations);
+            Stopwatch sw;
+            for (int frame = 0; frame < frames; ++frame) {
+                if (frame == WARMUP) {
+                    allocations = heapAllocations;
+                    sw.reset();
+                }
+                arena.beginFrame();
+                auto chunks = pool.getStats().chunks;
+
+                if (mode == 0) {
+                    // 一時配列とオブジェクトを毎フレームヒープから確保する
+                    std::vector<uint32_t, CountingAllocator<uint32_t>> visible(heap);
+                    for (int i = 0; i < objects; i += 2) {
+                        visible.push_back(static_cast<uint32_t>(i));
+                    }
+                    for (int i = 0; i < objects / 10; ++i) {
+                        live.push_back(new (particles.allocate(1)) Particle{ worlds[i], 1.0f });
+                    }
+                    for (auto particle : live) {
+                        particle->~Particle();
+                        particles.deallocate(particle, 1);
+                    }
+                    live.clear();
+                    common(visible.data(), visible.size());
+                }
+                else {
+                    // 一時配列はフレームアリーナ、オブジェクトはプールから確保する
+                    Lib::FrameVector<uint32_t> visible{ Lib::FrameAllocator<uint32_t>(arena) };
+                    for (int i = 0; i < objects; i += 2) {
+                        visible.push_back(static_cast<uint32_t>(i));
+                    }
+                    for (int i = 0; i < objects / 10; ++i) {
+                        live.push_back(pool.create(Particle{ worlds[i], 1.0f }));
+                    }
+                    for (auto particle : live) {
+                        pool.destroy(particle);
+                    }
+                    live.clear();
+                    common(visible.data(), visible.size());
+                }
+                // アリーナからヒープへはみ出した回数とプールが増やしたチャンク
+                heapAllocations += arena.getStats().overflows + (pool.getStats().chunks - chunks);
+            }
+            double time = sw.elapsed() / (frames - WARMUP);
+            double perFrame = static_cast<double>(heapAllocations - allocations) / (frames - WARMUP);
+            std::printf("%s, %10.2f, %8.3f\n", mode == 0 ? "heap " : "arena", perFrame, time);
+        }
+
+        auto arenaStats = arena.getStats();
+        std::printf("arena high water: %zu bytes, overflows: %u, pool high water: %zu blocks in %zu chunks\n",
+            arenaStats.highWater, arenaStats.overflows, pool.getStats().highWater, pool.getStats().chunks);
+        return 0;
+    }
+}
@@ -0,0 +1,73 @@
+#include <cstdio>
+#include <cstring>
+#include "Benchmark.h"
+
+// 使い方の表示
+static void usage()
+{
+    std::printf("usage: Benchmark <command> [options]\n");
+    std::printf("  obj [triangles(M)=4] [threads=0]  OBJ importer throughput\n");
+    std::printf("  instancing [max=100000] [meshes=4] per-object vs instanced recording cost\n");
+    std::printf("  transform [nodes=100000] [fanout=8] [threads=0]  transform hierarchy update cost\n");
+    std::printf("  jobs [count=1000000] [threads=cores] [pin=0]  job system parallel_for scaling\n");
+    std::printf("  alloc [objects=10000] [frames=200]  heap allocations per frame, heap vs frame arena/pool\n");
+    std::printf("  pacing [rate=60] [frames=300] [work(ms)=2]  frame pacing jitter and CPU use, busy-wait vs sleep vs hybrid\n");
+    std::printf("  profiler [scopes=1000000]  profiling scope cost (disabled/enabled) and export time\n");
+    std::printf("  framestats [frames=600]  frame time histogram record cost and percentile error\n");
+    std::printf("  renderstats [objects=10000] [json]  render counter cost and memory estimate\n");
+    std::printf("  replay [frames=100000] [path]  input log size, replay speed and determinism\n");
+    std::printf("  sweep [out=sweep.json] [frames=120] [baseline.json] [tolerance=0.10]  headless render loop sweep, exits 2 on regression\n");
+    std::printf("  math [out=math.json] [baseline.json] [tolerance=0.10]  Matrix/Vector3/Color/MyMath per-op and batched cost, exits 2 on regression\n");
+    std::printf("  capture [frames=300] [width=1024] [height=768] [y4m|ppm|raw]  render-thread handoff cost and drops of the async frame writer\n");
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        usage();
+        return 1;
+    }
+
+    if (std::strcmp(argv[1], "obj") == 0) {
+        return Bench::runObjLoader(argc - 2, argv + 2);
+    }
+    if (std::strcmp(argv[1], "instancing") == 0) {
+        return Bench::runInstancing(argc - 2, argv + 2);
+    }
+    if (std::strcmp(argv[1], "transform") == 0) {
+        return Bench::runTransform(argc - 2, argv + 2);
+    }
+    if (std::strcmp(argv[1], "jobs") == 0) {
+        return Bench::runJobSystem(argc - 2, argv + 2);
+    }
+    if (std::strcmp(argv[1], "alloc") == 0) {
+        return Bench::runAllocation(argc - 2, argv + 2);
+    }
+    if (std::strcmp(argv[1], "pacing") == 0) {
+        return Bench::runFramePacing(argc - 2, argv + 2);
+    }
+    if (std::strcmp(argv[1], "profiler") == 0) {
+        return Bench::runProfiler(argc - 2, argv + 2);
+    }
+    if (std::strcmp(argv[1], "framestats") == 0) {
+        return Bench::runFrameStats(argc - 2, argv + 2);
+    }
+    if (std::strcmp(argv[1], "renderstats") == 0) {
+        return Bench::runRenderStats(argc - 2, argv + 2);
+    }
+    if (std::strcmp(argv[1], "replay") == 0) {
+        return Bench::runReplay(argc - 2, argv + 2);
+    }
+    if (std::strcmp(argv[1], "sweep") == 0) {
+        return Bench::runSweep(argc - 2, argv + 2);
+    }
+    if (std::strcmp(argv[1], "math") == 0) {
+        return Bench::runMath(argc - 2, argv + 2);
+    }
+    if (std::strcmp(argv[1], "capture") == 0) {
+        return Bench::runFrameCapture(argc - 2, argv + 2);
+    }
+
+    usage();
+    return 1;
+}
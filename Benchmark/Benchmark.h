@@ -0,0 +1,71 @@
+#pragma once
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace Bench
+{
+    // 計測用のストップウォッチ(ミリ秒)
+    class Stopwatch
+    {
+    public:
+        Stopwatch() : start(std::chrono::steady_clock::now()) {}
+
+        void reset()
+        {
+            start = std::chrono::steady_clock::now();
+        }
+
+        double elapsed() const
+        {
+            return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        }
+
+    private:
+        std::chrono::steady_clock::time_point start;
+    };
+
+    // コンパイラにメモリの読み書きを並べ替え・省略させない(計測するループが消えないようにする)
+    inline void clobberMemory()
+    {
+#ifdef _MSC_VER
+        _ReadWriteBarrier();
+#else
+        asm volatile("" : : : "memory");
+#endif
+    }
+
+    // 1行のJSONからキーの数値を読む(ベンチマーク自身が1行に1件ずつ書いた結果を基準として読み戻す)
+    inline bool readJsonNumber(const std::string &line, const char *key, double &value)
+    {
+        std::string quoted = std::string("\"") + key + "\":";
+        auto position = line.find(quoted);
+        if (position == std::string::npos) {
+            return false;
+        }
+        value = std::strtod(line.c_str() + position + quoted.size(), nullptr);
+        return true;
+    }
+
+    // 各ベンチマークのエントリーポイント(argvはサブコマンド以降)
+    int runObjLoader(int argc, char **argv);
+    int runInstancing(int argc, char **argv);
+    int runTransform(int argc, char **argv);
+    int runJobSystem(int argc, char **argv);
+    int runAllocation(int argc, char **argv);
+    int runFramePacing(int argc, char **argv);
+    int runProfiler(int argc, char **argv);
+    int runFrameStats(int argc, char **argv);
+    int runRenderStats(int argc, char **argv);
+    int runReplay(int argc, char **argv);
+    int runSweep(int argc, char **argv);
+    int runMath(int argc, char **argv);
+    int runFrameCapture(int argc, char **argv);
+}
+
+#endif
@@ -0,0 +1,108 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include "Benchmark.h"
+#include "FrameCapture.h"
+
+namespace Bench
+{
+    namespace
+    {
+        // 描画の代わりに、フレームごとに動く縞模様を書き込む
+        void fillPattern(Lib::FrameCapture::Buffer &buffer, const uint32_t frame)
+        {
+            for (uint32_t y = 0; y < buffer.height; ++y) {
+                auto row = buffer.data + static_cast<size_t>(y) * buffer.width * 4;
+                for (uint32_t x = 0; x < buffer.width; ++x) {
+                    row[x * 4]     = static_cast<uint8_t>(x + frame);
+                    row[x * 4 + 1] = static_cast<uint8_t>(y + frame * 2);
+                    row[x * 4 + 2] = static_cast<uint8_t>((x ^ y) + frame);
+                    row[x * 4 + 3] = 255;
+                }
+            }
+        }
+
+        // 書き出したファイルの削除
+        void removeOutput(const std::string &path, const Lib::FrameCapture::Format format, const uint64_t frames)
+        {
+            if (format != Lib::FrameCapture::Format::PPM) {
+                std::remove(path.c_str());
+                return;
+            }
+            auto dot = path.find_last_of('.');
+            for (uint64_t frame = 0; frame < frames; ++frame) {
+                char number[32];
+                std::snprintf(number, sizeof(number), "_%06llu", static_cast<unsigned long long>(frame));
+                std::remove((path.substr(0, dot) + number + path.substr(dot)).c_str());
+            }
+        }
+    }
+
+    // 画像の書き出しで描画スレッドが払う時間(バッファの受け渡し)と、捨てたフレーム数・書き出しの速さ
+    int runFrameCapture(int argc, char **argv)
+    {
+        int         frames = argc > 0 ? std::atoi(argv[0]) : 300;
+        uint32_t    width  = argc > 1 ? static_cast<uint32_t>(std::atoi(argv[1])) : 1024;
+        uint32_t    height = argc > 2 ? static_cast<uint32_t>(std::atoi(argv[2])) : 768;
+        std::string path   = std::string("capture_bench.") + (argc > 3 ? argv[3] : "y4m");
+        if (frames <= 0 || width == 0 || height == 0) {
+            return 1;
+        }
+        auto format = Lib::FrameCapture::formatFromPath(path);
+
+        struct Mode
+        {
+            const char               *name;
+            Lib::FrameCapture::Policy policy;
+            uint32_t                  buffers;
+        };
+        // バッファ1つのBlockは書き出しを待ってから次を描くので、描画スレッドで書き出すのとほぼ同じ
+        const Mode MODES[] = {
+            { "drop  4", Lib::FrameCapture::Policy::Drop,  4 },
+            { "block 4", Lib::FrameCapture::Policy::Block, 4 },
+            { "block 1", Lib::FrameCapture::Policy::Block, 1 },
+        };
+
+        std::printf("%s %ux%u, %d frames\n", path.c_str(), width, height, frames);
+        std::printf("mode,    handoff us avg, max,     blocked ms, dropped, written, total ms, write MB/s\n");
+        for (auto &mode : MODES) {
+            Lib::FrameCapture capture;
+            Lib::FrameCapture::Settings settings{ format, width, height, 60.0f, mode.buffers, mode.policy };
+            if (!capture.start(path, settings)) {
+                std::printf("%s: start failed\n", mode.name);
+                return 1;
+            }
+
+            double handoff    = 0.0;
+            double maxHandoff = 0.0;
+            Stopwatch total;
+            for (int frame = 0; frame < frames; ++frame) {
+                Stopwatch sw;
+                auto buffer = capture.acquire();
+                double time = sw.elapsed();
+                if (buffer != nullptr) {
+                    fillPattern(*buffer, static_cast<uint32_t>(frame));
+                    sw.reset();
+                    capture.submit(buffer);
+                    time += sw.elapsed();
+                }
+                handoff   += time;
+                maxHandoff = std::max(maxHandoff, time);
+            }
+            double renderTime = total.elapsed();
+            capture.stop();
+            double totalTime = total.elapsed();
+
+            auto stats = capture.getStats();
+            std::printf("%s, %14.2f, %8.1f, %10.1f, %7llu, %7llu, %8.1f, %10.1f%s\n", mode.name,
+                1000.0 * handoff / frames, 1000.0 * maxHandoff, stats.blockTime,
+                static_cast<unsigned long long>(stats.dropped), static_cast<unsigned long long>(stats.written), totalTime,
+                stats.writeTime > 0.0f ? stats.bytesWritten / (1000.0 * stats.writeTime) : 0.0, stats.failed ? " (write failed)" : "");
+            std::printf("         render loop %.1fms, drain %.1fms, max queued %u\n", renderTime, totalTime - renderTime, stats.maxQueued);
+            removeOutput(path, format, stats.submitted);
+        }
+        return 0;
+    }
+}
@@ -0,0 +1,116 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <thread>
+#include "Benchmark.h"
+#include "FrameScheduler.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#endif
+
+namespace Bench
+{
+    namespace
+    {
+        using Clock = std::chrono::steady_clock;
+
+        // プロセスが使ったCPU時間(ミリ秒)
+        double cpuTime()
+        {
+#ifdef _WIN32
+            FILETIME creation, exit, kernel, user;
+            GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user);
+            auto toUnits = [](const FILETIME &time) {
+                return (static_cast<uint64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+            };
+            return (toUnits(kernel) + toUnits(user)) / 10000.0; // 100ns単位
+#else
+            return 1000.0 * std::clock() / CLOCKS_PER_SEC;
+#endif
+        }
+
+        // フレームの処理の代わりにworkミリ秒だけ計算する
+        void simulateWork(const float work)
+        {
+            auto end = Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float, std::milli>(work));
+            volatile float value = 1.0f;
+            while (Clock::now() < end) {
+                value = std::sqrt(value + 1.0f);
+            }
+        }
+
+        // フレーム間隔の平均と標準偏差
+        struct Pacing
+        {
+            double sum   = 0.0;
+            double sumSq = 0.0;
+            int    count = 0;
+
+            void add(const double interval)
+            {
+                sum   += interval;
+                sumSq += interval * interval;
+                ++count;
+            }
+            double average() const { return sum / count; }
+            double jitter()  const { return std::sqrt(std::fmax(sumSq / count - average() * average(), 0.0)); }
+        };
+    }
+
+    // 待ち方ごとのフレーム間隔のばらつきとCPU使用率(以前のビジーウェイト/スリープのみ/スリープ+スピン)
+    int runFramePacing(int argc, char **argv)
+    {
+        float rate   = argc > 0 ? static_cast<float>(std::atof(argv[0])) : 60.0f;
+        int   frames = argc > 1 ? std::atoi(argv[1]) : 300;
+        float work   = argc > 2 ? static_cast<float>(std::atof(argv[2])) : 2.0f;
+        if (rate <= 0.0f || frames <= 0 || work < 0.0f) {
+            return 1;
+        }
+        const float period = 1000.0f / rate;
+
+        std::printf("mode, frame ms, jitter ms, cpu %%\n");
+        for (int mode = 0; mode < 3; ++mode) {
+            Lib::FrameScheduler scheduler(rate);
+            Pacing pacing;
+            auto   last = Clock::now();
+            double cpu  = cpuTime();
+            Stopwatch sw;
+            for (int frame = 0; frame < frames; ++frame) {
+                if (mode == 0) {
+                    // 目標時間が経つまで空回りする(以前のMain.cppのループ)
+                    while (std::chrono::duration<float, std::milli>(Clock::now() - last).count() < period) {
+                    }
+                }
+                else if (mode == 1) {
+                    // 残り時間をまとめてスリープする(タイマーの精度の分だけ遅れる)
+                    auto remaining = period - std::chrono::duration<float, std::milli>(Clock::now() - last).count();
+                    if (remaining > 0.0f) {
+                        std::this_thread::sleep_for(std::chrono::duration<float, std::milli>(remaining));
+                    }
+                }
+                else {
+                    scheduler.waitForNextFrame();
+                }
+                auto now = Clock::now();
+                if (frame > 0) {
+                    pacing.add(std::chrono::duration<double, std::milli>(now - last).count());
+                }
+                last = now;
+                simulateWork(work);
+            }
+            double usage = 100.0 * (cpuTime() - cpu) / sw.elapsed();
+            static const char *NAMES[] = { "busy  ", "sleep ", "hybrid" };
+            std::printf("%s, %8.3f, %8.3f, %6.1f\n", NAMES[mode], pacing.average(), pacing.jitter(), usage);
+            if (mode == 2) {
+                auto stats = scheduler.getStats();
+                std::printf("hybrid: late frames: %u, max lateness: %.3fms, sleep %.1fms, spin %.1fms, granularity %.3fms\n",
+                    stats.lateFrames, stats.maxLateness, stats.sleepTime, stats.spinTime, stats.granularity);
+            }
+        }
+        return 0;
+    }
+}
@@ -0,0 +1,67 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "Benchmark.h"
+#include "FrameStats.h"
+
+namespace Bench
+{
+    // フレーム時間の記録のコストと、ヒストグラムのパーセンタイルの誤差(全件をソートした値との比較)
+    int runFrameStats(int argc, char **argv)
+    {
+        int frames = argc > 0 ? std::atoi(argv[0]) : 600;
+        if (frames <= 0) {
+            return 1;
+        }
+
+        // 16.7ms前後に散らばり、ときどき大きく遅れるフレーム時間
+        std::mt19937 rng(1234);
+        std::lognormal_distribution<float> jitter(std::log(16.7f), 0.08f);
+        std::uniform_real_distribution<float> spike(0.0f, 1.0f);
+        std::vector<float> times(frames);
+        for (auto &time : times) {
+            time = jitter(rng);
+            if (spike(rng) < 0.02f) {
+                time *= 3.0f;
+            }
+        }
+
+        // 直近の区間に全フレームが収まるようにする
+        Lib::FrameStats stats(25.0f, 1, 1e9f);
+        const int REPEAT = 1000;
+        Stopwatch sw;
+        for (int r = 0; r < REPEAT; ++r) {
+            for (auto time : times) {
+                stats.record(Lib::FrameStats::UPDATE, time);
+            }
+        }
+        double recordTime = sw.elapsed() * 1e6 / (static_cast<double>(REPEAT) * frames);
+        for (auto time : times) {
+            stats.recordFrame(time);
+        }
+        sw.reset();
+        auto summary = stats.getSummary(Lib::FrameStats::FRAME);
+        double summaryTime = sw.elapsed();
+
+        std::vector<float> sorted(times);
+        std::sort(sorted.begin(), sorted.end());
+        auto exact = [&](const double percentile) {
+            auto rank = static_cast<size_t>(std::ceil(percentile / 100.0 * sorted.size()));
+            return sorted[std::max<size_t>(rank, 1) - 1];
+        };
+
+        std::printf("record: %.2f ns/sample, summary: %.3f ms\n", recordTime, summaryTime);
+        std::printf("percentile, histogram ms, exact ms, error %%\n");
+        const double PERCENTILES[] = { 50.0, 95.0, 99.0 };
+        const float  VALUES[]      = { summary.p50, summary.p95, summary.p99 };
+        for (int i = 0; i < 3; ++i) {
+            float reference = exact(PERCENTILES[i]);
+            std::printf("p%.0f, %8.3f, %8.3f, %6.2f\n", PERCENTILES[i], VALUES[i], reference, 100.0 * (VALUES[i] - reference) / reference);
+        }
+        std::printf("hitches over %.1fms: %u of %d\n", stats.getBudget(), stats.getWindowHitches(), frames);
+        return 0;
+    }
+}
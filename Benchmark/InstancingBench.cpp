@@ -0,0 +1,83 @@
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "Benchmark.h"
+#include "InstanceBatch.h"
+#include "NullRenderDevice.h"
+
+namespace Bench
+{
+    namespace
+    {
+        // Null実装で使う見かけ上のリソース
+        Lib::NativeResource fake(const uintptr_t id)
+        {
+            return reinterpret_cast<Lib::NativeResource>(id);
+        }
+    }
+
+    // 1つずつ描く場合とインスタンス描画の記録コストの比較
+    int runInstancing(int argc, char **argv)
+    {
+        int maxCount = argc > 0 ? std::atoi(argv[0]) : 100000;
+        int meshes   = argc > 1 ? std::atoi(argv[1]) : 4;
+        if (maxCount <= 0 || meshes <= 0) {
+            return 1;
+        }
+
+        std::vector<Lib::InstanceBatch::Mesh> meshTable;
+        for (int i = 0; i < meshes; ++i) {
+            meshTable.push_back(Lib::InstanceBatch::Mesh{ fake(100 + i), fake(200 + i), Lib::IndexFormat::UInt16, 2160, 24 });
+        }
+
+        const int ITERATION = 10;
+        std::printf("instances, per-object ms, calls, instanced ms, calls, pack ms\n");
+        for (int count = 100; count <= maxCount; count *= 10) {
+            std::vector<Lib::Matrix> worlds(count);
+            for (int i = 0; i < count; ++i) {
+                worlds[i] = Lib::Matrix::translate(static_cast<float>(i % 100), 0.0f, static_cast<float>(i / 100));
+            }
+
+            // Model::render()と同じく、描画ごとにワールド行列を転送する
+            Lib::CommandList list;
+            Lib::NullRenderContext context;
+            Stopwatch sw;
+            for (int it = 0; it < ITERATION; ++it) {
+                list.reset();
+                for (int i = 0; i < count; ++i) {
+                    auto &mesh  = meshTable[i % meshes];
+                    auto  world = Lib::Matrix::transpose(worlds[i]);
+                    list.updateBuffer(fake(1), &world, sizeof(world));
+                    list.setVertexBuffer(mesh.vertexBuffer, mesh.vertexStride);
+                    list.setIndexBuffer(mesh.indexBuffer, mesh.indexFormat);
+                    list.setVSConstantBuffer(2, fake(1));
+                    list.drawIndexed(mesh.indexCount);
+                }
+            }
+            double perObject = sw.elapsed() / ITERATION;
+            context.execute(list);
+            auto perObjectCalls = context.getCounters().totalCalls();
+
+            // メッシュごとにまとめて1回で描く
+            Lib::InstanceBatch batch;
+            context.resetCounters();
+            sw.reset();
+            for (int it = 0; it < ITERATION; ++it) {
+                list.reset();
+                batch.clear();
+                for (int i = 0; i < count; ++i) {
+                    batch.add(meshTable[i % meshes], worlds[i], 0);
+                }
+                batch.record(list, fake(2), static_cast<uint32_t>(count));
+            }
+            double instanced = sw.elapsed() / ITERATION;
+            context.execute(list);
+
+            std::printf("%9d, %14.3f, %5llu, %12.3f, %5llu, %7.3f\n",
+                count, perObject, static_cast<unsigned long long>(perObjectCalls),
+                instanced, static_cast<unsigned long long>(context.getCounters().totalCalls()),
+                batch.getStats().packTime);
+        }
+        return 0;
+    }
+}
@@ -0,0 +1,73 @@
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include "Benchmark.h"
+#include "JobSystem.h"
+
+namespace Bench
+{
+    namespace
+    {
+        // 要素ごとの仕事(重さが場所によって偏るようにしてスティールを起こす)
+        float work(const size_t i)
+        {
+            float value = static_cast<float>(i);
+            int   steps = (i % 1024) < 128 ? 64 : 4;
+            for (int k = 0; k < steps; ++k) {
+                value = std::sqrt(value + 1.0f);
+            }
+            return value;
+        }
+    }
+
+    // parallelForのスケーリングとスティール・待機の計測
+    int runJobSystem(int argc, char **argv)
+    {
+        int      count      = argc > 0 ? std::atoi(argv[0]) : 1000000;
+        unsigned maxThreads = argc > 1 ? static_cast<unsigned>(std::atoi(argv[1])) : std::thread::hardware_concurrency();
+        bool     pin        = argc > 2 && std::atoi(argv[2]) != 0;
+        if (count <= 0 || maxThreads == 0) {
+            return 1;
+        }
+
+        const int ITERATION = 10;
+        std::vector<float> out(count);
+        std::printf("threads, ms, speedup, jobs, steals, failed steals, steal ms, idle ms\n");
+        double baseline = 0.0;
+        for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+            Lib::JobSystem jobs(threads, pin);
+            // 起動直後のワーカーの立ち上がりを除く
+            jobs.parallelFor(count, [&](const size_t begin, const size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    out[i] = work(i);
+                }
+            });
+            jobs.resetStats();
+
+            Stopwatch sw;
+            for (int it = 0; it < ITERATION; ++it) {
+                jobs.parallelFor(count, [&](const size_t begin, const size_t end) {
+                    for (size_t i = begin; i < end; ++i) {
+                        out[i] = work(i);
+                    }
+                }, 256);
+            }
+            double time = sw.elapsed() / ITERATION;
+            if (threads == 1) {
+                baseline = time;
+            }
+
+            auto stats = jobs.getStats();
+            std::printf("%7u, %8.3f, %7.2f, %6llu, %6llu, %13llu, %8.3f, %7.2f\n",
+                threads, time, baseline / time,
+                static_cast<unsigned long long>(stats.executed / ITERATION),
+                static_cast<unsigned long long>(stats.steals / ITERATION),
+                static_cast<unsigned long long>(stats.failedSteals / ITERATION),
+                stats.stealTime / ITERATION,
+                stats.idleTime / ITERATION);
+        }
+        return 0;
+    }
+}
@@ -0,0 +1,219 @@
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+#include "Benchmark.h"
+#include "Color.h"
+#include "Matrix.h"
+#include "MyMath.h"
+#include "Vector3.h"
+
+namespace Bench
+{
+    namespace
+    {
+        const size_t WARM_COUNT  = 256;          // キャッシュに収まる要素数(行列3配列で48KB)
+        const size_t COLD_COUNT  = 1 << 18;      // キャッシュに収まらない要素数(行列3配列で48MB)
+        const size_t FLUSH_BYTES = 64 << 20;     // コールドの計測前にキャッシュを追い出すために書くバイト数
+        const size_t SINGLE_OPS  = 2000000;      // 1回ずつの計測の回数
+        const size_t WARM_OPS    = 8000000;      // ウォームの一括の計測の合計要素数
+
+        // 計測する演算
+        struct MathOp
+        {
+            const char *name;
+            std::function<void(const size_t begin, const size_t end)> batch;  // [begin, end)の要素を一括で計算する
+            std::function<void(const size_t count)>                    single; // 0番目の要素をcount回、1回ずつ計算する
+        };
+
+        // 要素iを計算して出力の配列に書く関数から、一括と1回ずつの計測関数を作る
+        template <class Op>
+        MathOp makeOp(const char *name, Op op)
+        {
+            return MathOp{
+                name,
+                [op](const size_t begin, const size_t end) {
+                    for (size_t i = begin; i < end; ++i) {
+                        op(i);
+                    }
+                },
+                [op](const size_t count) {
+                    // 毎回メモリから読み直させ、ループ全体を1回の計算にまとめさせない
+                    for (size_t n = 0; n < count; ++n) {
+                        op(0);
+                        clobberMemory();
+                    }
+                }
+            };
+        }
+
+        // 1つの演算の結果(1要素あたりのナノ秒)
+        struct Result
+        {
+            std::string name;
+            double single;
+            double warm;
+            double cold;
+        };
+
+        // 基準と比べ、許容幅を超えて遅くなった値を表示して数を返す
+        int compare(const Result &result, const std::vector<Result> &baseline, const double tolerance)
+        {
+            for (auto &base : baseline) {
+                if (base.name != result.name) {
+                    continue;
+                }
+                int regressions = 0;
+                auto check = [&](const char *label, const double current, const double reference) {
+                    if (reference <= 0.0) {
+                        return;
+                    }
+                    double change = (current - reference) / reference;
+                    if (change > tolerance) {
+                        std::printf("  %s %s: %.3f -> %.3f ns (%+.1f%%)  REGRESSION\n", result.name.c_str(), label, reference, current, change * 100.0);
+                        ++regressions;
+                    }
+                };
+                check("single", result.single, base.single);
+                check("warm",   result.warm,   base.warm);
+                check("cold",   result.cold,   base.cold);
+                return regressions;
+            }
+            std::printf("  %s: (no baseline)\n", result.name.c_str());
+            return 0;
+        }
+    }
+
+    // 数学ライブラリの演算の速さ
+    // single: 1回ずつ計算した場合、warm: キャッシュに収まる配列を一括で、cold: キャッシュを追い出してから大きな配列を一括で
+    // 基準のJSONを渡すと、許容幅(割合)を超えて遅くなった演算があれば2を返す
+    int runMath(int argc, char **argv)
+    {
+        std::string outPath   = argc > 0 ? argv[0] : "math.json";
+        std::string basePath  = argc > 1 ? argv[1] : "";
+        double      tolerance = argc > 2 ? std::atof(argv[2]) : 0.10;
+        if (tolerance < 0.0) {
+            return 1;
+        }
+
+        // 入力(値の範囲は実際の使われ方に合わせる)
+        std::mt19937 rng(7);
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+        std::uniform_real_distribution<float> angle(0.0f, Lib::MyMath::PI2);
+        std::vector<Lib::Matrix>  a(COLD_COUNT), b(COLD_COUNT), m(COLD_COUNT);
+        std::vector<Lib::Vector3> u(COLD_COUNT), v(COLD_COUNT), w(COLD_COUNT);
+        std::vector<float>        f(COLD_COUNT), g(COLD_COUNT);
+        std::vector<Lib::Color>   c(COLD_COUNT), d(COLD_COUNT), e(COLD_COUNT);
+        for (size_t i = 0; i < COLD_COUNT; ++i) {
+            a[i] = Lib::Matrix::rotateY(angle(rng)) * Lib::Matrix::translate(unit(rng), unit(rng), unit(rng));
+            b[i] = Lib::Matrix::rotateX(angle(rng)) * Lib::Matrix::scale(1.0f + unit(rng) * 0.5f);
+            u[i] = Lib::Vector3(unit(rng), unit(rng), unit(rng) + 3.0f);
+            v[i] = Lib::Vector3(unit(rng), unit(rng), unit(rng));
+            f[i] = angle(rng) * 0.5f;
+            c[i] = Lib::Color(unit(rng), unit(rng), unit(rng), 1.0f);
+            d[i] = Lib::Color(unit(rng), unit(rng), unit(rng), 0.0f);
+        }
+
+        const float ASPECT = 1026.0f / 768.0f;
+        std::vector<MathOp> ops;
+        ops.push_back(makeOp("Matrix::operator*",          [&](const size_t i) { m[i] = a[i] * b[i]; }));
+        ops.push_back(makeOp("Matrix::transpose",          [&](const size_t i) { m[i] = Lib::Matrix::transpose(a[i]); }));
+        ops.push_back(makeOp("Matrix::LookAtLH",           [&](const size_t i) { m[i] = Lib::Matrix::LookAtLH(u[i], v[i], Lib::Vector3::UP); }));
+        ops.push_back(makeOp("Matrix::perspectiveFovLH",   [&](const size_t i) { m[i] = Lib::Matrix::perspectiveFovLH(f[i] * 0.5f + 0.5f, ASPECT, 0.01f, 100.0f); }));
+        ops.push_back(makeOp("Matrix::rotateX",            [&](const size_t i) { m[i] = Lib::Matrix::rotateX(f[i]); }));
+        ops.push_back(makeOp("Matrix::rotateY",            [&](const size_t i) { m[i] = Lib::Matrix::rotateY(f[i]); }));
+        ops.push_back(makeOp("Matrix::rotateZ",            [&](const size_t i) { m[i] = Lib::Matrix::rotateZ(f[i]); }));
+        ops.push_back(makeOp("Vector3::normalize",         [&](const size_t i) { w[i] = u[i].normalize(); }));
+        ops.push_back(makeOp("Vector3::cross",             [&](const size_t i) { w[i] = u[i].cross(v[i]); }));
+        ops.push_back(makeOp("Vector3::dot",               [&](const size_t i) { g[i] = u[i].dot(v[i]); }));
+        ops.push_back(makeOp("MyMath::clamp",              [&](const size_t i) { g[i] = Lib::MyMath::clamp(f[i] - 1.5f, 1.0f, -1.0f); }));
+        ops.push_back(makeOp("Color::operator+",           [&](const size_t i) { e[i] = c[i] + d[i]; }));
+
+        std::vector<Result> baseline;
+        if (!basePath.empty()) {
+            std::ifstream ifs(basePath);
+            if (!ifs) {
+                std::printf("cannot read baseline %s\n", basePath.c_str());
+                return 1;
+            }
+            std::string line;
+            while (std::getline(ifs, line)) {
+                auto begin = line.find("\"name\": \"");
+                Result entry;
+                if (begin == std::string::npos || !readJsonNumber(line, "single_ns", entry.single) ||
+                    !readJsonNumber(line, "warm_ns", entry.warm) || !readJsonNumber(line, "cold_ns", entry.cold)) {
+                    continue;
+                }
+                begin += 9;
+                entry.name = line.substr(begin, line.find('"', begin) - begin);
+                baseline.push_back(entry);
+            }
+        }
+
+        std::ofstream ofs(outPath, std::ios::trunc);
+        if (!ofs) {
+            std::printf("cannot write %s\n", outPath.c_str());
+            return 1;
+        }
+        ofs << "{\n  \"ops\": [\n";
+
+        std::vector<char> flush(FLUSH_BYTES);
+        int regressions = 0;
+        std::printf("op, single ns, warm ns, cold ns, warm Mops/s\n");
+        for (size_t k = 0; k < ops.size(); ++k) {
+            auto &op = ops[k];
+            Result result;
+            result.name = op.name;
+
+            // 1回ずつ
+            op.single(SINGLE_OPS / 10);
+            Stopwatch sw;
+            op.single(SINGLE_OPS);
+            result.single = sw.elapsed() * 1e6 / SINGLE_OPS;
+
+            // キャッシュに収まる配列を繰り返す
+            op.batch(0, WARM_COUNT);
+            sw.reset();
+            for (size_t n = 0; n < WARM_OPS / WARM_COUNT; ++n) {
+                op.batch(0, WARM_COUNT);
+                clobberMemory();
+            }
+            result.warm = sw.elapsed() * 1e6 / WARM_OPS;
+
+            // キャッシュを追い出してから大きな配列を1回
+            for (size_t i = 0; i < flush.size(); i += 64) {
+                flush[i] = static_cast<char>(flush[i] + 1);
+            }
+            clobberMemory();
+            sw.reset();
+            op.batch(0, COLD_COUNT);
+            clobberMemory();
+            result.cold = sw.elapsed() * 1e6 / COLD_COUNT;
+
+            std::printf("%-26s %8.3f, %8.3f, %8.3f, %10.1f\n", (result.name + ",").c_str(), result.single, result.warm, result.cold, 1e3 / result.warm);
+            char line[256];
+            snprintf(line, sizeof(line), "    {\"name\": \"%s\", \"single_ns\": %.4f, \"warm_ns\": %.4f, \"cold_ns\": %.4f}%s\n",
+                op.name, result.single, result.warm, result.cold, k + 1 == ops.size() ? "" : ",");
+            ofs << line;
+            if (!basePath.empty()) {
+                regressions += compare(result, baseline, tolerance);
+            }
+        }
+        ofs << "  ]\n}\n";
+
+        // 結果を使って計算が省かれないようにする
+        double checksum = 0.0;
+        for (size_t i = 0; i < COLD_COUNT; i += 4099) {
+            checksum += m[i].m11 + w[i].x + g[i] + e[i].r + flush[i];
+        }
+        std::printf("checksum: %f\n", checksum);
+
+        if (!basePath.empty()) {
+            std::printf("%d regression(s) beyond %.1f%%\n", regressions, tolerance * 100.0);
+        }
+        return regressions > 0 ? 2 : 0;
+    }
+}
@@ -0,0 +1,124 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Benchmark.h"
+#include "ObjLoader.h"
+
+namespace Bench
+{
+    namespace
+    {
+        const char *FILE_NAME = "bench_grid.obj";
+
+        // 波打ったグリッドのOBJを書き出す(四角形面、法線付き)
+        bool writeGrid(const char *path, const int SEGMENT)
+        {
+            FILE *fp = std::fopen(path, "wb");
+            if (fp == nullptr) {
+                return false;
+            }
+            std::string buffer;
+            buffer.reserve(1 << 20);
+            char line[128];
+            auto flush = [&](bool force) {
+                if (force || buffer.size() > (1 << 20) - 128) {
+                    std::fwrite(buffer.data(), 1, buffer.size(), fp);
+                    buffer.clear();
+                }
+            };
+
+            for (int y = 0; y <= SEGMENT; ++y) {
+                for (int x = 0; x <= SEGMENT; ++x) {
+                    float fx = static_cast<float>(x) / SEGMENT * 100.0f;
+                    float fz = static_cast<float>(y) / SEGMENT * 100.0f;
+                    float fy = std::sin(fx * 0.37f) * std::cos(fz * 0.21f);
+                    int len = std::snprintf(line, sizeof(line), "v %.6f %.6f %.6f\n", fx, fy, fz);
+                    buffer.append(line, len);
+                    len = std::snprintf(line, sizeof(line), "vn %.4f %.4f %.4f\n", -0.37f * std::cos(fx * 0.37f), 1.0f, 0.21f * std::sin(fz * 0.21f));
+                    buffer.append(line, len);
+                    flush(false);
+                }
+            }
+            for (int y = 0; y < SEGMENT; ++y) {
+                for (int x = 0; x < SEGMENT; ++x) {
+                    int a = y * (SEGMENT + 1) + x + 1;
+                    int b = a + 1;
+                    int c = a + SEGMENT + 2;
+                    int d = a + SEGMENT + 1;
+                    int len = std::snprintf(line, sizeof(line), "f %d//%d %d//%d %d//%d %d//%d\n", a, a, b, b, c, c, d, d);
+                    buffer.append(line, len);
+                    flush(false);
+                }
+            }
+            flush(true);
+            std::fclose(fp);
+            return true;
+        }
+    }
+
+    // OBJローダーのスループット計測
+    int runObjLoader(int argc, char **argv)
+    {
+        double   millions = argc > 0 ? std::atof(argv[0]) : 4.0;
+        unsigned threads  = argc > 1 ? static_cast<unsigned>(std::atoi(argv[1])) : 0;
+        const char *path  = argc > 2 ? argv[2] : nullptr;
+
+        // 入力ファイルの作成(四角形1つで2三角形)
+        if (path == nullptr) {
+            const int SEGMENT = static_cast<int>(std::sqrt(millions * 1000000.0 / 2.0));
+            Stopwatch sw;
+            if (!writeGrid(FILE_NAME, SEGMENT)) {
+                std::printf("failed to write %s\n", FILE_NAME);
+                return 1;
+            }
+            std::printf("generated %s (%d x %d quads) in %.1f ms\n", FILE_NAME, SEGMENT, SEGMENT, sw.elapsed());
+            path = FILE_NAME;
+        }
+
+        // スレッド数を変えて計測する
+        std::vector<unsigned> counts;
+        if (threads != 0) {
+            counts.push_back(threads);
+        }
+        else {
+            unsigned hw = std::max(1u, std::thread::hardware_concurrency());
+            for (unsigned t = 1; t < hw; t *= 2) {
+                counts.push_back(t);
+            }
+            counts.push_back(hw);
+        }
+
+        const int ITERATION = 3;
+        std::printf("threads,  MB/s, Mtri/s, parse ms, weld ms, total ms, vertices, index bits\n");
+        for (auto count : counts) {
+            Lib::ObjLoader::Stats best = {};
+            best.totalTime = 1e30f;
+            int indexBits = 0;
+            for (int i = 0; i < ITERATION; ++i) {
+                Lib::MeshData mesh;
+                Lib::ObjLoader::Stats stats;
+                if (!Lib::ObjLoader::load(path, mesh, count, &stats)) {
+                    std::printf("failed to load %s\n", path);
+                    return 1;
+                }
+                indexBits = mesh.indices32.empty() ? 16 : 32;
+                if (stats.totalTime < best.totalTime) {
+                    best = stats;
+                }
+            }
+            double seconds = best.totalTime / 1000.0;
+            std::printf("%7u, %5.0f, %6.2f, %8.1f, %7.1f, %8.1f, %8u, %d\n",
+                best.threads,
+                best.bytes / (1024.0 * 1024.0) / seconds,
+                best.triangles / 1000000.0 / seconds,
+                best.parseTime, best.weldTime, best.totalTime,
+                best.vertices, indexBits);
+        }
+
+        return 0;
+    }
+}
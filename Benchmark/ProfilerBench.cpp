@@ -0,0 +1,60 @@
+#include <cstdio>
+#include <cstdlib>
+#include "Benchmark.h"
+#include "Profiler.h"
+
+namespace Bench
+{
+    namespace
+    {
+        // 計測対象の小さな仕事(最適化で消えないようにする)
+        volatile uint32_t sink = 0;
+
+        void nested(const int count)
+        {
+            for (int i = 0; i < count; ++i) {
+                PROFILE_SCOPE("outer");
+                sink = sink + 1;
+                {
+                    PROFILE_SCOPE("inner");
+                    sink = sink + 1;
+                }
+            }
+        }
+    }
+
+    // 計測区間1つあたりのコスト(無効・有効)と書き出しの時間
+    int runProfiler(int argc, char **argv)
+    {
+        int count = argc > 0 ? std::atoi(argv[0]) : 1000000;
+        if (count <= 0) {
+            return 1;
+        }
+        auto &profiler = Lib::Profiler::getInstance();
+
+        std::printf("mode, ns/scope\n");
+        for (int mode = 0; mode < 2; ++mode) {
+            profiler.clear();
+            profiler.setEnabled(mode == 1);
+            nested(1000); // リングの作成を除く
+            Stopwatch sw;
+            nested(count);
+            std::printf("%s, %8.2f\n", mode == 0 ? "disabled" : "enabled ", sw.elapsed() * 1e6 / (count * 2.0));
+        }
+        profiler.setEnabled(false);
+
+        auto stats = profiler.getStats();
+        Stopwatch sw;
+        bool json = profiler.exportChromeTrace("profile_bench.json");
+        double jsonTime = sw.elapsed();
+        sw.reset();
+        bool binary = profiler.exportBinary("profile_bench.bin");
+        double binaryTime = sw.elapsed();
+        std::printf("recorded: %llu (kept %u per thread), export json: %.2fms%s, binary: %.2fms%s\n",
+            static_cast<unsigned long long>(stats.recorded), Lib::Profiler::EVENTS_PER_THREAD,
+            jsonTime, json ? "" : " (failed)", binaryTime, binary ? "" : " (failed)");
+        std::remove("profile_bench.json");
+        std::remove("profile_bench.bin");
+        return 0;
+    }
+}
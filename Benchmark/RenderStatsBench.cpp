@@ -0,0 +1,95 @@
+#include <cstdio>
+#include <cstdlib>
+#include "Benchmark.h"
+#include "NullRenderDevice.h"
+#include "RenderStats.h"
+
+namespace Bench
+{
+    namespace
+    {
+        // Null実装で使う見かけ上のリソース
+        Lib::NativeResource fake(const uintptr_t id)
+        {
+            return reinterpret_cast<Lib::NativeResource>(id);
+        }
+    }
+
+    // 描画の負荷の集計にかかる時間(実行との比較)と、集計した値・メモリの見積もりの確認
+    int runRenderStats(int argc, char **argv)
+    {
+        int objects = argc > 0 ? std::atoi(argv[0]) : 10000;
+        if (objects <= 0) {
+            return 1;
+        }
+
+        // Model::render()と同じ並びで、メッシュとマテリアルを4種類ずつ切り替えながら記録する
+        const uint32_t INDEX_COUNT = 2160;
+        Lib::CommandList list;
+        for (int i = 0; i < objects; ++i) {
+            float world[16] = {};
+            list.updateBuffer(fake(1), world, sizeof(world));
+            list.setVSConstantBuffer(2, fake(1));
+            list.setVertexBuffer(fake(100 + i % 4), 24);
+            list.setIndexBuffer(fake(200 + i % 4), Lib::IndexFormat::UInt16);
+            list.setPSConstantBuffer(1, fake(300 + i / 4 % 4));
+            list.drawIndexed(INDEX_COUNT);
+        }
+        list.drawIndexedInstanced(INDEX_COUNT, 1000);
+
+        const int ITERATION = 100;
+        Lib::RenderStats stats;
+        Lib::NullRenderContext context;
+
+        // 無効の間(DirectX11と同じくisEnabled()で呼び出しを省く)
+        Stopwatch sw;
+        for (int it = 0; it < ITERATION; ++it) {
+            stats.beginFrame();
+            if (stats.isEnabled()) {
+                stats.count(list);
+            }
+            stats.endFrame();
+        }
+        double disabledTime = sw.elapsed() / ITERATION;
+
+        stats.setEnabled(true);
+        sw.reset();
+        for (int it = 0; it < ITERATION; ++it) {
+            stats.beginFrame();
+            if (stats.isEnabled()) {
+                stats.count(list);
+            }
+            stats.endFrame();
+        }
+        double countTime = sw.elapsed() / ITERATION;
+
+        sw.reset();
+        for (int it = 0; it < ITERATION; ++it) {
+            context.execute(list);
+        }
+        double executeTime = sw.elapsed() / ITERATION;
+
+        auto &frame = stats.getLastFrame();
+        std::printf("commands: %zu, disabled: %.4f ms, count: %.4f ms (%.2f ns/command), null execute: %.4f ms\n",
+            list.getCommands().size(), disabledTime, countTime, countTime * 1e6 / list.getCommands().size(), executeTime);
+        std::printf("draws: %u instances: %u triangles: %llu state changes: %u eliminated: %u constants: %u bytes\n",
+            frame.drawCalls, frame.instances, static_cast<unsigned long long>(frame.triangles), frame.stateChanges, frame.eliminated, frame.constantBytes);
+        auto &counters = context.getCounters();
+        std::printf("null context: draws: %llu, update bytes: %llu\n",
+            static_cast<unsigned long long>(counters.draws / ITERATION), static_cast<unsigned long long>(counters.updateBytes / ITERATION));
+
+        // Model::initSqhere()と同じ大きさのバッファからメモリを見積もる
+        Lib::NullRenderDevice device;
+        Lib::ResourceRegistry registry(device);
+        auto vb = registry.getBuffer(Lib::ResourceType::VertexBuffer, 1, 24 * 703, 24, nullptr);
+        auto ib = registry.getBuffer(Lib::ResourceType::IndexBuffer, 1, 2 * INDEX_COUNT, 2, nullptr);
+        auto cb = registry.getBuffer(Lib::ResourceType::ConstantBuffer, 2, 64, 0, nullptr);
+        auto memory = Lib::RenderStats::measureMemory(registry, 1026ull * 768 * 4 * 2);
+        std::printf("memory: %llu bytes (resources: %llu, render targets: %llu)\n",
+            static_cast<unsigned long long>(memory.total), static_cast<unsigned long long>(memory.resourceBytes), static_cast<unsigned long long>(memory.renderTargetBytes));
+        if (argc > 1) {
+            stats.writeJson(argv[1], registry, memory.renderTargetBytes);
+        }
+        return 0;
+    }
+}
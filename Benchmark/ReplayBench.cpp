@@ -0,0 +1,94 @@
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include "Benchmark.h"
+#include "InputRecorder.h"
+#include "SimulationThread.h"
+
+namespace Bench
+{
+    namespace
+    {
+        const uint8_t KEYS[] = { 'W', 'S', 'A', 'D' };
+
+        // 記録の入力で仮想の時計を進め、最後の状態を返す
+        double simulate(Lib::InputRecorder &input, uint64_t &steps)
+        {
+            uint32_t keys     = 0;
+            double   position = 0.0;
+            double   velocity = 0.0;
+            Lib::SimulationThread simulation(50.0f, [&](const float stepTime) {
+                double accel = (keys & input.keyBit('W') ? 1.0 : 0.0) - (keys & input.keyBit('S') ? 1.0 : 0.0);
+                velocity = velocity * 0.98 + accel * stepTime * 0.001;
+                position += velocity * stepTime;
+            }, [](const Lib::SimulationThread::Clock::time_point) {});
+
+            Lib::InputLogFrame frame;
+            while (input.next(frame)) {
+                keys = frame.keys;
+                if (keys != 0) {
+                    simulation.resume();
+                }
+                simulation.advance(frame.deltaTime);
+                if (keys == 0 && velocity < 1e-6 && velocity > -1e-6) {
+                    simulation.pause();
+                }
+            }
+            steps = simulation.getStats().steps;
+            return position;
+        }
+    }
+
+    // 入力の記録・再生(記録の大きさ、再生の速さと、同じ記録から同じ結果になるか)
+    int runReplay(int argc, char **argv)
+    {
+        int frames = argc > 0 ? std::atoi(argv[0]) : 100000;
+        const char *path = argc > 1 ? argv[1] : "replay_bench.inp";
+        if (frames <= 0) {
+            return 1;
+        }
+
+        // 揺らぎのあるフレーム間隔と、ときどき押されるキーを記録する
+        Lib::InputRecorder recorder(std::vector<uint8_t>(KEYS, KEYS + sizeof(KEYS)));
+        if (!recorder.startRecording(path, 50.0f)) {
+            std::printf("cannot write %s\n", path);
+            return 1;
+        }
+        std::mt19937 rng(42);
+        std::normal_distribution<float> jitter(16.7f, 1.5f);
+        std::uniform_int_distribution<int> press(0, 63);
+        uint32_t keys = 0;
+        Stopwatch sw;
+        for (int i = 0; i < frames; ++i) {
+            if (press(rng) == 0) {
+                keys ^= recorder.keyBit(KEYS[press(rng) % 4]);
+            }
+            recorder.record(std::max(jitter(rng), 1.0f), keys);
+        }
+        recorder.stop();
+        double recordTime = sw.elapsed();
+
+        // 2回再生して結果を比べる
+        double   results[2];
+        uint64_t steps[2];
+        double   replayTime[2];
+        for (int run = 0; run < 2; ++run) {
+            Lib::InputRecorder player(std::vector<uint8_t>(KEYS, KEYS + sizeof(KEYS)));
+            sw.reset();
+            if (!player.startReplay(path) || player.getFrameCount() != static_cast<uint32_t>(frames)) {
+                std::printf("cannot read %s\n", path);
+                return 1;
+            }
+            results[run]    = simulate(player, steps[run]);
+            replayTime[run] = sw.elapsed();
+        }
+
+        std::printf("frames: %d, file: %zu bytes, record: %.2f ms\n", frames, sizeof(Lib::InputLogHeader) + frames * sizeof(Lib::InputLogFrame), recordTime);
+        std::printf("replay: %.2f ms (%.0f frames/s, %.1f s of recorded time), steps: %llu\n",
+            replayTime[0], frames / (replayTime[0] / 1000.0), frames * 16.7 / 1000.0, static_cast<unsigned long long>(steps[0]));
+        bool same = results[0] == results[1] && steps[0] == steps[1];
+        std::printf("deterministic: %s (%.9f / %.9f)\n", same ? "yes" : "NO", results[0], results[1]);
+        std::remove(path);
+        return same ? 0 : 1;
+    }
+}
@@ -0,0 +1,375 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Benchmark.h"
+#include "FrameStats.h"
+#include "JobSystem.h"
+#include "Matrix.h"
+#include "MeshData.h"
+#include "NullRenderDevice.h"
+#include "ParallelRecorder.h"
+#include "RenderStats.h"
+#include "ResourceRegistry.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+namespace Bench
+{
+    namespace
+    {
+        // 掃引する値
+        const int      SEGMENTS[]  = { 16, 36, 64, 128 };
+        const uint32_t INSTANCES[] = { 100, 1000, 10000 };
+        const uint32_t LIGHTS[]    = { 1, 8 };
+
+        // 計測の前に捨てるフレーム数
+        const int WARMUP_FRAMES = 10;
+
+        // 画面の大きさ(レンダーターゲットのメモリの見積もりに使う。Mainのウィンドウと同じ)
+        const uint64_t TARGET_WIDTH  = 1026;
+        const uint64_t TARGET_HEIGHT = 768;
+
+        // 点光源の定数(DirectX11::Lightと同じ大きさ)
+        struct LightConstants
+        {
+            float pos[4];
+            float diffuse[4];
+            float attenuate[4];
+        };
+
+        // 1つの構成
+        struct Config
+        {
+            int      segment;
+            uint32_t instances;
+            uint32_t lights;
+            unsigned threads;
+        };
+
+        // 1つの構成の結果(時間はミリ秒)
+        struct Result
+        {
+            Config   config;
+            Lib::FrameStats::Summary frame;
+            Lib::FrameStats::Summary update;
+            Lib::FrameStats::Summary record;
+            Lib::FrameStats::Summary execute;
+            uint64_t trianglesPerFrame;
+            double   trianglesPerSecond;
+            uint32_t drawCalls;
+            uint32_t stateChanges;
+            uint64_t gpuBytes;
+            uint64_t peakMemory;
+        };
+
+        // Null実装で使う見かけ上のリソース
+        Lib::NativeResource fake(const uintptr_t id)
+        {
+            return reinterpret_cast<Lib::NativeResource>(id);
+        }
+
+        // プロセスの最大使用メモリ(バイト。起動からの最大なので構成の順に単調に増える)
+        uint64_t peakMemory()
+        {
+#ifdef _WIN32
+            PROCESS_MEMORY_COUNTERS counters;
+            if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+                return counters.PeakWorkingSetSize;
+            }
+            return 0;
+#else
+            rusage usage;
+            getrusage(RUSAGE_SELF, &usage);
+            return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+        }
+
+        // 1つの構成を描画の記録と実行だけで回す(GPUへは送らない)
+        Result runConfig(const Config &config, const int frames)
+        {
+            // Model::initSqhere()と同じバッファをレジストリに作り、メモリを見積もる
+            auto sphere = Lib::MeshData::createSphere(config.segment);
+            auto mesh   = sphere.view();
+            Lib::NullRenderDevice  device;
+            Lib::ResourceRegistry  registry(device);
+            std::vector<Lib::ResourceRef> resources;
+            resources.push_back(registry.getBuffer(Lib::ResourceType::VertexBuffer, 1, sizeof(Lib::SimpleVertex) * mesh.vertexCount, sizeof(Lib::SimpleVertex), mesh.vertices));
+            resources.push_back(registry.getBuffer(Lib::ResourceType::IndexBuffer, 1, mesh.indexStride() * mesh.indexCount, mesh.indexStride(), mesh.indices));
+            resources.push_back(registry.getBuffer(Lib::ResourceType::ConstantBuffer, 2, sizeof(Lib::Matrix) * 3 + 64 + sizeof(LightConstants) * config.lights, 0, nullptr));
+            resources.push_back(registry.getBuffer(Lib::ResourceType::ConstantBuffer, 3, sizeof(Lib::Matrix), 0, nullptr));
+            for (uint32_t i = 0; i < 4; ++i) {
+                resources.push_back(registry.getBuffer(Lib::ResourceType::ConstantBuffer, 10 + i, 32, 0, nullptr));
+            }
+            auto vb         = resources[0].get();
+            auto ib         = resources[1].get();
+            auto cbFrame    = resources[2].get();
+            auto cbObject   = resources[3].get();
+            auto vs         = fake(1);
+            auto ps         = fake(2);
+            auto layout     = fake(3);
+            auto indexCount = mesh.indexCount;
+            auto format     = mesh.indexFormat;
+
+            Lib::JobSystem        jobs(config.threads);
+            Lib::ParallelRecorder recorder(jobs);
+            Lib::NullRenderContext context;
+            Lib::CommandList      frameList;
+            Lib::RenderStats      renderStats;
+            renderStats.setEnabled(true);
+            Lib::FrameStats       stats(1000.0f / 60.0f, 1, 1e9f);
+
+            std::vector<Lib::Matrix> worlds(config.instances);
+            std::vector<LightConstants> lights(config.lights);
+            const uint32_t GRID = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(config.instances))));
+
+            for (int frame = -WARMUP_FRAMES; frame < frames; ++frame) {
+                auto frameBegin = std::chrono::steady_clock::now();
+                float angle = frame * 0.01f;
+
+                // 更新(インスタンスのワールド行列とライトの位置)
+                jobs.parallelFor(config.instances, [&](const size_t begin, const size_t end) {
+                    for (size_t i = begin; i < end; ++i) {
+                        auto x = static_cast<float>(i % GRID);
+                        auto z = static_cast<float>(i / GRID);
+                        worlds[i] = Lib::Matrix::scale(0.04f) * Lib::Matrix::rotateY(angle + i * 0.001f) * Lib::Matrix::translate(x * 0.1f, -1.0f, z * 0.1f);
+                    }
+                }, 256);
+                for (uint32_t i = 0; i < config.lights; ++i) {
+                    lights[i] = LightConstants{ { std::cos(angle + i), 2.0f, std::sin(angle + i), 1.0f }, { 1.0f, 1.0f, 1.0f, 1.0f }, { 1.0f, 0.0f, 0.1f, 0.0f } };
+                }
+                auto updateEnd = std::chrono::steady_clock::now();
+
+                // 記録(Model::render()と同じく、描画ごとにオブジェクト定数を転送する)
+                frameList.reset();
+                frameList.updateBuffer(cbFrame, lights.data(), static_cast<uint32_t>(sizeof(LightConstants) * lights.size()));
+                frameList.setInputLayout(layout);
+                frameList.setVertexBuffer(vb, sizeof(Lib::SimpleVertex));
+                frameList.setIndexBuffer(ib, format);
+                frameList.setPrimitiveTopology(Lib::PrimitiveTopology::TriangleList);
+                frameList.setVertexShader(vs);
+                frameList.setPixelShader(ps);
+                // ライトの位置を示す小さな球体
+                for (uint32_t i = 0; i < config.lights; ++i) {
+                    auto gizmo = Lib::Matrix::transpose(Lib::Matrix::scale(0.1f) * Lib::Matrix::translate(lights[i].pos[0], lights[i].pos[1], lights[i].pos[2]));
+                    frameList.updateBuffer(cbObject, &gizmo, sizeof(gizmo));
+                    frameList.setVSConstantBuffer(2, cbObject);
+                    frameList.drawIndexed(indexCount);
+                }
+                recorder.record(config.instances, [&](Lib::CommandList &commands, const size_t begin, const size_t end) {
+                    commands.setInputLayout(layout);
+                    commands.setVertexBuffer(vb, sizeof(Lib::SimpleVertex));
+                    commands.setIndexBuffer(ib, format);
+                    commands.setPrimitiveTopology(Lib::PrimitiveTopology::TriangleList);
+                    commands.setVertexShader(vs);
+                    commands.setVSConstantBuffer(0, cbFrame);
+                    commands.setPixelShader(ps);
+                    commands.setPSConstantBuffer(0, cbFrame);
+                    for (size_t i = begin; i < end; ++i) {
+                        auto world = Lib::Matrix::transpose(worlds[i]);
+                        commands.updateBuffer(cbObject, &world, sizeof(world));
+                        commands.setVSConstantBuffer(2, cbObject);
+                        commands.setPSConstantBuffer(1, resources[4 + i % 4].get());
+                        commands.drawIndexed(indexCount);
+                    }
+                });
+                auto recordEnd = std::chrono::steady_clock::now();
+
+                // 実行
+                renderStats.beginFrame();
+                renderStats.count(frameList);
+                for (size_t slice = 0; slice < recorder.getSliceCount(); ++slice) {
+                    renderStats.count(recorder.getList(slice));
+                }
+                context.execute(frameList);
+                recorder.submit(context);
+                renderStats.endFrame();
+                auto frameEnd = std::chrono::steady_clock::now();
+
+                if (frame < 0) {
+                    continue;
+                }
+                auto ms = [](const std::chrono::steady_clock::duration duration) {
+                    return std::chrono::duration<float, std::milli>(duration).count();
+                };
+                stats.record(Lib::FrameStats::UPDATE,  ms(updateEnd - frameBegin));
+                stats.record(Lib::FrameStats::RENDER,  ms(recordEnd - updateEnd));
+                stats.record(Lib::FrameStats::PRESENT, ms(frameEnd - recordEnd));
+                stats.recordFrame(ms(frameEnd - frameBegin));
+            }
+
+            Result result;
+            result.config  = config;
+            result.frame   = stats.getSummary(Lib::FrameStats::FRAME);
+            result.update  = stats.getSummary(Lib::FrameStats::UPDATE);
+            result.record  = stats.getSummary(Lib::FrameStats::RENDER);
+            result.execute = stats.getSummary(Lib::FrameStats::PRESENT);
+            auto &last = renderStats.getLastFrame();
+            result.trianglesPerFrame  = last.triangles;
+            result.trianglesPerSecond = result.frame.mean > 0.0f ? last.triangles * 1000.0 / result.frame.mean : 0.0;
+            result.drawCalls    = last.drawCalls;
+            result.stateChanges = last.stateChanges;
+            result.gpuBytes     = Lib::RenderStats::measureMemory(registry, TARGET_WIDTH * TARGET_HEIGHT * 4 * 2).total;
+            result.peakMemory   = peakMemory();
+            return result;
+        }
+
+        // 結果の1行(基準との比較で読み戻せるよう、1つの構成を1行に書く)
+        void writeResult(std::ofstream &ofs, const Result &result, const bool last)
+        {
+            char line[1024];
+            auto &c = result.config;
+            snprintf(line, sizeof(line),
+                "    {\"segment\": %d, \"instances\": %u, \"lights\": %u, \"threads\": %u, "
+                "\"frame_mean_ms\": %.4f, \"frame_p50_ms\": %.4f, \"frame_p95_ms\": %.4f, \"frame_p99_ms\": %.4f, \"frame_max_ms\": %.4f, "
+                "\"update_mean_ms\": %.4f, \"update_p99_ms\": %.4f, \"record_mean_ms\": %.4f, \"record_p99_ms\": %.4f, \"execute_mean_ms\": %.4f, \"execute_p99_ms\": %.4f, "
+                "\"triangles_per_frame\": %llu, \"triangles_per_second\": %.0f, \"draw_calls\": %u, \"state_changes\": %u, "
+                "\"gpu_bytes\": %llu, \"peak_memory_bytes\": %llu}%s\n",
+                c.segment, c.instances, c.lights, c.threads,
+                result.frame.mean, result.frame.p50, result.frame.p95, result.frame.p99, result.frame.max,
+                result.update.mean, result.update.p99, result.record.mean, result.record.p99, result.execute.mean, result.execute.p99,
+                static_cast<unsigned long long>(result.trianglesPerFrame), result.trianglesPerSecond, result.drawCalls, result.stateChanges,
+                static_cast<unsigned long long>(result.gpuBytes), static_cast<unsigned long long>(result.peakMemory), last ? "" : ",");
+            ofs << line;
+        }
+
+        // 基準の結果(構成ごとの比較する値)
+        struct Baseline
+        {
+            Config config;
+            double frameP50;
+            double frameP99;
+            double trianglesPerSecond;
+        };
+
+        // 基準のJSONを読む(writeResult()が書いた形式のみ)
+        bool loadBaseline(const std::string &path, std::vector<Baseline> &baseline)
+        {
+            std::ifstream ifs(path);
+            if (!ifs) {
+                return false;
+            }
+            std::string line;
+            while (std::getline(ifs, line)) {
+                double segment, instances, lights, threads;
+                Baseline entry;
+                if (!readJsonNumber(line, "segment", segment) || !readJsonNumber(line, "instances", instances) ||
+                    !readJsonNumber(line, "lights", lights) || !readJsonNumber(line, "threads", threads) ||
+                    !readJsonNumber(line, "frame_p50_ms", entry.frameP50) || !readJsonNumber(line, "frame_p99_ms", entry.frameP99) ||
+                    !readJsonNumber(line, "triangles_per_second", entry.trianglesPerSecond)) {
+                    continue;
+                }
+                entry.config = Config{ static_cast<int>(segment), static_cast<uint32_t>(instances), static_cast<uint32_t>(lights), static_cast<unsigned>(threads) };
+                baseline.push_back(entry);
+            }
+            return true;
+        }
+
+        // 基準と比べ、許容幅を超えて悪くなった値を表示して数を返す
+        int compare(const Result &result, const std::vector<Baseline> &baseline, const double tolerance)
+        {
+            auto &c  = result.config;
+            auto  it = std::find_if(baseline.begin(), baseline.end(), [&](const Baseline &entry) {
+                return entry.config.segment == c.segment && entry.config.instances == c.instances &&
+                       entry.config.lights == c.lights && entry.config.threads == c.threads;
+            });
+            if (it == baseline.end()) {
+                std::printf("  (no baseline)\n");
+                return 0;
+            }
+
+            int regressions = 0;
+            auto check = [&](const char *name, const double current, const double base, const bool higherIsWorse) {
+                if (base <= 0.0) {
+                    return;
+                }
+                double change = (current - base) / base;
+                bool   worse  = higherIsWorse ? change > tolerance : -change > tolerance;
+                if (worse) {
+                    ++regressions;
+                }
+                std::printf("  %-14s %12.6g -> %12.6g (%+6.1f%%)%s\n", name, base, current, change * 100.0, worse ? "  REGRESSION" : "");
+            };
+            check("frame p50 ms", result.frame.p50, it->frameP50, true);
+            check("frame p99 ms", result.frame.p99, it->frameP99, true);
+            check("triangles/s", result.trianglesPerSecond, it->trianglesPerSecond, false);
+            return regressions;
+        }
+    }
+
+    // 描画の記録と実行を画面なしで回し、分割数・インスタンス数・ライト数・スレッド数を掃引する
+    // 基準のJSONを渡すと、許容幅(割合)を超えて悪くなった構成があれば2を返す
+    int runSweep(int argc, char **argv)
+    {
+        std::string outPath  = argc > 0 ? argv[0] : "sweep.json";
+        int         frames   = argc > 1 ? std::atoi(argv[1]) : 120;
+        std::string basePath = argc > 2 ? argv[2] : "";
+        double      tolerance = argc > 3 ? std::atof(argv[3]) : 0.10;
+        if (frames <= 0 || tolerance < 0.0) {
+            return 1;
+        }
+
+        std::vector<Baseline> baseline;
+        if (!basePath.empty() && !loadBaseline(basePath, baseline)) {
+            std::printf("cannot read baseline %s\n", basePath.c_str());
+            return 1;
+        }
+
+        std::vector<unsigned> threadCounts = { 1 };
+        auto hardware = std::max(1u, std::thread::hardware_concurrency());
+        if (hardware > 1) {
+            threadCounts.push_back(hardware);
+        }
+
+        std::ofstream ofs(outPath, std::ios::trunc);
+        if (!ofs) {
+            std::printf("cannot write %s\n", outPath.c_str());
+            return 1;
+        }
+        ofs << "{\n  \"frames\": " << frames << ",\n  \"configs\": [\n";
+
+        std::vector<Config> configs;
+        for (auto segment : SEGMENTS) {
+            for (auto instances : INSTANCES) {
+                for (auto lights : LIGHTS) {
+                    for (auto threads : threadCounts) {
+                        configs.push_back(Config{ segment, instances, lights, threads });
+                    }
+                }
+            }
+        }
+
+        int regressions = 0;
+        std::printf("segment, instances, lights, threads, p50 ms, p99 ms, update ms, record ms, execute ms, Mtriangles/s, gpu KB\n");
+        for (size_t i = 0; i < configs.size(); ++i) {
+            auto result = runConfig(configs[i], frames);
+            auto &c = result.config;
+            std::printf("%7d, %9u, %6u, %7u, %6.3f, %6.3f, %9.3f, %9.3f, %10.3f, %12.1f, %6llu\n",
+                c.segment, c.instances, c.lights, c.threads, result.frame.p50, result.frame.p99,
+                result.update.mean, result.record.mean, result.execute.mean, result.trianglesPerSecond / 1e6,
+                static_cast<unsigned long long>(result.gpuBytes / 1024));
+            writeResult(ofs, result, i + 1 == configs.size());
+            if (!baseline.empty()) {
+                regressions += compare(result, baseline, tolerance);
+            }
+        }
+        ofs << "  ]\n}\n";
+
+        if (!baseline.empty()) {
+            std::printf("%d regression(s) beyond %.1f%%\n", regressions, tolerance * 100.0);
+        }
+        return regressions > 0 ? 2 : 0;
+    }
+}
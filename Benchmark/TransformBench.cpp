@@ -0,0 +1,69 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include "Benchmark.h"
+#include "TransformHierarchy.h"
+
+namespace Bench
+{
+    namespace
+    {
+        // 根1つ、子がfanout個ずつの幅優先の木を作る
+        void build(Lib::TransformHierarchy &hierarchy, const int count, const int fanout)
+        {
+            hierarchy.clear();
+            hierarchy.reserve(count);
+            hierarchy.create();
+            for (int i = 1; i < count; ++i) {
+                auto node = hierarchy.create(static_cast<Lib::TransformHierarchy::Node>((i - 1) / fanout));
+                float f = static_cast<float>(i);
+                hierarchy.setLocal(node, Lib::Vector3(f * 0.01f, 0.0f, 1.0f), Lib::Vector3(0.0f, f * 0.1f, 0.0f), Lib::Vector3(1.0f, 1.0f, 1.0f));
+            }
+        }
+    }
+
+    // 変換の階層の更新コスト
+    int runTransform(int argc, char **argv)
+    {
+        int      count   = argc > 0 ? std::atoi(argv[0]) : 100000;
+        int      fanout  = argc > 1 ? std::atoi(argv[1]) : 8;
+        unsigned threads = argc > 2 ? static_cast<unsigned>(std::atoi(argv[2])) : 0;
+        if (count <= 0 || fanout <= 0) {
+            return 1;
+        }
+
+        const int ITERATION = 20;
+        Lib::JobSystem jobs(threads);
+        Lib::TransformHierarchy hierarchy;
+        build(hierarchy, count, fanout);
+
+        // 各ケースの最短時間(ミリ秒)と再計算したノード数
+        auto measure = [&](const char *name, auto touch, const bool parallel) {
+            float best = 1e9f;
+            for (int it = 0; it < ITERATION; ++it) {
+                touch(it);
+                if (parallel) {
+                    hierarchy.updateParallel(jobs);
+                }
+                else {
+                    hierarchy.update();
+                }
+                best = std::min(best, hierarchy.getStats().updateTime);
+            }
+            auto &stats = hierarchy.getStats();
+            std::printf("%-18s %9.3f ms  updated: %7u  locals: %7u  levels: %u\n", name, best, stats.updated, stats.locals, stats.levels);
+        };
+
+        std::printf("nodes: %d  fanout: %d  threads: %u\n", count, fanout, jobs.getThreadCount());
+        measure("all dirty", [&](const int) { build(hierarchy, count, fanout); }, false);
+        measure("root moved", [&](const int it) { hierarchy.setPosition(0, Lib::Vector3(static_cast<float>(it), 0.0f, 0.0f)); }, false);
+        measure("root moved (par)", [&](const int it) { hierarchy.setPosition(0, Lib::Vector3(0.0f, static_cast<float>(it), 0.0f)); }, true);
+        measure("1% leaves moved", [&](const int it) {
+            for (int i = count - 1; i >= count - count / 100; --i) {
+                hierarchy.setRotation(static_cast<Lib::TransformHierarchy::Node>(i), Lib::Vector3(0.0f, static_cast<float>(it), 0.0f));
+            }
+        }, false);
+        measure("clean", [&](const int) {}, false);
+        return 0;
+    }
+}
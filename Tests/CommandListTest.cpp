@@ -0,0 +1,115 @@
+#include "Test.h"
+#include "CommandList.h"
+#include "NullRenderDevice.h"
+
+namespace Test
+{
+    namespace
+    {
+        // ダミーのオブジェクト
+        Lib::NativeResource resource(const uintptr_t id)
+        {
+            return reinterpret_cast<Lib::NativeResource>(id);
+        }
+
+        const size_t SET_VS_CB = static_cast<size_t>(Lib::CommandType::SetVSConstantBuffer);
+        const size_t SET_VS    = static_cast<size_t>(Lib::CommandType::SetVertexShader);
+        const size_t SET_VB    = static_cast<size_t>(Lib::CommandType::SetVertexBuffer);
+
+        // 同じメッシュ・シェーダーの物体を、物体ごとの定数だけ変えて描く
+        void recordObjects(Lib::CommandList &commands, const uint32_t count)
+        {
+            for (uint32_t i = 0; i < count; ++i) {
+                commands.setInputLayout(resource(1));
+                commands.setVertexBuffer(resource(2), 24);
+                commands.setIndexBuffer(resource(3), Lib::IndexFormat::UInt16);
+                commands.setPrimitiveTopology(Lib::PrimitiveTopology::TriangleList);
+                commands.setVertexShader(resource(4));
+                commands.setPixelShader(resource(5));
+                commands.setVSConstantBuffer(0, resource(6));
+                commands.setVSConstantBuffer(2, resource(7), i * 256, 256);
+                commands.drawIndexed(36);
+            }
+        }
+
+        // 冗長な設定の除去
+        void testRedundantElimination()
+        {
+            const uint32_t OBJECTS = 10;
+            Lib::CommandList commands;
+            recordObjects(commands, OBJECTS);
+
+            // 最初の物体は全て設定し、以降は範囲の変わる定数バッファと描画だけが残る
+            auto &stats = commands.getStats();
+            CHECK(stats.draws == OBJECTS);
+            CHECK(stats.recorded == 8 + (OBJECTS - 1) * 1 + OBJECTS);
+            CHECK(stats.eliminated == (OBJECTS - 1) * 7);
+
+            Lib::NullRenderContext context;
+            context.execute(commands);
+            auto &counters = context.getCounters();
+            CHECK(counters.draws == OBJECTS);
+            CHECK(counters.indices == 36 * OBJECTS);
+            CHECK(counters.calls[SET_VS] == 1);
+            CHECK(counters.calls[SET_VB] == 1);
+            CHECK(counters.calls[SET_VS_CB] == 1 + OBJECTS);
+            CHECK(counters.totalCalls() == stats.recorded);
+
+            // 除去しない場合は全て残る
+            Lib::CommandList all(false);
+            recordObjects(all, OBJECTS);
+            CHECK(all.getStats().eliminated == 0);
+            CHECK(all.getStats().recorded == OBJECTS * 9);
+            CHECK(all.getStats().recorded - stats.recorded == stats.eliminated);
+        }
+
+        // 状態の比較の細部
+        void testTrackerDetails()
+        {
+            Lib::CommandList commands;
+
+            // 未設定の状態からのnullptrは設定として残す
+            commands.setPixelShader(nullptr);
+            commands.setPixelShader(nullptr);
+            CHECK(commands.getStats().recorded == 1);
+            CHECK(commands.getStats().eliminated == 1);
+
+            // ストライド・オフセット・スロットが違えば別の設定
+            commands.setVertexBuffer(resource(2), 24);
+            commands.setVertexBuffer(resource(2), 32);
+            commands.setVertexBuffer(resource(2), 32, 16);
+            commands.setVertexBuffer(resource(2), 32, 16, 1);
+            commands.setVertexBuffer(resource(2), 32, 16, 1);
+            CHECK(commands.getStats().recorded == 5);
+            CHECK(commands.getStats().eliminated == 2);
+
+            // 定数バッファはVSとPSで別に追跡する
+            commands.setVSConstantBuffer(1, resource(6));
+            commands.setPSConstantBuffer(1, resource(6));
+            commands.setPSConstantBuffer(1, resource(6));
+            CHECK(commands.getStats().recorded == 7);
+            CHECK(commands.getStats().eliminated == 3);
+
+            // 転送と描画は除去しない
+            uint8_t data[16] = {};
+            commands.updateBuffer(resource(6), data, sizeof(data));
+            commands.updateBuffer(resource(6), data, sizeof(data));
+            CHECK(commands.getStats().recorded == 9);
+            CHECK(commands.getStats().updateBytes == 32);
+
+            // resetで状態は不明に戻る
+            commands.reset();
+            commands.setPixelShader(nullptr);
+            CHECK(commands.getStats().recorded == 1);
+            CHECK(commands.getStats().eliminated == 0);
+            CHECK(commands.getCommands().size() == 1);
+        }
+    }
+
+    // コマンドリストの冗長な設定の除去
+    void runCommandList()
+    {
+        testRedundantElimination();
+        testTrackerDetails();
+    }
+}
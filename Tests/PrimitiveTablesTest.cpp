@@ -0,0 +1,79 @@
+#include <cmath>
+#include <cstring>
+#include "Test.h"
+#include "PrimitiveTables.h"
+
+namespace Test
+{
+    namespace
+    {
+        // floatで計算した実行時の球体との位置の差の許容値(数ulp)
+        const float POSITION_EPSILON = 1e-6f;
+        const float LENGTH_EPSILON   = 1e-6f;
+
+        // コンパイル時の球体は実行時のMeshData::createSphere()と一致する
+        void testSphereMatchesMeshData()
+        {
+            const int SEGMENTS[] = { 16, 36, 64 };
+            for (auto segment : SEGMENTS) {
+                Lib::MeshView table;
+                CHECK(Lib::PrimitiveTables::sphere(segment, table));
+                auto mesh = Lib::MeshData::createSphere(segment);
+                auto view = mesh.view();
+                CHECK(table.vertexCount == view.vertexCount);
+                CHECK(table.indexCount == view.indexCount);
+                CHECK(table.indexFormat == view.indexFormat);
+                if (table.vertexCount != view.vertexCount || table.indexCount != view.indexCount) {
+                    continue;
+                }
+
+                float maxError = 0.0f;
+                for (uint32_t i = 0; i < table.vertexCount; ++i) {
+                    for (int k = 0; k < 3; ++k) {
+                        maxError = std::fmax(maxError, std::fabs(table.vertices[i].pos[k] - view.vertices[i].pos[k]));
+                        maxError = std::fmax(maxError, std::fabs(table.vertices[i].normal[k] - view.vertices[i].normal[k]));
+                    }
+                }
+                CHECK(maxError < POSITION_EPSILON);
+                CHECK(std::memcmp(table.indices, view.indices, table.indexCount * table.indexStride()) == 0);
+            }
+
+            Lib::MeshView unused;
+            CHECK(!Lib::PrimitiveTables::sphere(20, unused));
+        }
+
+        // 正二十面体球の頂点は単位球面上にあり、インデックスは範囲内
+        void testIcosphereOnUnitSphere()
+        {
+            for (int level = 0; level <= Lib::PrimitiveTables::ICOSPHERE_MAX_LEVEL; ++level) {
+                auto mesh = Lib::PrimitiveTables::icosphere(level);
+                CHECK(mesh.vertexCount == static_cast<uint32_t>(10 * (1 << (2 * level)) + 2));
+                CHECK(mesh.indexCount == static_cast<uint32_t>(60 * (1 << (2 * level))));
+
+                float maxError = 0.0f;
+                for (uint32_t i = 0; i < mesh.vertexCount; ++i) {
+                    auto &v = mesh.vertices[i];
+                    float length = std::sqrt(v.pos[0] * v.pos[0] + v.pos[1] * v.pos[1] + v.pos[2] * v.pos[2]);
+                    maxError = std::fmax(maxError, std::fabs(length - 1.0f));
+                    for (int k = 0; k < 3; ++k) {
+                        CHECK(v.normal[k] == v.pos[k]);
+                    }
+                }
+                CHECK(maxError < LENGTH_EPSILON);
+
+                auto *indices = static_cast<const uint16_t*>(mesh.indices);
+                bool inRange = true;
+                for (uint32_t i = 0; i < mesh.indexCount; ++i) {
+                    inRange = inRange && indices[i] < mesh.vertexCount;
+                }
+                CHECK(inRange);
+            }
+        }
+    }
+
+    void runPrimitiveTables()
+    {
+        testSphereMatchesMeshData();
+        testIcosphereOnUnitSphere();
+    }
+}
@@ -0,0 +1,107 @@
+#include <utility>
+#include "Test.h"
+#include "NullRenderDevice.h"
+#include "ResourceRegistry.h"
+
+namespace Test
+{
+    namespace
+    {
+        const uint64_t KEY_A = 1;
+        const uint64_t KEY_B = 2;
+
+        // 同じキーは共有し、参照がなくなったら解放する
+        void testSharingAndRelease()
+        {
+            Lib::NullRenderDevice device;
+            {
+                Lib::ResourceRegistry registry(device);
+                auto first  = registry.getBuffer(Lib::ResourceType::VertexBuffer, KEY_A, 64, 16, nullptr);
+                auto second = registry.getBuffer(Lib::ResourceType::VertexBuffer, KEY_A, 64, 16, nullptr);
+                CHECK(first && second);
+                CHECK(first.get() == second.get());
+                CHECK(first.getHandle() == second.getHandle());
+                CHECK(registry.getInfo(first.getHandle()).refCount == 2);
+
+                // 種類が違えば同じキーでも別のリソース
+                auto index = registry.getBuffer(Lib::ResourceType::IndexBuffer, KEY_A, 32, 2, nullptr);
+                CHECK(index.get() != first.get());
+
+                auto stats = registry.getStats();
+                CHECK(stats.resources == 2);
+                CHECK(stats.references == 3);
+                CHECK(stats.bytes == 96);
+                CHECK(stats.creates == 2);
+                CHECK(stats.hits == 1);
+                CHECK(device.getCounters().totalCreated() == 2);
+
+                // コピーで増え、破棄で減る
+                {
+                    auto copy = first;
+                    CHECK(registry.getInfo(first.getHandle()).refCount == 3);
+                }
+                CHECK(registry.getInfo(first.getHandle()).refCount == 2);
+
+                // ムーブでは変わらない
+                auto moved = std::move(second);
+                CHECK(!second);
+                CHECK(registry.getInfo(first.getHandle()).refCount == 2);
+
+                // 最後の参照で解放される
+                first.reset();
+                CHECK(device.getCounters().totalReleased() == 0);
+                moved.reset();
+                CHECK(device.getCounters().released[static_cast<size_t>(Lib::ResourceType::VertexBuffer)] == 1);
+                CHECK(registry.getStats().destroys == 1);
+                CHECK(!registry.find(Lib::ResourceType::VertexBuffer, KEY_A));
+                CHECK(registry.getResources().size() == 1);
+
+                // 解放後の同じキーは作り直す
+                auto recreated = registry.getBuffer(Lib::ResourceType::VertexBuffer, KEY_A, 64, 16, nullptr);
+                CHECK(recreated);
+                CHECK(registry.getStats().creates == 3);
+
+                // 作成に失敗したものは登録しない
+                auto failed = registry.getBuffer(Lib::ResourceType::ConstantBuffer, KEY_B, 0, 0, nullptr);
+                CHECK(!failed);
+                CHECK(!registry.find(Lib::ResourceType::ConstantBuffer, KEY_B));
+            }
+            // レジストリの破棄で残りも解放する
+            CHECK(device.getCounters().live() == 0);
+        }
+
+        // 解放されたスロットを再利用しても古いハンドルは無効になる
+        void testGeneration()
+        {
+            Lib::NullRenderDevice device;
+            Lib::ResourceRegistry registry(device);
+
+            auto first = registry.getBuffer(Lib::ResourceType::ConstantBuffer, KEY_A, 16, 0, nullptr);
+            auto stale = first.getHandle();
+            CHECK(stale.generation != 0);
+            CHECK(registry.getNative(stale) != nullptr);
+            first.reset();
+            CHECK(registry.getNative(stale) == nullptr);
+            CHECK(registry.getInfo(stale).type == Lib::ResourceType::Count);
+
+            auto second = registry.getBuffer(Lib::ResourceType::ConstantBuffer, KEY_B, 16, 0, nullptr);
+            CHECK(second.getHandle().index == stale.index);
+            CHECK(second.getHandle().generation != stale.generation);
+            CHECK(registry.getNative(stale) == nullptr);
+            CHECK(registry.getNative(second.getHandle()) == second.get());
+            CHECK(registry.getInfo(second.getHandle()).key == KEY_B);
+
+            // findは参照を増やす
+            auto found = registry.find(Lib::ResourceType::ConstantBuffer, KEY_B);
+            CHECK(found.getHandle() == second.getHandle());
+            CHECK(registry.getInfo(second.getHandle()).refCount == 2);
+        }
+    }
+
+    // リソースのレジストリ
+    void runResourceRegistry()
+    {
+        testSharingAndRelease();
+        testGeneration();
+    }
+}
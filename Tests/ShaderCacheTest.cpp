@@ -0,0 +1,267 @@
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include "Test.h"
+#include "Hash.h"
+#include "ShaderCache.h"
+
+namespace Test
+{
+    namespace
+    {
+        // D3DCompile()の代わりのコンパイラ
+        // ※「#include "name"」の行はソースと同じディレクトリから読み込み、バイトコードは展開後の内容のハッシュにする
+        class StubCompiler : public Lib::IShaderCompiler
+        {
+        public:
+            bool compile(const Lib::ShaderSource &source, std::vector<uint8_t> &bytecode, std::vector<Lib::ShaderInclude> &includes, std::string &error) override
+            {
+                ++compiles;
+                // gateが設定されていれば開くまで待つ(コンパイル中に別のスレッドが来た場合の確認用)
+                entered = true;
+                while (gate && !open) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+                if (source.code.find("error") != std::string::npos) {
+                    error = "stub: syntax error";
+                    return false;
+                }
+
+                auto directory = std::filesystem::path(source.name).parent_path();
+                std::string expanded;
+                std::istringstream lines(source.code);
+                std::string line;
+                while (std::getline(lines, line)) {
+                    if (line.compare(0, 10, "#include \"") == 0) {
+                        auto name = line.substr(10, line.find('"', 10) - 10);
+                        std::string code;
+                        if (!Lib::ShaderCache::readInclude((directory / name).string(), code, includes)) {
+                            error = "stub: cannot open " + name;
+                            return false;
+                        }
+                        expanded += code;
+                    }
+                    else {
+                        expanded += line;
+                    }
+                }
+                auto hash  = Lib::Hash::fnv1a(expanded.data(), expanded.size());
+                auto bytes = reinterpret_cast<const uint8_t*>(&hash);
+                bytecode.assign(bytes, bytes + sizeof(hash));
+                return true;
+            }
+
+            uint64_t getVersion() const override { return version; }
+
+            std::atomic<int>  compiles{ 0 };
+            std::atomic<bool> entered{ false };
+            std::atomic<bool> open{ false };
+            bool              gate    = false;
+            uint64_t          version = 1;
+        };
+
+        void writeFile(const std::string &path, const std::string &text)
+        {
+            std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+            ofs << text;
+        }
+
+        // ディレクトリ内のキャッシュファイル(1つだけの前提)
+        std::string findCacheFile(const std::string &directory)
+        {
+            for (auto &entry : std::filesystem::directory_iterator(directory)) {
+                if (entry.path().extension() == ".cso") {
+                    return entry.path().string();
+                }
+            }
+            return std::string();
+        }
+
+        // メモリ・ディスクのヒットとミス
+        void testHitAndMiss()
+        {
+            TempDirectory temp("shadercache_hit");
+            auto source = temp.file("a.hlsl");
+            writeFile(source, "float4 main() : SV_Target { return 1; }");
+            auto compiler = std::make_shared<StubCompiler>();
+
+            Lib::ShaderBytecode first;
+            {
+                Lib::ShaderCache cache(compiler, temp.file("cache"));
+                first = cache.getFromFile(source, "main", "ps_4_0", 0);
+                auto second = cache.getFromFile(source, "main", "ps_4_0", 0);
+                CHECK(first != nullptr);
+                CHECK(second == first);
+                auto stats = cache.getStats();
+                CHECK(stats.compiles == 1);
+                CHECK(stats.memoryHits == 1);
+                CHECK(stats.diskHits == 0);
+
+                // フラグが違えば別のキー
+                cache.getFromFile(source, "main", "ps_4_0", 1);
+                CHECK(cache.getStats().compiles == 2);
+            }
+
+            // 作り直したキャッシュはディスクから読む
+            Lib::ShaderCache cache(compiler, temp.file("cache"));
+            auto loaded = cache.getFromFile(source, "main", "ps_4_0", 0);
+            CHECK(loaded != nullptr && *loaded == *first);
+            CHECK(cache.getStats().diskHits == 1);
+            CHECK(cache.getStats().compiles == 0);
+
+            // コンパイラの版が変わればキーが変わる
+            compiler->version = 2;
+            cache.clearMemory();
+            cache.getFromFile(source, "main", "ps_4_0", 0);
+            CHECK(cache.getStats().compiles == 1);
+        }
+
+        // #includeしたファイルの変更でディスクキャッシュを捨てる
+        void testIncludeInvalidation()
+        {
+            TempDirectory temp("shadercache_include");
+            auto source = temp.file("a.hlsl");
+            writeFile(source, "#include \"common.hlsli\"\nfloat4 main() : SV_Target { return COLOR; }");
+            writeFile(temp.file("common.hlsli"), "#define COLOR 1");
+            auto compiler = std::make_shared<StubCompiler>();
+
+            Lib::ShaderBytecode before;
+            {
+                Lib::ShaderCache cache(compiler, temp.file("cache"));
+                before = cache.getFromFile(source, "main", "ps_4_0", 0);
+                CHECK(before != nullptr);
+            }
+            {
+                // 変更がなければディスクから読む
+                Lib::ShaderCache cache(compiler, temp.file("cache"));
+                cache.getFromFile(source, "main", "ps_4_0", 0);
+                CHECK(cache.getStats().diskHits == 1);
+                CHECK(cache.getStats().invalidations == 0);
+            }
+
+            writeFile(temp.file("common.hlsli"), "#define COLOR 0.5");
+            {
+                Lib::ShaderCache cache(compiler, temp.file("cache"));
+                auto after = cache.getFromFile(source, "main", "ps_4_0", 0);
+                auto stats = cache.getStats();
+                CHECK(stats.invalidations == 1);
+                CHECK(stats.diskHits == 0);
+                CHECK(stats.compiles == 1);
+                CHECK(after != nullptr && *after != *before);
+            }
+            {
+                // 書き直されたキャッシュは新しい内容で使える
+                Lib::ShaderCache cache(compiler, temp.file("cache"));
+                cache.getFromFile(source, "main", "ps_4_0", 0);
+                CHECK(cache.getStats().diskHits == 1);
+            }
+
+            // #includeしたファイルが消えた場合も捨てる
+            std::filesystem::remove(temp.file("common.hlsli"));
+            Lib::ShaderCache cache(compiler, temp.file("cache"));
+            std::string error;
+            auto missing = cache.getFromFile(source, "main", "ps_4_0", 0, {}, &error);
+            CHECK(missing == nullptr);
+            CHECK(cache.getStats().invalidations == 1);
+            CHECK(error.find("common.hlsli") != std::string::npos);
+        }
+
+        // 途中までしか書かれていないファイルや壊れたファイル
+        void testCorruptEntries()
+        {
+            TempDirectory temp("shadercache_corrupt");
+            auto source = temp.file("a.hlsl");
+            writeFile(source, "float4 main() : SV_Target { return 1; }");
+            auto compiler = std::make_shared<StubCompiler>();
+            {
+                Lib::ShaderCache cache(compiler, temp.file("cache"));
+                cache.getFromFile(source, "main", "ps_4_0", 0);
+            }
+            auto path = findCacheFile(temp.file("cache"));
+            CHECK(!path.empty());
+            auto size = std::filesystem::file_size(path);
+
+            // 末尾が欠けている
+            std::filesystem::resize_file(path, size - 1);
+            {
+                Lib::ShaderCache cache(compiler, temp.file("cache"));
+                CHECK(cache.getFromFile(source, "main", "ps_4_0", 0) != nullptr);
+                CHECK(cache.getStats().invalidations == 1);
+                CHECK(cache.getStats().compiles == 1);
+            }
+
+            // バイトコードの大きさが壊れている(確保する前に弾く)
+            {
+                std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+                uint64_t huge = ~0ull >> 8;
+                file.seekp(16);
+                file.write(reinterpret_cast<const char*>(&huge), sizeof(huge));
+            }
+            {
+                Lib::ShaderCache cache(compiler, temp.file("cache"));
+                CHECK(cache.getFromFile(source, "main", "ps_4_0", 0) != nullptr);
+                CHECK(cache.getStats().invalidations == 1);
+            }
+
+            // 内容が壊れている(チェックサムで弾く)
+            {
+                std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+                file.seekp(static_cast<std::streamoff>(size - 1));
+                file.put('\x5A');
+            }
+            Lib::ShaderCache cache(compiler, temp.file("cache"));
+            CHECK(cache.getFromFile(source, "main", "ps_4_0", 0) != nullptr);
+            CHECK(cache.getStats().invalidations == 1);
+        }
+
+        // コンパイル中に待っていたスレッドにもエラーを渡す
+        void testErrorPropagation()
+        {
+            auto compiler = std::make_shared<StubCompiler>();
+            compiler->gate = true;
+            Lib::ShaderCache cache(compiler);
+
+            Lib::ShaderSource source{ "bad.hlsl", "error", "main", "ps_4_0", 0, {} };
+            std::string firstError;
+            std::string waiterError;
+            Lib::ShaderBytecode firstResult  = std::make_shared<std::vector<uint8_t>>();
+            Lib::ShaderBytecode waiterResult = std::make_shared<std::vector<uint8_t>>();
+
+            std::thread first([&]() { firstResult = cache.get(source, &firstError); });
+            while (!compiler->entered) {
+                std::this_thread::yield();
+            }
+            std::thread waiter([&]() { waiterResult = cache.get(source, &waiterError); });
+            // 待つ側がコンパイル中の項目を見つけてから失敗させる
+            while (cache.getStats().memoryHits == 0) {
+                std::this_thread::yield();
+            }
+            compiler->open = true;
+            first.join();
+            waiter.join();
+
+            CHECK(firstResult == nullptr);
+            CHECK(waiterResult == nullptr);
+            CHECK(firstError == "stub: syntax error");
+            CHECK(waiterError == "stub: syntax error");
+            CHECK(compiler->compiles == 1);
+
+            // 失敗は記録しないので次はコンパイルし直す
+            compiler->gate = false;
+            cache.get(source);
+            CHECK(compiler->compiles == 2);
+        }
+    }
+
+    // シェーダーキャッシュ
+    void runShaderCache()
+    {
+        testHitAndMiss();
+        testIncludeInvalidation();
+        testCorruptEntries();
+        testErrorPropagation();
+    }
+}
@@ -0,0 +1,131 @@
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include "Test.h"
+#include "NullRenderDevice.h"
+#include "ResourceRegistry.h"
+#include "StaticBatcher.h"
+
+namespace Test
+{
+    namespace
+    {
+        const float EPSILON = 1e-5f;
+
+        float dot(const float a[3], const float b[3])
+        {
+            return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+        }
+
+        // 平面x + y = 1上の三角形(法線は(1, 1, 0)の向き)
+        std::vector<Lib::SimpleVertex> slantedTriangle()
+        {
+            const float n = std::sqrt(0.5f);
+            return {
+                { { 1.0f, 0.0f, 0.0f }, { n, n, 0.0f } },
+                { { 0.0f, 1.0f, 0.0f }, { n, n, 0.0f } },
+                { { 0.0f, 1.0f, 1.0f }, { n, n, 0.0f } },
+            };
+        }
+
+        // 記録した頂点バッファの転送内容(転送先の先頭から)
+        std::vector<Lib::SimpleVertex> uploadedVertices(const Lib::CommandList &commands)
+        {
+            for (auto &command : commands.getCommands()) {
+                if (command.type == Lib::CommandType::UpdateBuffer && command.arg2 == 0 && command.arg1 % sizeof(Lib::SimpleVertex) == 0) {
+                    std::vector<Lib::SimpleVertex> vertices(command.arg1 / sizeof(Lib::SimpleVertex));
+                    std::memcpy(vertices.data(), commands.getPayload(command), command.arg1);
+                    return vertices;
+                }
+            }
+            return {};
+        }
+
+        // 軸ごとに違う拡大率でも法線が面に垂直なままになる
+        void testNonUniformScaleNormals()
+        {
+            Lib::NullRenderDevice  device;
+            Lib::ResourceRegistry  registry(device);
+            Lib::StaticBatcher     batcher(registry);
+            auto source = slantedTriangle();
+            const uint16_t indices[] = { 0, 1, 2 };
+            Lib::MeshView mesh = { source.data(), 3, indices, 3, Lib::IndexFormat::UInt16 };
+
+            // 拡大(4, 1, 1)と、x軸で反転する拡大(-2, 1, 1)
+            const Lib::Matrix worlds[] = {
+                Lib::Matrix::scale(4.0f, 1.0f, 1.0f) * Lib::Matrix::translate(0.0f, 2.0f, 0.0f),
+                Lib::Matrix::scale(-2.0f, 1.0f, 1.0f),
+            };
+            for (auto &world : worlds) {
+                batcher.add(mesh, world);
+            }
+            Lib::CommandList commands;
+            batcher.record(commands);
+            auto vertices = uploadedVertices(commands);
+            CHECK(vertices.size() == 6);
+            if (vertices.size() != 6) {
+                return;
+            }
+
+            for (int m = 0; m < 2; ++m) {
+                auto *v = &vertices[m * 3];
+                const float edge1[3] = { v[1].pos[0] - v[0].pos[0], v[1].pos[1] - v[0].pos[1], v[1].pos[2] - v[0].pos[2] };
+                const float edge2[3] = { v[2].pos[0] - v[0].pos[0], v[2].pos[1] - v[0].pos[1], v[2].pos[2] - v[0].pos[2] };
+                for (int i = 0; i < 3; ++i) {
+                    CHECK(std::fabs(dot(v[i].normal, v[i].normal) - 1.0f) < EPSILON);
+                    CHECK(std::fabs(dot(v[i].normal, edge1)) < EPSILON);
+                    CHECK(std::fabs(dot(v[i].normal, edge2)) < EPSILON);
+                }
+            }
+            // (4, 1, 1)では法線は(1/4, 1, 0)の向きへ寝る(ワールド行列のままなら(4, 1, 0)になる)
+            const float expected[3] = { 0.25f / std::sqrt(1.0625f), 1.0f / std::sqrt(1.0625f), 0.0f };
+            CHECK(std::fabs(dot(vertices[0].normal, expected) - 1.0f) < EPSILON);
+            // 反転しても表側を向いたまま(xだけ符号が変わる)
+            CHECK(vertices[3].normal[0] < 0.0f);
+            CHECK(vertices[3].normal[1] > 0.0f);
+        }
+
+        // 頂点プールだけに穴がある場合も詰める
+        void testVertexFragmentation()
+        {
+            Lib::NullRenderDevice  device;
+            Lib::ResourceRegistry  registry(device);
+            Lib::StaticBatcher     batcher(registry);
+
+            // 頂点が多くインデックスが少ないメッシュと、その逆のメッシュ
+            std::vector<Lib::SimpleVertex> manyVertices(100, Lib::SimpleVertex{ { 0.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f } });
+            const uint16_t fewIndices[] = { 0, 1, 2 };
+            std::vector<uint16_t> manyIndices(30, 0);
+            for (size_t i = 0; i < manyIndices.size(); ++i) {
+                manyIndices[i] = static_cast<uint16_t>(i % 3);
+            }
+            Lib::MeshView vertexHeavy = { manyVertices.data(), 100, fewIndices, 3, Lib::IndexFormat::UInt16 };
+            Lib::MeshView indexHeavy  = { manyVertices.data(), 3, manyIndices.data(), 30, Lib::IndexFormat::UInt16 };
+
+            auto heavy = batcher.add(vertexHeavy, Lib::Matrix::Identify);
+            batcher.add(indexHeavy, Lib::Matrix::Identify);
+            Lib::CommandList commands;
+            batcher.record(commands);
+            CHECK(batcher.getStats().compactions == 0);
+
+            // 頂点の穴は100 / 103、インデックスの穴は3 / 33
+            CHECK(batcher.remove(heavy));
+            CHECK(batcher.getVertexCount() == 103);
+            CHECK(batcher.getFragmentation() > Lib::StaticBatcher::COMPACT_THRESHOLD);
+
+            commands.reset();
+            batcher.record(commands);
+            CHECK(batcher.getStats().compactions == 1);
+            CHECK(batcher.getFragmentation() == 0.0f);
+            CHECK(batcher.getVertexCount() == 3);
+            CHECK(batcher.getIndexCount() == 30);
+            CHECK(batcher.getStats().draws == 1);
+        }
+    }
+
+    void runStaticBatcher()
+    {
+        testNonUniformScaleNormals();
+        testVertexFragmentation();
+    }
+}
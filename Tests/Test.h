@@ -0,0 +1,52 @@
+#pragma once
+#ifndef TEST_H
+#define TEST_H
+#include <cstdio>
+#include <string>
+
+namespace Test
+{
+    // 失敗した検査の数(TestMain.cppで定義)
+    extern int failures;
+
+    // 検査(失敗したら場所と式を表示して数える)
+    inline bool check(const bool condition, const char *expression, const char *file, const int line)
+    {
+        if (!condition) {
+            std::printf("  FAILED %s(%d): %s\n", file, line, expression);
+            ++failures;
+        }
+        return condition;
+    }
+
+    // 一時ディレクトリ(テストごとに作り直し、終わったら消す)
+    class TempDirectory
+    {
+    public:
+        explicit TempDirectory(const std::string &name);
+        ~TempDirectory();
+
+        const std::string &path() const { return directory; }
+        // ディレクトリ内のファイルのパス
+        std::string file(const std::string &name) const;
+
+    private:
+        // コピーの禁止
+        TempDirectory(const TempDirectory &) = delete;
+        TempDirectory& operator=(const TempDirectory &) = delete;
+
+        std::string directory;
+    };
+
+    // 各テストのエントリーポイント(失敗はfailuresに数える)
+    void runShaderCache();
+    void runResourceRegistry();
+    void runCommandList();
+    void runUploadRing();
+    void runStaticBatcher();
+    void runPrimitiveTables();
+}
+
+#define CHECK(expression) ::Test::check(static_cast<bool>(expression), #expression, __FILE__, __LINE__)
+
+#endif
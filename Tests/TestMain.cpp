@@ -0,0 +1,72 @@
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include "Test.h"
+
+namespace Test
+{
+    int failures = 0;
+
+    // コンストラクタ
+    TempDirectory::TempDirectory(const std::string &name)
+    {
+        std::error_code ec;
+        auto base = std::filesystem::temp_directory_path(ec);
+        directory = ((ec ? std::filesystem::path(".") : base) / ("3DCGLibTests_" + name)).string();
+        std::filesystem::remove_all(directory, ec);
+        std::filesystem::create_directories(directory, ec);
+    }
+
+    // デストラクタ
+    TempDirectory::~TempDirectory()
+    {
+        std::error_code ec;
+        std::filesystem::remove_all(directory, ec);
+    }
+
+    // ディレクトリ内のファイルのパス
+    std::string TempDirectory::file(const std::string &name) const
+    {
+        return (std::filesystem::path(directory) / name).string();
+    }
+}
+
+namespace
+{
+    // テストの一覧
+    struct Entry
+    {
+        const char *name;
+        void (*run)();
+    };
+    const Entry TESTS[] = {
+        { "shadercache", Test::runShaderCache },
+        { "registry",    Test::runResourceRegistry },
+        { "commandlist", Test::runCommandList },
+        { "uploadring",  Test::runUploadRing },
+        { "staticbatch", Test::runStaticBatcher },
+        { "primitives",  Test::runPrimitiveTables },
+    };
+}
+
+// 引数がなければ全てのテスト、あれば名前が一致するものだけを実行する
+// 失敗があれば1を返す
+int main(int argc, char **argv)
+{
+    int executed = 0;
+    for (auto &test : TESTS) {
+        if (argc > 1 && std::strcmp(argv[1], test.name) != 0) {
+            continue;
+        }
+        int before = Test::failures;
+        test.run();
+        std::printf("%s %s\n", Test::failures == before ? "ok    " : "FAILED", test.name);
+        ++executed;
+    }
+    if (executed == 0) {
+        std::printf("unknown test: %s\n", argv[1]);
+        return 1;
+    }
+    std::printf("%d tests, %d failed checks\n", executed, Test::failures);
+    return Test::failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,125 @@
+#include <vector>
+#include "Test.h"
+#include "UploadRing.h"
+
+namespace Test
+{
+    namespace
+    {
+        const uint32_t CAPACITY = 1024;
+
+        // 末尾に収まらない割り当ての折り返し
+        void testWrapAround()
+        {
+            Lib::SimulatedFence  fence(100);
+            Lib::UploadRing      ring(CAPACITY, fence);
+            std::vector<uint8_t> memory(CAPACITY);
+            ring.setMemory(memory.data());
+
+            ring.beginFrame();
+            auto first = ring.allocate(600);
+            CHECK(first);
+            CHECK(first.offset == 0);
+            ring.endFrame();
+
+            // GPUが最初のフレームを使い終わった
+            fence.complete(1);
+            ring.beginFrame();
+            auto second = ring.allocate(600);
+            CHECK(second);
+            CHECK(second.offset == 0);
+            CHECK(second.data == memory.data());
+            ring.endFrame();
+
+            auto &stats = ring.getStats();
+            CHECK(stats.allocations == 1);
+            CHECK(stats.wraps == 1);
+            CHECK(stats.paddingBytes == CAPACITY - 600);
+            CHECK(stats.stalls == 0);
+            CHECK(fence.getWaitCount() == 0);
+        }
+
+        // 完了していないフェンスでの待ち
+        void testStall()
+        {
+            Lib::SimulatedFence  fence(100);
+            Lib::UploadRing      ring(CAPACITY, fence);
+            std::vector<uint8_t> memory(CAPACITY);
+            ring.setMemory(memory.data());
+
+            for (uint32_t i = 0; i < 2; ++i) {
+                ring.beginFrame();
+                auto allocation = ring.allocate(512);
+                CHECK(allocation.offset == i * 512);
+                ring.endFrame();
+                CHECK(ring.getStats().stalls == 0);
+            }
+            CHECK(fence.getCompletedValue() == 0);
+            CHECK(ring.getUsed() == CAPACITY);
+
+            // 空きがないので最も古いフレームだけを待って再利用する
+            ring.beginFrame();
+            auto allocation = ring.allocate(256);
+            CHECK(allocation);
+            CHECK(allocation.offset == 0);
+            CHECK(fence.getWaitCount() == 1);
+            CHECK(fence.getCompletedValue() == 1);
+            ring.endFrame();
+            CHECK(ring.getStats().stalls == 1);
+            CHECK(ring.getStats().failures == 0);
+
+            // 現在のフレームだけで埋まっている時は待たずに失敗する
+            Lib::SimulatedFence other(100);
+            Lib::UploadRing     full(CAPACITY, other);
+            full.setMemory(memory.data());
+            full.beginFrame();
+            CHECK(full.allocate(CAPACITY));
+            CHECK(!full.allocate(16, 16));
+            full.endFrame();
+            CHECK(full.getStats().failures == 1);
+            CHECK(full.getStats().stalls == 0);
+            CHECK(other.getWaitCount() == 0);
+
+            // 不正な引数
+            full.beginFrame();
+            CHECK(!full.allocate(0));
+            CHECK(!full.allocate(CAPACITY + 1));
+            CHECK(!full.allocate(16, 24));
+            full.endFrame();
+            CHECK(full.getStats().failures == 3);
+        }
+
+        // 回収した領域の再利用
+        void testReuseAfterReclaim()
+        {
+            // 1フレーム遅れでGPUが追いつく
+            Lib::SimulatedFence  fence(1);
+            Lib::UploadRing      ring(CAPACITY, fence);
+            std::vector<uint8_t> memory(CAPACITY);
+            ring.setMemory(memory.data());
+
+            for (uint32_t i = 0; i < 16; ++i) {
+                ring.beginFrame();
+                auto allocation = ring.allocate(512);
+                CHECK(allocation);
+                CHECK(allocation.offset == (i % 2) * 512);
+                ring.endFrame();
+                CHECK(ring.getStats().stalls == 0);
+            }
+            CHECK(fence.getWaitCount() == 0);
+
+            // 回収すると使用中はGPUが使っている1フレーム分だけになる
+            ring.beginFrame();
+            CHECK(ring.getUsed() == 512);
+            ring.endFrame();
+        }
+    }
+
+    // 転送用リングバッファ
+    void runUploadRing()
+    {
+        testWrapAround();
+        testStall();
+        testReuseAfterReclaim();
+    }
+}